@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    CharacteristicTableBenchmark.cpp
+
+    The cost of the detector with the characteristic table and with the direct computation, and how far they differ.
+
+  ==============================================================================
+*/
+
+#include "KernelVerifier.h"
+#include "GainReductionComputer.h"
+#include "CharacteristicTable.h"
+#include <cstdio>
+#include <limits>
+#include <memory>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+
+    KernelVerifier::Kernel makeDetector (const float knee, const float ratio, const bool useTable)
+    {
+        auto computer = std::make_shared<GainReductionComputer>();
+        computer->setThreshold (-20.0f);
+        computer->setKnee (knee);
+        computer->setRatio (ratio);
+        computer->setAttackTime (0.001f);
+        computer->setReleaseTime (0.1f);
+        computer->prepare (sampleRate);
+
+        auto table = std::make_shared<CharacteristicTable>();
+        if (useTable)
+        {
+            table->build (*computer);
+            computer->setCharacteristicTable (table.get());
+        }
+
+        return [computer, table] (const float* in, float* out, int n) { computer->computeGainInDecibelsFromSidechainSignal (in, out, n); };
+    }
+}
+
+int main()
+{
+    const KernelVerifier::Signal signals[] = { KernelVerifier::Signal::sineSweep, KernelVerifier::Signal::whiteNoise,
+                                               KernelVerifier::Signal::bursts, KernelVerifier::Signal::impulses };
+
+    std::printf ("%-6s %-6s %-11s %14s %14s %16s\n", "knee", "ratio", "signal", "direct ns/smp", "table ns/smp", "max diff in dB");
+
+    for (const float knee : { 0.0f, 6.0f })
+        for (const float ratio : { 4.0f, std::numeric_limits<float>::infinity() })
+        {
+            KernelVerifier verifier (sampleRate, 512);
+
+            for (const auto signal : signals)
+            {
+                // only measuring: no budget to pass
+                const auto report = verifier.compare (signal, makeDetector (knee, ratio, false), makeDetector (knee, ratio, true),
+                                                      { std::numeric_limits<float>::infinity(), 0.0f, std::numeric_limits<float>::infinity() }, 1 << 20);
+
+                std::printf ("%-6g %-6g %-11s %14.1f %14.1f %16.3g\n", knee, ratio, report.signalName.c_str(),
+                             report.referenceNanosecondsPerSample, report.candidateNanosecondsPerSample, report.maxAbsError);
+            }
+        }
+
+    return 0;
+}
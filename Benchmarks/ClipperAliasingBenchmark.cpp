@@ -0,0 +1,177 @@
+/*
+  ==============================================================================
+
+    ClipperAliasingBenchmark.cpp
+
+    The alias energy of the clipper with and without antiderivative antialiasing, against the plain curve at 2x and 4x oversampling with ideal filters, and what each order costs.
+
+  ==============================================================================
+*/
+
+#include "AntiderivativeClipper.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int fftSize = 8192;
+    constexpr int settleLength = 512;
+    constexpr int blockSize = 64;
+    constexpr double pi = 3.14159265358979323846;
+
+    /** 6 dB over the clipper's ceiling of 0 dBFS. */
+    constexpr double amplitude = 2.0;
+
+    /** In-place radix-2 FFT; the size has to be a power of two. */
+    void fft (std::vector<std::complex<double>>& data)
+    {
+        const size_t size = data.size();
+
+        for (size_t i = 1, j = 0; i < size; ++i)
+        {
+            size_t bit = size >> 1;
+            for (; (j & bit) != 0; bit >>= 1)
+                j ^= bit;
+            j ^= bit;
+
+            if (i < j)
+                std::swap (data[i], data[j]);
+        }
+
+        for (size_t length = 2; length <= size; length <<= 1)
+        {
+            const auto step = std::polar (1.0, -2.0 * pi / static_cast<double> (length));
+
+            for (size_t start = 0; start < size; start += length)
+            {
+                std::complex<double> twiddle (1.0);
+                for (size_t k = 0; k < length / 2; ++k)
+                {
+                    const auto even = data[start + k];
+                    const auto odd = data[start + k + length / 2] * twiddle;
+                    data[start + k] = even + odd;
+                    data[start + k + length / 2] = even - odd;
+                    twiddle *= step;
+                }
+            }
+        }
+    }
+
+    /**
+     The energy of everything below the base rate's Nyquist frequency that isn't a harmonic of the fundamental, relative to the fundamental, in dB. The sine completes a whole number of periods in the analysed samples, so every harmonic falls exactly onto a bin and no window is needed; an odd fundamental bin makes the aliases fall between the harmonics.
+
+     The signal may run at a multiple of the base rate: keeping only the bins below the base rate's Nyquist frequency is then an ideal decimation filter.
+     */
+    double getAliasEnergyInDecibels (const std::vector<float>& signal, const int fundamentalBin)
+    {
+        std::vector<std::complex<double>> spectrum (signal.begin(), signal.end());
+        fft (spectrum);
+
+        const double fundamental = std::norm (spectrum[static_cast<size_t> (fundamentalBin)]);
+        double alias = 0.0;
+
+        for (int bin = 1; bin < fftSize / 2; ++bin)
+            if (bin % fundamentalBin != 0)
+                alias += std::norm (spectrum[static_cast<size_t> (bin)]);
+
+        return 10.0 * std::log10 (alias / fundamental);
+    }
+
+    std::vector<float> makeSine (const int fundamentalBin, const int oversamplingFactor, const int numSamples)
+    {
+        const double frequency = sampleRate * fundamentalBin / fftSize;
+        std::vector<float> signal (static_cast<size_t> (numSamples));
+
+        for (int n = 0; n < numSamples; ++n)
+            signal[static_cast<size_t> (n)] = static_cast<float> (amplitude * std::sin (2.0 * pi * frequency * n / (sampleRate * oversamplingFactor)));
+
+        return signal;
+    }
+
+    /** The plain curve at the base rate or, oversampled, before an ideal decimation filter. */
+    double measurePlain (const int fundamentalBin, const int oversamplingFactor)
+    {
+        auto signal = makeSine (fundamentalBin, oversamplingFactor, fftSize * oversamplingFactor);
+        for (auto& sample : signal)
+            sample = AntiderivativeClipper::clip (sample);
+
+        // fftSize * oversamplingFactor samples span the same time, so the bins stay the same frequencies
+        return getAliasEnergyInDecibels (signal, fundamentalBin);
+    }
+
+    /** Clips one block: with the plain curve when the order is off, which makes the clipper pass its input through. */
+    void clipBlock (AntiderivativeClipper& clipper, float* samples, const int numSamples)
+    {
+        if (clipper.getOrder() == AntiderivativeClipper::Order::off)
+            for (int i = 0; i < numSamples; ++i)
+                samples[i] = AntiderivativeClipper::clip (samples[i]);
+        else
+            clipper.process (samples, numSamples, 0);
+    }
+
+    /** The clipper at the base rate, processed in blocks, with the first samples left out of the analysis so its state has settled. */
+    double measureClipper (const int fundamentalBin, const AntiderivativeClipper::Order order)
+    {
+        AntiderivativeClipper clipper;
+        clipper.prepare (blockSize, 1);
+        clipper.setCeiling (0.0f);
+        clipper.setOrder (order);
+
+        auto signal = makeSine (fundamentalBin, 1, settleLength + fftSize);
+        for (int start = 0; start < static_cast<int> (signal.size()); start += blockSize)
+            clipBlock (clipper, signal.data() + start, blockSize);
+
+        return getAliasEnergyInDecibels (std::vector<float> (signal.begin() + settleLength, signal.end()), fundamentalBin);
+    }
+
+    double measureNanosecondsPerSample (const AntiderivativeClipper::Order order)
+    {
+        AntiderivativeClipper clipper;
+        clipper.prepare (blockSize, 1);
+        clipper.setCeiling (0.0f);
+        clipper.setOrder (order);
+
+        const auto sine = makeSine (401, 1, fftSize);
+        std::vector<float> block (blockSize);
+        constexpr int numBlocks = 200000;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            std::copy_n (sine.begin() + (i * blockSize) % fftSize, blockSize, block.begin());
+            clipBlock (clipper, block.data(), blockSize);
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        return std::chrono::duration<double, std::nano> (end - start).count() / (static_cast<double> (numBlocks) * blockSize);
+    }
+}
+
+int main()
+{
+    std::printf ("alias energy relative to the fundamental in dB, sine 6 dB over the ceiling at %.0f kHz\n", sampleRate / 1000.0);
+    std::printf ("%-10s %8s %8s %8s %10s %10s\n", "f0", "plain", "ADAA1", "ADAA2", "2x ideal", "4x ideal");
+
+    // odd bins, so the aliases don't land on harmonics
+    for (const int fundamentalBin : { 401, 811, 1201 })
+    {
+        std::printf ("%-3.1f kHz   ", sampleRate * fundamentalBin / fftSize / 1000.0);
+        std::printf (" %8.1f", measureClipper (fundamentalBin, AntiderivativeClipper::Order::off));
+        std::printf (" %8.1f", measureClipper (fundamentalBin, AntiderivativeClipper::Order::first));
+        std::printf (" %8.1f", measureClipper (fundamentalBin, AntiderivativeClipper::Order::second));
+        std::printf (" %10.1f", measurePlain (fundamentalBin, 2));
+        std::printf (" %10.1f\n", measurePlain (fundamentalBin, 4));
+    }
+
+    std::printf ("\ncost in ns/sample, one channel in blocks of %d: plain %.1f, ADAA1 %.1f, ADAA2 %.1f\n", blockSize,
+                 measureNanosecondsPerSample (AntiderivativeClipper::Order::off),
+                 measureNanosecondsPerSample (AntiderivativeClipper::Order::first),
+                 measureNanosecondsPerSample (AntiderivativeClipper::Order::second));
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    ControlRateBenchmark.cpp
+
+    How far the decimated detector deviates from the one at every sample, and what it saves.
+
+  ==============================================================================
+*/
+
+#include "KernelVerifier.h"
+#include "GainReductionComputer.h"
+#include <cstdio>
+#include <limits>
+#include <memory>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+
+    KernelVerifier::Kernel makeDetector (const int decimationFactor)
+    {
+        // the setting the control rate was measured with: brickwall at -20 dB, 1 ms attack
+        auto computer = std::make_shared<GainReductionComputer>();
+        computer->setThreshold (-20.0f);
+        computer->setKnee (0.0f);
+        computer->setRatio (std::numeric_limits<float>::infinity());
+        computer->setAttackTime (0.001f);
+        computer->setReleaseTime (0.1f);
+        computer->setDecimationFactor (decimationFactor);
+        computer->prepare (sampleRate);
+
+        return [computer] (const float* in, float* out, int n) { computer->computeGainInDecibelsFromSidechainSignal (in, out, n); };
+    }
+}
+
+int main()
+{
+    const KernelVerifier::Signal signals[] = { KernelVerifier::Signal::sineSweep, KernelVerifier::Signal::whiteNoise,
+                                               KernelVerifier::Signal::bursts, KernelVerifier::Signal::impulses };
+
+    std::printf ("max deviation from the detector at every sample in dB, and the cost in ns/sample (every sample -> decimated)\n");
+    std::printf ("%-8s %8s %8s %8s %9s %20s\n", "factor", "sweep", "noise", "bursts", "impulses", "cost");
+
+    for (const int factor : { 4, 8, 16 })
+    {
+        KernelVerifier verifier (sampleRate, 512);
+        std::printf ("%-8d", factor);
+
+        double referenceCost = 0.0, decimatedCost = 0.0;
+        for (const auto signal : signals)
+        {
+            // only measuring: no budget to pass
+            const auto report = verifier.compare (signal, makeDetector (1), makeDetector (factor), { std::numeric_limits<float>::infinity(), 0.0f, std::numeric_limits<float>::infinity() });
+            std::printf (" %8.2f", report.maxAbsError);
+
+            referenceCost += report.referenceNanosecondsPerSample / 4.0;
+            decimatedCost += report.candidateNanosecondsPerSample / 4.0;
+        }
+
+        std::printf (" %10.1f -> %5.1f\n", referenceCost, decimatedCost);
+    }
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    EnvelopeCacheBenchmark.cpp
+
+    How long the two-pass limiter's first pass over ten minutes of stereo takes without the envelope cache, on a miss, on a hit and after an edit late in the file.
+
+  ==============================================================================
+*/
+
+#include "TwoPassLimiter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+    constexpr int64_t numSamples = static_cast<int64_t> (600 * sampleRate);
+    constexpr int blockSize = 4096;
+
+    struct Analysis
+    {
+        double seconds = 0.0;
+        int64_t numSamplesFromCache = 0;
+        std::vector<float> envelope;
+    };
+
+    /** beginAnalysis() to endAnalysis(), which includes storing the entry on a miss. */
+    Analysis analyse (const std::vector<float> (&input)[numChannels], EnvelopeCache* cache)
+    {
+        TwoPassLimiter limiter;
+        limiter.setThreshold (-12.0f);
+        limiter.setAttackTime (0.001f);
+        limiter.setReleaseTime (0.2f);
+        limiter.setEnvelopeCache (cache);
+
+        Analysis analysis;
+        const auto start = std::chrono::steady_clock::now();
+
+        limiter.beginAnalysis (sampleRate, numChannels);
+        for (int64_t position = 0; position < numSamples; position += blockSize)
+        {
+            const float* channels[] = { input[0].data() + position, input[1].data() + position };
+            limiter.analyse (channels, static_cast<int> (std::min<int64_t> (blockSize, numSamples - position)));
+        }
+        limiter.endAnalysis();
+
+        analysis.seconds = std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+        analysis.numSamplesFromCache = limiter.getNumSamplesFromCache();
+        if (limiter.getEnvelope() != nullptr)
+            analysis.envelope.assign (limiter.getEnvelope(), limiter.getEnvelope() + numSamples);
+
+        return analysis;
+    }
+
+    void print (const char* name, const Analysis& analysis, const Analysis& reference)
+    {
+        const bool same = analysis.envelope.size() == reference.envelope.size()
+                       && std::memcmp (analysis.envelope.data(), reference.envelope.data(), analysis.envelope.size() * sizeof (float)) == 0;
+
+        std::printf ("%-22s %7.3f s   %5.1f%% from the cache   %s\n", name, analysis.seconds,
+                     100.0 * static_cast<double> (analysis.numSamplesFromCache) / static_cast<double> (numSamples), same ? "identical" : "DIFFERENT");
+    }
+}
+
+int main()
+{
+    std::vector<float> input[numChannels];
+    std::mt19937 random (5);
+    std::normal_distribution<float> noise (0.0f, 0.3f);
+    for (auto& channel : input)
+    {
+        channel.resize (static_cast<size_t> (numSamples));
+        for (auto& sample : channel)
+            sample = noise (random);
+    }
+
+    const auto directory = std::filesystem::temp_directory_path() / "EnvelopeCacheBenchmark";
+    std::filesystem::remove_all (directory);
+    std::filesystem::create_directories (directory);
+    EnvelopeCache cache (directory.string());
+
+    std::printf ("first pass over 10 minutes of 48 kHz stereo noise, envelopes compared with the analysis without the cache\n");
+
+    const auto reference = analyse (input, nullptr);
+    print ("without the cache", reference, reference);
+    print ("miss", analyse (input, &cache), reference);
+    print ("hit", analyse (input, &cache), reference);
+
+    // a 1 s edit at 70% of the file
+    for (int64_t i = numSamples * 7 / 10; i < numSamples * 7 / 10 + static_cast<int64_t> (sampleRate); ++i)
+        input[0][static_cast<size_t> (i)] *= 3.0f;
+
+    const auto editedReference = analyse (input, nullptr);
+    print ("1 s edit at 70%", analyse (input, &cache), editedReference);
+
+    std::filesystem::remove_all (directory);
+    return 0;
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    MinMaxPyramidBenchmark.cpp
+
+    What pushing a meter value into the history costs, and what reading a 1000-column display from it costs at different zooms.
+
+  ==============================================================================
+*/
+
+#include "MinMaxPyramid.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+
+    // as the processor prepares its histories: one bin per 64-sample sub-block, ten minutes
+    constexpr int samplesPerBin = 64;
+    constexpr int binsPerLevel = 4096;
+    constexpr int64_t historyLength = static_cast<int64_t> (600 * sampleRate);
+
+    constexpr int numColumns = 1000;
+}
+
+int main()
+{
+    MinMaxPyramid pyramid;
+    pyramid.prepare (samplesPerBin, binsPerLevel, historyLength);
+    std::printf ("%d levels of %d bins cover %.0f s in %d KB\n", pyramid.getNumLevels(), binsPerLevel, pyramid.getLengthInSamples() / sampleRate,
+                 static_cast<int> (static_cast<size_t> (pyramid.getNumLevels()) * binsPerLevel * sizeof (MinMaxPyramid::Range) / 1024));
+
+    // fifteen minutes of random block sizes, longer than the history
+    std::mt19937 random (1);
+    std::normal_distribution<float> level (-20.0f, 6.0f);
+    int64_t numSamples = 0;
+
+    const auto pushStart = std::chrono::steady_clock::now();
+    while (numSamples < static_cast<int64_t> (900 * sampleRate))
+    {
+        const int blockSize = 1 + static_cast<int> (random() % 300);
+        pyramid.push (level (random), blockSize);
+        numSamples += blockSize;
+    }
+    const double pushSeconds = std::chrono::duration<double> (std::chrono::steady_clock::now() - pushStart).count();
+    std::printf ("push: %.2f ns per sample\n", pushSeconds * 1.0e9 / static_cast<double> (numSamples));
+
+    for (const int64_t samplesPerColumn : { static_cast<int64_t> (samplesPerBin), static_cast<int64_t> (1000), static_cast<int64_t> (sampleRate), static_cast<int64_t> (10 * sampleRate) })
+    {
+        const int64_t endColumn = pyramid.getNumSamples (samplesPerColumn) / samplesPerColumn;
+        int numDrawn = 0;
+
+        // the fastest of a few repaints
+        double fastest = 1.0e30;
+        for (int run = 0; run < 20; ++run)
+        {
+            numDrawn = 0;
+            const auto start = std::chrono::steady_clock::now();
+
+            for (int x = 0; x < numColumns; ++x)
+            {
+                const int64_t column = endColumn - numColumns + x;
+                MinMaxPyramid::Range range;
+                numDrawn += pyramid.getRange (column * samplesPerColumn, (column + 1) * samplesPerColumn, range) ? 1 : 0;
+            }
+
+            fastest = std::min (fastest, std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now() - start).count());
+        }
+
+        std::printf ("%8lld samples per column: %6.1f ns per column, %4d of %d columns drawn\n", static_cast<long long> (samplesPerColumn), fastest / numColumns, numDrawn, numColumns);
+    }
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    OversamplingBenchmark.cpp
+
+    The cost of the processor at every oversampling factor and filter, to find the cheapest setting which passes.
+
+  ==============================================================================
+*/
+
+#include "ProcessorHarness.h"
+
+int main()
+{
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+    constexpr int numSeconds = 20;
+
+    AudioBuffer<float> input (numChannels, static_cast<int> (numSeconds * sampleRate));
+    ProcessorHarness::fillWithTestSignal (input, 1);
+
+    std::printf ("%-8s %-22s %8s %12s %10s\n", "factor", "filter", "latency", "ns/sample", "realtime");
+
+    const char* filterNames[] = { "Minimum Phase (IIR)", "Linear Phase (FIR)" };
+
+    for (int factorChoice = 0; factorChoice < 4; ++factorChoice)
+    {
+        // without oversampling, the filter doesn't matter
+        for (int quality = 0; quality < (factorChoice == 0 ? 1 : 2); ++quality)
+        {
+            TLimiterAudioProcessor processor;
+            ProcessorHarness::setParameter (processor, "lookAhead", 1.0f);
+            ProcessorHarness::setParameter (processor, "attack", 0.1f);
+            ProcessorHarness::setParameter (processor, "oversampling", static_cast<float> (factorChoice));
+            ProcessorHarness::setParameter (processor, "oversamplingQuality", static_cast<float> (quality));
+
+            if (! ProcessorHarness::prepare (processor, numChannels, sampleRate, blockSize))
+                return 1;
+
+            AudioBuffer<float> signal (input);
+
+            // one pass to warm up the caches, the second one counts
+            ProcessorHarness::process (processor, signal, [] (int) { return blockSize; });
+            signal.makeCopyOf (input);
+            const auto timing = ProcessorHarness::process (processor, signal, [] (int) { return blockSize; });
+
+            const double numSamples = static_cast<double> (input.getNumSamples());
+            std::printf ("%-8d %-22s %8d %12.1f %9.0fx\n", 1 << factorChoice, factorChoice == 0 ? "-" : filterNames[quality],
+                         processor.getLatencySamples(), 1.0e9 * timing.totalSeconds / numSamples, numSeconds / timing.totalSeconds);
+
+            processor.releaseResources();
+        }
+    }
+
+    return 0;
+}
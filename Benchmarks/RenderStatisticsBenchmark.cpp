@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    RenderStatisticsBenchmark.cpp
+
+    What collecting the render statistics costs per sample and channel, fed in blocks of different sizes.
+
+  ==============================================================================
+*/
+
+#include "RenderStatistics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+    constexpr int numSamples = 1 << 20;
+
+    /** The fastest of a few runs over the same interleaved stereo signal. */
+    double measureNanosecondsPerSample (const std::vector<float>& frames, const int blockSize)
+    {
+        RenderStatistics statistics;
+        statistics.prepare (sampleRate, numChannels, blockSize);
+
+        const std::vector<float> gainReduction (static_cast<size_t> (blockSize), -1.0f);
+        std::vector<float> key (static_cast<size_t> (blockSize));
+        double fastest = 1.0e30;
+
+        for (int run = 0; run < 5; ++run)
+        {
+            statistics.reset();
+            const auto start = std::chrono::steady_clock::now();
+
+            for (int offset = 0; offset < numSamples; offset += blockSize)
+            {
+                const float* block = frames.data() + offset * numChannels;
+                for (int i = 0; i < blockSize; ++i)
+                    key[static_cast<size_t> (i)] = std::max (std::abs (block[numChannels * i]), std::abs (block[numChannels * i + 1]));
+
+                statistics.addKeySignal (key.data(), blockSize);
+                statistics.addGainReduction (gainReduction.data(), blockSize);
+                for (int ch = 0; ch < numChannels; ++ch)
+                    statistics.addOutput (block + ch, blockSize, ch, numChannels);
+                statistics.endBlock (blockSize);
+            }
+
+            statistics.flush();
+            const auto end = std::chrono::steady_clock::now();
+            fastest = std::min (fastest, std::chrono::duration<double, std::nano> (end - start).count());
+        }
+
+        return fastest / (static_cast<double> (numSamples) * numChannels);
+    }
+}
+
+int main()
+{
+    std::vector<float> frames (static_cast<size_t> (numSamples * numChannels));
+    for (size_t n = 0; n < frames.size(); ++n)
+        frames[n] = static_cast<float> (0.8 * std::sin (0.0123 * static_cast<double> (n)));
+
+    std::printf ("%-12s %18s\n", "block size", "ns/sample/channel");
+    for (const int blockSize : { 16, 64, 512 })
+        std::printf ("%-12d %18.2f\n", blockSize, measureNanosecondsPerSample (frames, blockSize));
+
+    return 0;
+}
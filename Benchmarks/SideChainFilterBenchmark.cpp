@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    SideChainFilterBenchmark.cpp
+
+    What the detector EQ costs per sample and channel, against the unfiltered key.
+
+  ==============================================================================
+*/
+
+#include "SideChainFilter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 64;
+    constexpr int numBlocks = 100000;
+
+    template <typename Function>
+    double measureNanosecondsPerSample (const int numChannels, Function&& function)
+    {
+        double fastest = 1.0e30;
+        for (int run = 0; run < 3; ++run)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (int block = 0; block < numBlocks; ++block)
+                function();
+            const auto end = std::chrono::steady_clock::now();
+            fastest = std::min (fastest, std::chrono::duration<double, std::nano> (end - start).count());
+        }
+
+        return fastest / (static_cast<double> (numBlocks) * blockSize * numChannels);
+    }
+}
+
+int main()
+{
+    std::printf ("ns per sample and channel, blocks of %d\n", blockSize);
+    std::printf ("%-10s %12s %12s %14s %12s\n", "channels", "unfiltered", "high-pass", "high-pass+tilt", "per channel");
+
+    for (const int numChannels : { 2, 4, 8 })
+    {
+        std::mt19937 random (1);
+        std::uniform_real_distribution<float> noise (-1.0f, 1.0f);
+        std::vector<std::vector<float>> channels (static_cast<size_t> (numChannels), std::vector<float> (blockSize));
+        std::vector<const float*> channelPointers;
+        for (auto& channel : channels)
+        {
+            std::generate (channel.begin(), channel.end(), [&] { return noise (random); });
+            channelPointers.push_back (channel.data());
+        }
+
+        std::vector<float> key (blockSize);
+        std::vector<std::vector<float>> keys (static_cast<size_t> (numChannels), std::vector<float> (blockSize));
+        std::vector<float*> keyPointers;
+        for (auto& channelKey : keys)
+            keyPointers.push_back (channelKey.data());
+
+        // the key without the EQ: the maximum of the absolute values, as the limiter computes it
+        const double unfiltered = measureNanosecondsPerSample (numChannels, [&]
+        {
+            for (int i = 0; i < blockSize; ++i)
+                key[static_cast<size_t> (i)] = std::abs (channelPointers[0][i]);
+            for (int ch = 1; ch < numChannels; ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                    key[static_cast<size_t> (i)] = std::max (key[static_cast<size_t> (i)], std::abs (channelPointers[static_cast<size_t> (ch)][i]));
+        });
+
+        SideChainFilter filter;
+        filter.setEnabled (true);
+        filter.prepare (sampleRate, numChannels);
+
+        filter.setTilt (0.0f);
+        const double highPass = measureNanosecondsPerSample (numChannels, [&] { filter.processMaxAbs (channelPointers.data(), numChannels, key.data(), blockSize); });
+
+        filter.setTilt (3.0f);
+        const double withTilt = measureNanosecondsPerSample (numChannels, [&] { filter.processMaxAbs (channelPointers.data(), numChannels, key.data(), blockSize); });
+        const double perChannel = measureNanosecondsPerSample (numChannels, [&] { filter.processAbs (channelPointers.data(), keyPointers.data(), numChannels, blockSize); });
+
+        std::printf ("%-10d %12.2f %12.2f %14.2f %12.2f\n", numChannels, unfiltered, highPass, withTilt, perChannel);
+    }
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    WorkerPoolBenchmark.cpp
+
+    How the unlinked channels scale with the number of cores, with one fan-out per sub-block and one per host block.
+
+  ==============================================================================
+*/
+
+#include "WorkerPool.h"
+#include "LimiterCore.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 32;
+    constexpr int channelsPerTask = 4;
+    constexpr int numGroups = numChannels / channelsPerTask;
+    constexpr int hostBlockSize = 512;
+    constexpr int numSeconds = 10;
+
+    /** The plug-in's unlinked path for one channel group: detector EQ, look-ahead, clipper and dither. */
+    std::unique_ptr<LimiterCore> createGroup()
+    {
+        auto core = std::make_unique<LimiterCore>();
+        core->prepare (sampleRate, channelsPerTask);
+        core->setThreshold (-10.0f);
+        core->setLookAhead (true);
+        core->setChannelLink (false);
+        core->getSideChainFilter().setEnabled (true);
+        core->setClipper (AntiderivativeClipper::Order::second, 1.0f);
+        core->setDither (24, NoiseShapingDither::Shape::firstOrder);
+        return core;
+    }
+
+    /** Runs the whole signal through the pool and returns the seconds it took. With perSubBlock, every sub-block is a fan-out of its own, as the plug-in used to do it. */
+    double run (WorkerPool& pool, std::vector<std::vector<float>>& signal, const bool perSubBlock)
+    {
+        std::vector<std::unique_ptr<LimiterCore>> groups;
+        for (int g = 0; g < numGroups; ++g)
+            groups.push_back (createGroup());
+
+        const int numSamples = static_cast<int> (signal[0].size());
+        int blockStart = 0, blockLength = 0;
+
+        auto task = [&] (int group)
+        {
+            float* channels[channelsPerTask];
+            for (int ch = 0; ch < channelsPerTask; ++ch)
+                channels[ch] = signal[static_cast<size_t> (group * channelsPerTask + ch)].data() + blockStart;
+
+            groups[static_cast<size_t> (group)]->processPlanar (channels, blockLength);
+        };
+
+        const auto begin = std::chrono::steady_clock::now();
+
+        for (int start = 0; start < numSamples; start += hostBlockSize)
+        {
+            const int hostLength = std::min (hostBlockSize, numSamples - start);
+            const int step = perSubBlock ? LimiterCore::subBlockSize : hostLength;
+
+            for (int offset = 0; offset < hostLength; offset += step)
+            {
+                blockStart = start + offset;
+                blockLength = std::min (step, hostLength - offset);
+                pool.parallelFor (numGroups, task);
+            }
+        }
+
+        return std::chrono::duration<double> (std::chrono::steady_clock::now() - begin).count();
+    }
+}
+
+/** Optionally takes the highest number of workers to try, e.g. to oversubscribe a machine with few cores. */
+int main (int argc, char** argv)
+{
+    std::vector<std::vector<float>> input (numChannels, std::vector<float> (static_cast<size_t> (numSeconds * sampleRate)));
+    std::mt19937 random (1);
+    std::uniform_real_distribution<float> distribution (-2.0f, 2.0f);
+    for (auto& channel : input)
+        for (auto& sample : channel)
+            sample = distribution (random);
+
+    const int numCores = static_cast<int> (std::max (1u, std::thread::hardware_concurrency()));
+    const int maxNumWorkers = argc > 1 ? std::atoi (argv[1]) : std::min (numCores, numGroups) - 1;
+    const double numSamples = static_cast<double> (input[0].size());
+
+    std::printf ("%d channels in groups of %d, host blocks of %d samples, %d cores\n", numChannels, channelsPerTask, hostBlockSize, numCores);
+    std::printf ("%-8s %22s %22s %10s\n", "workers", "per sub-block ns/smp", "per host block ns/smp", "speed-up");
+
+    double serialSeconds = 0.0;
+
+    // the audio thread takes part as well, so there is one worker less than threads
+    for (int numWorkers = 0; numWorkers <= maxNumWorkers; ++numWorkers)
+    {
+        WorkerPool pool;
+        pool.start (numWorkers);
+
+        // one pass to warm up, the second one counts
+        auto signal = input;
+        run (pool, signal, false);
+
+        signal = input;
+        const double perSubBlock = run (pool, signal, true);
+        signal = input;
+        const double perHostBlock = run (pool, signal, false);
+
+        if (numWorkers == 0)
+            serialSeconds = perHostBlock;
+
+        std::printf ("%-8d %22.1f %22.1f %9.2fx\n", numWorkers, 1.0e9 * perSubBlock / numSamples, 1.0e9 * perHostBlock / numSamples, serialSeconds / perHostBlock);
+    }
+
+    return 0;
+}
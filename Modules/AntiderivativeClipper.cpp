@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    AntiderivativeClipper.cpp
+
+  ==============================================================================
+*/
+
+#include "AntiderivativeClipper.h"
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+    constexpr float w = AntiderivativeClipper::kneeWidth;
+    constexpr float kneeStart = 1.0f - w;
+    constexpr float kneeEnd = 1.0f + w;
+
+    // the same in double for the antiderivatives, derived from the width itself so that the knee is exactly 2 * w wide
+    constexpr double wd = w;
+    constexpr double kneeStartd = 1.0 - wd;
+    constexpr double kneeEndd = 1.0 + wd;
+
+    // first antiderivative at the end of the knee
+    constexpr double firstAntiderivativeAtKneeEnd = 0.5 * kneeEndd * kneeEndd - 2.0 * wd * wd / 3.0;
+
+    inline float sign (const float x) { return x < 0.0f ? -1.0f : 1.0f; }
+    inline double sign (const double x) { return x < 0.0 ? -1.0 : 1.0; }
+}
+
+// All three functions are written without branches on the signal (min, max and the sign select compile to blends),
+// t is the absolute value, k the position inside the knee, and over the part beyond the knee.
+
+float AntiderivativeClipper::clip (const float x)
+{
+    const float t = std::abs (x);
+    const float k = std::min (std::max (t - kneeStart, 0.0f), 2.0f * w);
+    return sign (x) * (std::min (t, kneeEnd) - k * k / (4.0f * w));
+}
+
+double AntiderivativeClipper::firstAntiderivative (const double x)
+{
+    const double t = std::abs (x);
+    const double k = std::min (std::max (t - kneeStartd, 0.0), 2.0 * wd);
+    const double over = std::max (t - kneeEndd, 0.0);
+    const double inside = std::min (t, kneeEndd);
+
+    return 0.5 * inside * inside - k * k * k / (12.0 * wd) + over;
+}
+
+double AntiderivativeClipper::secondAntiderivative (const double x)
+{
+    const double t = std::abs (x);
+    const double k = std::min (std::max (t - kneeStartd, 0.0), 2.0 * wd);
+    const double over = std::max (t - kneeEndd, 0.0);
+    const double inside = std::min (t, kneeEndd);
+
+    return sign (x) * (inside * inside * inside / 6.0 - k * k * k * k / (48.0 * wd)
+                       + firstAntiderivativeAtKneeEnd * over + 0.5 * over * over);
+}
+
+bool AntiderivativeClipper::isIllConditioned (const double difference, const double x)
+{
+    // the rounding error of the antiderivatives grows with their size, and so with the input's
+    return std::abs (difference) < minimumRelativeDifference * std::max (1.0, std::abs (x));
+}
+
+void AntiderivativeClipper::prepare (const int maximumBlockSize, const int numChannels)
+{
+    states.assign (static_cast<size_t> (std::max (1, numChannels)), ChannelState());
+
+    // two more entries for the samples of the previous block
+    const auto size = static_cast<size_t> (maximumBlockSize + 2);
+    scratches.resize (states.size());
+    for (auto& scratch : scratches)
+    {
+        scratch.input.assign (size, 0.0);
+        scratch.antiderivative.assign (size, 0.0);
+        scratch.quotient.assign (size, 0.0);
+    }
+}
+
+void AntiderivativeClipper::reset()
+{
+    std::fill (states.begin(), states.end(), ChannelState());
+}
+
+void AntiderivativeClipper::saveState (DspCheckpoint& checkpoint) const
+{
+    checkpoint.write (states.size());
+    checkpoint.write (states.data(), states.size());
+}
+
+bool AntiderivativeClipper::restoreState (DspCheckpoint::Reader& reader)
+{
+    size_t numStates = 0;
+    return reader.read (numStates) && numStates == states.size() && reader.read (states.data(), states.size());
+}
+
+void AntiderivativeClipper::setCeiling (const float ceilingInDecibels)
+{
+    ceiling = std::pow (10.0f, 0.05f * ceilingInDecibels);
+}
+
+void AntiderivativeClipper::process (float* samples, const int numSamples, const int channel, const int stride)
+{
+    auto& state = states[static_cast<size_t> (channel)];
+    auto& scratch = scratches[static_cast<size_t> (channel)];
+
+    switch (getOrder())
+    {
+        case Order::first:  processFirstOrder (samples, numSamples, state, scratch, stride); break;
+        case Order::second: processSecondOrder (samples, numSamples, state, scratch, stride); break;
+        case Order::off:
+        default:            break;
+    }
+}
+
+void AntiderivativeClipper::processFirstOrder (float* samples, const int numSamples, ChannelState& state, Scratch& scratch, const int stride)
+{
+    const double inverseCeiling = 1.0 / ceiling;
+    double* x = scratch.input.data();
+    double* f1 = scratch.antiderivative.data();
+
+    // x[0] is the last sample of the previous block
+    x[0] = state.previous;
+    for (int i = 0; i < numSamples; ++i)
+        x[i + 1] = samples[i * stride] * inverseCeiling;
+
+    for (int i = 0; i <= numSamples; ++i)
+        f1[i] = firstAntiderivative (x[i]);
+
+    // y[n] = (F1(x[n]) - F1(x[n-1])) / (x[n] - x[n-1]), which is a mean of the curve and so within the ceiling; the clamp only catches rounding
+    for (int i = 0; i < numSamples; ++i)
+        samples[i * stride] = ceiling * static_cast<float> (std::min (std::max ((f1[i + 1] - f1[i]) / (x[i + 1] - x[i]), -1.0), 1.0));
+
+    // ill-conditioned quotients: the curve at the midpoint is the limit
+    for (int i = 0; i < numSamples; ++i)
+        if (isIllConditioned (x[i + 1] - x[i], x[i]))
+            samples[i * stride] = ceiling * clip (static_cast<float> (0.5 * (x[i + 1] + x[i])));
+
+    state.previous = static_cast<float> (x[numSamples]);
+}
+
+void AntiderivativeClipper::processSecondOrder (float* samples, const int numSamples, ChannelState& state, Scratch& scratch, const int stride)
+{
+    const double inverseCeiling = 1.0 / ceiling;
+    double* x = scratch.input.data();
+    double* f2 = scratch.antiderivative.data();
+    double* d = scratch.quotient.data();
+
+    // x[0] and x[1] are the last two samples of the previous block
+    x[0] = state.beforePrevious;
+    x[1] = state.previous;
+    for (int i = 0; i < numSamples; ++i)
+        x[i + 2] = samples[i * stride] * inverseCeiling;
+
+    for (int i = 0; i < numSamples + 2; ++i)
+        f2[i] = secondAntiderivative (x[i]);
+
+    // first difference quotient of F2 between neighbours: d[n] ~ F1 around x[n - 1/2]
+    for (int i = 1; i < numSamples + 2; ++i)
+        d[i] = (f2[i] - f2[i - 1]) / (x[i] - x[i - 1]);
+
+    for (int i = 1; i < numSamples + 2; ++i)
+        if (isIllConditioned (x[i] - x[i - 1], x[i]))
+            d[i] = firstAntiderivative (0.5 * (x[i] + x[i - 1]));
+
+    // y[n] = 2 / (x[n] - x[n-2]) * (d[n] - d[n-1]), a weighted mean of the curve; the clamp only catches rounding
+    for (int i = 0; i < numSamples; ++i)
+        samples[i * stride] = ceiling * static_cast<float> (std::min (std::max (2.0 * (d[i + 2] - d[i + 1]) / (x[i + 2] - x[i]), -1.0), 1.0));
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        if (! isIllConditioned (x[i + 2] - x[i], x[i]))
+            continue;
+
+        // x[n] ~ x[n-2]: evaluate around their mean instead
+        const double mean = 0.5 * (x[i + 2] + x[i]);
+        const double delta = mean - x[i + 1];
+
+        double y;
+        if (isIllConditioned (delta, mean))
+            y = clip (static_cast<float> (0.5 * (mean + x[i + 1])));
+        else
+            y = 2.0 / delta * (firstAntiderivative (mean) + (secondAntiderivative (x[i + 1]) - secondAntiderivative (mean)) / delta);
+
+        samples[i * stride] = ceiling * static_cast<float> (std::min (std::max (y, -1.0), 1.0));
+    }
+
+    state.beforePrevious = static_cast<float> (x[numSamples]);
+    state.previous = static_cast<float> (x[numSamples + 1]);
+}
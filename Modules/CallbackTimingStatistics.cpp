@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    CallbackTimingStatistics.cpp
+
+  ==============================================================================
+*/
+
+#include "CallbackTimingStatistics.h"
+#include <cmath>
+
+void CallbackTimingStatistics::reset()
+{
+    count = 0;
+    mean = 0.0;
+    m2 = 0.0;
+
+    numCallbacks = 0;
+    meanPerSample = 0.0;
+    standardDeviationPerSample = 0.0;
+    maxPerSample = 0.0;
+    maxCallback = 0.0;
+}
+
+double CallbackTimingStatistics::end (const int numSamples)
+{
+    const auto duration = std::chrono::duration<double> (std::chrono::steady_clock::now() - startTime).count();
+
+    if (numSamples <= 0)
+        return duration;
+
+    const double perSample = duration * 1.0e9 / numSamples;
+
+    ++count;
+    const double delta = perSample - mean;
+    mean += delta / count;
+    m2 += delta * (perSample - mean);
+
+    numCallbacks.store (count, std::memory_order_relaxed);
+    meanPerSample.store (mean, std::memory_order_relaxed);
+    standardDeviationPerSample.store (count > 1 ? std::sqrt (m2 / (count - 1)) : 0.0, std::memory_order_relaxed);
+
+    if (perSample > maxPerSample.load (std::memory_order_relaxed))
+        maxPerSample.store (perSample, std::memory_order_relaxed);
+
+    if (duration * 1.0e6 > maxCallback.load (std::memory_order_relaxed))
+        maxCallback.store (duration * 1.0e6, std::memory_order_relaxed);
+
+    return duration;
+}
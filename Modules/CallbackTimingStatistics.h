@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    CallbackTimingStatistics.h
+
+    Running statistics about how long the audio callbacks take.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ Collects the duration of every audio callback, normalized to the number of samples it processed, so the per-callback cost can be checked for being proportional to the block length. The spread (standard deviation and maximum) of the cost per sample is the timing jitter.
+
+ Call begin() and end() on the audio thread. The getters can be called from any thread.
+ */
+class CallbackTimingStatistics
+{
+public:
+    CallbackTimingStatistics() {}
+
+    /** Clears all collected statistics. Not thread-safe, call it while the audio thread is not running. */
+    void reset();
+
+    /** Marks the start of a callback. */
+    void begin() { startTime = std::chrono::steady_clock::now(); }
+
+    /** Marks the end of a callback which processed numSamples samples. Returns the callback's duration in seconds. */
+    double end (const int numSamples);
+
+    int64_t getNumCallbacks() const { return numCallbacks.load (std::memory_order_relaxed); }
+
+    /** Mean cost per sample in nanoseconds. */
+    double getMeanNanosecondsPerSample() const { return meanPerSample.load (std::memory_order_relaxed); }
+
+    /** Standard deviation of the cost per sample in nanoseconds, i.e. the jitter of the per-callback cost. */
+    double getJitterNanosecondsPerSample() const { return standardDeviationPerSample.load (std::memory_order_relaxed); }
+
+    /** Worst cost per sample in nanoseconds. */
+    double getMaxNanosecondsPerSample() const { return maxPerSample.load (std::memory_order_relaxed); }
+
+    /** Longest single callback in microseconds. */
+    double getMaxCallbackMicroseconds() const { return maxCallback.load (std::memory_order_relaxed); }
+
+private:
+    std::chrono::steady_clock::time_point startTime;
+
+    // Welford accumulators, only touched by the audio thread
+    int64_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+
+    std::atomic<int64_t> numCallbacks { 0 };
+    std::atomic<double> meanPerSample { 0.0 };
+    std::atomic<double> standardDeviationPerSample { 0.0 };
+    std::atomic<double> maxPerSample { 0.0 };
+    std::atomic<double> maxCallback { 0.0 };
+};
@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    CharacteristicTable.cpp
+
+  ==============================================================================
+*/
+
+#include "CharacteristicTable.h"
+#include "GainReductionComputer.h"
+#include <cmath>
+#include <algorithm>
+
+void CharacteristicTable::build (GainReductionComputer& computer)
+{
+    for (int i = 0; i < numEntries; ++i)
+    {
+        // start of the segment: 2^exponent * (1 + mantissa / 2^mantissaBits)
+        const int exponent = minExponent + (i >> mantissaBits);
+        const double mantissa = 1.0 + static_cast<double> (i & ((1 << mantissaBits) - 1)) / (1 << mantissaBits);
+        const double levelInDecibels = 20.0 * std::log10 (std::ldexp (mantissa, exponent));
+
+        gainReduction[i] = computer.getGainReductionForLevel (static_cast<float> (levelInDecibels));
+    }
+}
+
+CharacteristicTableHandOver::~CharacteristicTableHandOver()
+{
+    delete current.exchange (nullptr);
+}
+
+void CharacteristicTableHandOver::publish (std::unique_ptr<CharacteristicTable> table)
+{
+    std::unique_ptr<CharacteristicTable> previous (current.exchange (table.release()));
+
+    // the block running right now might still use the previous table, it's safe to delete once that one completed
+    const uint64_t completed = numCompletedBlocks.load();
+    if (previous != nullptr)
+        retired.push_back ({ std::move (previous), completed });
+
+    retired.erase (std::remove_if (retired.begin(), retired.end(),
+                                   [completed] (const RetiredTable& r) { return completed > r.numCompletedBlocksWhenRetired; }),
+                   retired.end());
+}
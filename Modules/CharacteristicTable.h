@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    CharacteristicTable.h
+
+    The static gain-reduction curve as a lookup table indexed by float bits,
+    and its lock-free hand-over to the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+
+class GainReductionComputer;
+
+/**
+ The static characteristic (threshold, knee, ratio) of a GainReductionComputer, sampled over the absolute sample value. The table is indexed directly by the exponent and the upper mantissa bits of the float, so each octave is split into 2^mantissaBits segments and no logarithm is needed to find the entry. Between two entries the gain reduction is interpolated linearly, using the remaining mantissa bits as the fraction.
+
+ Values below 2^minExponent (about -144 dBFS) are clamped to the first entry, values above 2^maxExponent (about +48 dBFS) to the last one.
+ */
+class CharacteristicTable
+{
+public:
+    static constexpr int mantissaBits = 8;
+    static constexpr int minExponent = -24;
+    static constexpr int maxExponent = 8;
+    static constexpr int numEntries = ((maxExponent - minExponent) << mantissaBits) + 1;
+
+    CharacteristicTable() : gainReduction (numEntries, 0.0f) {}
+
+    /** Samples the static curve of the given computer. Allocates, so don't call it on the audio thread. */
+    void build (GainReductionComputer& computer);
+
+    /** A number the owner tells its tables apart by, e.g. how often the characteristic had changed when the table was built. */
+    void setVersion (const uint64_t newVersion) { version = newVersion; }
+    uint64_t getVersion() const { return version; }
+
+    /** Returns the gain reduction in decibels for a non-negative sample value. */
+    inline float getGainReductionInDecibels (const float absoluteValue) const noexcept
+    {
+        uint32_t bits;
+        std::memcpy (&bits, &absoluteValue, sizeof (bits));
+
+        // clamping the bits also catches zeros and NaNs
+        bits = bits < minBits ? minBits : (bits > maxBits ? maxBits : bits);
+
+        const uint32_t offset = bits - minBits;
+        const uint32_t index = offset >> fractionBits;
+        const float fraction = static_cast<float> (offset & fractionMask) * (1.0f / (1 << fractionBits));
+
+        const float* entry = gainReduction.data() + index;
+        return entry[0] + fraction * (entry[1] - entry[0]);
+    }
+
+private:
+    static constexpr int fractionBits = 23 - mantissaBits;
+    static constexpr uint32_t fractionMask = (1u << fractionBits) - 1;
+    static constexpr uint32_t minBits = static_cast<uint32_t> (minExponent + 127) << 23;
+    static constexpr uint32_t maxBits = (static_cast<uint32_t> (maxExponent + 127) << 23) - 1;
+
+    std::vector<float> gainReduction;
+    uint64_t version = 0;
+};
+
+/**
+ Hands freshly built tables from the message thread to the audio thread. Publishing swaps an atomic pointer; the previous table is retired and only deleted once the audio thread has completed a block which started after the swap, so the audio thread never takes a lock and never frees memory.
+ */
+class CharacteristicTableHandOver
+{
+public:
+    CharacteristicTableHandOver() {}
+    ~CharacteristicTableHandOver();
+
+    /** Makes the table the current one and deletes retired tables which are no longer in use. Call this from one non-audio thread only.
+     */
+    void publish (std::unique_ptr<CharacteristicTable> table);
+
+    /** Audio thread: returns the table to use for the current block, or nullptr if none was published yet. */
+    const CharacteristicTable* getCurrent() const { return current.load(); }
+
+    /** Audio thread: tells that the table returned by getCurrent() isn't used anymore. */
+    void blockCompleted() { numCompletedBlocks.fetch_add (1); }
+
+private:
+    struct RetiredTable
+    {
+        std::unique_ptr<CharacteristicTable> table;
+        uint64_t numCompletedBlocksWhenRetired;
+    };
+
+    std::atomic<CharacteristicTable*> current { nullptr };
+    std::atomic<uint64_t> numCompletedBlocks { 0 };
+    std::vector<RetiredTable> retired;
+};
@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    DspCheckpoint.h
+
+    A snapshot of the state of DSP modules between two blocks.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ The state of one or more DSP modules at a block boundary, e.g. detector states, delay lines and filter memories, as plain bytes. The modules write their state with saveState (checkpoint) and read it back in the same order with restoreState (reader); restoring it into modules prepared with the same settings continues the processing exactly where the checkpoint was taken.
+
+ Two checkpoints taken at the same position compare equal if and only if all the saved state is bit by bit the same, so from there on the modules produce the same output for the same input.
+ */
+class DspCheckpoint
+{
+public:
+    DspCheckpoint() {}
+
+    void clear() { data.clear(); }
+    size_t getSize() const { return data.size(); }
+    const uint8_t* getData() const { return data.data(); }
+
+    template <typename Type>
+    void write (const Type& value)
+    {
+        static_assert (std::is_trivially_copyable<Type>::value, "only plain values can be written");
+        write (&value, 1);
+    }
+
+    template <typename Type>
+    void write (const Type* values, const size_t numValues)
+    {
+        static_assert (std::is_trivially_copyable<Type>::value, "only plain values can be written");
+        const auto* bytes = reinterpret_cast<const uint8_t*> (values);
+        data.insert (data.end(), bytes, bytes + numValues * sizeof (Type));
+    }
+
+    bool operator== (const DspCheckpoint& other) const { return data == other.data; }
+    bool operator!= (const DspCheckpoint& other) const { return data != other.data; }
+
+    // ======================================================================
+    /** Reads a checkpoint back, value by value. Once a read fails, e.g. because the module was prepared for a different size than the one which wrote the checkpoint, all further reads fail as well. */
+    class Reader
+    {
+    public:
+        explicit Reader (const DspCheckpoint& checkpointToRead) : checkpoint (checkpointToRead) {}
+
+        template <typename Type>
+        bool read (Type& value) { return read (&value, 1); }
+
+        template <typename Type>
+        bool read (Type* values, const size_t numValues)
+        {
+            static_assert (std::is_trivially_copyable<Type>::value, "only plain values can be read");
+            const size_t numBytes = numValues * sizeof (Type);
+
+            if (failed || position + numBytes > checkpoint.data.size())
+            {
+                failed = true;
+                return false;
+            }
+
+            std::memcpy (values, checkpoint.data.data() + position, numBytes);
+            position += numBytes;
+            return true;
+        }
+
+        /** Whether everything was read, and nothing more than there was. */
+        bool isComplete() const { return ! failed && position == checkpoint.data.size(); }
+
+    private:
+        const DspCheckpoint& checkpoint;
+        size_t position = 0;
+        bool failed = false;
+    };
+
+private:
+    std::vector<uint8_t> data;
+};
+
+/**
+ A processor which can save the state of its DSP between two blocks and restore it later, so a renderer can start in the middle of a file as if it had processed everything before.
+ */
+class CheckpointableProcessor
+{
+public:
+    virtual ~CheckpointableProcessor() {}
+
+    /** Whether the current settings allow checkpoints at all, e.g. not with processing whose state isn't accessible or which depends on anything but the audio. */
+    virtual bool canSaveCheckpoints() const = 0;
+
+    /** Writes the state of all DSP into the (cleared) checkpoint. Call it between two blocks, on the thread which processes them. */
+    virtual void saveCheckpoint (DspCheckpoint& checkpoint) = 0;
+
+    /** Restores a checkpoint saved with the same settings. Returns false, and leaves the state undefined, if it doesn't fit. */
+    virtual bool restoreCheckpoint (const DspCheckpoint& checkpoint) = 0;
+};
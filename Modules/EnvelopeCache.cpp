@@ -0,0 +1,281 @@
+/*
+  ==============================================================================
+
+    EnvelopeCache.cpp
+
+  ==============================================================================
+*/
+
+#include "EnvelopeCache.h"
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+
+namespace
+{
+    const char magic[4] = { 'T', 'L', 'E', 'C' };
+    constexpr uint32_t formatVersion = 1;
+
+    constexpr uint64_t prime1 = 11400714785074694791ULL;
+    constexpr uint64_t prime2 = 14029467366897019727ULL;
+    constexpr uint64_t prime3 = 1609587929392839161ULL;
+    constexpr uint64_t prime4 = 9650029242287828579ULL;
+    constexpr uint64_t prime5 = 2870177450012600261ULL;
+
+    inline uint64_t rotateLeft (const uint64_t x, const int bits) { return (x << bits) | (x >> (64 - bits)); }
+
+    inline uint64_t read64 (const uint8_t* p) { uint64_t x; std::memcpy (&x, p, sizeof (x)); return x; }
+    inline uint32_t read32 (const uint8_t* p) { uint32_t x; std::memcpy (&x, p, sizeof (x)); return x; }
+
+    inline uint64_t accumulate (uint64_t accumulator, const uint64_t input)
+    {
+        accumulator += input * prime2;
+        return rotateLeft (accumulator, 31) * prime1;
+    }
+
+    inline uint64_t merge (uint64_t accumulator, const uint64_t value)
+    {
+        accumulator ^= accumulate (0, value);
+        return accumulator * prime1 + prime4;
+    }
+
+    template <typename Type>
+    bool writeValue (std::FILE* file, const Type& value)
+    {
+        return std::fwrite (&value, sizeof (Type), 1, file) == 1;
+    }
+
+    template <typename Type>
+    bool readValue (std::FILE* file, Type& value)
+    {
+        return std::fread (&value, sizeof (Type), 1, file) == 1;
+    }
+}
+
+uint64_t EnvelopeCache::hash (const void* data, const size_t numBytes, const uint64_t seed)
+{
+    const auto* p = static_cast<const uint8_t*> (data);
+    const uint8_t* const end = p + numBytes;
+    uint64_t h;
+
+    // four independent lanes over 32-byte stripes, so the multiplications overlap
+    if (numBytes >= 32)
+    {
+        uint64_t v1 = seed + prime1 + prime2, v2 = seed + prime2, v3 = seed, v4 = seed - prime1;
+
+        for (; p + 32 <= end; p += 32)
+        {
+            v1 = accumulate (v1, read64 (p));
+            v2 = accumulate (v2, read64 (p + 8));
+            v3 = accumulate (v3, read64 (p + 16));
+            v4 = accumulate (v4, read64 (p + 24));
+        }
+
+        h = rotateLeft (v1, 1) + rotateLeft (v2, 7) + rotateLeft (v3, 12) + rotateLeft (v4, 18);
+        h = merge (h, v1);
+        h = merge (h, v2);
+        h = merge (h, v3);
+        h = merge (h, v4);
+    }
+    else
+        h = seed + prime5;
+
+    h += static_cast<uint64_t> (numBytes);
+
+    for (; p + 8 <= end; p += 8)
+        h = rotateLeft (h ^ accumulate (0, read64 (p)), 27) * prime1 + prime4;
+
+    if (p + 4 <= end)
+    {
+        h = rotateLeft (h ^ (read32 (p) * prime1), 23) * prime2 + prime3;
+        p += 4;
+    }
+
+    for (; p < end; ++p)
+        h = rotateLeft (h ^ (*p * prime5), 11) * prime1;
+
+    h ^= h >> 33;
+    h *= prime2;
+    h ^= h >> 29;
+    h *= prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+std::string EnvelopeCache::getPath (const uint64_t settingsHash, const uint64_t firstIntervalHash) const
+{
+    char name[64];
+    std::snprintf (name, sizeof (name), "%016llx-%016llx.tlenv", static_cast<unsigned long long> (settingsHash), static_cast<unsigned long long> (firstIntervalHash));
+    return directory + "/" + name;
+}
+
+// ==============================================================================
+void EnvelopeCache::Entry::close()
+{
+    if (file != nullptr)
+        std::fclose (file);
+
+    file = nullptr;
+    numSamples = 0;
+    intervals.clear();
+}
+
+bool EnvelopeCache::Entry::readEnvelope (float* destination, const int numSamplesToRead)
+{
+    return file != nullptr && std::fread (destination, sizeof (float), static_cast<size_t> (numSamplesToRead), file) == static_cast<size_t> (numSamplesToRead);
+}
+
+bool EnvelopeCache::open (const uint64_t settingsHash, const uint64_t firstIntervalHash, Entry& entry) const
+{
+    entry.close();
+
+    std::FILE* file = std::fopen (getPath (settingsHash, firstIntervalHash).c_str(), "rb");
+    if (file == nullptr)
+        return false;
+
+    entry.file = file;
+    std::setvbuf (file, nullptr, _IOFBF, 1 << 16);
+
+    char header[4];
+    uint32_t version = 0;
+    int32_t savedIntervalSize = 0;
+    int64_t numIntervals = 0;
+
+    if (std::fread (header, 1, sizeof (header), file) != sizeof (header) || std::memcmp (header, magic, sizeof (magic)) != 0
+        || ! readValue (file, version) || version != formatVersion
+        || ! readValue (file, entry.numSamples) || entry.numSamples <= 0
+        || ! readValue (file, savedIntervalSize) || savedIntervalSize != intervalSize
+        || ! readValue (file, numIntervals) || numIntervals != (entry.numSamples + intervalSize - 1) / intervalSize)
+    {
+        entry.close();
+        return false;
+    }
+
+    std::vector<uint8_t> state;
+    entry.intervals.resize (static_cast<size_t> (numIntervals));
+    for (auto& interval : entry.intervals)
+    {
+        uint32_t stateSize = 0;
+        if (! readValue (file, interval.hash) || ! readValue (file, stateSize) || stateSize > 4096)
+        {
+            entry.close();
+            return false;
+        }
+
+        state.resize (stateSize);
+        if (std::fread (state.data(), 1, stateSize, file) != stateSize)
+        {
+            entry.close();
+            return false;
+        }
+
+        interval.detectorState.write (state.data(), stateSize);
+    }
+
+    // a different first interval would have a different name
+    if (entry.intervals.front().hash != firstIntervalHash)
+    {
+        entry.close();
+        return false;
+    }
+
+    // the time of the last use, which evict() goes by; a failure only makes the entry look older
+    std::error_code error;
+    std::filesystem::last_write_time (getPath (settingsHash, firstIntervalHash), std::filesystem::file_time_type::clock::now(), error);
+
+    return true;
+}
+
+bool EnvelopeCache::store (const uint64_t settingsHash, const std::vector<Interval>& intervals, EnvelopeFile& envelope) const
+{
+    const int64_t numSamples = envelope.getNumSamples();
+    if (envelope.getData() == nullptr || intervals.empty() || numSamples <= 0 || static_cast<int64_t> (intervals.size()) != (numSamples + intervalSize - 1) / intervalSize)
+        return false;
+
+    // written under a temporary name, so a reader never sees half an entry
+    const std::string path = getPath (settingsHash, intervals.front().hash);
+    const std::string temporaryPath = path + ".part";
+
+    std::FILE* file = std::fopen (temporaryPath.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+
+    std::setvbuf (file, nullptr, _IOFBF, 1 << 16);
+
+    bool ok = std::fwrite (magic, 1, sizeof (magic), file) == sizeof (magic)
+           && writeValue (file, formatVersion)
+           && writeValue (file, numSamples)
+           && writeValue (file, static_cast<int32_t> (intervalSize))
+           && writeValue (file, static_cast<int64_t> (intervals.size()));
+
+    for (const auto& interval : intervals)
+    {
+        const auto stateSize = static_cast<uint32_t> (interval.detectorState.getSize());
+        ok = ok && writeValue (file, interval.hash) && writeValue (file, stateSize)
+                && std::fwrite (interval.detectorState.getData(), 1, stateSize, file) == stateSize;
+    }
+
+    for (int64_t start = 0; ok && start < numSamples; start += intervalSize)
+    {
+        const auto n = static_cast<size_t> (std::min<int64_t> (intervalSize, numSamples - start));
+        ok = std::fwrite (envelope.getData() + start, sizeof (float), n, file) == n;
+        envelope.releasePages (start, static_cast<int64_t> (n));
+    }
+    ok = std::fclose (file) == 0 && ok;
+
+    if (ok)
+    {
+        std::remove (path.c_str());
+        ok = std::rename (temporaryPath.c_str(), path.c_str()) == 0;
+    }
+
+    if (! ok)
+        std::remove (temporaryPath.c_str());
+
+    return ok;
+}
+
+uint64_t EnvelopeCache::evict (const uint64_t maxNumBytes) const
+{
+    namespace fs = std::filesystem;
+
+    struct StoredEntry
+    {
+        fs::path path;
+        fs::file_time_type lastUse;
+        uint64_t numBytes;
+    };
+
+    std::vector<StoredEntry> entries;
+    uint64_t totalNumBytes = 0;
+    std::error_code error;
+
+    for (fs::directory_iterator it (directory, error), end; ! error && it != end; it.increment (error))
+    {
+        if (it->path().extension() != ".tlenv")
+            continue;
+
+        std::error_code entryError;
+        const auto numBytes = it->file_size (entryError);
+        const auto lastUse = it->last_write_time (entryError);
+        if (entryError)
+            continue;
+
+        entries.push_back ({ it->path(), lastUse, numBytes });
+        totalNumBytes += numBytes;
+    }
+
+    std::sort (entries.begin(), entries.end(), [] (const StoredEntry& a, const StoredEntry& b) { return a.lastUse < b.lastUse; });
+
+    uint64_t numBytesFreed = 0;
+    for (const auto& entry : entries)
+    {
+        if (totalNumBytes - numBytesFreed <= maxNumBytes)
+            break;
+
+        if (fs::remove (entry.path, error))
+            numBytesFreed += entry.numBytes;
+    }
+
+    return numBytesFreed;
+}
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    EnvelopeCache.h
+
+    Raw gain-reduction envelopes on disk, keyed by the content of the input.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "DspCheckpoint.h"
+#include "EnvelopeFile.h"
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ Keeps the raw gain-reduction envelopes of earlier analyses, one file per input and detector setting, so the same audio doesn't have to run through the detector again.
+
+ An entry is cut into intervals of intervalSize samples. For every interval it holds a hash chained over the input so far, and the detector's state after it. A new analysis compares its own chain with the entry's, interval by interval: as long as they agree, the envelope is read from the entry; from the first interval which differs on, the detector takes over, starting from the state stored for the interval before. So an unchanged input costs a hash and a read, and one which only changed towards its end is analysed from the change on.
+
+ Entries are named after the hash of the detector settings and the first interval, and written in the machine's byte order. The hash is XXH64, which runs at memory speed; it tells inputs apart, it doesn't protect against tampering.
+
+ Every edit of a file leaves an entry of its own, so the directory only grows by itself; evict() keeps it to a size, dropping the entries which were used least recently.
+ */
+class EnvelopeCache
+{
+public:
+    static constexpr int intervalSize = 1 << 16;
+
+    /** Keeps the entries as files in the given directory, which has to exist. */
+    explicit EnvelopeCache (const std::string& directoryPath) : directory (directoryPath) {}
+
+    /** The 64-bit XXH64 hash of numBytes bytes. */
+    static uint64_t hash (const void* data, const size_t numBytes, const uint64_t seed);
+
+    struct Interval
+    {
+        uint64_t hash;              // of the input up to the end of this interval, chained
+        DspCheckpoint detectorState; // after this interval
+    };
+
+    // ======================================================================
+    /** An entry, opened for reading its envelope from the beginning. */
+    class Entry
+    {
+    public:
+        Entry() {}
+        ~Entry() { close(); }
+
+        Entry (const Entry&) = delete;
+        Entry& operator= (const Entry&) = delete;
+
+        bool isOpen() const { return file != nullptr; }
+        void close();
+
+        int64_t getNumSamples() const { return numSamples; }
+        const std::vector<Interval>& getIntervals() const { return intervals; }
+
+        /** Reads the next samples of the envelope. */
+        bool readEnvelope (float* destination, const int numSamplesToRead);
+
+    private:
+        friend class EnvelopeCache;
+
+        std::FILE* file = nullptr;
+        int64_t numSamples = 0;
+        std::vector<Interval> intervals;
+    };
+
+    /** Opens the entry for the given settings and first interval hash, if there is one. Returns false if not, or if it's damaged. */
+    bool open (const uint64_t settingsHash, const uint64_t firstIntervalHash, Entry& entry) const;
+
+    /** Writes the mapped envelope as an entry, replacing the one for the same settings and first interval, and lets go of its pages on the way. Returns false if the file can't be written. */
+    bool store (const uint64_t settingsHash, const std::vector<Interval>& intervals, EnvelopeFile& envelope) const;
+
+    /** Removes the entries which were stored or opened least recently until the rest takes at most maxNumBytes. Call it while no analysis uses the directory, e.g. after a render. Returns how many bytes were freed. */
+    uint64_t evict (const uint64_t maxNumBytes) const;
+
+private:
+    std::string getPath (const uint64_t settingsHash, const uint64_t firstIntervalHash) const;
+
+    std::string directory;
+};
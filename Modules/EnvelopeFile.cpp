@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    EnvelopeFile.cpp
+
+  ==============================================================================
+*/
+
+#include "EnvelopeFile.h"
+
+#if defined (_WIN32)
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+ #include <io.h>
+#else
+ #include <sys/mman.h>
+ #include <unistd.h>
+#endif
+
+#include <algorithm>
+
+bool EnvelopeFile::create()
+{
+    close();
+
+    // deleted by the OS when it's closed
+    file = std::tmpfile();
+    if (file == nullptr)
+        return false;
+
+    std::setvbuf (file, nullptr, _IOFBF, 1 << 16);
+    return true;
+}
+
+bool EnvelopeFile::append (const float* samples, const int numSamplesToAppend)
+{
+    if (file == nullptr || isMapped() || numSamplesToAppend < 0)
+        return false;
+
+    const size_t numWritten = std::fwrite (samples, sizeof (float), static_cast<size_t> (numSamplesToAppend), file);
+    numSamples += static_cast<int64_t> (numWritten);
+
+    return numWritten == static_cast<size_t> (numSamplesToAppend);
+}
+
+bool EnvelopeFile::map()
+{
+    if (file == nullptr || std::fflush (file) != 0)
+        return false;
+
+    if (isMapped() || numSamples == 0)
+        return true;
+
+    const uint64_t numBytes = static_cast<uint64_t> (numSamples) * sizeof (float);
+
+   #if defined (_WIN32)
+    const HANDLE handle = reinterpret_cast<HANDLE> (_get_osfhandle (_fileno (file)));
+    mapping = CreateFileMappingW (handle, nullptr, PAGE_READWRITE, static_cast<DWORD> (numBytes >> 32), static_cast<DWORD> (numBytes & 0xffffffff), nullptr);
+    if (mapping == nullptr)
+        return false;
+
+    data = static_cast<float*> (MapViewOfFile (mapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T> (numBytes)));
+    if (data == nullptr)
+    {
+        CloseHandle (mapping);
+        mapping = nullptr;
+        return false;
+    }
+   #else
+    void* address = mmap (nullptr, static_cast<size_t> (numBytes), PROT_READ | PROT_WRITE, MAP_SHARED, fileno (file), 0);
+    if (address == MAP_FAILED)
+        return false;
+
+    data = static_cast<float*> (address);
+   #endif
+
+    return true;
+}
+
+void EnvelopeFile::unmap()
+{
+    if (data == nullptr)
+        return;
+
+   #if defined (_WIN32)
+    UnmapViewOfFile (data);
+    CloseHandle (mapping);
+    mapping = nullptr;
+   #else
+    munmap (data, static_cast<size_t> (numSamples) * sizeof (float));
+   #endif
+
+    data = nullptr;
+}
+
+void EnvelopeFile::releasePages (const int64_t start, const int64_t numSamplesToRelease)
+{
+    if (data == nullptr)
+        return;
+
+   #if defined (_WIN32)
+    // the working set of a mapped view is trimmed by the OS on its own
+    (void) start;
+    (void) numSamplesToRelease;
+   #else
+    // whole pages inside the range only; the file keeps the contents
+    const uintptr_t pageSize = static_cast<uintptr_t> (sysconf (_SC_PAGESIZE));
+    const int64_t end = std::min (numSamples, start + numSamplesToRelease);
+    const uintptr_t first = (reinterpret_cast<uintptr_t> (data + std::max<int64_t> (0, start)) + pageSize - 1) & ~(pageSize - 1);
+    const uintptr_t last = reinterpret_cast<uintptr_t> (data + end) & ~(pageSize - 1);
+
+    if (last > first)
+        madvise (reinterpret_cast<void*> (first), static_cast<size_t> (last - first), MADV_DONTNEED);
+   #endif
+}
+
+void EnvelopeFile::close()
+{
+    unmap();
+
+    if (file != nullptr)
+        std::fclose (file);
+
+    file = nullptr;
+    numSamples = 0;
+}
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    EnvelopeFile.h
+
+    A temporary file of float samples, appended to and then memory-mapped.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+
+/**
+ Keeps an envelope which may be far larger than what should stay in memory, e.g. one gain-reduction value per sample of a whole program. The samples are appended through a small write buffer, then map() maps the file, so it can be read and modified in place while the OS pages it in and out as needed.
+
+ The file is anonymous and deleted as soon as it's closed, also if the process ends unexpectedly.
+ */
+class EnvelopeFile
+{
+public:
+    EnvelopeFile() {}
+    ~EnvelopeFile() { close(); }
+
+    EnvelopeFile (const EnvelopeFile&) = delete;
+    EnvelopeFile& operator= (const EnvelopeFile&) = delete;
+
+    /** Creates a new, empty file. Closes the previous one first. Returns false if the file can't be created. */
+    bool create();
+
+    /** Appends samples. Only before map(). Returns false if the disk is full. */
+    bool append (const float* samples, const int numSamples);
+
+    /** Maps all samples appended so far, for reading and writing. Returns false if that fails. */
+    bool map();
+
+    /** Tells the OS that the mapped samples in [start, start + numSamplesToRelease) won't be needed again soon, so their pages can leave memory. Keeps the resident size flat while a long envelope is streamed through.
+     */
+    void releasePages (const int64_t start, const int64_t numSamplesToRelease);
+
+    /** Unmaps and deletes the file. */
+    void close();
+
+    bool isMapped() const { return data != nullptr; }
+
+    /** The mapped samples, or nullptr before map(). */
+    float* getData() const { return data; }
+
+    int64_t getNumSamples() const { return numSamples; }
+
+private:
+    void unmap();
+
+    std::FILE* file = nullptr;
+    int64_t numSamples = 0;
+    float* data = nullptr;
+
+   #if defined (_WIN32)
+    void* mapping = nullptr;
+   #endif
+};
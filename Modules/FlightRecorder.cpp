@@ -0,0 +1,331 @@
+/*
+  ==============================================================================
+
+    FlightRecorder.cpp
+
+  ==============================================================================
+*/
+
+#include "FlightRecorder.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    const char magic[4] = { 'T', 'L', 'F', 'R' };
+    constexpr uint32_t formatVersion = 2;
+
+    // blocks are rarely shorter than this, so the block ring covers about as long as the audio ring
+    constexpr int typicalMinBlockSize = 32;
+
+    template <typename Type>
+    void writeValue (std::ostream& output, const Type& value)
+    {
+        output.write (reinterpret_cast<const char*> (&value), sizeof (Type));
+    }
+
+    template <typename Type>
+    bool readValue (std::istream& input, Type& value)
+    {
+        return static_cast<bool> (input.read (reinterpret_cast<char*> (&value), sizeof (Type)));
+    }
+}
+
+void FlightRecorder::prepare (const double newSampleRate, const int newNumChannels, const double lengthInSeconds, const size_t maxNumBytes,
+                              const std::vector<std::string>& newParameterIDs, const size_t newCheckpointSize)
+{
+    sampleRate = newSampleRate;
+    numChannels = std::max (1, newNumChannels);
+
+    parameterIDs = newParameterIDs;
+    if (parameterIDs.size() > maxNumParameters)
+        parameterIDs.resize (maxNumParameters);
+
+    // enough checkpoints to span the whole length, plus the one being written; they're small, so they come off the top
+    checkpointSize = newCheckpointSize;
+    checkpointInterval = std::max<int64_t> (1, static_cast<int64_t> (checkpointIntervalInSeconds * sampleRate));
+    checkpointCapacity = checkpointSize > 0 ? static_cast<int> (lengthInSeconds / checkpointIntervalInSeconds) + 2 : 0;
+    const size_t checkpointBytes = static_cast<size_t> (checkpointCapacity) * (checkpointSize + sizeof (CheckpointRecord));
+
+    // every sample takes one float per channel, plus its share of a block record and the block's parameter values
+    const double bytesPerSample = numChannels * sizeof (float) + (sizeof (BlockRecord) + parameterIDs.size() * sizeof (float)) / static_cast<double> (typicalMinBlockSize);
+    const double affordableSamples = maxNumBytes > checkpointBytes ? static_cast<double> (maxNumBytes - checkpointBytes) / bytesPerSample : 0.0;
+
+    audioCapacity = std::max (1, static_cast<int> (std::min (lengthInSeconds * sampleRate, affordableSamples)));
+    blockCapacity = audioCapacity / typicalMinBlockSize + 1;
+
+    if (checkpointCapacity > 0)
+        checkpointCapacity = static_cast<int> (audioCapacity / checkpointInterval) + 2;
+
+    audio.assign (static_cast<size_t> (numChannels) * static_cast<size_t> (audioCapacity), 0.0f);
+    blocks.assign (static_cast<size_t> (blockCapacity), BlockRecord { 0, 0 });
+    parameters.assign (static_cast<size_t> (blockCapacity) * parameterIDs.size(), 0.0f);
+    checkpointRecords.assign (static_cast<size_t> (checkpointCapacity), CheckpointRecord { -1, 0 });
+    checkpointData.assign (static_cast<size_t> (checkpointCapacity) * checkpointSize, 0);
+
+    numSamplesReserved = 0;
+    numSamplesWritten = 0;
+    numBlocksReserved = 0;
+    numBlocksWritten = 0;
+    numCheckpointsReserved = 0;
+    numCheckpointsWritten = 0;
+    nextCheckpointSample = 0;
+}
+
+void FlightRecorder::release()
+{
+    std::vector<float>().swap (audio);
+    std::vector<BlockRecord>().swap (blocks);
+    std::vector<float>().swap (parameters);
+    std::vector<CheckpointRecord>().swap (checkpointRecords);
+    std::vector<uint8_t>().swap (checkpointData);
+
+    audioCapacity = 0;
+    blockCapacity = 0;
+    checkpointCapacity = 0;
+
+    numSamplesReserved = 0;
+    numSamplesWritten = 0;
+    numBlocksReserved = 0;
+    numBlocksWritten = 0;
+    numCheckpointsReserved = 0;
+    numCheckpointsWritten = 0;
+}
+
+bool FlightRecorder::needsCheckpoint() const
+{
+    return checkpointCapacity > 0 && numSamplesWritten.load (std::memory_order_relaxed) >= nextCheckpointSample;
+}
+
+size_t FlightRecorder::getMemoryUsageInBytes() const
+{
+    return audio.size() * sizeof (float) + blocks.size() * sizeof (BlockRecord) + parameters.size() * sizeof (float)
+         + checkpointRecords.size() * sizeof (CheckpointRecord) + checkpointData.size();
+}
+
+void FlightRecorder::record (const float* const* channels, const int numSamples, const float* parameterValues, const DspCheckpoint* stateBeforeBlock)
+{
+    if (audio.empty() || numSamples <= 0)
+        return;
+
+    // longer blocks than the ring only keep their end
+    const int numToRecord = std::min (numSamples, audioCapacity);
+    const int skip = numSamples - numToRecord;
+
+    const int64_t sampleIndex = numSamplesWritten.load (std::memory_order_relaxed);
+    const int64_t blockIndex = numBlocksWritten.load (std::memory_order_relaxed);
+    const int64_t checkpointIndex = numCheckpointsWritten.load (std::memory_order_relaxed);
+
+    const bool withCheckpoint = stateBeforeBlock != nullptr && needsCheckpoint() && stateBeforeBlock->getSize() <= checkpointSize;
+
+    // tell readers which parts are about to change, before changing them
+    numSamplesReserved.store (sampleIndex + numSamples, std::memory_order_relaxed);
+    numBlocksReserved.store (blockIndex + 1, std::memory_order_relaxed);
+    if (withCheckpoint)
+        numCheckpointsReserved.store (checkpointIndex + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    const int start = static_cast<int> ((sampleIndex + skip) % audioCapacity);
+    const int numFirst = std::min (numToRecord, audioCapacity - start);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* ring = audio.data() + static_cast<size_t> (ch) * static_cast<size_t> (audioCapacity);
+        const float* source = channels[ch] + skip;
+        std::copy (source, source + numFirst, ring + start);
+        std::copy (source + numFirst, source + numToRecord, ring);
+    }
+
+    const size_t slot = static_cast<size_t> (blockIndex % blockCapacity);
+    blocks[slot] = { sampleIndex, numSamples };
+    std::copy (parameterValues, parameterValues + parameterIDs.size(), parameters.begin() + static_cast<std::ptrdiff_t> (slot * parameterIDs.size()));
+
+    if (withCheckpoint)
+    {
+        const size_t checkpointSlot = static_cast<size_t> (checkpointIndex % checkpointCapacity);
+        checkpointRecords[checkpointSlot] = { blockIndex, stateBeforeBlock->getSize() };
+        std::copy (stateBeforeBlock->getData(), stateBeforeBlock->getData() + stateBeforeBlock->getSize(),
+                   checkpointData.begin() + static_cast<std::ptrdiff_t> (checkpointSlot * checkpointSize));
+
+        numCheckpointsWritten.store (checkpointIndex + 1, std::memory_order_release);
+        nextCheckpointSample = sampleIndex + checkpointInterval;
+    }
+
+    numSamplesWritten.store (sampleIndex + numSamples, std::memory_order_release);
+    numBlocksWritten.store (blockIndex + 1, std::memory_order_release);
+}
+
+bool FlightRecorder::writeTo (std::ostream& output) const
+{
+    // the blocks are published after their audio and checkpoints, so all of those up to numBlocks are there
+    const int64_t numBlocks = numBlocksWritten.load (std::memory_order_acquire);
+    const int64_t numSamples = numSamplesWritten.load (std::memory_order_acquire);
+    const int64_t numCheckpoints = numCheckpointsWritten.load (std::memory_order_acquire);
+
+    if (numBlocks == 0)
+        return false;
+
+    const std::vector<float> audioCopy (audio);
+    const std::vector<BlockRecord> blocksCopy (blocks);
+    const std::vector<float> parametersCopy (parameters);
+    const std::vector<CheckpointRecord> checkpointRecordsCopy (checkpointRecords);
+    const std::vector<uint8_t> checkpointDataCopy (checkpointData);
+
+    // whatever the audio thread started to overwrite while we were copying is lost
+    std::atomic_thread_fence (std::memory_order_acquire);
+    const int64_t oldestValidSample = std::max<int64_t> (numSamples, numSamplesReserved.load (std::memory_order_relaxed)) - audioCapacity;
+    const int64_t oldestValidBlock = std::max<int64_t> (numBlocks, numBlocksReserved.load (std::memory_order_relaxed)) - blockCapacity;
+    const int64_t oldestValidCheckpoint = std::max<int64_t> (numCheckpoints, numCheckpointsReserved.load (std::memory_order_relaxed)) - checkpointCapacity;
+
+    // the oldest block whose record and audio are both still intact; all newer ones are as well
+    int64_t first = std::max<int64_t> (0, oldestValidBlock);
+    while (first < numBlocks)
+    {
+        const auto& block = blocksCopy[static_cast<size_t> (first % blockCapacity)];
+        if (block.startSample >= oldestValidSample)
+            break;
+
+        ++first;
+    }
+
+    // the audio thread may have gone round the block ring while we were copying, past the blocks we knew of
+    if (first >= numBlocks)
+        return false;
+
+    // start at the oldest intact checkpoint of an intact block instead, so a replay can restore the state before it
+    const CheckpointRecord* initialState = nullptr;
+    const uint8_t* initialStateData = nullptr;
+
+    for (int64_t c = std::max<int64_t> (0, oldestValidCheckpoint); c < numCheckpoints; ++c)
+    {
+        const size_t slot = static_cast<size_t> (c % checkpointCapacity);
+        const auto& checkpoint = checkpointRecordsCopy[slot];
+
+        if (checkpoint.blockIndex >= first && checkpoint.blockIndex < numBlocks)
+        {
+            first = checkpoint.blockIndex;
+            initialState = &checkpoint;
+            initialStateData = checkpointDataCopy.data() + slot * checkpointSize;
+            break;
+        }
+    }
+
+    output.write (magic, sizeof (magic));
+    writeValue (output, formatVersion);
+    writeValue (output, sampleRate);
+    writeValue (output, static_cast<int32_t> (numChannels));
+    writeValue (output, static_cast<int32_t> (parameterIDs.size()));
+
+    for (const auto& id : parameterIDs)
+    {
+        writeValue (output, static_cast<uint32_t> (id.size()));
+        output.write (id.data(), static_cast<std::streamsize> (id.size()));
+    }
+
+    writeValue (output, static_cast<uint64_t> (initialState != nullptr ? initialState->numBytes : 0));
+    if (initialState != nullptr)
+        output.write (reinterpret_cast<const char*> (initialStateData), static_cast<std::streamsize> (initialState->numBytes));
+
+    writeValue (output, numBlocks - first);
+
+    std::vector<float> frames;
+    for (int64_t b = first; b < numBlocks; ++b)
+    {
+        const size_t slot = static_cast<size_t> (b % blockCapacity);
+        const auto& block = blocksCopy[slot];
+
+        writeValue (output, static_cast<int32_t> (block.numSamples));
+        output.write (reinterpret_cast<const char*> (parametersCopy.data() + slot * parameterIDs.size()), static_cast<std::streamsize> (parameterIDs.size() * sizeof (float)));
+
+        frames.resize (static_cast<size_t> (block.numSamples) * static_cast<size_t> (numChannels));
+        for (int i = 0; i < block.numSamples; ++i)
+        {
+            const size_t position = static_cast<size_t> ((block.startSample + i) % audioCapacity);
+            for (int ch = 0; ch < numChannels; ++ch)
+                frames[static_cast<size_t> (i * numChannels + ch)] = audioCopy[static_cast<size_t> (ch) * static_cast<size_t> (audioCapacity) + position];
+        }
+
+        output.write (reinterpret_cast<const char*> (frames.data()), static_cast<std::streamsize> (frames.size() * sizeof (float)));
+    }
+
+    return static_cast<bool> (output);
+}
+
+// ==============================================================================
+int FlightRecorder::Recording::getMaxBlockSize() const
+{
+    int maxBlockSize = 0;
+    for (const auto& block : blocks)
+        maxBlockSize = std::max (maxBlockSize, block.numSamples);
+
+    return maxBlockSize;
+}
+
+bool FlightRecorder::Recording::readFrom (std::istream& input)
+{
+    char header[4];
+    uint32_t version = 0;
+    int32_t channels = 0, numParameters = 0;
+
+    if (! input.read (header, sizeof (header)) || std::memcmp (header, magic, sizeof (magic)) != 0
+        || ! readValue (input, version) || version != formatVersion
+        || ! readValue (input, sampleRate) || ! (sampleRate > 0.0)
+        || ! readValue (input, channels) || channels < 1 || channels > 1024
+        || ! readValue (input, numParameters) || numParameters < 0 || numParameters > maxNumParameters)
+        return false;
+
+    numChannels = channels;
+
+    parameterIDs.clear();
+    for (int p = 0; p < numParameters; ++p)
+    {
+        uint32_t length = 0;
+        if (! readValue (input, length) || length > 256)
+            return false;
+
+        std::string id (length, '\0');
+        if (! input.read (&id[0], static_cast<std::streamsize> (length)))
+            return false;
+
+        parameterIDs.push_back (std::move (id));
+    }
+
+    uint64_t stateSize = 0;
+    if (! readValue (input, stateSize) || stateSize > (1u << 30))
+        return false;
+
+    std::vector<uint8_t> state (static_cast<size_t> (stateSize));
+    if (! input.read (reinterpret_cast<char*> (state.data()), static_cast<std::streamsize> (stateSize)))
+        return false;
+
+    initialState.clear();
+    initialState.write (state.data(), state.size());
+
+    int64_t numBlocks = 0;
+    if (! readValue (input, numBlocks) || numBlocks < 0)
+        return false;
+
+    blocks.clear();
+    audio.clear();
+    parameterValues.clear();
+
+    for (int64_t b = 0; b < numBlocks; ++b)
+    {
+        int32_t numSamples = 0;
+        if (! readValue (input, numSamples) || numSamples <= 0 || numSamples > (1 << 24))
+            return false;
+
+        const Block block { numSamples, audio.size(), parameterValues.size() };
+
+        parameterValues.resize (parameterValues.size() + static_cast<size_t> (numParameters));
+        audio.resize (audio.size() + static_cast<size_t> (numSamples) * static_cast<size_t> (numChannels));
+
+        if (! input.read (reinterpret_cast<char*> (parameterValues.data() + block.parameterOffset), static_cast<std::streamsize> (numParameters * sizeof (float)))
+            || ! input.read (reinterpret_cast<char*> (audio.data() + block.audioOffset), static_cast<std::streamsize> (static_cast<size_t> (numSamples) * static_cast<size_t> (numChannels) * sizeof (float))))
+            return false;
+
+        blocks.push_back (block);
+    }
+
+    return true;
+}
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    FlightRecorder.h
+
+    Always-on recording of the last seconds of input, block sizes, parameters and the DSP state.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <string>
+#include <istream>
+#include <ostream>
+#include <cstdint>
+#include "DspCheckpoint.h"
+
+/**
+ Keeps the last few seconds of everything that went into the processor: the input audio, where each block started and ended, and the values of all parameters at every block. With that, a glitch from a live session can be replayed offline, block by block, through the same processBlock.
+
+ record() runs on the audio thread: it copies the block into rings which were allocated in prepare(), and publishes it with atomic counters, so it never waits and never allocates. writeTo() can be called from any other thread at the same time. It copies the rings, then checks which parts the audio thread overwrote while it was copying and leaves those out, so a dump always holds a consistent run of whole blocks.
+
+ About every checkpointIntervalInSeconds, record() also keeps a DspCheckpoint of the processor's state before the block. A dump starts at the oldest block with a checkpoint which is still intact and carries that checkpoint, so a replay can restore the state and continue exactly as the processor did live. Without one, e.g. while the processor can't save checkpoints, the dump starts at the oldest intact block, without any state.
+
+ The memory is capped: wide buses at high rates get a shorter recording rather than hundreds of megabytes.
+
+ The dump is binary, in the machine's byte order; Recording reads it back.
+ */
+class FlightRecorder
+{
+public:
+    /** The parameters recorded with every block are limited to this many. */
+    static constexpr int maxNumParameters = 64;
+
+    /** How often needsCheckpoint() asks for a checkpoint; a dump starts up to this much later than the oldest recorded block. */
+    static constexpr double checkpointIntervalInSeconds = 1.0;
+
+    FlightRecorder() {}
+
+    /** Allocates the rings for the given length, or a shorter one if that would take more than maxNumBytes, and forgets everything recorded so far. Checkpoints of up to checkpointSize bytes are kept with the blocks, 0 keeps none. Not for the audio thread.
+     */
+    void prepare (const double sampleRate, const int numChannels, const double lengthInSeconds, const size_t maxNumBytes,
+                  const std::vector<std::string>& parameterIDs, const size_t checkpointSize);
+
+    /** Frees all memory; record() ignores everything until the next prepare(). Not for the audio thread. */
+    void release();
+
+    /** Whether the next block should be passed to record() with a checkpoint of the state before it. For the audio thread. */
+    bool needsCheckpoint() const;
+
+    /** Records one block of input and the parameter values it's processed with, one per parameter ID passed to prepare(). channels has to hold as many channels as were passed to prepare(). The state before the block is kept if it's given and fits into the size passed to prepare(). For the audio thread.
+     */
+    void record (const float* const* channels, const int numSamples, const float* parameterValues, const DspCheckpoint* stateBeforeBlock = nullptr);
+
+    /** The length the rings hold, which the memory cap might have shortened. */
+    double getLengthInSeconds() const { return sampleRate > 0.0 ? audioCapacity / sampleRate : 0.0; }
+
+    /** Everything prepare() allocated. */
+    size_t getMemoryUsageInBytes() const;
+
+    /** Writes the blocks recorded so far as a dump. Returns false if nothing has been recorded yet, the audio thread overwrote all of it while it was being copied, or the stream failed. */
+    bool writeTo (std::ostream& output) const;
+
+    // ======================================================================
+    /** A dump, read back. The audio is stored block after block, each block interleaved. */
+    struct Recording
+    {
+        struct Block
+        {
+            int numSamples;
+            size_t audioOffset;     // index of the block's first sample in audio
+            size_t parameterOffset; // index of the block's first value in parameterValues
+        };
+
+        double sampleRate = 0.0;
+        int numChannels = 0;
+        std::vector<std::string> parameterIDs;
+        DspCheckpoint initialState; // the state before the first block; empty if the dump has none
+        std::vector<Block> blocks;
+        std::vector<float> audio;
+        std::vector<float> parameterValues;
+
+        int getMaxBlockSize() const;
+
+        /** Reads a dump. Returns false if it's not a dump or it's damaged. */
+        bool readFrom (std::istream& input);
+    };
+
+private:
+    struct BlockRecord
+    {
+        int64_t startSample;
+        int numSamples;
+    };
+
+    struct CheckpointRecord
+    {
+        int64_t blockIndex;
+        size_t numBytes;
+    };
+
+    double sampleRate = 0.0;
+    int numChannels = 0;
+    int audioCapacity = 0;
+    int blockCapacity = 0;
+    std::vector<std::string> parameterIDs;
+
+    // audio: one ring per channel; blocks: the start and length of every block plus its parameter values
+    std::vector<float> audio;
+    std::vector<BlockRecord> blocks;
+    std::vector<float> parameters;
+
+    // checkpoints: one slot of checkpointSize bytes each, and which block each one belongs to
+    int checkpointCapacity = 0;
+    size_t checkpointSize = 0;
+    int64_t checkpointInterval = 0;
+    int64_t nextCheckpointSample = 0; // audio thread only
+    std::vector<CheckpointRecord> checkpointRecords;
+    std::vector<uint8_t> checkpointData;
+
+    // everything before the written counts is complete, the audio and checkpoints are published before the blocks which refer to them;
+    // everything up to the reserved counts may be changing right now
+    std::atomic<int64_t> numSamplesReserved { 0 };
+    std::atomic<int64_t> numSamplesWritten { 0 };
+    std::atomic<int64_t> numBlocksReserved { 0 };
+    std::atomic<int64_t> numBlocksWritten { 0 };
+    std::atomic<int64_t> numCheckpointsReserved { 0 };
+    std::atomic<int64_t> numCheckpointsWritten { 0 };
+};
+
+/**
+ A processor which records values of its own with every block besides its parameters, under IDs which aren't parameters. These are decisions which live depend on when another thread got around to something, e.g. whether a freshly built table had been handed over yet. A replay hands them back before every block, so the processor decides the same again.
+ */
+class ReplayableProcessor
+{
+public:
+    virtual ~ReplayableProcessor() {}
+
+    /** Sets a recorded value for the next block. IDs the processor doesn't know are ignored. */
+    virtual void setRecordedValue (const std::string& id, const float value) = 0;
+
+    /** Goes back to deciding everything itself, after a replay. */
+    virtual void clearRecordedValues() = 0;
+};
@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    GainLinkGroup.cpp
+
+  ==============================================================================
+*/
+
+#include "GainLinkGroup.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+GainLinkGroups& GainLinkGroups::getInstance()
+{
+    static GainLinkGroups instance;
+    return instance;
+}
+
+uint64_t GainLinkGroups::makeEntry (const int64_t position, const float gainReductionInDecibels)
+{
+    // the ring index holds the low bits of the position, the tag the ones above; 0 is never a valid tag
+    const auto tag = static_cast<uint32_t> ((position >> ringBits) + 1);
+
+    uint32_t bits;
+    std::memcpy (&bits, &gainReductionInDecibels, sizeof (bits));
+    return (static_cast<uint64_t> (tag) << 32) | bits;
+}
+
+bool GainLinkGroups::readEntry (const uint64_t entry, const int64_t position, float& gainReductionInDecibels)
+{
+    if (static_cast<uint32_t> (entry >> 32) != static_cast<uint32_t> ((position >> ringBits) + 1))
+        return false;
+
+    const auto bits = static_cast<uint32_t> (entry);
+    std::memcpy (&gainReductionInDecibels, &bits, sizeof (bits));
+    return true;
+}
+
+bool GainLinkMember::prepare (const int newGroupIndex, const int linkLatencyInSamples, const int newOversamplingFactor, const int maxBlockSize)
+{
+    leave();
+
+    oversamplingFactor = std::max (1, newOversamplingFactor);
+    latencyInSamples = 0;
+    delayLine.clear();
+    writePosition = 0;
+
+    // the other members may be up to a block ahead of what we read, and everything in between has to stay in the ring
+    if (newGroupIndex < 0 || newGroupIndex >= GainLinkGroups::numGroups
+        || linkLatencyInSamples <= 0 || 2 * linkLatencyInSamples + maxBlockSize / oversamplingFactor > GainLinkGroups::ringSize)
+        return newGroupIndex < 0;
+
+    auto& groups = GainLinkGroups::getInstance();
+    for (int candidate = 0; candidate < GainLinkGroups::maxNumMembers; ++candidate)
+    {
+        int expected = 0;
+        auto& member = groups.getMember (candidate);
+
+        if (member.groupPlusOne.compare_exchange_strong (expected, newGroupIndex + 1))
+        {
+            // whatever the previous member of the slot left behind is no part of our envelope
+            for (auto& entry : member.envelope)
+                entry.store (0, std::memory_order_relaxed);
+
+            groupIndex = newGroupIndex;
+            slot = candidate;
+            latencyInSamples = linkLatencyInSamples * oversamplingFactor;
+            delayLine.assign (static_cast<size_t> (latencyInSamples + maxBlockSize), 0.0f);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void GainLinkMember::leave()
+{
+    if (slot >= 0)
+        GainLinkGroups::getInstance().getMember (slot).groupPlusOne.store (0);
+
+    groupIndex = -1;
+    slot = -1;
+}
+
+void GainLinkMember::linkEnvelope (float* gainReductionInDecibels, const int numSamples, const int64_t position)
+{
+    if (slot < 0)
+        return;
+
+    auto& groups = GainLinkGroups::getInstance();
+    const int numBaseSamples = numSamples / oversamplingFactor;
+    constexpr int ringMask = GainLinkGroups::ringSize - 1;
+
+    // publish our own envelope, one minimum per base-rate sample
+    if (position >= 0)
+    {
+        auto& self = groups.getMember (slot);
+
+        for (int i = 0; i < numBaseSamples; ++i)
+        {
+            const float* group = gainReductionInDecibels + i * oversamplingFactor;
+            const float minimum = *std::min_element (group, group + oversamplingFactor);
+            self.envelope[static_cast<size_t> ((position + i) & ringMask)].store (GainLinkGroups::makeEntry (position + i, minimum), std::memory_order_relaxed);
+        }
+    }
+
+    // delay our own envelope by the link latency; the delay line is long enough to write before reading
+    const int delayLineSize = static_cast<int> (delayLine.size());
+    for (int i = 0; i < numSamples; ++i)
+    {
+        delayLine[static_cast<size_t> ((writePosition + i) % delayLineSize)] = gainReductionInDecibels[i];
+        gainReductionInDecibels[i] = delayLine[static_cast<size_t> ((writePosition + i - latencyInSamples + delayLineSize) % delayLineSize)];
+    }
+    writePosition = (writePosition + numSamples) % delayLineSize;
+
+    if (position < 0)
+        return;
+
+    // combine with what the other members published for the part of the timeline we deliver now
+    const int64_t linkedPosition = position - latencyInSamples / oversamplingFactor;
+    const int ownGroup = groupIndex + 1;
+
+    for (int start = 0; start < numBaseSamples; start += maxBaseSamplesPerChunk)
+    {
+        const int length = std::min (maxBaseSamplesPerChunk, numBaseSamples - start);
+        float others[maxBaseSamplesPerChunk];
+        std::fill (others, others + length, std::numeric_limits<float>::infinity());
+
+        for (int candidate = 0; candidate < GainLinkGroups::maxNumMembers; ++candidate)
+        {
+            auto& other = groups.getMember (candidate);
+            if (candidate == slot || other.groupPlusOne.load (std::memory_order_relaxed) != ownGroup)
+                continue;
+
+            // samples the other member hasn't published (yet) simply don't take part
+            for (int i = 0; i < length; ++i)
+            {
+                const int64_t samplePosition = linkedPosition + start + i;
+                float value;
+                if (GainLinkGroups::readEntry (other.envelope[static_cast<size_t> (samplePosition & ringMask)].load (std::memory_order_relaxed), samplePosition, value))
+                    others[i] = std::min (others[i], value);
+            }
+        }
+
+        for (int i = 0; i < length; ++i)
+        {
+            float* group = gainReductionInDecibels + (start + i) * oversamplingFactor;
+            for (int k = 0; k < oversamplingFactor; ++k)
+                group[k] = std::min (group[k], others[i]);
+        }
+    }
+}
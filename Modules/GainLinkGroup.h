@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    GainLinkGroup.h
+
+    Lock-free gain-reduction linking between plug-in instances of the same
+    process.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ The process-wide shared segment for gain linking: a fixed pool of member slots, each with a ring of envelope samples keyed by their position on the host's timeline. Every entry packs the gain reduction and a tag of its position into one 64-bit atomic, so publishing and reading never block and a reader can tell for every single sample whether it's the one it asked for.
+
+ Everything is statically sized and zero-initialised, so joining a group doesn't allocate, and slots nobody uses don't take any physical memory.
+ */
+class GainLinkGroups
+{
+public:
+    static constexpr int numGroups = 8;
+    static constexpr int maxNumMembers = 32;
+
+    /** Envelope samples per member, at the base rate. A member's link latency has to stay below half of it. */
+    static constexpr int ringBits = 15;
+    static constexpr int ringSize = 1 << ringBits;
+
+    struct Member
+    {
+        std::atomic<int> groupPlusOne { 0 }; // 0 while the slot is free
+        std::array<std::atomic<uint64_t>, ringSize> envelope {};
+    };
+
+    static GainLinkGroups& getInstance();
+
+    Member& getMember (const int slot) { return members[static_cast<size_t> (slot)]; }
+
+    /** Packs a gain reduction with the tag of its position, and checks a packed entry against a position. */
+    static uint64_t makeEntry (const int64_t position, const float gainReductionInDecibels);
+    static bool readEntry (const uint64_t entry, const int64_t position, float& gainReductionInDecibels);
+
+private:
+    constexpr GainLinkGroups() = default;
+
+    std::array<Member, maxNumMembers> members;
+};
+
+/**
+ One instance's membership in a link group.
+
+ Linking is symmetric and never waits: every block, a member publishes its gain-reduction envelope for its position on the host's timeline, and applies the minimum (= strongest reduction) of all members from one link latency earlier. With the link latency at least the host's block size, every other member has published that part of the timeline already, whichever order the host processes them in, and on whichever thread. The member's own envelope is delayed by the same amount, and the audio has to be delayed by getLatencyInSamples() as well, which is reported to the host.
+
+ The envelopes are exchanged at the base rate, so members with different oversampling factors can be linked; a member publishes the minimum of every group of oversampled samples. Without a shared timeline, e.g. while the host is stopped, nothing is exchanged, but the envelope is still delayed so the latency stays the same.
+ */
+class GainLinkMember
+{
+public:
+    GainLinkMember() {}
+    ~GainLinkMember() { prepare (-1, 0, 1, 0); }
+
+    /** Joins the group with the given index (0 ... GainLinkGroups::numGroups - 1), or leaves the current group with -1, and prepares the delay of the own envelope. The link latency is given at the base rate and should be the host's block size. Returns false if the group has no free slot, or the latency is too long for the shared rings; the member doesn't link then, and has no latency. Not while linkEnvelope() might run.
+     */
+    bool prepare (const int groupIndex, const int linkLatencyInSamples, const int oversamplingFactor, const int maxBlockSize);
+
+    /** Returns the index of the group this member belongs to, or -1. */
+    int getGroup() const { return groupIndex; }
+
+    /** The delay of the linked envelope at the processing rate, 0 outside a group. */
+    int getLatencyInSamples() const { return latencyInSamples; }
+
+    /** Publishes the envelope (in decibels, at the processing rate) for the given position at the base rate, and replaces it with the group minimum from one link latency earlier. Without a shared timeline, pass -1 as the position. Call this on the audio thread, with at most maxBlockSize samples.
+     */
+    void linkEnvelope (float* gainReductionInDecibels, const int numSamples, const int64_t position);
+
+private:
+    void leave();
+
+    static constexpr int maxBaseSamplesPerChunk = 256;
+
+    int groupIndex = -1;
+    int slot = -1;
+    int oversamplingFactor = 1;
+    int latencyInSamples = 0;
+
+    // the own envelope's delay line, at the processing rate
+    std::vector<float> delayLine;
+    int writePosition = 0;
+};
@@ -17,6 +17,7 @@
  */
 
 #include "GainReductionComputer.h"
+#include <algorithm>
 
 GainReductionComputer::GainReductionComputer()
 {
@@ -29,6 +30,9 @@ GainReductionComputer::GainReductionComputer()
     releaseTime = 0.15f;
     setRatio (2); // 2 : 1
     makeUpGain = 0.0f;
+    decimationFactor = 1;
+    alphaAttack = 0.0f;
+    alphaRelease = 0.0f;
     reset();
 }
 
@@ -36,25 +40,43 @@ void GainReductionComputer::prepare (const double newSampleRate)
 {
     sampleRate = newSampleRate;
 
-    alphaAttack = 1.0f - timeToGain (attackTime);
-    alphaRelease = 1.0f - timeToGain (releaseTime);
+    ballisticsNeedUpdate = true;
+    updateBallistics();
 }
 
 void GainReductionComputer::setAttackTime (const float attackTimeInSeconds)
 {
     attackTime = attackTimeInSeconds;
-    alphaAttack = 1.0f - timeToGain (attackTime);
+    ballisticsNeedUpdate = true;
 }
 
 void GainReductionComputer::setReleaseTime (const float releaseTimeInSeconds)
 {
     releaseTime = releaseTimeInSeconds;
-    alphaRelease = 1.0f - timeToGain (releaseTime);
+    ballisticsNeedUpdate = true;
+}
+
+void GainReductionComputer::setDecimationFactor (const int factor)
+{
+    decimationFactor = std::max (1, factor);
+    ballisticsNeedUpdate = true;
+}
+
+void GainReductionComputer::updateBallistics()
+{
+    if (! ballisticsNeedUpdate.exchange (false))
+        return;
+
+    // factor and coefficients change together, so a block never runs with one of them stale
+    controlRateFactor = decimationFactor.load();
+    alphaAttack = 1.0f - timeToGain (attackTime.load());
+    alphaRelease = 1.0f - timeToGain (releaseTime.load());
 }
 
 const float GainReductionComputer::timeToGain (const float timeInSeconds)
 {
-    return std::exp (-1.0f / (static_cast<float> (sampleRate) * timeInSeconds));
+    // the ballistics run at the control rate
+    return std::exp (-1.0f / (static_cast<float> (sampleRate / controlRateFactor) * timeInSeconds));
 }
 
 void GainReductionComputer::setKnee (const float kneeInDecibels)
@@ -91,13 +113,27 @@ inline const float GainReductionComputer::applyCharacteristicToOverShoot (const
 
 void GainReductionComputer::computeGainInDecibelsFromSidechainSignal (const float* sideChainSignal, float* destination, const int numSamples)
 {
+    updateBallistics();
+
+    if (controlRateFactor > 1)
+    {
+        computeGainInDecibelsAtControlRate (sideChainSignal, destination, numSamples);
+        return;
+    }
+
+    if (characteristicTable != nullptr)
+    {
+        computeGainInDecibelsFromTable (sideChainSignal, destination, numSamples);
+        return;
+    }
+
     maxInputLevel = -std::numeric_limits<float>::infinity();
     maxGainReduction = 0.0f;
 
     for (int i = 0; i < numSamples; ++i)
     {
         // convert sample to decibels
-        const float levelInDecibels = 20.0f * std::log10 (abs (sideChainSignal[i]));
+        const float levelInDecibels = 20.0f * std::log10 (std::abs (sideChainSignal[i]));
         
         if (levelInDecibels > maxInputLevel)
             maxInputLevel = levelInDecibels;
@@ -121,6 +157,81 @@ void GainReductionComputer::computeGainInDecibelsFromSidechainSignal (const floa
     }
 }
 
+void GainReductionComputer::computeGainInDecibelsAtControlRate (const float* sideChainSignal, float* destination, const int numSamples)
+{
+    float maxPeak = 0.0f;
+    float minState = 0.0f;
+
+    for (int start = 0; start < numSamples; start += controlRateFactor)
+    {
+        const int groupLength = std::min (controlRateFactor, numSamples - start);
+
+        // take the peak of the group, so no peak gets lost
+        float peak = 0.0f;
+        for (int i = start; i < start + groupLength; ++i)
+            peak = std::max (peak, std::abs (sideChainSignal[i]));
+
+        maxPeak = std::max (maxPeak, peak);
+
+        const float gainReduction = characteristicTable != nullptr ? characteristicTable->getGainReductionInDecibels (peak)
+                                                                   : applyCharacteristicToOverShoot (20.0f * std::log10 (peak) - threshold);
+
+        // apply ballistics, a group cut short by the end of the block only gets its share of the step
+        const float diff = gainReduction - state;
+        float alpha = diff < 0.0f ? alphaAttack : alphaRelease;
+        if (groupLength < controlRateFactor)
+            alpha = 1.0f - std::pow (1.0f - alpha, static_cast<float> (groupLength) / controlRateFactor);
+
+        const float previousState = state;
+        state += alpha * diff;
+
+        // The group's peak may be its first sample, so a deeper reduction applies to the whole group. Only the release is
+        // interpolated linearly from the previous control value, it never reduces less than the new one. Works in place, the group was read already.
+        if (state < previousState)
+            std::fill (destination + start, destination + start + groupLength, state);
+        else
+        {
+            const float increment = (state - previousState) / groupLength;
+            for (int i = 0; i < groupLength; ++i)
+                destination[start + i] = previousState + increment * (i + 1);
+        }
+
+        minState = std::min (minState, state);
+    }
+
+    maxInputLevel = 20.0f * std::log10 (maxPeak);
+    maxGainReduction = minState;
+}
+
+void GainReductionComputer::computeGainInDecibelsFromTable (const float* sideChainSignal, float* destination, const int numSamples)
+{
+    float maxPeak = 0.0f;
+    float minState = 0.0f;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float absoluteValue = std::abs (sideChainSignal[i]);
+        maxPeak = std::max (maxPeak, absoluteValue);
+
+        // the table replaces log, overshoot, knee and ratio
+        const float gainReduction = characteristicTable->getGainReductionInDecibels (absoluteValue);
+
+        // apply ballistics
+        const float diff = gainReduction - state;
+        if (diff < 0.0f) // wanted gain reduction is below state -> attack phase
+            state += alphaAttack * diff;
+        else // release phase
+            state += alphaRelease * diff;
+
+        destination[i] = state;
+        minState = std::min (minState, state);
+    }
+
+    // the meter only needs one logarithm per block
+    maxInputLevel = 20.0f * std::log10 (maxPeak);
+    maxGainReduction = minState;
+}
+
 void GainReductionComputer::computeLinearGainFromSidechainSignal (const float* sideChainSignal, float* destination, const int numSamples)
 {
     computeGainInDecibelsFromSidechainSignal (sideChainSignal, destination, numSamples);
@@ -135,6 +246,11 @@ void GainReductionComputer::getCharacteristic (float* inputLevelsInDecibels, flo
         dest[i] = getCharacteristicSample (inputLevelsInDecibels[i]);
 }
 
+float GainReductionComputer::getGainReductionForLevel (const float inputLevelInDecibels)
+{
+    return applyCharacteristicToOverShoot (inputLevelInDecibels - threshold);
+}
+
 float GainReductionComputer::getCharacteristicSample (const float inputLevelInDecibels)
 {
     float overShoot = inputLevelInDecibels - threshold;
@@ -22,9 +22,13 @@
 #include <limits>
 #include <cmath>
 #include <atomic>
+#include "CharacteristicTable.h"
+#include "DspCheckpoint.h"
 
 /**
  This class acts as the side-chain path of a dynamic range compressor. It processes a given side-chain signal and computes the gain reduction samples depending on the parameters threshold, knee, attack-time, release-time, ratio, and make-up gain.
+
+ Attack time, release time and decimation factor can be set from any thread; the ballistics' coefficients are computed on the processing thread with the next block.
  */
 class GainReductionComputer
 {
@@ -66,6 +70,12 @@ public:
      */
     void setRatio (const float ratio);
 
+    /**
+     Sets how many samples share one control-rate step of the gain computation. With a factor of 1 (the default) the gain is computed for every sample. With larger factors, log, characteristic and ballistics only run once per group of samples, on the group's peak. A deeper gain reduction applies from the group's first sample on, so the peak is covered wherever it is in the group; only the release is linearly interpolated.
+     */
+    void setDecimationFactor (const int factor);
+    const int getDecimationFactor() { return decimationFactor.load (std::memory_order_relaxed); }
+
     // ======================================================================
     /**
      Computes the static output levels for an array of input levels in decibels. Useful for visualization of the compressor's characteristic. Will contain make-up gain.
@@ -77,6 +87,16 @@ public:
      */
     float getCharacteristicSample (const float inputLevelInDecibels);
 
+    /**
+     Computes the static gain reduction in decibels for a given input level in decibels. Will NOT contain make-up gain.
+     */
+    float getGainReductionForLevel (const float inputLevelInDecibels);
+
+    /**
+     Sets a table of the static characteristic, which replaces the logarithm and the knee math in the detector. Pass nullptr to compute the characteristic directly again. The table isn't owned and has to stay alive while it's set.
+     */
+    void setCharacteristicTable (const CharacteristicTable* table) { characteristicTable = table; }
+
     // ======================================================================
     /**
      Prepares the compressor with sampleRate and expected blockSize. Make sure you call this before you do any processing!
@@ -88,6 +108,12 @@ public:
      */
     void reset() { state = 0.0f; }
 
+    /**
+     Saves the ballistics' state into the checkpoint, and restores it.
+     */
+    void saveState (DspCheckpoint& checkpoint) const { checkpoint.write (state); }
+    bool restoreState (DspCheckpoint::Reader& reader) { return reader.read (state); }
+
     /**
      Computes the gain reduction for a given side-chain signal. The values will be in decibels and will NOT contain the make-up gain.
      */
@@ -103,17 +129,24 @@ public:
 
 private:
     inline const float timeToGain (const float timeInSeconds);
+    void updateBallistics();
     inline const float applyCharacteristicToOverShoot (const float overShootInDecibels);
+    void computeGainInDecibelsAtControlRate (const float* sideChainSignal, float* destination, const int numSamples);
+    void computeGainInDecibelsFromTable (const float* sideChainSignal, float* destination, const int numSamples);
 
     double sampleRate;
 
     // parameters
     float knee, kneeHalf;
     float threshold;
-    float attackTime;
-    float releaseTime;
     float slope;
     float makeUpGain;
+    const CharacteristicTable* characteristicTable = nullptr;
+
+    // set from any thread, turned into coefficients by updateBallistics()
+    std::atomic<float> attackTime, releaseTime;
+    std::atomic<int> decimationFactor;
+    std::atomic<bool> ballisticsNeedUpdate { true };
 
     std::atomic<float> maxInputLevel {-std::numeric_limits<float>::infinity()};
     std::atomic<float> maxGainReduction {0};
@@ -121,6 +154,8 @@ private:
     //state variable
     float state;
 
+    // processing thread only: the coefficients, and the decimation factor they are computed for
     float alphaAttack;
     float alphaRelease;
+    int controlRateFactor = 1;
 };
@@ -0,0 +1,346 @@
+/*
+  ==============================================================================
+
+    LimiterCore.cpp
+
+  ==============================================================================
+*/
+
+#include "LimiterCore.h"
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+    constexpr float lookAheadTimeInSeconds = 0.005f;
+
+    // the same as juce::Decibels::decibelsToGain
+    inline float decibelsToGain (const float decibels)
+    {
+        return decibels > -100.0f ? std::pow (10.0f, decibels * 0.05f) : 0.0f;
+    }
+}
+
+LimiterCore::LimiterCore()
+{
+    // the plug-in's default parameters
+    setThreshold (-30.0f);
+    setKnee (0.0f);
+    setRatio (std::numeric_limits<float>::infinity());
+    setAttackTime (0.03f);
+    setReleaseTime (0.15f);
+
+    lookAheadFadeIn.setDelayTime (lookAheadTimeInSeconds);
+}
+
+void LimiterCore::applySettings (GainReductionComputer& computer)
+{
+    computer.setThreshold (threshold);
+    computer.setKnee (knee);
+    computer.setRatio (ratio);
+    computer.setAttackTime (attackTime);
+    computer.setReleaseTime (releaseTime);
+    computer.setDecimationFactor (decimationFactor);
+}
+
+template <typename Function>
+void LimiterCore::forEachGainReductionComputer (Function&& function)
+{
+    function (gainReductionComputer);
+
+    for (auto& strip : strips)
+        function (strip->gainReductionComputer);
+}
+
+void LimiterCore::prepare (const double newSampleRate, const int newNumChannels)
+{
+    sampleRate = newSampleRate;
+    numChannels = std::max (1, newNumChannels);
+
+    // new strips take over the settings of the linked detector and look-ahead
+    while (static_cast<int> (strips.size()) < numChannels)
+    {
+        strips.push_back (std::make_unique<ChannelStrip>());
+        applySettings (strips.back()->gainReductionComputer);
+        strips.back()->gainReductionComputer.setCharacteristicTable (&characteristicTable);
+        strips.back()->lookAheadFadeIn.setDelayTime (lookAheadTimeInSeconds);
+        strips.back()->lookAheadFadeIn.setFadeShape (lookAheadFadeIn.getFadeShape());
+    }
+
+    forEachGainReductionComputer ([this] (GainReductionComputer& computer) { computer.prepare (sampleRate); });
+
+    lookAheadFadeIn.prepare (sampleRate, subBlockSize);
+    for (auto& strip : strips)
+        strip->lookAheadFadeIn.prepare (sampleRate, subBlockSize);
+
+    delayInSamples = lookAheadFadeIn.getDelayInSamples();
+    delayLines.assign (static_cast<size_t> (numChannels * std::max (1, delayInSamples)), 0.0f);
+    delayPosition = 0;
+
+    gain.assign (subBlockSize, 0.0f);
+
+    sideChainFilter.prepare (sampleRate, numChannels);
+    channelPointers.assign (static_cast<size_t> (numChannels), nullptr);
+    keys.assign (static_cast<size_t> (numChannels * subBlockSize), 0.0f);
+    keyPointers.resize (static_cast<size_t> (numChannels));
+    for (int ch = 0; ch < numChannels; ++ch)
+        keyPointers[static_cast<size_t> (ch)] = keys.data() + ch * subBlockSize;
+
+    clipper.prepare (subBlockSize, numChannels);
+    dither.prepare (subBlockSize, numChannels);
+    statistics.prepare (sampleRate, numChannels, subBlockSize);
+
+    reset();
+}
+
+void LimiterCore::reset()
+{
+    forEachGainReductionComputer ([] (GainReductionComputer& computer) { computer.reset(); });
+    std::fill (delayLines.begin(), delayLines.end(), 0.0f);
+    delayPosition = 0;
+    sideChainFilter.reset();
+    clipper.reset();
+    dither.reset();
+    statistics.reset();
+}
+
+// ==============================================================================
+void LimiterCore::setThreshold (const float thresholdInDecibels)
+{
+    threshold = thresholdInDecibels;
+    statistics.setThreshold (thresholdInDecibels);
+    forEachGainReductionComputer ([=] (GainReductionComputer& computer) { computer.setThreshold (thresholdInDecibels); });
+    rebuildCharacteristicTable();
+}
+
+void LimiterCore::setKnee (const float kneeInDecibels)
+{
+    knee = kneeInDecibels;
+    forEachGainReductionComputer ([=] (GainReductionComputer& computer) { computer.setKnee (kneeInDecibels); });
+    rebuildCharacteristicTable();
+}
+
+void LimiterCore::setRatio (const float newRatio)
+{
+    ratio = newRatio;
+    forEachGainReductionComputer ([=] (GainReductionComputer& computer) { computer.setRatio (newRatio); });
+    rebuildCharacteristicTable();
+}
+
+void LimiterCore::setAttackTime (const float attackTimeInSeconds)
+{
+    attackTime = attackTimeInSeconds;
+    forEachGainReductionComputer ([=] (GainReductionComputer& computer) { computer.setAttackTime (attackTimeInSeconds); });
+}
+
+void LimiterCore::setReleaseTime (const float releaseTimeInSeconds)
+{
+    releaseTime = releaseTimeInSeconds;
+    forEachGainReductionComputer ([=] (GainReductionComputer& computer) { computer.setReleaseTime (releaseTimeInSeconds); });
+}
+
+void LimiterCore::setFadeShape (const LookAheadGainReduction::FadeShape shape)
+{
+    lookAheadFadeIn.setFadeShape (shape);
+    for (auto& strip : strips)
+        strip->lookAheadFadeIn.setFadeShape (shape);
+}
+
+void LimiterCore::setDecimationFactor (const int factor)
+{
+    decimationFactor = factor;
+    forEachGainReductionComputer ([=] (GainReductionComputer& computer) { computer.setDecimationFactor (factor); });
+}
+
+void LimiterCore::setClipper (const AntiderivativeClipper::Order order, const float ceilingAboveTargetInDecibels)
+{
+    clipper.setOrder (order);
+    ceilingAboveTarget = ceilingAboveTargetInDecibels;
+}
+
+void LimiterCore::setDither (const int bitDepth, const NoiseShapingDither::Shape shape)
+{
+    dither.setBitDepth (bitDepth);
+    dither.setShape (shape);
+}
+
+void LimiterCore::rebuildCharacteristicTable()
+{
+    characteristicTable.build (gainReductionComputer);
+    forEachGainReductionComputer ([this] (GainReductionComputer& computer) { computer.setCharacteristicTable (&characteristicTable); });
+}
+
+// ==============================================================================
+void LimiterCore::processPlanar (float* const* channels, const int numSamples)
+{
+    process (PlanarBuffer { channels }, numSamples);
+}
+
+void LimiterCore::processInterleaved (float* frames, const int numFrames)
+{
+    process (InterleavedBuffer { frames, numChannels }, numFrames);
+}
+
+template <typename Buffer>
+void LimiterCore::process (const Buffer& buffer, const int numSamples)
+{
+    clipper.setCeiling (threshold + makeUpGain + ceilingAboveTarget);
+
+    for (int start = 0; start < numSamples; start += subBlockSize)
+        processSubBlock (buffer, start, std::min (subBlockSize, numSamples - start));
+
+    // the statistics analyse their output once per call instead of once per sub-block, and are up to date afterwards
+    statistics.flush();
+}
+
+template <typename Buffer>
+void LimiterCore::processSubBlock (const Buffer& buffer, const int start, const int numSamples)
+{
+    float* g = gain.data();
+
+    // dither has to come last, it only fits into the gain stage if the clipper doesn't follow
+    const bool useDither = dither.isEnabled();
+    const bool ditherInGainStage = useDither && clipper.getOrder() == AntiderivativeClipper::Order::off;
+
+    const bool useSideChainFilter = sideChainFilter.isEnabled();
+    if (useSideChainFilter)
+        for (int ch = 0; ch < numChannels; ++ch)
+            channelPointers[static_cast<size_t> (ch)] = &buffer (ch, start);
+
+    if (linkChannels)
+    {
+        // side-chain: the maximum of the absolute values of all channels
+        if (useSideChainFilter)
+            sideChainFilter.processMaxAbs (channelPointers.data(), numChannels, g, numSamples, buffer.getStride());
+        else
+        {
+            for (int i = 0; i < numSamples; ++i)
+                g[i] = std::abs (buffer (0, start + i));
+
+            for (int ch = 1; ch < numChannels; ++ch)
+                for (int i = 0; i < numSamples; ++i)
+                    g[i] = std::max (g[i], std::abs (buffer (ch, start + i)));
+        }
+
+        if (collectStatistics)
+            statistics.addKeySignal (g, numSamples);
+
+        gainReductionComputer.computeGainInDecibelsFromSidechainSignal (g, g, numSamples);
+
+        if (collectStatistics)
+            statistics.addGainReduction (g, numSamples);
+
+        convertToLinearGain (g, numSamples, lookAheadFadeIn, makeUpGain, useLookAhead);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            if (useLookAhead)
+                delayChannel (buffer, ch, start, numSamples);
+
+            applyGain (buffer, ch, start, numSamples, ditherInGainStage);
+        }
+    }
+    else
+    {
+        // the detector EQ filters four channels at once, so all keys are computed up front
+        if (useSideChainFilter)
+            sideChainFilter.processAbs (channelPointers.data(), keyPointers.data(), numChannels, numSamples, buffer.getStride());
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& strip = *strips[static_cast<size_t> (ch)];
+
+            if (useSideChainFilter)
+                std::copy (keyPointers[static_cast<size_t> (ch)], keyPointers[static_cast<size_t> (ch)] + numSamples, g);
+            else
+                for (int i = 0; i < numSamples; ++i)
+                    g[i] = std::abs (buffer (ch, start + i));
+
+            if (collectStatistics)
+                statistics.addKeySignal (g, numSamples);
+
+            strip.gainReductionComputer.computeGainInDecibelsFromSidechainSignal (g, g, numSamples);
+
+            if (collectStatistics)
+                statistics.addGainReduction (g, numSamples);
+
+            convertToLinearGain (g, numSamples, strip.lookAheadFadeIn, makeUpGain, useLookAhead);
+
+            if (useLookAhead)
+                delayChannel (buffer, ch, start, numSamples);
+
+            applyGain (buffer, ch, start, numSamples, ditherInGainStage);
+        }
+    }
+
+    if (useLookAhead && delayInSamples > 0)
+        delayPosition = (delayPosition + numSamples) % delayInSamples;
+
+    if (clipper.getOrder() != AntiderivativeClipper::Order::off)
+        for (int ch = 0; ch < numChannels; ++ch)
+            clipper.process (&buffer (ch, start), numSamples, ch, buffer.getStride());
+
+    if (useDither && ! ditherInGainStage)
+        for (int ch = 0; ch < numChannels; ++ch)
+            dither.process (&buffer (ch, start), numSamples, ch, buffer.getStride());
+
+    if (collectStatistics)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            statistics.addOutput (&buffer (ch, start), numSamples, ch, buffer.getStride());
+
+        statistics.endBlock (numSamples);
+    }
+}
+
+template <typename Buffer>
+void LimiterCore::applyGain (const Buffer& buffer, const int channel, const int start, const int numSamples, const bool withDither)
+{
+    const float* g = gain.data();
+
+    if (withDither)
+        dither.processWithGain (&buffer (channel, start), g, numSamples, channel, buffer.getStride());
+    else
+        for (int i = 0; i < numSamples; ++i)
+            buffer (channel, start + i) *= g[i];
+}
+
+template <typename Buffer>
+void LimiterCore::delayChannel (const Buffer& buffer, const int channel, const int start, const int numSamples)
+{
+    if (delayInSamples <= 0)
+        return;
+
+    float* line = delayLines.data() + channel * delayInSamples;
+    int position = delayPosition;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float& sample = buffer (channel, start + i);
+        std::swap (sample, line[position]);
+
+        if (++position == delayInSamples)
+            position = 0;
+    }
+}
+
+void LimiterCore::convertToLinearGain (float* gain, const int numSamples, LookAheadGainReduction& fadeIn, const float makeUpGainInDecibels, const bool useLookAhead)
+{
+    if (useLookAhead)
+    {
+        // fade in gain reduction
+        fadeIn.pushSamples (gain, numSamples);
+        fadeIn.process();
+        fadeIn.readSamples (gain, numSamples);
+
+        // add make-up and convert to linear gain
+        for (int i = 0; i < numSamples; ++i)
+            gain[i] = decibelsToGain (gain[i] + makeUpGainInDecibels);
+    }
+    else
+    {
+        // add make-up and convert to linear gain, the same way GainReductionComputer::computeLinearGainFromSidechainSignal does
+        for (int i = 0; i < numSamples; ++i)
+            gain[i] = std::pow (10.0f, 0.05f * (gain[i] + makeUpGainInDecibels));
+    }
+}
@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    LimiterCore.h
+
+    The complete limiter without JUCE, for planar and interleaved buffers.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "GainReductionComputer.h"
+#include "LookAheadGainReduction.h"
+#include "CharacteristicTable.h"
+#include "AntiderivativeClipper.h"
+#include "NoiseShapingDither.h"
+#include "RenderStatistics.h"
+#include "SideChainFilter.h"
+#include <vector>
+#include <memory>
+
+/**
+ The limiter as the plug-in runs it without oversampling: detector with characteristic table, optional control rate, look-ahead fade-in, delay and gain stage, linked over all channels or per channel. It only depends on the standard library and the other modules, so it can be used outside of the plug-in.
+
+ Buffers are processed in place and in sub-blocks of subBlockSize samples, the same way the plug-in does, so for the same parameters the output is bit-identical to the plug-in's. Interleaved buffers are processed directly with a stride, without deinterleaving them first.
+
+ prepare() and the setters for threshold, knee and ratio allocate; the process functions don't.
+ */
+class LimiterCore
+{
+public:
+    static constexpr int subBlockSize = 64;
+
+    LimiterCore();
+    ~LimiterCore() {}
+
+    /** Prepares the limiter for the given number of channels. Has to be called before processing. */
+    void prepare (const double sampleRate, const int numChannels);
+
+    /** Clears the state, the delay lines and the look-ahead. */
+    void reset();
+
+    // ======================================================================
+    void setThreshold (const float thresholdInDecibels);
+    void setKnee (const float kneeInDecibels);
+    void setRatio (const float newRatio);
+    void setAttackTime (const float attackTimeInSeconds);
+    void setReleaseTime (const float releaseTimeInSeconds);
+    void setMakeUpGain (const float makeUpGainInDecibels) { makeUpGain = makeUpGainInDecibels; }
+    void setLookAhead (const bool shouldUseLookAhead) { useLookAhead = shouldUseLookAhead; }
+    void setFadeShape (const LookAheadGainReduction::FadeShape shape);
+    void setDecimationFactor (const int factor);
+
+    /** With linked channels (the default), all channels share the gain reduction of the loudest one; otherwise each channel is limited on its own. */
+    void setChannelLink (const bool shouldLinkChannels) { linkChannels = shouldLinkChannels; }
+
+    /** The detector EQ, which filters the key signal only. Off by default. */
+    SideChainFilter& getSideChainFilter() { return sideChainFilter; }
+
+    /** Sets the output clipper's antialiasing order, or turns it off, and its ceiling above threshold plus make-up gain. */
+    void setClipper (const AntiderivativeClipper::Order order, const float ceilingAboveTargetInDecibels);
+
+    /** Sets the dither's word length (0 turns it off) and noise shaping. */
+    void setDither (const int bitDepth, const NoiseShapingDither::Shape shape);
+
+    /** Seeds the dither's generators, takes effect with the next reset() or prepare(). */
+    void setDitherSeed (const uint32_t seed) { dither.setSeed (seed); }
+
+    /** Collects the quality-control statistics of everything processed from now on, until the next reset(). Off by default, as it costs a true-peak interpolator per channel.
+     */
+    void setCollectStatistics (const bool shouldCollectStatistics) { collectStatistics = shouldCollectStatistics; }
+
+    /** The statistics collected since the last reset() or prepare(), up to the end of the last process call. */
+    const RenderStatistics& getStatistics() const { return statistics; }
+
+    /** The latency in samples, caused by the look-ahead and the clipper. */
+    int getLatencyInSamples() const { return (useLookAhead ? delayInSamples : 0) + clipper.getLatencyInSamples(); }
+
+    // ======================================================================
+    /** Processes planar channels in place. */
+    void processPlanar (float* const* channels, const int numSamples);
+
+    /** Processes interleaved frames of all channels in place. */
+    void processInterleaved (float* frames, const int numFrames);
+
+    // ======================================================================
+    /** Fades in the gain reduction if look-ahead is enabled, adds the make-up gain and converts it to linear gain, in place. The plug-in uses this as well, so both compute exactly the same gains.
+     */
+    static void convertToLinearGain (float* gain, const int numSamples, LookAheadGainReduction& fadeIn, const float makeUpGainInDecibels, const bool useLookAhead);
+
+private:
+    struct PlanarBuffer
+    {
+        float* const* channels;
+        float& operator() (const int channel, const int sample) const { return channels[channel][sample]; }
+        int getStride() const { return 1; }
+    };
+
+    struct InterleavedBuffer
+    {
+        float* frames;
+        int numChannels;
+        float& operator() (const int channel, const int sample) const { return frames[sample * numChannels + channel]; }
+        int getStride() const { return numChannels; }
+    };
+
+    struct ChannelStrip
+    {
+        GainReductionComputer gainReductionComputer;
+        LookAheadGainReduction lookAheadFadeIn;
+    };
+
+    template <typename Buffer>
+    void process (const Buffer& buffer, const int numSamples);
+
+    template <typename Buffer>
+    void processSubBlock (const Buffer& buffer, const int start, const int numSamples);
+
+    template <typename Buffer>
+    void applyGain (const Buffer& buffer, const int channel, const int start, const int numSamples, const bool withDither);
+
+    template <typename Buffer>
+    void delayChannel (const Buffer& buffer, const int channel, const int start, const int numSamples);
+
+    template <typename Function>
+    void forEachGainReductionComputer (Function&& function);
+
+    void applySettings (GainReductionComputer& computer);
+
+    void rebuildCharacteristicTable();
+
+    double sampleRate = 0.0;
+    int numChannels = 0;
+
+    // kept for strips added by prepare()
+    float threshold, knee, ratio, attackTime, releaseTime;
+    int decimationFactor = 1;
+
+    float makeUpGain = 0.0f;
+    bool useLookAhead = false;
+    bool linkChannels = true;
+
+    GainReductionComputer gainReductionComputer;
+    LookAheadGainReduction lookAheadFadeIn;
+    std::vector<std::unique_ptr<ChannelStrip>> strips;
+    CharacteristicTable characteristicTable;
+
+    // the audio delay lines, one ring of delayInSamples per channel
+    int delayInSamples = 0;
+    int delayPosition = 0;
+    std::vector<float> delayLines;
+
+    // detector EQ, with the channel pointers of the current sub-block and the keys of unlinked channels
+    SideChainFilter sideChainFilter;
+    std::vector<const float*> channelPointers;
+    std::vector<float> keys;
+    std::vector<float*> keyPointers;
+
+    AntiderivativeClipper clipper;
+    float ceilingAboveTarget = 1.0f;
+
+    NoiseShapingDither dither;
+
+    RenderStatistics statistics;
+    bool collectStatistics = false;
+
+    std::vector<float> gain;
+};
@@ -18,6 +18,8 @@
 
 
 #include "LookAheadGainReduction.h"
+#include "MemoryArena.h"
+#include "TraceZones.h"
 #include <cmath>
 #include <algorithm>
 
@@ -28,22 +30,115 @@ void LookAheadGainReduction::setDelayTime (float delayTimeInSeconds)
     else
         delay = delayTimeInSeconds;
 
-    if (sampleRate != 0.0)
+    // arena memory is sized for the delay time it was prepared with
+    if (sampleRate != 0.0 && ! usesArena)
         prepare (sampleRate, blockSize);
 }
 
-void LookAheadGainReduction::prepare (const double newSampleRate, const int newBlockSize)
+void LookAheadGainReduction::computeSizes (const double newSampleRate, const int newBlockSize)
 {
     sampleRate = newSampleRate;
     blockSize = newBlockSize;
 
     delayInSamples = static_cast<int> (delay * sampleRate);
+    bufferSize = blockSize + delayInSamples;
+}
+
+void LookAheadGainReduction::prepare (const double newSampleRate, const int newBlockSize)
+{
+    computeSizes (newSampleRate, newBlockSize);
+
+    ownMemory.resize (static_cast<size_t> (bufferSize + numFadeShapes * (delayInSamples + 1)));
+    buffer = ownMemory.data();
+    fadeTables = buffer + bufferSize;
+    usesArena = false;
+
+    clearBuffers();
+    buildFadeTables();
+}
+
+bool LookAheadGainReduction::prepare (const double newSampleRate, const int newBlockSize, MemoryArena& arena)
+{
+    computeSizes (newSampleRate, newBlockSize);
+
+    buffer = arena.allocate<float> (static_cast<size_t> (bufferSize));
+    fadeTables = arena.allocate<float> (static_cast<size_t> (numFadeShapes * (delayInSamples + 1)));
+    ownMemory.clear();
+    ownMemory.shrink_to_fit();
+    usesArena = true;
 
-    buffer.resize (blockSize + delayInSamples);
-    std::fill (buffer.begin(), buffer.end(), 0.0f);
+    if (buffer == nullptr || fadeTables == nullptr)
+        return false;
+
+    clearBuffers();
+    buildFadeTables();
+    return true;
+}
+
+size_t LookAheadGainReduction::getRequiredArenaBytes (const double sampleRate, const int blockSize, const float delayTimeInSeconds)
+{
+    const int delayInSamples = static_cast<int> (std::max (0.0f, delayTimeInSeconds) * sampleRate);
+    return MemoryArena::getRequiredBytes<float> (static_cast<size_t> (blockSize + delayInSamples))
+         + MemoryArena::getRequiredBytes<float> (static_cast<size_t> (numFadeShapes * (delayInSamples + 1)));
+}
+
+void LookAheadGainReduction::clearBuffers()
+{
+    std::fill (buffer, buffer + bufferSize, 0.0f);
     writePosition = 0;
 }
 
+void LookAheadGainReduction::saveState (DspCheckpoint& checkpoint) const
+{
+    checkpoint.write (bufferSize);
+    checkpoint.write (buffer, static_cast<size_t> (bufferSize));
+    checkpoint.write (writePosition);
+    checkpoint.write (lastPushedSamples);
+}
+
+bool LookAheadGainReduction::restoreState (DspCheckpoint::Reader& reader)
+{
+    int savedBufferSize = 0;
+    if (! reader.read (savedBufferSize) || savedBufferSize != bufferSize)
+        return false;
+
+    return reader.read (buffer, static_cast<size_t> (bufferSize))
+        && reader.read (writePosition)
+        && reader.read (lastPushedSamples);
+}
+
+float LookAheadGainReduction::getFadeValue (const FadeShape shape, const double x)
+{
+    const double pi = 3.14159265358979323846;
+    const double exponentialCurvature = 4.0;
+
+    switch (shape)
+    {
+        case FadeShape::raisedCosine:   return static_cast<float> (0.5 - 0.5 * std::cos (pi * x));
+        case FadeShape::exponential:    return static_cast<float> ((std::exp (exponentialCurvature * x) - 1.0) / (std::exp (exponentialCurvature) - 1.0));
+        case FadeShape::sCurve:         return static_cast<float> (x * x * x * (x * (6.0 * x - 15.0) + 10.0));
+        case FadeShape::linear:
+        default:                        return static_cast<float> (x);
+    }
+}
+
+void LookAheadGainReduction::buildFadeTables()
+{
+    const int tableSize = delayInSamples + 1;
+
+    for (int shape = 0; shape < numFadeShapes; ++shape)
+    {
+        float* table = fadeTables + shape * tableSize;
+
+        for (int k = 0; k < tableSize; ++k)
+        {
+            // x runs from 1 (at the peak) down to 0 (start of the fade)
+            const double x = delayInSamples > 0 ? 1.0 - static_cast<double> (k) / delayInSamples : 0.0;
+            table[k] = getFadeValue (static_cast<FadeShape> (shape), x);
+        }
+    }
+}
+
 void LookAheadGainReduction::pushSamples (const float* src, const int numSamples)
 {
     int startIndex, blockSize1, blockSize2;
@@ -59,34 +154,41 @@ void LookAheadGainReduction::pushSamples (const float* src, const int numSamples
             buffer[i] = src[blockSize1 + i];
 
     writePosition += numSamples;
-    writePosition = writePosition % buffer.size();
+    writePosition = writePosition % bufferSize;
 
     lastPushedSamples = numSamples;
 }
 
 void LookAheadGainReduction::process()
 {
+    TLIMITER_TRACE_ZONE ("LookAheadGainReduction::process");
+
     /** The basic idea here is to look for high gain-reduction values in the signal, and apply a fade which starts exactly  `delayInSamples` many samples before that value appears. Depending on the value itself, the slope of the fade will vary.
 
      Some things to note:
         - as the samples are gain-reduction values in decibel, we actually look for negative peaks or local minima.
         - it's easier for us to time-reverse our search, so we start with the last sample
-        - once we find a minimum, we calculate the slope, which will be called `step`
-        - with that slope, we can calculate the next value of our fade-in `nextGainReductionValue`
-        - once a value in the buffer is below our fade-in value, we found a new minimum, which might not be as deep as the previous one, but as it comes in earlier, it needs more attention, so we update our fade-in slope
+        - once we find a minimum, we remember it as `peak` and start counting the `distance` to it
+        - with the fade table of the selected shape, we can calculate the next value of our fade-in `nextGainReductionValue = peak * fade[distance]`
+        - once a value in the buffer is below our fade-in value, we found a new minimum, which might not be as deep as the previous one, but as it comes in earlier, it needs more attention, so we restart our fade-in from there
         - our buffer is a ring-buffer which makes things a little bit messy
      */
 
 
-    // As we don't know any samples of the future, yet, we assume we don't have to apply a fade-in right now, and initialize both `nextGainReductionValue` and step (slope of the fade-in) with zero.
+    // As we don't know any samples of the future, yet, we assume we don't have to apply a fade-in right now, and initialize both `nextGainReductionValue` and the `peak` we are fading towards with zero.
     float nextGainReductionValue = 0.0f;
-    float step = 0.0f;
+    float peak = 0.0f;
+
+    // The fade-in is read from a table of the selected shape: `fade[distance]` is the fraction of the peak value `distance` samples before the peak. Beyond `delayInSamples` the table is zero, so we simply stop counting there.
+    const int tableSize = delayInSamples + 1;
+    const float* fade = fadeTables + fadeShape.load (std::memory_order_relaxed) * tableSize;
+    int distance = delayInSamples;
 
 
     // Get the position of the last sample in the buffer, which is the sample right before our new write position.
     int index = writePosition - 1;
     if (index < 0) // in case it's negative...
-        index += static_cast<int> (buffer.size()); // ... add the buffersize so we wrap around.
+        index += bufferSize; // ... add the buffersize so we wrap around.
 
     // == FIRST STEP: Process all recently pushed samples.
 
@@ -102,12 +204,14 @@ void LookAheadGainReduction::process()
         if (smpl > nextGainReductionValue) // in case the sample is above our ramp...
         {
             buffer[index] = nextGainReductionValue; // ... replace it with the current ramp value
-            nextGainReductionValue += step; // and update the next ramp value
+            distance = std::min (distance + 1, delayInSamples);
+            nextGainReductionValue = peak * fade[distance]; // and update the next ramp value
         }
         else // otherwise... (new peak)
         {
-            step = - smpl / delayInSamples; // calculate the new slope
-            nextGainReductionValue = smpl + step; // and also the new ramp value
+            peak = smpl; // remember the new peak
+            distance = std::min (1, delayInSamples);
+            nextGainReductionValue = peak * fade[distance]; // and also the new ramp value
         }
         --index;
     }
@@ -115,7 +219,7 @@ void LookAheadGainReduction::process()
     // second run
     if (size2 > 0) // in case we have some samples left for the second run
     {
-        index = static_cast<int> (buffer.size()) - 1; // wrap around: start from the last sample of the buffer
+        index = bufferSize - 1; // wrap around: start from the last sample of the buffer
 
         // exactly the same procedure as before... I guess I could have written that better...
         for (int i = 0; i < size2; ++i)
@@ -125,12 +229,14 @@ void LookAheadGainReduction::process()
             if (smpl > nextGainReductionValue)
             {
                 buffer[index] = nextGainReductionValue;
-                nextGainReductionValue += step;
+                distance = std::min (distance + 1, delayInSamples);
+                nextGainReductionValue = peak * fade[distance];
             }
             else
             {
-                step = - smpl / delayInSamples;
-                nextGainReductionValue = smpl + step;
+                peak = smpl;
+                distance = std::min (1, delayInSamples);
+                nextGainReductionValue = peak * fade[distance];
             }
             --index;
         }
@@ -143,7 +249,7 @@ void LookAheadGainReduction::process()
      */
 
     if (index < 0) // it's possible the index is exactly -1
-        index = static_cast<int> (buffer.size()) - 1; // so let's take care of that
+        index = bufferSize - 1; // so let's take care of that
 
     /*
      This time we only need to check `delayInSamples` many samples.
@@ -161,7 +267,8 @@ void LookAheadGainReduction::process()
         if (smpl > nextGainReductionValue) // in case the sample is above our ramp...
         {
             buffer[index] = nextGainReductionValue; // ... replace it with the current ramp value
-            nextGainReductionValue += step; // and update the next ramp value
+            distance = std::min (distance + 1, delayInSamples);
+            nextGainReductionValue = peak * fade[distance]; // and update the next ramp value
         }
         else // otherwise... JACKPOT! Nothing left to do here!
         {
@@ -174,7 +281,7 @@ void LookAheadGainReduction::process()
     // second run
     if (! breakWasUsed && size2 > 0) // is there still some work to do?
     {
-        index = static_cast<int> (buffer.size()) - 1; // wrap around (ring-buffer)
+        index = bufferSize - 1; // wrap around (ring-buffer)
         for (int i = 0; i < size2; ++i)
         {
             const float smpl = buffer[index];
@@ -183,7 +290,8 @@ void LookAheadGainReduction::process()
             if (smpl > nextGainReductionValue) // in case the sample is above our ramp...
             {
                 buffer[index] = nextGainReductionValue; // ... replace it with the current ramp value
-                nextGainReductionValue += step; // and update the next ramp value
+                distance = std::min (distance + 1, delayInSamples);
+                nextGainReductionValue = peak * fade[distance]; // and update the next ramp value
             }
             else // otherwise... already processed -> byebye!
                 break;
@@ -226,7 +334,7 @@ inline void LookAheadGainReduction::getProcessPositions (int startIndex, int num
 
 inline void LookAheadGainReduction::getWritePositions (int numSamples, int& startIndex, int& blockSize1, int& blockSize2)
 {
-    const int L = static_cast<int> (buffer.size());
+    const int L = bufferSize;
     int pos = writePosition;
 
     if (pos < 0)
@@ -250,7 +358,7 @@ inline void LookAheadGainReduction::getWritePositions (int numSamples, int& star
 
 inline void LookAheadGainReduction::getReadPositions (int numSamples, int& startIndex, int& blockSize1, int& blockSize2)
 {
-    const int L = static_cast<int> (buffer.size());
+    const int L = bufferSize;
     int pos = writePosition - lastPushedSamples - delayInSamples;
 
     if (pos < 0)
@@ -19,23 +19,52 @@
 
 #pragma once
 #include <vector>
+#include <atomic>
+#include <cstddef>
+#include "DspCheckpoint.h"
+
+class MemoryArena;
 
 /** This class acts as a delay line for gain-reduction samples, which additionally fades in high gain-reduction values in order to avoid distortion when limiting an audio signal.
  */
 class LookAheadGainReduction
 {
 public:
+    /** The shape of the fade-in ramp towards a gain-reduction peak. All shapes start at 0 dB and reach the peak value after exactly `delayInSamples` samples.
+     */
+    enum class FadeShape
+    {
+        linear = 0,     // linear in decibels
+        raisedCosine,   // half a cosine period, smooth start and end
+        exponential,    // starts slowly, then speeds up towards the peak
+        sCurve          // 5th-order smoothstep, smoothest start and end
+    };
+    static constexpr int numFadeShapes = 4;
+
     LookAheadGainReduction() : sampleRate (0.0) {}
     ~LookAheadGainReduction() {}
 
     void setDelayTime (float delayTimeInSeconds);
 
+    /** Selects the fade-in shape. Can be called from any thread, as the tables for all shapes are built in prepare().
+     */
+    void setFadeShape (FadeShape newShape) { fadeShape = static_cast<int> (newShape); }
+    FadeShape getFadeShape() const { return static_cast<FadeShape> (fadeShape.load()); }
+
     const int getDelayInSamples() { return delayInSamples; }
 
     /** Prepares the processor so it can resize the buffers depending on samplerate and the expected buffersize.
      */
     void prepare (const double sampleRate, const int blockSize);
 
+    /** Prepares the processor like above, but takes the buffers from the given arena instead of the heap. With an arena, set the delay time before preparing.
+        Returns false if the arena is exhausted; the processor mustn't be used until it was prepared successfully.
+     */
+    bool prepare (const double sampleRate, const int blockSize, MemoryArena& arena);
+
+    /** The number of arena bytes prepare() takes for the given settings. */
+    static size_t getRequiredArenaBytes (const double sampleRate, const int blockSize, const float delayTimeInSeconds);
+
     /** Writes gain-reduction samples into the delay-line. Make sure you call process() afterwards, and read the same amount of samples with the readSamples method. Make also sure the pushed samples are decibel values.
      */
     void pushSamples (const float* src, const int numSamples);
@@ -48,6 +77,15 @@ public:
      */
     void readSamples (float* dest, const int numSamples);
 
+    /** Saves the delay line and its position into the checkpoint, and restores them. Restoring fails if the delay line was prepared for a different size.
+     */
+    void saveState (DspCheckpoint& checkpoint) const;
+    bool restoreState (DspCheckpoint::Reader& reader);
+
+    /** The fraction of the peak's gain reduction the fade of the given shape reaches at x, which runs from 0 (start of the fade) to 1 (at the peak).
+     */
+    static float getFadeValue (const FadeShape shape, const double x);
+
 
 private:
     /** A little helper-function which calulcates how many samples we should process in a first step before we have to wrap around, as our buffer is a ring-buffer.
@@ -58,6 +96,14 @@ private:
 
     inline void getReadPositions (int numSamples, int& startIndex, int& blockSize1, int& blockSize2);
 
+    /** Fills the fade tables, one per shape, each with delayInSamples + 1 entries. Entry k holds the fraction of the peak's gain reduction k samples before the peak.
+     */
+    void buildFadeTables();
+
+    /** Sets the sizes for the current settings, the pointers into the memory have to be set afterwards. */
+    void computeSizes (const double newSampleRate, const int newBlockSize);
+    void clearBuffers();
+
 
 private:
     //==============================================================================
@@ -68,5 +114,13 @@ private:
     int delayInSamples = 0;
     int writePosition = 0;
     int lastPushedSamples = 0;
-    std::vector<float> buffer;
+
+    // the delay line and the fade tables either live in ownMemory or in an arena
+    float* buffer = nullptr;
+    int bufferSize = 0;
+    float* fadeTables = nullptr;
+    std::vector<float> ownMemory;
+    bool usesArena = false;
+
+    std::atomic<int> fadeShape { static_cast<int> (FadeShape::linear) };
 };
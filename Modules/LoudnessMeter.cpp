@@ -0,0 +1,232 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.cpp
+
+  ==============================================================================
+*/
+
+#include "LoudnessMeter.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+}
+
+MultiChannelBiquad::Coefficients LoudnessMeter::makeKWeightingShelf (const double sampleRate)
+{
+    // stage 1 of the BS.1770 pre-filter (head related high shelf), re-derived for any sample rate
+    const double f0 = 1681.974450955533;
+    const double G = 3.999843853973347;
+    const double Q = 0.7071752369554196;
+
+    const double K = std::tan (pi * f0 / sampleRate);
+    const double Vh = std::pow (10.0, G / 20.0);
+    const double Vb = std::pow (Vh, 0.4996667741545416);
+    const double a0 = 1.0 + K / Q + K * K;
+
+    MultiChannelBiquad::Coefficients c;
+    c.b0 = static_cast<float> ((Vh + Vb * K / Q + K * K) / a0);
+    c.b1 = static_cast<float> (2.0 * (K * K - Vh) / a0);
+    c.b2 = static_cast<float> ((Vh - Vb * K / Q + K * K) / a0);
+    c.a1 = static_cast<float> (2.0 * (K * K - 1.0) / a0);
+    c.a2 = static_cast<float> ((1.0 - K / Q + K * K) / a0);
+    return c;
+}
+
+MultiChannelBiquad::Coefficients LoudnessMeter::makeKWeightingHighPass (const double sampleRate)
+{
+    // stage 2 of the BS.1770 pre-filter (RLB high pass)
+    const double f0 = 38.13547087602444;
+    const double Q = 0.5003270373238773;
+
+    const double K = std::tan (pi * f0 / sampleRate);
+    const double a0 = 1.0 + K / Q + K * K;
+
+    MultiChannelBiquad::Coefficients c;
+    c.b0 = 1.0f;
+    c.b1 = -2.0f;
+    c.b2 = 1.0f;
+    c.a1 = static_cast<float> (2.0 * (K * K - 1.0) / a0);
+    c.a2 = static_cast<float> ((1.0 - K / Q + K * K) / a0);
+    return c;
+}
+
+void LoudnessMeter::prepare (const double newSampleRate, const int numChannels, const std::vector<float>& channelWeights)
+{
+    sampleRate = newSampleRate;
+    samplesPerStep = std::max (1, static_cast<int> (std::round (0.1 * sampleRate)));
+
+    const int numGroups = (std::max (1, numChannels) + MultiChannelBiquad::lanes - 1) / MultiChannelBiquad::lanes;
+    filters.resize (numGroups);
+
+    const auto shelf = makeKWeightingShelf (sampleRate);
+    const auto highPass = makeKWeightingHighPass (sampleRate);
+    for (size_t g = 0; g < filters.size(); ++g)
+    {
+        auto& group = filters[g];
+        group.shelf.setCoefficients (shelf);
+        group.highPass.setCoefficients (highPass);
+
+        for (int l = 0; l < MultiChannelBiquad::lanes; ++l)
+        {
+            const size_t channel = g * MultiChannelBiquad::lanes + static_cast<size_t> (l);
+            group.weights[l] = channel < channelWeights.size() ? channelWeights[channel] : 1.0f;
+        }
+    }
+
+    for (int b = 0; b < numBins; ++b)
+        binEnergies[b] = loudnessToEnergy (histogramMinimum + (b + 0.5) / binsPerLU);
+
+    reset();
+}
+
+void LoudnessMeter::reset()
+{
+    for (auto& group : filters)
+    {
+        group.shelf.reset();
+        group.highPass.reset();
+    }
+
+    stepEnergy = 0.0;
+    stepSamples = 0;
+    stepRing.fill (0.0);
+    stepRingPosition = 0;
+    numStepsCollected = 0;
+    histogram.fill (0);
+
+    momentaryLoudness = -std::numeric_limits<float>::infinity();
+    shortTermLoudness = -std::numeric_limits<float>::infinity();
+    integratedLoudness = -std::numeric_limits<float>::infinity();
+}
+
+void LoudnessMeter::process (const float* const* channels, const int numChannels, const int numSamples)
+{
+    if (samplesPerStep == 0)
+        return;
+
+    constexpr int lanes = MultiChannelBiquad::lanes;
+    const int numGroups = std::min (static_cast<int> (filters.size()), (numChannels + lanes - 1) / lanes);
+
+    int i = 0;
+    while (i < numSamples)
+    {
+        // process up to the end of the current 100 ms step
+        const int end = std::min (numSamples, i + samplesPerStep - stepSamples);
+        double energy = 0.0;
+
+        for (int g = 0; g < numGroups; ++g)
+        {
+            const int firstChannel = g * lanes;
+            const int groupChannels = std::min (lanes, numChannels - firstChannel);
+            auto& group = filters[g];
+
+            alignas (16) float x[lanes] = {};
+            alignas (16) float sum[lanes] = {};
+
+            for (int n = i; n < end; ++n)
+            {
+                for (int l = 0; l < groupChannels; ++l)
+                    x[l] = channels[firstChannel + l][n];
+
+                group.shelf.processLanes (x);
+                group.highPass.processLanes (x);
+
+                for (int l = 0; l < lanes; ++l)
+                    sum[l] += x[l] * x[l];
+            }
+
+            for (int l = 0; l < groupChannels; ++l)
+                energy += group.weights[l] * sum[l];
+        }
+
+        stepEnergy += energy;
+        stepSamples += end - i;
+        i = end;
+
+        if (stepSamples >= samplesPerStep)
+            finishStep();
+    }
+}
+
+void LoudnessMeter::finishStep()
+{
+    stepRing[stepRingPosition] = stepEnergy / stepSamples;
+    stepRingPosition = (stepRingPosition + 1) % stepsPerShortTerm;
+    numStepsCollected = std::min (numStepsCollected + 1, stepsPerShortTerm);
+
+    stepEnergy = 0.0;
+    stepSamples = 0;
+
+    auto meanOfLastSteps = [this] (const int numSteps)
+    {
+        double sum = 0.0;
+        for (int s = 1; s <= numSteps; ++s)
+            sum += stepRing[(stepRingPosition - s + stepsPerShortTerm) % stepsPerShortTerm];
+        return sum / numSteps;
+    };
+
+    if (numStepsCollected >= stepsPerMomentary)
+    {
+        const float momentary = energyToLoudness (meanOfLastSteps (stepsPerMomentary));
+        momentaryLoudness.store (momentary, std::memory_order_relaxed);
+
+        // every 100 ms a new 400 ms gating block (75 % overlap) is complete
+        if (momentary >= histogramMinimum)
+        {
+            const int bin = std::min (numBins - 1, static_cast<int> ((momentary - histogramMinimum) * binsPerLU));
+            ++histogram[bin];
+            updateIntegratedLoudness();
+        }
+    }
+
+    if (numStepsCollected >= stepsPerShortTerm)
+        shortTermLoudness.store (energyToLoudness (meanOfLastSteps (stepsPerShortTerm)), std::memory_order_relaxed);
+}
+
+void LoudnessMeter::updateIntegratedLoudness()
+{
+    // absolute gate: all counted blocks are above -70 LUFS
+    double energy = 0.0;
+    uint64_t count = 0;
+    for (int b = 0; b < numBins; ++b)
+    {
+        energy += histogram[b] * binEnergies[b];
+        count += histogram[b];
+    }
+
+    if (count == 0)
+        return;
+
+    // relative gate 10 LU below the absolute-gated loudness
+    const double relativeGate = energyToLoudness (energy / count) - 10.0;
+    const int firstBin = std::max (0, static_cast<int> (std::ceil ((relativeGate - histogramMinimum) * binsPerLU - 0.5)));
+
+    energy = 0.0;
+    count = 0;
+    for (int b = firstBin; b < numBins; ++b)
+    {
+        energy += histogram[b] * binEnergies[b];
+        count += histogram[b];
+    }
+
+    if (count > 0)
+        integratedLoudness.store (energyToLoudness (energy / count), std::memory_order_relaxed);
+}
+
+float LoudnessMeter::energyToLoudness (const double meanSquare)
+{
+    if (meanSquare <= 0.0)
+        return -std::numeric_limits<float>::infinity();
+
+    return static_cast<float> (-0.691 + 10.0 * std::log10 (meanSquare));
+}
+
+double LoudnessMeter::loudnessToEnergy (const double loudness)
+{
+    return std::pow (10.0, (loudness + 0.691) / 10.0);
+}
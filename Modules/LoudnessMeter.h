@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.h
+
+    Streaming ITU-R BS.1770 / EBU R128 loudness measurement.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "MultiChannelBiquad.h"
+
+/**
+ Measures momentary (400 ms), short-term (3 s) and gated integrated loudness according to ITU-R BS.1770-4 while the audio streams through.
+
+ The K-weighting pre-filter runs as two MultiChannelBiquad stages, which filter up to four channels at once. The mean square is accumulated in 100 ms steps; momentary and short-term loudness are computed from a ring of the last 30 steps. For the integrated loudness, each 400 ms gating block is only counted in a histogram with 0.1 LU bins, so the memory stays constant no matter how long the program is, at a resolution error below 0.05 LU.
+
+ Each channel's mean square is weighted before the channels are summed, as BS.1770 specifies for surround formats: 1.41 for the surround channels at the sides, 0 to leave out the LFE, 1.0 for everything else.
+
+ process() has to be called on the audio thread, the getters can be called from any thread. All values are in LUFS, -infinity while there is nothing to report yet.
+ */
+class LoudnessMeter
+{
+public:
+    LoudnessMeter() { reset(); }
+
+    /** Prepares the filters for the given sample rate and channel count, and resets the measurement. channelWeights holds the weight of every channel; channels it doesn't cover have a weight of 1.0. */
+    void prepare (const double sampleRate, const int numChannels, const std::vector<float>& channelWeights = {});
+
+    /** Resets all measurements, including the integrated loudness. */
+    void reset();
+
+    /** Measures the given channels. */
+    void process (const float* const* channels, const int numChannels, const int numSamples);
+
+    float getMomentaryLoudness() const { return momentaryLoudness.load (std::memory_order_relaxed); }
+    float getShortTermLoudness() const { return shortTermLoudness.load (std::memory_order_relaxed); }
+    float getIntegratedLoudness() const { return integratedLoudness.load (std::memory_order_relaxed); }
+
+    static MultiChannelBiquad::Coefficients makeKWeightingShelf (const double sampleRate);
+    static MultiChannelBiquad::Coefficients makeKWeightingHighPass (const double sampleRate);
+
+    /** The BS.1770 weight of the left and right surround channels. */
+    static constexpr float surroundChannelWeight = 1.41f;
+
+private:
+    void finishStep();
+    void updateIntegratedLoudness();
+
+    static float energyToLoudness (const double meanSquare);
+    static double loudnessToEnergy (const double loudness);
+
+    static constexpr int stepsPerMomentary = 4;   // 4 x 100 ms
+    static constexpr int stepsPerShortTerm = 30;  // 30 x 100 ms
+
+    static constexpr float histogramMinimum = -70.0f; // absolute gate
+    static constexpr float histogramMaximum = 10.0f;
+    static constexpr int binsPerLU = 10;
+    static constexpr int numBins = static_cast<int> (histogramMaximum - histogramMinimum) * binsPerLU;
+
+    double sampleRate = 0.0;
+    int samplesPerStep = 0;
+
+    struct FilterGroup
+    {
+        MultiChannelBiquad shelf, highPass;
+        float weights[MultiChannelBiquad::lanes];
+    };
+    std::vector<FilterGroup> filters;
+
+    // the energy each histogram bin stands for, at its centre
+    std::array<double, numBins> binEnergies {};
+
+    // the 100 ms step currently being accumulated
+    double stepEnergy = 0.0;
+    int stepSamples = 0;
+
+    // ring of the last mean squares of complete 100 ms steps
+    std::array<double, stepsPerShortTerm> stepRing {};
+    int stepRingPosition = 0;
+    int numStepsCollected = 0;
+
+    std::array<uint32_t, numBins> histogram {};
+
+    std::atomic<float> momentaryLoudness;
+    std::atomic<float> shortTermLoudness;
+    std::atomic<float> integratedLoudness;
+};
@@ -0,0 +1,36 @@
+/*
+  ==============================================================================
+
+    MemoryArena.cpp
+
+  ==============================================================================
+*/
+
+#include "MemoryArena.h"
+#include <new>
+
+bool MemoryArena::reserve (const size_t numBytes)
+{
+    numBytesUsed = 0;
+
+    if (numBytes <= capacity)
+        return true;
+
+    release();
+    memory = static_cast<char*> (::operator new (numBytes, std::align_val_t (alignment), std::nothrow));
+    if (memory == nullptr)
+        return false;
+
+    capacity = numBytes;
+    return true;
+}
+
+void MemoryArena::release()
+{
+    if (memory != nullptr)
+        ::operator delete (memory, std::align_val_t (alignment));
+
+    memory = nullptr;
+    capacity = 0;
+    numBytesUsed = 0;
+}
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    MemoryArena.h
+
+    One 64-byte aligned block of memory, handed out by bumping a pointer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+/**
+ Holds all the DSP memory of one instance in a single allocation. reserve() allocates the block, allocate() hands out zeroed, 64-byte aligned pieces of it, and clear() takes them all back without freeing anything. So a re-prepare which fits into the reserved size doesn't touch the heap at all, and all buffers of an instance sit next to each other.
+
+ getRequiredBytes() helps to sum up the size beforehand, including the alignment padding.
+ */
+class MemoryArena
+{
+public:
+    static constexpr size_t alignment = 64;
+
+    MemoryArena() {}
+    ~MemoryArena() { release(); }
+
+    MemoryArena (const MemoryArena&) = delete;
+    MemoryArena& operator= (const MemoryArena&) = delete;
+
+    /** Makes sure the arena holds at least numBytes, and takes back all allocations. Only allocates if the arena has to grow.
+        Returns false, and leaves the arena empty, if that allocation fails.
+     */
+    bool reserve (const size_t numBytes);
+
+    /** Takes back all allocations, keeps the memory. */
+    void clear() { numBytesUsed = 0; }
+
+    /** Frees the memory. */
+    void release();
+
+    /** Returns zeroed memory for numElements objects of type T, aligned to 64 bytes, or nullptr if the arena is exhausted. */
+    template <typename T>
+    T* allocate (const size_t numElements)
+    {
+        const size_t numBytes = getRequiredBytes<T> (numElements);
+        if (numBytesUsed + numBytes > capacity)
+            return nullptr;
+
+        char* result = memory + numBytesUsed;
+        numBytesUsed += numBytes;
+
+        std::memset (result, 0, numBytes);
+        return reinterpret_cast<T*> (result);
+    }
+
+    /** The number of bytes allocate<T> (numElements) takes from the arena. */
+    template <typename T>
+    static constexpr size_t getRequiredBytes (const size_t numElements)
+    {
+        return (numElements * sizeof (T) + alignment - 1) / alignment * alignment;
+    }
+
+    size_t getCapacity() const { return capacity; }
+    size_t getNumBytesUsed() const { return numBytesUsed; }
+
+private:
+    char* memory = nullptr;
+    size_t capacity = 0;
+    size_t numBytesUsed = 0;
+};
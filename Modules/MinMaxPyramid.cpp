@@ -0,0 +1,168 @@
+/*
+  ==============================================================================
+
+    MinMaxPyramid.cpp
+
+  ==============================================================================
+*/
+
+#include "MinMaxPyramid.h"
+#include <algorithm>
+#include <thread>
+
+void MinMaxPyramid::prepare (const int newSamplesPerBin, const int newBinsPerLevel, const int64_t lengthInSamples)
+{
+    if (numLevels > 0 && newSamplesPerBin == samplesPerBin && newBinsPerLevel == binsPerLevel && lengthInSamples == preparedLength)
+        return;
+
+    // readers which come in from now on find nothing, the ones already inside have to leave before anything changes
+    preparing = true;
+    while (numReaders.load() > 0)
+        std::this_thread::yield();
+
+    samplesPerBin = std::max (1, newSamplesPerBin);
+    binsPerLevel = std::max (1, newBinsPerLevel);
+    preparedLength = lengthInSamples;
+
+    numLevels = 1;
+    while (numLevels < maxNumLevels && getLengthInSamples() < lengthInSamples)
+        ++numLevels;
+
+    bins.assign (static_cast<size_t> (numLevels) * static_cast<size_t> (binsPerLevel), Range());
+
+    openBins.fill (Range());
+    openCounts.fill (0);
+
+    for (int level = 0; level < maxNumLevels; ++level)
+    {
+        numBinsReserved[static_cast<size_t> (level)] = 0;
+        numBinsWritten[static_cast<size_t> (level)] = 0;
+    }
+
+    preparing = false;
+}
+
+int64_t MinMaxPyramid::getLengthInSamples() const
+{
+    const int levels = numLevels.load (std::memory_order_relaxed);
+    return levels > 0 ? static_cast<int64_t> (binsPerLevel.load (std::memory_order_relaxed)) * getBinSize (levels - 1) : 0;
+}
+
+void MinMaxPyramid::push (const float value, const int numSamples)
+{
+    const int binSize = samplesPerBin.load (std::memory_order_relaxed);
+    if (binSize == 0)
+        return;
+
+    Range range;
+    range.minimum = value;
+    range.maximum = value;
+
+    // a value can fill the rest of the open bin and more
+    for (int64_t remaining = numSamples; remaining > 0;)
+    {
+        const int64_t numToAdd = std::min<int64_t> (remaining, binSize - openCounts[0]);
+        openBins[0].merge (range);
+        openCounts[0] += numToAdd;
+        remaining -= numToAdd;
+
+        if (openCounts[0] == binSize)
+        {
+            completeBin (openBins[0]);
+            openBins[0] = Range();
+            openCounts[0] = 0;
+        }
+    }
+}
+
+void MinMaxPyramid::completeBin (Range range)
+{
+    const auto ringSize = static_cast<size_t> (binsPerLevel.load (std::memory_order_relaxed));
+    const auto levels = static_cast<size_t> (numLevels.load (std::memory_order_relaxed));
+
+    // every second bin completes one on the level above, so this runs through two levels per bin on average
+    for (size_t level = 0;; ++level)
+    {
+        const int64_t index = numBinsWritten[level].load (std::memory_order_relaxed);
+
+        // tell readers which bin is about to change, before changing it
+        numBinsReserved[level].store (index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+
+        bins[level * ringSize + static_cast<size_t> (index) % ringSize] = range;
+        numBinsWritten[level].store (index + 1, std::memory_order_release);
+
+        if (level + 1 == levels)
+            return;
+
+        openBins[level + 1].merge (range);
+        if (++openCounts[level + 1] < 2)
+            return;
+
+        range = openBins[level + 1];
+        openBins[level + 1] = Range();
+        openCounts[level + 1] = 0;
+    }
+}
+
+int MinMaxPyramid::getLevelFor (const int64_t samplesPerRange) const
+{
+    const int levels = numLevels.load (std::memory_order_relaxed);
+
+    int level = 0;
+    while (level + 1 < levels && getBinSize (level + 1) <= samplesPerRange)
+        ++level;
+
+    return level;
+}
+
+bool MinMaxPyramid::getRange (const int64_t startSample, const int64_t endSample, Range& range) const
+{
+    const ScopedReader reader (*this);
+    const int levels = numLevels.load (std::memory_order_relaxed);
+    const int64_t ringSize = binsPerLevel.load (std::memory_order_relaxed);
+
+    if (! reader.isValid() || levels == 0 || endSample <= startSample || endSample <= 0)
+        return false;
+
+    for (int level = getLevelFor (endSample - startSample); level < levels; ++level)
+    {
+        const int64_t binSize = getBinSize (level);
+        const int64_t numWritten = numBinsWritten[static_cast<size_t> (level)].load (std::memory_order_acquire);
+
+        const int64_t first = std::max<int64_t> (0, startSample / binSize);
+        const int64_t last = (endSample + binSize - 1) / binSize;
+
+        // the coarser levels are even further behind
+        if (last > numWritten)
+            return false;
+
+        if (first < numWritten - ringSize)
+            continue;
+
+        const Range* ring = bins.data() + static_cast<size_t> (level * ringSize);
+        Range result;
+        for (int64_t b = first; b < last; ++b)
+            result.merge (ring[b % ringSize]);
+
+        // whatever the writer started to overwrite while we were reading is lost
+        std::atomic_thread_fence (std::memory_order_acquire);
+        if (first < numBinsReserved[static_cast<size_t> (level)].load (std::memory_order_relaxed) - ringSize)
+            continue;
+
+        range = result;
+        return true;
+    }
+
+    return false;
+}
+
+int64_t MinMaxPyramid::getNumSamples (const int64_t samplesPerRange) const
+{
+    const ScopedReader reader (*this);
+    if (! reader.isValid() || numLevels.load (std::memory_order_relaxed) == 0)
+        return 0;
+
+    const int level = getLevelFor (samplesPerRange);
+    return numBinsWritten[static_cast<size_t> (level)].load (std::memory_order_acquire) * getBinSize (level);
+}
@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    MinMaxPyramid.h
+
+    Minimum and maximum of a meter value over minutes, at every zoom level.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <vector>
+#include <cstdint>
+
+/**
+ The history of a meter value, e.g. the input level or the gain reduction, as a mipmap of minimum/maximum pairs, the way waveform editors keep their overviews. Level 0 holds one bin per samplesPerBin samples, every level above merges two bins of the one below. So a display column of any width is covered by at most three bins of the level whose bins are just narrower than the column, and drawing it costs the same at every zoom; only columns wider than two bins of the coarsest level merge more.
+
+ Each level is a ring of the same number of bins. The finer levels forget sooner: they keep seconds, the coarsest one keeps the whole length passed to prepare(). Where a fine level has already been overwritten, getRange() takes the next coarser one which still holds the range, so old history gets blurrier instead of disappearing.
+
+ push() runs on the thread which processes the audio: it merges the value into the bins which are still open, and publishes every bin it completes with two atomic counters, the same way FlightRecorder does; it never waits and never allocates. getRange() can be called from any other thread at the same time. Bins which are still open aren't visible, so the coarser levels lag behind by up to one of their bins.
+
+ A host may prepare the processor again on any thread while its editor is drawing. prepare() marks the pyramid as being prepared and waits until the readers inside getRange() or getNumSamples() have left before it touches the bins; readers which arrive meanwhile find nothing.
+ */
+class MinMaxPyramid
+{
+public:
+    static constexpr int maxNumLevels = 32;
+
+    struct Range
+    {
+        float minimum = std::numeric_limits<float>::infinity();
+        float maximum = -std::numeric_limits<float>::infinity();
+
+        bool isEmpty() const { return minimum > maximum; }
+
+        void merge (const Range& other)
+        {
+            if (other.minimum < minimum) minimum = other.minimum;
+            if (other.maximum > maximum) maximum = other.maximum;
+        }
+    };
+
+    MinMaxPyramid() {}
+
+    /** Allocates as many levels of binsPerLevel bins as it takes for the coarsest one to cover lengthInSamples, and forgets the history. Preparing it again with the same arguments keeps the history. Not for the audio thread, and not while push() runs. */
+    void prepare (const int samplesPerBin, const int binsPerLevel, const int64_t lengthInSamples);
+
+    /** Adds the value measured over the next numSamples samples. For the thread which processes the audio. */
+    void push (const float value, const int numSamples);
+
+    /** The minimum and maximum over [startSample, endSample), taken from the finest level whose bins aren't wider than the range and which still holds all of it. Bins which only overlap the range are counted as a whole. Returns false if no level holds the range completely any more, or not yet. */
+    bool getRange (const int64_t startSample, const int64_t endSample, Range& range) const;
+
+    /** How far the level which getRange() uses for ranges of this many samples reaches, i.e. where a display at that resolution ends. */
+    int64_t getNumSamples (const int64_t samplesPerRange) const;
+
+    int getSamplesPerBin() const { return samplesPerBin.load (std::memory_order_relaxed); }
+    int getNumLevels() const { return numLevels.load (std::memory_order_relaxed); }
+
+    /** How many samples the coarsest level covers. */
+    int64_t getLengthInSamples() const;
+
+private:
+    /** Counts a reader in for as long as it exists; isValid() is false while prepare() runs. */
+    class ScopedReader
+    {
+    public:
+        explicit ScopedReader (const MinMaxPyramid& pyramidToRead) : pyramid (pyramidToRead)
+        {
+            ++pyramid.numReaders;
+            valid = ! pyramid.preparing.load();
+        }
+
+        ~ScopedReader() { --pyramid.numReaders; }
+
+        bool isValid() const { return valid; }
+
+    private:
+        const MinMaxPyramid& pyramid;
+        bool valid;
+    };
+
+    int64_t getBinSize (const int level) const { return static_cast<int64_t> (samplesPerBin.load (std::memory_order_relaxed)) << level; }
+    int getLevelFor (const int64_t samplesPerRange) const;
+    void completeBin (Range range);
+
+    // changed by prepare() only, while no reader is inside
+    std::atomic<int> samplesPerBin { 0 };
+    std::atomic<int> binsPerLevel { 0 };
+    std::atomic<int> numLevels { 0 };
+    int64_t preparedLength = 0;
+
+    std::atomic<bool> preparing { false };
+    mutable std::atomic<int> numReaders { 0 };
+
+    std::vector<Range> bins; // numLevels rings of binsPerLevel bins each
+
+    // the bins still being filled, and how many bins (samples on level 0) went into them so far; push() only
+    std::array<Range, maxNumLevels> openBins;
+    std::array<int64_t, maxNumLevels> openCounts {};
+
+    // per level, everything before the written count is complete, everything up to the reserved count may be changing right now
+    std::array<std::atomic<int64_t>, maxNumLevels> numBinsReserved {};
+    std::array<std::atomic<int64_t>, maxNumLevels> numBinsWritten {};
+};
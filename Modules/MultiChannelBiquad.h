@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    MultiChannelBiquad.h
+
+    A transposed direct form II biquad filtering several channels at once.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "DspCheckpoint.h"
+
+/**
+ A transposed direct form II biquad which filters up to `lanes` channels in parallel. The states of all channels are stored next to each other, so each update is a handful of element-wise operations on `lanes` floats, which the compiler maps onto a single SIMD register. Unused lanes simply filter zeros.
+ */
+class MultiChannelBiquad
+{
+public:
+    static constexpr int lanes = 4;
+
+    struct Coefficients
+    {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+    };
+
+    MultiChannelBiquad() {}
+
+    void setCoefficients (const Coefficients& newCoefficients) { c = newCoefficients; }
+    const Coefficients& getCoefficients() const { return c; }
+
+    /** Clears the filter states of all lanes. */
+    void reset()
+    {
+        for (int l = 0; l < lanes; ++l)
+            z1[l] = z2[l] = 0.0f;
+    }
+
+    /** Saves the filter states of all lanes into the checkpoint, and restores them. */
+    void saveState (DspCheckpoint& checkpoint) const
+    {
+        checkpoint.write (z1, lanes);
+        checkpoint.write (z2, lanes);
+    }
+
+    bool restoreState (DspCheckpoint::Reader& reader) { return reader.read (z1, lanes) && reader.read (z2, lanes); }
+
+    /** Filters one sample of every lane in place. */
+    inline void processLanes (float (&x)[lanes])
+    {
+        for (int l = 0; l < lanes; ++l)
+        {
+            const float in = x[l];
+            const float out = c.b0 * in + z1[l];
+            z1[l] = c.b1 * in - c.a1 * out + z2[l];
+            z2[l] = c.b2 * in - c.a2 * out;
+            x[l] = out;
+        }
+    }
+
+    /** Filters numFrames frames of `lanes` samples in place. The state and the coefficients are kept in locals meanwhile, so the compiler can hold them in registers instead of reloading them after every store.
+     */
+    void processFrames (float (*frames)[lanes], const int numFrames)
+    {
+        const float b0 = c.b0, b1 = c.b1, b2 = c.b2, a1 = c.a1, a2 = c.a2;
+
+        alignas (16) float s1[lanes], s2[lanes];
+        for (int l = 0; l < lanes; ++l)
+        {
+            s1[l] = z1[l];
+            s2[l] = z2[l];
+        }
+
+        for (int n = 0; n < numFrames; ++n)
+        {
+            for (int l = 0; l < lanes; ++l)
+            {
+                const float in = frames[n][l];
+                const float out = b0 * in + s1[l];
+                s1[l] = b1 * in - a1 * out + s2[l];
+                s2[l] = b2 * in - a2 * out;
+                frames[n][l] = out;
+            }
+        }
+
+        for (int l = 0; l < lanes; ++l)
+        {
+            z1[l] = s1[l];
+            z2[l] = s2[l];
+        }
+    }
+
+    /** Filters numFrames frames through this filter and then through next, in place. Both filters run in the same pass, so the out-of-order core overlaps their feedback loops; that is about a third faster than two passes.
+     */
+    void processFramesCascaded (MultiChannelBiquad& next, float (*frames)[lanes], const int numFrames)
+    {
+        const Coefficients c1 = c, c2 = next.c;
+
+        alignas (16) float s1[lanes], s2[lanes], t1[lanes], t2[lanes];
+        for (int l = 0; l < lanes; ++l)
+        {
+            s1[l] = z1[l];
+            s2[l] = z2[l];
+            t1[l] = next.z1[l];
+            t2[l] = next.z2[l];
+        }
+
+        for (int n = 0; n < numFrames; ++n)
+        {
+            for (int l = 0; l < lanes; ++l)
+            {
+                const float in = frames[n][l];
+                const float mid = c1.b0 * in + s1[l];
+                s1[l] = c1.b1 * in - c1.a1 * mid + s2[l];
+                s2[l] = c1.b2 * in - c1.a2 * mid;
+
+                const float out = c2.b0 * mid + t1[l];
+                t1[l] = c2.b1 * mid - c2.a1 * out + t2[l];
+                t2[l] = c2.b2 * mid - c2.a2 * out;
+                frames[n][l] = out;
+            }
+        }
+
+        for (int l = 0; l < lanes; ++l)
+        {
+            z1[l] = s1[l];
+            z2[l] = s2[l];
+            next.z1[l] = t1[l];
+            next.z2[l] = t2[l];
+        }
+    }
+
+    /** Filters numChannels (at most `lanes`) channels from src into dest, which may point to the same memory.
+     */
+    void process (const float* const* src, float* const* dest, const int numChannels, const int numSamples)
+    {
+        alignas (16) float x[lanes] = {};
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int l = 0; l < numChannels; ++l)
+                x[l] = src[l][i];
+
+            processLanes (x);
+
+            for (int l = 0; l < numChannels; ++l)
+                dest[l][i] = x[l];
+        }
+    }
+
+private:
+    Coefficients c;
+    alignas (16) float z1[lanes] = {};
+    alignas (16) float z2[lanes] = {};
+};
@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+    NoiseShapingDither.cpp
+
+  ==============================================================================
+*/
+
+#include "NoiseShapingDither.h"
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+    // error-feedback coefficients, the noise transfer function is 1 - sum (h[k] z^-(k + 1))
+    constexpr float shapeCoefficients[][NoiseShapingDither::maxNumTaps] =
+    {
+        { 0.0f,   0.0f,    0.0f,   0.0f,    0.0f },
+        { 1.0f,   0.0f,    0.0f,   0.0f,    0.0f },
+        { 1.623f, -0.982f, 0.109f, 0.0f,    0.0f },
+        { 2.033f, -2.165f, 1.959f, -1.590f, 0.6149f }
+    };
+
+    // rounds to the nearest integer with an inline conversion instead of a library call, the values fit into 32 bits for every word length
+    inline float roundToInteger (const float x)
+    {
+        return static_cast<float> (static_cast<int32_t> (x + (x < 0.0f ? -0.5f : 0.5f)));
+    }
+
+    // splitmix32, turns seed and channel into well-spread generator states
+    uint32_t mix (uint32_t x)
+    {
+        x += 0x9e3779b9u;
+        x = (x ^ (x >> 16)) * 0x85ebca6bu;
+        x = (x ^ (x >> 13)) * 0xc2b2ae35u;
+        return x ^ (x >> 16);
+    }
+}
+
+void NoiseShapingDither::prepare (const int maximumBlockSize, const int numChannels)
+{
+    states.resize (static_cast<size_t> (std::max (1, numChannels)));
+
+    // two uniform values per sample, plus the spare values and the rounding up to whole rounds of the lanes
+    const int numValues = 2 * maximumBlockSize + 2 * numLanes;
+    for (auto& state : states)
+        state.noise.assign (static_cast<size_t> (numValues), 0.0f);
+
+    reset();
+}
+
+void NoiseShapingDither::reset()
+{
+    for (size_t ch = 0; ch < states.size(); ++ch)
+    {
+        auto& state = states[ch];
+        std::fill (std::begin (state.error), std::end (state.error), 0.0f);
+        state.numSpare = 0;
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const uint32_t value = mix (seed ^ mix (static_cast<uint32_t> (ch * numLanes + lane)));
+            state.lanes[lane] = value != 0 ? value : 1; // xorshift must not start at zero
+        }
+    }
+}
+
+void NoiseShapingDither::saveState (DspCheckpoint& checkpoint) const
+{
+    // the noise buffers are refilled for every block, they're not part of the state
+    checkpoint.write (states.size());
+    for (const auto& state : states)
+    {
+        checkpoint.write (state.lanes, numLanes);
+        checkpoint.write (state.error, maxNumTaps);
+        checkpoint.write (state.spare, numLanes);
+        checkpoint.write (state.numSpare);
+    }
+}
+
+bool NoiseShapingDither::restoreState (DspCheckpoint::Reader& reader)
+{
+    size_t numStates = 0;
+    if (! reader.read (numStates) || numStates != states.size())
+        return false;
+
+    for (auto& state : states)
+        if (! (reader.read (state.lanes, numLanes) && reader.read (state.error, maxNumTaps)
+               && reader.read (state.spare, numLanes) && reader.read (state.numSpare)))
+            return false;
+
+    return true;
+}
+
+void NoiseShapingDither::generateNoise (ChannelState& state, const int numSamples)
+{
+    float* noise = state.noise.data();
+    const int numNeeded = 2 * numSamples;
+
+    // start with the values left over from the previous block
+    std::copy (state.spare, state.spare + state.numSpare, noise);
+    const int numRounds = (std::max (0, numNeeded - state.numSpare) + numLanes - 1) / numLanes;
+    float* dest = noise + state.numSpare;
+
+    for (int round = 0; round < numRounds; ++round)
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            uint32_t x = state.lanes[lane];
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            state.lanes[lane] = x;
+
+            dest[round * numLanes + lane] = static_cast<float> (x >> 8) * (1.0f / 16777216.0f);
+        }
+
+    const int numGenerated = state.numSpare + numRounds * numLanes;
+    state.numSpare = numGenerated - numNeeded;
+    std::copy (noise + numNeeded, noise + numGenerated, state.spare);
+
+    // the difference of two uniform values has a triangular distribution
+    for (int i = 0; i < numSamples; ++i)
+        noise[i] = noise[2 * i] - noise[2 * i + 1];
+}
+
+void NoiseShapingDither::process (float* samples, const int numSamples, const int channel, const int stride)
+{
+    quantize<false> (samples, nullptr, numSamples, channel, stride);
+}
+
+void NoiseShapingDither::processWithGain (float* samples, const float* gain, const int numSamples, const int channel, const int stride)
+{
+    quantize<true> (samples, gain, numSamples, channel, stride);
+}
+
+template <bool withGain>
+void NoiseShapingDither::quantize (float* samples, const float* gain, const int numSamples, const int channel, const int stride)
+{
+    const int bits = bitDepth.load();
+    if (bits <= 0)
+    {
+        if (withGain)
+            for (int i = 0; i < numSamples; ++i)
+                samples[i * stride] *= gain[i];
+        return;
+    }
+
+    auto& state = states[static_cast<size_t> (channel)];
+    generateNoise (state, numSamples);
+
+    const float step = std::ldexp (1.0f, 1 - bits);
+    const float inverseStep = 1.0f / step;
+    const float maxValue = 1.0f - step;
+    const float* noise = state.noise.data();
+    const int shapeIndex = shape.load();
+
+    if (shapeIndex == static_cast<int> (Shape::none))
+    {
+        // no feedback, so this loop has no dependencies between samples and vectorizes
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float x = withGain ? samples[i * stride] * gain[i] : samples[i * stride];
+            const float y = roundToInteger (x * inverseStep + noise[i]) * step;
+            samples[i * stride] = std::min (std::max (y, -1.0f), maxValue);
+        }
+        return;
+    }
+
+    const float* h = shapeCoefficients[shapeIndex];
+    const float h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3], h4 = h[4];
+
+    // keep the error history in registers, the samples could alias it otherwise
+    float e0 = state.error[0], e1 = state.error[1], e2 = state.error[2], e3 = state.error[3], e4 = state.error[4];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float x = withGain ? samples[i * stride] * gain[i] : samples[i * stride];
+
+        // subtract the filtered error of the previous samples
+        const float v = x - (h0 * e0 + h1 * e1 + h2 * e2 + h3 * e3 + h4 * e4);
+        const float q = roundToInteger (v * inverseStep + noise[i]) * step;
+
+        // the error is taken before clipping, so it stays within the dither and rounding: fed back, the clipped amount would
+        // accumulate over a loud passage and come out as a burst of full-scale noise afterwards
+        e4 = e3;
+        e3 = e2;
+        e2 = e1;
+        e1 = e0;
+        e0 = q - v;
+
+        samples[i * stride] = std::min (std::max (q, -1.0f), maxValue);
+    }
+
+    state.error[0] = e0;
+    state.error[1] = e1;
+    state.error[2] = e2;
+    state.error[3] = e3;
+    state.error[4] = e4;
+}
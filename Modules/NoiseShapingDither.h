@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    NoiseShapingDither.h
+
+    TPDF dither with error-feedback noise shaping for 16 and 24 bit output.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include "DspCheckpoint.h"
+
+/**
+ Quantizes the output to the given word length with triangular (TPDF) dither, and optionally shapes the requantization noise with an error-feedback filter, moving it to where the ear is least sensitive.
+
+ The random numbers come from eight interleaved xorshift32 generators per channel, which the compiler vectorizes, so a block of noise costs about as much as a copy. The generators are seeded from the seed and the channel index, so the output is reproducible: the same seed and the same input give bit-identical output, no matter how the input is split into blocks and which thread processes which channel.
+
+ processWithGain() multiplies and dithers in the same pass, so the dither can be fused into the limiter's gain stage.
+ */
+class NoiseShapingDither
+{
+public:
+    enum class Shape
+    {
+        none = 0,
+        firstOrder,
+        wannamaker3, // 3-tap, F-weighted
+        lipshitz5    // 5-tap, E-weighted
+    };
+
+    static constexpr int maxNumTaps = 5;
+
+    NoiseShapingDither() {}
+    ~NoiseShapingDither() {}
+
+    /** Allocates the noise buffers and the state for the given number of channels. */
+    void prepare (const int maximumBlockSize, const int numChannels);
+
+    /** Clears the error feedback and reseeds the generators. */
+    void reset();
+
+    /** Saves the generators and the error feedback of all channels into the checkpoint, and restores them. */
+    void saveState (DspCheckpoint& checkpoint) const;
+    bool restoreState (DspCheckpoint::Reader& reader);
+
+    void setSeed (const uint32_t newSeed) { seed = newSeed; }
+
+    /** Sets the output word length, or 0 to turn dithering off. */
+    void setBitDepth (const int bits) { bitDepth = bits; }
+    bool isEnabled() const { return bitDepth.load() > 0; }
+
+    void setShape (const Shape newShape) { shape = static_cast<int> (newShape); }
+
+    /** Dithers and quantizes the samples of one channel in place. The samples are stride floats apart. */
+    void process (float* samples, const int numSamples, const int channel, const int stride = 1);
+
+    /** Multiplies the samples of one channel with the gain, then dithers and quantizes them, all in one pass. */
+    void processWithGain (float* samples, const float* gain, const int numSamples, const int channel, const int stride = 1);
+
+private:
+    static constexpr int numLanes = 8;
+
+    struct ChannelState
+    {
+        uint32_t lanes[numLanes];
+        float error[maxNumTaps];
+        std::vector<float> noise;
+
+        // uniform values of the last round of the lanes which weren't used yet, so the sequence doesn't depend on the block sizes
+        float spare[numLanes];
+        int numSpare = 0;
+    };
+
+    /** Fills the channel's noise buffer with numSamples TPDF values in [-1, 1]. */
+    void generateNoise (ChannelState& state, const int numSamples);
+
+    template <bool withGain>
+    void quantize (float* samples, const float* gain, const int numSamples, const int channel, const int stride);
+
+    std::atomic<int> bitDepth { 0 };
+    std::atomic<int> shape { static_cast<int> (Shape::none) };
+    uint32_t seed = 0x2545f491;
+
+    std::vector<ChannelState> states;
+};
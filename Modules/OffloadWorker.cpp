@@ -0,0 +1,260 @@
+/*
+  ==============================================================================
+
+    OffloadWorker.cpp
+
+  ==============================================================================
+*/
+
+#include "OffloadWorker.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cassert>
+
+void OffloadWorker::Fifo::prepare (const int newNumChannels, const int newCapacity)
+{
+    numChannels = newNumChannels;
+    capacity = newCapacity;
+    data.assign (static_cast<size_t> (numChannels * capacity), 0.0f);
+    numWritten = 0;
+    numRead = 0;
+}
+
+void OffloadWorker::Fifo::write (const float* const* source, const int numSourceChannels, const int numSamples)
+{
+    const int64_t position = numWritten.load();
+    const int start = static_cast<int> (position % capacity);
+    const int numFirst = std::min (numSamples, capacity - start);
+
+    for (int ch = 0; ch < std::min (numChannels, numSourceChannels); ++ch)
+    {
+        float* channel = data.data() + ch * capacity;
+        std::copy (source[ch], source[ch] + numFirst, channel + start);
+        std::copy (source[ch] + numFirst, source[ch] + numSamples, channel);
+    }
+
+    // publishes the samples to the reading thread
+    numWritten.store (position + numSamples);
+}
+
+void OffloadWorker::Fifo::writeSilence (const int numSamples)
+{
+    const int64_t position = numWritten.load();
+    const int start = static_cast<int> (position % capacity);
+    const int numFirst = std::min (numSamples, capacity - start);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* channel = data.data() + ch * capacity;
+        std::fill (channel + start, channel + start + numFirst, 0.0f);
+        std::fill (channel, channel + numSamples - numFirst, 0.0f);
+    }
+
+    numWritten.store (position + numSamples);
+}
+
+void OffloadWorker::Fifo::read (float* const* destination, const int numDestinationChannels, const int numSamples, const int destinationOffset)
+{
+    const int64_t position = numRead.load();
+    const int start = static_cast<int> (position % capacity);
+    const int numFirst = std::min (numSamples, capacity - start);
+
+    for (int ch = 0; ch < std::min (numChannels, numDestinationChannels); ++ch)
+    {
+        const float* channel = data.data() + ch * capacity;
+        float* target = destination[ch] + destinationOffset;
+        std::copy (channel + start, channel + start + numFirst, target);
+        std::copy (channel, channel + numSamples - numFirst, target + numFirst);
+    }
+
+    // hands the space back to the writing thread
+    numRead.store (position + numSamples);
+}
+
+// ==============================================================================
+void OffloadWorker::start (const int newNumChannels, const int newMaxBlockSize, ProcessFunction function, void* context)
+{
+    stop();
+
+    numChannels = std::max (1, newNumChannels);
+    maxBlockSize = std::max (1, newMaxBlockSize);
+    processFunction = function;
+    processContext = context;
+
+    // The output holds the block of silence, everything in the input and the worker's chunk, and as much again of
+    // late samples still to be dropped, so the worker never has to wait for space.
+    input.prepare (numChannels, fifoSizeInBlocks * maxBlockSize);
+    output.prepare (numChannels, (2 * fifoSizeInBlocks + 2) * maxBlockSize);
+    output.writeSilence (maxBlockSize);
+
+    scratch.assign (static_cast<size_t> (numChannels * maxBlockSize), 0.0f);
+    scratchChannels.resize (static_cast<size_t> (numChannels));
+    for (int ch = 0; ch < numChannels; ++ch)
+        scratchChannels[static_cast<size_t> (ch)] = scratch.data() + ch * maxBlockSize;
+
+    numExchanged = 0;
+    gapIndex = 0;
+    numGaps = 0;
+    gapOffset = 0;
+    numUnderruns = 0;
+
+    shouldExit = false;
+    thread = std::thread ([this] { workerLoop(); });
+    WorkerPool::setRealtimePriority (thread);
+}
+
+void OffloadWorker::stop()
+{
+    if (! thread.joinable())
+        return;
+
+    shouldExit = true;
+    wakeWorker();
+
+    thread.join();
+    sleeping = false;
+}
+
+void OffloadWorker::waitUntilIdle() const
+{
+    if (! thread.joinable())
+        return;
+
+    // all accepted input has come out again, behind the block of silence the output started with
+    while (output.numWritten.load() - maxBlockSize < input.numWritten.load())
+        std::this_thread::yield();
+}
+
+void OffloadWorker::exchange (float* const* channels, const int numChannelsToExchange, const int numSamples)
+{
+    // the output due now belongs to the input of one block ago
+    const int64_t firstDue = numExchanged - maxBlockSize;
+    numExchanged += numSamples;
+
+    // input which doesn't fit any more is lost, its output is replaced by silence once it's due
+    const int64_t inputPosition = input.numWritten.load();
+    const int numAccepted = std::min (numSamples, input.getFreeSpace());
+    input.write (channels, numChannelsToExchange, numAccepted);
+
+    if (numAccepted < numSamples)
+        addGap (inputPosition + numAccepted, numSamples - numAccepted);
+
+    // publish, then wake the sleeper (both sequentially consistent, so a worker going to sleep right now can't miss it)
+    wakeWorker();
+
+    int numReady = output.getNumReady();
+    bool underrun = false;
+
+    for (int i = 0; i < numSamples;)
+    {
+        // the output starts with a block of silence, the rest is the worker's output of the accepted input
+        const int64_t producedPosition = output.numRead.load() - maxBlockSize;
+
+        if (numGaps > 0 && gaps[gapIndex].position <= producedPosition)
+        {
+            gapOffset += gaps[gapIndex].length;
+            gapIndex = (gapIndex + 1) % maxNumGaps;
+            --numGaps;
+            continue;
+        }
+
+        const int64_t streamPosition = producedPosition + gapOffset;
+        const int64_t due = firstDue + i;
+        const int64_t untilGap = numGaps > 0 ? gaps[gapIndex].position - producedPosition : numSamples;
+
+        if (numReady == 0 || streamPosition > due)
+        {
+            // not produced yet, or lost: silence
+            const int numSilent = numReady == 0 ? numSamples - i : static_cast<int> (std::min<int64_t> (streamPosition - due, numSamples - i));
+            for (int ch = 0; ch < numChannelsToExchange; ++ch)
+                std::fill (channels[ch] + i, channels[ch] + i + numSilent, 0.0f);
+
+            underrun = underrun || numReady == 0;
+            i += numSilent;
+        }
+        else if (streamPosition < due)
+        {
+            // arrived too late: drop it
+            const int numLate = static_cast<int> (std::min<int64_t> ({ due - streamPosition, numReady, untilGap }));
+            output.skip (numLate);
+            numReady -= numLate;
+        }
+        else
+        {
+            const int numDelivered = static_cast<int> (std::min<int64_t> ({ numSamples - i, numReady, untilGap }));
+            output.read (channels, numChannelsToExchange, numDelivered, i);
+            numReady -= numDelivered;
+            i += numDelivered;
+        }
+    }
+
+    if (underrun)
+        numUnderruns.fetch_add (1, std::memory_order_relaxed);
+}
+
+void OffloadWorker::addGap (const int64_t position, const int length)
+{
+    const int last = (gapIndex + numGaps - 1) % maxNumGaps;
+
+    // while the worker is stuck, every block is lost at the same position; and if there are too many gaps, they
+    // are merged, which shifts the few samples between them
+    if (numGaps > 0 && (gaps[last].position == position || numGaps == maxNumGaps))
+    {
+        gaps[last].length += length;
+        return;
+    }
+
+    gaps[(gapIndex + numGaps) % maxNumGaps] = { position, length };
+    ++numGaps;
+}
+
+void OffloadWorker::workerLoop()
+{
+    while (! shouldExit.load())
+    {
+        const int numReady = input.getNumReady();
+
+        if (numReady > 0)
+        {
+            const int numSamples = std::min (numReady, maxBlockSize);
+            input.read (scratchChannels.data(), numChannels, numSamples);
+
+            processFunction (processContext, scratchChannels.data(), numChannels, numSamples);
+
+            assert (output.getFreeSpace() >= numSamples);
+            output.write (scratchChannels.data(), numChannels, numSamples);
+            continue;
+        }
+
+        // spin for a short while, the next block usually isn't far away
+        const auto spinEnd = std::chrono::steady_clock::now() + std::chrono::microseconds (spinTimeInMicroseconds);
+        while (input.getNumReady() == 0 && ! shouldExit.load() && std::chrono::steady_clock::now() < spinEnd)
+            std::this_thread::yield();
+
+        if (input.getNumReady() == 0)
+            sleep();
+    }
+}
+
+void OffloadWorker::wakeWorker()
+{
+    if (sleeping.exchange (false))
+        wakeSemaphore.post();
+}
+
+void OffloadWorker::sleep()
+{
+    // flag ourselves first, then check: either we see the new input, or exchange() sees the flag and posts a token
+    sleeping = true;
+
+    if (input.getNumReady() == 0 && ! shouldExit.load())
+    {
+        wakeSemaphore.wait();
+        return;
+    }
+
+    // we don't need to sleep; take the flag back, unless exchange() took it already and owes us a token
+    if (! sleeping.exchange (false))
+        wakeSemaphore.wait();
+}
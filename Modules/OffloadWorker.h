@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    OffloadWorker.h
+
+    Runs the processing on a real-time worker thread, one block behind the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include "WakeSemaphore.h"
+
+/**
+ Moves the processing off the audio thread: exchange() only copies the new input into a lock-free FIFO, wakes the worker and takes the output the worker has finished so far. The worker processes whatever input is waiting, in chunks of up to maxBlockSize samples, and writes the result into a second FIFO, which starts out with maxBlockSize samples of silence. That silence is the price: the output is delayed by one block, and in return the worker has a whole callback period to process a block while the host does its other work.
+
+ If the worker falls behind, exchange() fills the missing output with silence and counts an underrun. The samples which arrive late are dropped afterwards, and input which doesn't fit into the FIFO any more is replaced by silence once it's due, so the latency always stays the same.
+
+ Both FIFOs have a single producer and a single consumer, so neither side ever waits for the other. The worker spins briefly after each chunk before it goes to sleep, like the WorkerPool's threads, and is woken through a WakeSemaphore, so exchange() never takes a lock.
+ */
+class OffloadWorker
+{
+public:
+    using ProcessFunction = void (*) (void* context, float* const* channels, int numChannels, int numSamples);
+
+    OffloadWorker() {}
+    ~OffloadWorker() { stop(); }
+
+    /** Allocates the FIFOs and spawns the worker, which calls function (context, channels, numChannels, numSamples) for every chunk. Stops a running worker first. Not for the audio thread.
+     */
+    void start (const int numChannels, const int maxBlockSize, ProcessFunction function, void* context);
+
+    /** Joins the worker. Afterwards, nothing the process function touches is in use any more. */
+    void stop();
+
+    bool isRunning() const { return thread.joinable(); }
+
+    /** The delay exchange() adds: one block of the size passed to start(), or 0 if the worker isn't running. */
+    int getLatencyInSamples() const { return isRunning() ? maxBlockSize : 0; }
+
+    /** Hands the channels to the worker and replaces them with the output which is due, in place. For the audio thread, doesn't allocate or wait.
+     */
+    void exchange (float* const* channels, const int numChannels, const int numSamples);
+
+    /** Waits until the worker has processed all input it was handed, so the caller may touch what the process function uses. Returns at once if the worker isn't running. Not for the real-time audio thread, for an offline render it's fine.
+     */
+    void waitUntilIdle() const;
+
+    /** The number of exchange() calls which had to fill in silence since start(). */
+    int getNumUnderruns() const { return numUnderruns.load (std::memory_order_relaxed); }
+
+private:
+    /** Planar ring buffer with one writing and one reading thread; the counters only ever grow. */
+    struct Fifo
+    {
+        void prepare (const int numChannels, const int capacity);
+
+        int getNumReady() const { return static_cast<int> (numWritten.load() - numRead.load()); }
+        int getFreeSpace() const { return capacity - getNumReady(); }
+
+        void write (const float* const* source, const int numSourceChannels, const int numSamples);
+        void writeSilence (const int numSamples);
+        void read (float* const* destination, const int numDestinationChannels, const int numSamples, const int destinationOffset = 0);
+        void skip (const int numSamples) { numRead.store (numRead.load() + numSamples); }
+
+        std::vector<float> data;
+        int numChannels = 0;
+        int capacity = 0;
+        std::atomic<int64_t> numWritten { 0 };
+        std::atomic<int64_t> numRead { 0 };
+    };
+
+    /** Remembers that length samples of input were lost before the input sample at position. */
+    void addGap (const int64_t position, const int length);
+
+    void workerLoop();
+
+    static constexpr int spinTimeInMicroseconds = 100;
+    static constexpr int fifoSizeInBlocks = 4;
+    static constexpr int maxNumGaps = 16;
+
+    int numChannels = 0;
+    int maxBlockSize = 0;
+    ProcessFunction processFunction = nullptr;
+    void* processContext = nullptr;
+
+    Fifo input, output;
+
+    // the worker's chunk, planar
+    std::vector<float> scratch;
+    std::vector<float*> scratchChannels;
+
+    // Audio thread only: the samples exchanged so far, and where input was lost because the worker fell too far behind.
+    // Gap positions count the accepted input; gapOffset sums up the gaps the output has passed already.
+    struct Gap { int64_t position; int64_t length; };
+    int64_t numExchanged = 0;
+    Gap gaps[maxNumGaps] {};
+    int gapIndex = 0;
+    int numGaps = 0;
+    int64_t gapOffset = 0;
+    std::atomic<int> numUnderruns { 0 };
+
+    std::thread thread;
+    std::atomic<bool> shouldExit { false };
+
+    // The worker sets sleeping before it checks the input a last time; exchange() publishes the input first, then takes the
+    // flag and posts a token. A worker which finds input after setting the flag takes it back, or takes its token.
+    WakeSemaphore wakeSemaphore;
+    std::atomic<bool> sleeping { false };
+
+    void wakeWorker();
+    void sleep();
+};
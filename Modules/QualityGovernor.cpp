@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    QualityGovernor.cpp
+
+  ==============================================================================
+*/
+
+#include "QualityGovernor.h"
+#include <cmath>
+#include <algorithm>
+
+void QualityGovernor::reset()
+{
+    smoothedLoad = 0.0;
+    secondsSinceChange = 0.0;
+    tier = 0;
+    load = 0.0;
+}
+
+int QualityGovernor::update (const double callbackSeconds, const int numSamples, const double sampleRate)
+{
+    int currentTier = tier.load (std::memory_order_relaxed);
+
+    if (numSamples <= 0 || sampleRate <= 0.0)
+        return currentTier;
+
+    // a callback which overran its budget has caused a dropout anyway, more than the whole budget shouldn't weigh more
+    const double budget = numSamples / sampleRate;
+    const double callbackLoad = std::min (1.0, callbackSeconds / budget);
+
+    // one-pole smoothing with the time constant scaled to the block length
+    const double timeConstant = callbackLoad > smoothedLoad ? riseTimeInSeconds : decayTimeInSeconds;
+    smoothedLoad += (callbackLoad - smoothedLoad) * (1.0 - std::exp (-budget / timeConstant));
+    secondsSinceChange += budget;
+
+    if (smoothedLoad > stepDownLoad && currentTier < numTiers - 1 && secondsSinceChange >= holdBeforeStepDownInSeconds)
+    {
+        ++currentTier;
+        secondsSinceChange = 0.0;
+    }
+    else if (smoothedLoad < stepUpLoad && currentTier > 0 && secondsSinceChange >= holdBeforeStepUpInSeconds)
+    {
+        --currentTier;
+        secondsSinceChange = 0.0;
+    }
+
+    tier.store (currentTier, std::memory_order_relaxed);
+    load.store (smoothedLoad, std::memory_order_relaxed);
+    return currentTier;
+}
@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    QualityGovernor.h
+
+    Steps the processing quality down and up with the measured CPU load.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+
+/**
+ Watches how much of the real-time budget (block length / sample rate) the audio callback takes, and picks a quality tier: 0 is the full quality the user set, every higher tier saves more work. The processor decides what a tier means; the governor only decides when to change it.
+
+ The load is smoothed asymmetrically: it follows a rise within about 100 ms but decays slowly, so a single fast callback doesn't undo a step down. Single callbacks count with at most the whole budget, so an isolated spike doesn't step down either. Between the load limits lies a hysteresis band, and after every change the governor holds the tier for a while (short before stepping further down, long before stepping up), so it doesn't oscillate between two tiers.
+
+ update() has to be called on the audio thread, the getters can be called from any thread.
+ */
+class QualityGovernor
+{
+public:
+    static constexpr int numTiers = 3;
+
+    /** Smoothed load above which the governor steps down. */
+    static constexpr double stepDownLoad = 0.5;
+
+    /** Smoothed load below which the governor steps up again. */
+    static constexpr double stepUpLoad = 0.2;
+
+    QualityGovernor() {}
+
+    /** Goes back to full quality and forgets the load. */
+    void reset();
+
+    /** Feeds the duration of a callback which processed numSamples at the given sample rate. Returns the tier for the next callback. */
+    int update (const double callbackSeconds, const int numSamples, const double sampleRate);
+
+    int getTier() const { return tier.load (std::memory_order_relaxed); }
+
+    /** The smoothed share of the real-time budget the callbacks take, 1.0 is the whole budget. */
+    double getLoad() const { return load.load (std::memory_order_relaxed); }
+
+private:
+    static constexpr double riseTimeInSeconds = 0.1;
+    static constexpr double decayTimeInSeconds = 1.0;
+    static constexpr double holdBeforeStepDownInSeconds = 0.2;
+    static constexpr double holdBeforeStepUpInSeconds = 3.0;
+
+    // audio thread only
+    double smoothedLoad = 0.0;
+    double secondsSinceChange = 0.0;
+
+    std::atomic<int> tier { 0 };
+    std::atomic<double> load { 0.0 };
+};
@@ -0,0 +1,313 @@
+/*
+  ==============================================================================
+
+    RenderStatistics.cpp
+
+  ==============================================================================
+*/
+
+#include "RenderStatistics.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+
+    float gainToDecibels (const float gain)
+    {
+        return gain > 0.0f ? 20.0f * std::log10 (gain) : -std::numeric_limits<float>::infinity();
+    }
+
+    /** JSON has no infinities, so values which don't exist are written as null. */
+    void writeNumber (std::ostream& output, const double value)
+    {
+        if (std::isfinite (value))
+            output << value;
+        else
+            output << "null";
+    }
+}
+
+void RenderStatistics::prepare (const double newSampleRate, const int newNumChannels, const int newMaxBlockSize)
+{
+    sampleRate = newSampleRate;
+    numChannels = std::max (1, newNumChannels);
+    maxBlockSize = std::max (1, newMaxBlockSize);
+    batchCapacity = std::max (outputBatchSize, maxBlockSize);
+
+    blockKey.assign (static_cast<size_t> (maxBlockSize), 0.0f);
+    blockGainReduction.assign (static_cast<size_t> (maxBlockSize), 0.0f);
+    batchOutput.assign (static_cast<size_t> (numChannels * batchCapacity), 0.0f);
+
+    batchOutputChannels.resize (static_cast<size_t> (numChannels));
+    for (int ch = 0; ch < numChannels; ++ch)
+        batchOutputChannels[static_cast<size_t> (ch)] = batchOutput.data() + ch * batchCapacity;
+
+    truePeakHistory.assign (static_cast<size_t> (numChannels * historyLength), 0.0f);
+    truePeakInput.assign (static_cast<size_t> (historyLength + batchCapacity), 0.0f);
+    truePeakOutput.assign (static_cast<size_t> (batchCapacity), 0.0f);
+    buildTruePeakFilter();
+
+    loudnessMeter.prepare (sampleRate, numChannels);
+
+    reset();
+}
+
+void RenderStatistics::reset()
+{
+    std::fill (blockKey.begin(), blockKey.end(), 0.0f);
+    std::fill (blockGainReduction.begin(), blockGainReduction.end(), 0.0f);
+    std::fill (truePeakHistory.begin(), truePeakHistory.end(), 0.0f);
+    numBatchSamples = 0;
+    loudnessMeter.reset();
+
+    numSamples = 0;
+    numSamplesAboveThreshold = 0;
+    numSampleOvers = 0;
+    numTruePeakOvers = 0;
+    samplePeak = 0.0f;
+    truePeak = 0.0f;
+
+    gainReductionSum = 0.0;
+    maxGainReduction = 0.0f;
+    histogram.fill (0);
+
+    currentRunStart = -1;
+    longestRunStart = 0;
+    longestRunLength = 0;
+
+    hasDetectorSignals = false;
+}
+
+void RenderStatistics::setThreshold (const float thresholdInDecibels)
+{
+    thresholdGain = std::pow (10.0f, 0.05f * thresholdInDecibels);
+}
+
+void RenderStatistics::buildTruePeakFilter()
+{
+    // Hann-windowed sinc, cut off at the original Nyquist frequency; tap k belongs to phase k % truePeakOversampling
+    const int numTaps = truePeakOversampling * truePeakTapsPerPhase;
+    const double centre = 0.5 * (numTaps - 1);
+
+    for (int k = 0; k < numTaps; ++k)
+    {
+        const double t = (k - centre) / truePeakOversampling;
+        const double sinc = t == 0.0 ? 1.0 : std::sin (pi * t) / (pi * t);
+        const double window = 0.5 + 0.5 * std::cos (pi * (k - centre) / (0.5 * numTaps));
+        truePeakFilter[static_cast<size_t> (k)] = static_cast<float> (sinc * window);
+    }
+
+    // every phase passes DC with unity gain
+    for (int phase = 0; phase < truePeakOversampling; ++phase)
+    {
+        float sum = 0.0f;
+        for (int j = 0; j < truePeakTapsPerPhase; ++j)
+            sum += truePeakFilter[static_cast<size_t> (phase + j * truePeakOversampling)];
+
+        for (int j = 0; j < truePeakTapsPerPhase; ++j)
+            truePeakFilter[static_cast<size_t> (phase + j * truePeakOversampling)] /= sum;
+    }
+}
+
+// ==============================================================================
+void RenderStatistics::addKeySignal (const float* key, const int numSamplesInBlock)
+{
+    hasDetectorSignals = true;
+
+    for (int i = 0; i < numSamplesInBlock; ++i)
+        blockKey[static_cast<size_t> (i)] = std::max (blockKey[static_cast<size_t> (i)], key[i]);
+}
+
+void RenderStatistics::addGainReduction (const float* gainReductionInDecibels, const int numSamplesInBlock)
+{
+    hasDetectorSignals = true;
+
+    for (int i = 0; i < numSamplesInBlock; ++i)
+        blockGainReduction[static_cast<size_t> (i)] = std::min (blockGainReduction[static_cast<size_t> (i)], gainReductionInDecibels[i]);
+}
+
+void RenderStatistics::addOutput (const float* samples, const int numSamplesInBlock, const int channel, const int stride)
+{
+    float* planar = batchOutputChannels[static_cast<size_t> (channel)] + numBatchSamples;
+
+    for (int i = 0; i < numSamplesInBlock; ++i)
+        planar[i] = samples[i * stride];
+}
+
+void RenderStatistics::analyseOutput (const int channel, const int numSamplesInBatch)
+{
+    const float* planar = batchOutputChannels[static_cast<size_t> (channel)];
+    float* history = truePeakHistory.data() + channel * historyLength;
+
+    // the interpolator reads the channel's history followed by the batch, oldest sample first
+    float* input = truePeakInput.data();
+    std::copy (history, history + historyLength, input);
+    std::copy (planar, planar + numSamplesInBatch, input + historyLength);
+    std::copy (input + numSamplesInBatch, input + numSamplesInBatch + historyLength, history);
+
+    float batchSamplePeak = samplePeak;
+    for (int i = 0; i < numSamplesInBatch; ++i)
+    {
+        const float magnitude = std::abs (planar[i]);
+        batchSamplePeak = std::max (batchSamplePeak, magnitude);
+        numSampleOvers += magnitude >= overLevel ? 1 : 0;
+    }
+    samplePeak = batchSamplePeak;
+
+    // the largest of the four interpolated values per sample, which lag behind by half the filter length
+    float* peaks = truePeakOutput.data();
+    std::fill (peaks, peaks + numSamplesInBatch, 0.0f);
+
+    for (int phase = 0; phase < truePeakOversampling; ++phase)
+    {
+        // taps in reversed order; the tap loop has a fixed length, so it's unrolled and the sample loop vectorized,
+        // with the sums in registers
+        float coefficients[truePeakTapsPerPhase];
+        for (int m = 0; m < truePeakTapsPerPhase; ++m)
+            coefficients[m] = truePeakFilter[static_cast<size_t> (phase + (truePeakTapsPerPhase - 1 - m) * truePeakOversampling)];
+
+        for (int i = 0; i < numSamplesInBatch; ++i)
+        {
+            float sum = 0.0f;
+            for (int m = 0; m < truePeakTapsPerPhase; ++m)
+                sum += coefficients[m] * input[i + m];
+
+            peaks[i] = std::max (peaks[i], std::abs (sum));
+        }
+    }
+
+    float batchTruePeak = std::max (truePeak, batchSamplePeak);
+    for (int i = 0; i < numSamplesInBatch; ++i)
+    {
+        const float peak = std::max (peaks[i], std::abs (planar[i]));
+        batchTruePeak = std::max (batchTruePeak, peak);
+        numTruePeakOvers += peak >= overLevel ? 1 : 0;
+    }
+    truePeak = batchTruePeak;
+}
+
+void RenderStatistics::endBlock (const int numSamplesInBlock)
+{
+    for (int i = 0; i < numSamplesInBlock; ++i)
+    {
+        const float gainReduction = blockGainReduction[static_cast<size_t> (i)];
+        const int64_t position = numSamples + i;
+
+        numSamplesAboveThreshold += blockKey[static_cast<size_t> (i)] > thresholdGain ? 1 : 0;
+
+        gainReductionSum += gainReduction;
+        maxGainReduction = std::min (maxGainReduction, gainReduction);
+
+        const int bin = static_cast<int> (-gainReduction / histogramBinWidthInDecibels);
+        ++histogram[static_cast<size_t> (std::min (numHistogramBins - 1, std::max (0, bin)))];
+
+        if (gainReduction < limitingThresholdInDecibels)
+        {
+            if (currentRunStart < 0)
+                currentRunStart = position;
+
+            if (position + 1 - currentRunStart > longestRunLength)
+            {
+                longestRunStart = currentRunStart;
+                longestRunLength = position + 1 - currentRunStart;
+            }
+        }
+        else
+            currentRunStart = -1;
+    }
+
+    numSamples += numSamplesInBlock;
+
+    std::fill (blockKey.begin(), blockKey.begin() + numSamplesInBlock, 0.0f);
+    std::fill (blockGainReduction.begin(), blockGainReduction.begin() + numSamplesInBlock, 0.0f);
+
+    // analyse before the next block could overflow the batch
+    numBatchSamples += numSamplesInBlock;
+    if (numBatchSamples > batchCapacity - maxBlockSize)
+        flush();
+}
+
+void RenderStatistics::flush()
+{
+    if (numBatchSamples == 0)
+        return;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        analyseOutput (ch, numBatchSamples);
+
+    loudnessMeter.process (batchOutputChannels.data(), numChannels, numBatchSamples);
+    numBatchSamples = 0;
+}
+
+// ==============================================================================
+float RenderStatistics::getSamplePeakInDecibels() const
+{
+    return gainToDecibels (samplePeak);
+}
+
+float RenderStatistics::getTruePeakInDecibels() const
+{
+    return gainToDecibels (truePeak);
+}
+
+void RenderStatistics::writeJson (std::ostream& output) const
+{
+    const double secondsPerSample = sampleRate > 0.0 ? 1.0 / sampleRate : 0.0;
+    const float truePeakInDecibels = getTruePeakInDecibels();
+    const float integratedLoudness = getIntegratedLoudness();
+
+    const auto flags = output.flags();
+    const auto precision = output.precision();
+    output << std::fixed << std::setprecision (3);
+
+    output << "{\"duration\":" << numSamples * secondsPerSample
+           << ",\"sampleRate\":" << sampleRate
+           << ",\"channels\":" << numChannels
+           << ",\"samplePeak\":";
+    writeNumber (output, getSamplePeakInDecibels());
+    output << ",\"truePeak\":";
+    writeNumber (output, truePeakInDecibels);
+    output << ",\"sampleOvers\":" << numSampleOvers
+           << ",\"truePeakOvers\":" << numTruePeakOvers
+           << ",\"integratedLoudness\":";
+    writeNumber (output, integratedLoudness);
+    output << ",\"peakToLoudnessRatio\":";
+    writeNumber (output, truePeakInDecibels - integratedLoudness);
+    output << ",\"timeAboveThreshold\":";
+
+    // without the detector's signals, its figures would only report silence and no reduction at all
+    if (! hasDetectorSignals)
+    {
+        output << "null,\"maxGainReduction\":null,\"meanGainReduction\":null,\"longestLimitingRun\":null,\"gainReductionHistogram\":null}";
+    }
+    else
+    {
+        output << numSamplesAboveThreshold * secondsPerSample
+               << ",\"maxGainReduction\":" << maxGainReduction
+               << ",\"meanGainReduction\":" << (numSamples > 0 ? gainReductionSum / numSamples : 0.0)
+               << ",\"longestLimitingRun\":{\"start\":" << longestRunStart * secondsPerSample
+               << ",\"length\":" << longestRunLength * secondsPerSample
+               << "},\"gainReductionHistogram\":{\"binWidth\":" << histogramBinWidthInDecibels
+               << ",\"counts\":[";
+
+        for (int bin = 0; bin < numHistogramBins; ++bin)
+            output << (bin > 0 ? "," : "") << histogram[static_cast<size_t> (bin)];
+
+        output << "]}}";
+    }
+
+    output.flags (flags);
+    output.precision (precision);
+}
+
+std::string RenderStatistics::toJson() const
+{
+    std::ostringstream stream;
+    writeJson (stream);
+    return stream.str();
+}
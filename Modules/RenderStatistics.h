@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    RenderStatistics.h
+
+    Streaming quality-control statistics of a render, written as JSON.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "LoudnessMeter.h"
+#include <vector>
+#include <array>
+#include <string>
+#include <ostream>
+#include <cstdint>
+
+/**
+ Collects the quality-control figures of a render while it streams through the limiter, so the output doesn't have to be read again afterwards: a gain-reduction histogram, the time the detector spent above the threshold, sample-peak and true-peak overs, the peak-to-loudness ratio and the longest limiting run.
+
+ Each block is fed in three steps: the detector's key signal with addKeySignal(), the gain reduction the detector computed from it with addGainReduction(), and the output of every channel with addOutput(). endBlock() then folds the block into the statistics. With unlinked channels the key and the gain reduction can be added once per channel; the statistics use the loudest key and the strongest reduction of each sample. Where the detector can't be reached, e.g. behind a host's processor interface, only the output can be added: the report then has null for the figures which need the detector.
+
+ The output is only collected per block: the peaks, the true-peak interpolator and the loudness meter run over batches of up to outputBatchSize samples, so they don't pay their overhead for every small block. flush() analyses what's collected so far; call it before reading the figures.
+
+ A sample or interpolated value counts as an over if its magnitude reaches full scale, so every sample over is a true-peak over as well.
+
+ The memory is allocated in prepare() and stays the same no matter how long the render is. True peak is estimated with a 4x polyphase interpolator of 48 taps, as described in ITU-R BS.1770-4, Annex 2. It reads a 0.5 FS sine at a quarter of the sample rate as -6.09 dBTP instead of -6.02 dBTP.
+ */
+class RenderStatistics
+{
+public:
+    static constexpr float histogramBinWidthInDecibels = 0.5f;
+    static constexpr int numHistogramBins = 48; // the last bin collects everything from 23.5 dB on
+
+    /** Gain reduction stronger than this counts as limiting for the longest limiting run. */
+    static constexpr float limitingThresholdInDecibels = -0.1f;
+
+    /** The level at and above which samples and interpolated values are counted as overs. */
+    static constexpr float overLevel = 1.0f;
+
+    /** The number of output samples per channel collected before they're analysed. */
+    static constexpr int outputBatchSize = 2048;
+
+    RenderStatistics() {}
+
+    /** Allocates everything for blocks of up to maxBlockSize samples, and resets the statistics. */
+    void prepare (const double sampleRate, const int numChannels, const int maxBlockSize);
+
+    /** Starts over, e.g. for the next file. */
+    void reset();
+
+    /** The threshold the time above threshold refers to. */
+    void setThreshold (const float thresholdInDecibels);
+
+    // ======================================================================
+    /** Adds the detector's (absolute) key signal of the current block. */
+    void addKeySignal (const float* key, const int numSamples);
+
+    /** Adds the gain reduction in decibels the detector computed for the current block. */
+    void addGainReduction (const float* gainReductionInDecibels, const int numSamples);
+
+    /** Adds one output channel of the current block. */
+    void addOutput (const float* samples, const int numSamples, const int channel, const int stride = 1);
+
+    /** Folds the current block into the statistics. The output is analysed once a batch is full, or with flush(). */
+    void endBlock (const int numSamples);
+
+    /** Analyses the output collected since the last batch, so the figures below are up to date. */
+    void flush();
+
+    // ======================================================================
+    int64_t getNumSamples() const { return numSamples; }
+    float getSamplePeakInDecibels() const;
+    float getTruePeakInDecibels() const;
+    int64_t getNumSampleOvers() const { return numSampleOvers; }
+    int64_t getNumTruePeakOvers() const { return numTruePeakOvers; }
+    float getIntegratedLoudness() const { return loudnessMeter.getIntegratedLoudness(); }
+
+    /** Writes the report as a single line of JSON. Values which don't exist (e.g. the loudness of silence) are null. Output which wasn't flushed yet is left out. */
+    void writeJson (std::ostream& output) const;
+    std::string toJson() const;
+
+private:
+    static constexpr int truePeakOversampling = 4;
+    static constexpr int truePeakTapsPerPhase = 12;
+    static constexpr int historyLength = truePeakTapsPerPhase - 1;
+
+    void buildTruePeakFilter();
+
+    /** Measures the sample peak, the true peak and the overs of one channel's batch. */
+    void analyseOutput (const int channel, const int numSamples);
+
+    double sampleRate = 0.0;
+    int numChannels = 0;
+    int maxBlockSize = 0;
+    int batchCapacity = 0;
+    float thresholdGain = 1.0f;
+
+    // the current block: loudest key and strongest reduction
+    std::vector<float> blockKey;
+    std::vector<float> blockGainReduction;
+
+    // the planar output of the current batch, which the true-peak interpolator and the loudness meter read
+    std::vector<float> batchOutput;
+    std::vector<float*> batchOutputChannels;
+    int numBatchSamples = 0;
+
+    // true peak: the last samples of every channel, oldest first, and the scratch of the current block
+    std::array<float, truePeakOversampling * truePeakTapsPerPhase> truePeakFilter {};
+    std::vector<float> truePeakHistory;
+    std::vector<float> truePeakInput, truePeakOutput;
+
+    LoudnessMeter loudnessMeter;
+
+    int64_t numSamples = 0;
+    int64_t numSamplesAboveThreshold = 0;
+    int64_t numSampleOvers = 0;
+    int64_t numTruePeakOvers = 0;
+    float samplePeak = 0.0f;
+    float truePeak = 0.0f;
+
+    double gainReductionSum = 0.0;
+    float maxGainReduction = 0.0f;
+    std::array<int64_t, numHistogramBins> histogram {};
+
+    int64_t currentRunStart = -1;
+    int64_t longestRunStart = 0;
+    int64_t longestRunLength = 0;
+
+    // whether any key or gain reduction was added since the last reset
+    bool hasDetectorSignals = false;
+};
@@ -0,0 +1,197 @@
+/*
+  ==============================================================================
+
+    SideChainFilter.cpp
+
+  ==============================================================================
+*/
+
+#include "SideChainFilter.h"
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double butterworthQ = 0.7071067811865476;
+}
+
+MultiChannelBiquad::Coefficients SideChainFilter::makeHighPass (const double sampleRate, const double frequency, const double Q)
+{
+    const double w0 = 2.0 * pi * std::min (frequency, 0.49 * sampleRate) / sampleRate;
+    const double alpha = std::sin (w0) / (2.0 * Q);
+    const double cosW0 = std::cos (w0);
+    const double a0 = 1.0 + alpha;
+
+    MultiChannelBiquad::Coefficients c;
+    c.b0 = static_cast<float> ((1.0 + cosW0) / 2.0 / a0);
+    c.b1 = static_cast<float> (-(1.0 + cosW0) / a0);
+    c.b2 = c.b0;
+    c.a1 = static_cast<float> (-2.0 * cosW0 / a0);
+    c.a2 = static_cast<float> ((1.0 - alpha) / a0);
+    return c;
+}
+
+MultiChannelBiquad::Coefficients SideChainFilter::makeHighShelf (const double sampleRate, const double frequency, const double Q, const double gainInDecibels)
+{
+    const double A = std::pow (10.0, gainInDecibels / 40.0);
+    const double w0 = 2.0 * pi * std::min (frequency, 0.49 * sampleRate) / sampleRate;
+    const double alpha = std::sin (w0) / (2.0 * Q);
+    const double cosW0 = std::cos (w0);
+    const double twoSqrtAAlpha = 2.0 * std::sqrt (A) * alpha;
+    const double a0 = (A + 1.0) - (A - 1.0) * cosW0 + twoSqrtAAlpha;
+
+    MultiChannelBiquad::Coefficients c;
+    c.b0 = static_cast<float> (A * ((A + 1.0) + (A - 1.0) * cosW0 + twoSqrtAAlpha) / a0);
+    c.b1 = static_cast<float> (-2.0 * A * ((A - 1.0) + (A + 1.0) * cosW0) / a0);
+    c.b2 = static_cast<float> (A * ((A + 1.0) + (A - 1.0) * cosW0 - twoSqrtAAlpha) / a0);
+    c.a1 = static_cast<float> (2.0 * ((A - 1.0) - (A + 1.0) * cosW0) / a0);
+    c.a2 = static_cast<float> (((A + 1.0) - (A - 1.0) * cosW0 - twoSqrtAAlpha) / a0);
+    return c;
+}
+
+void SideChainFilter::prepare (const double newSampleRate, const int numChannels)
+{
+    sampleRate = newSampleRate;
+
+    const int numGroups = (std::max (1, numChannels) + MultiChannelBiquad::lanes - 1) / MultiChannelBiquad::lanes;
+    filters.resize (static_cast<size_t> (numGroups));
+
+    coefficientsNeedUpdate = true;
+    updateCoefficients();
+    reset();
+}
+
+void SideChainFilter::reset()
+{
+    for (auto& group : filters)
+    {
+        group.highPass.reset();
+        group.tilt.reset();
+    }
+}
+
+void SideChainFilter::saveState (DspCheckpoint& checkpoint) const
+{
+    checkpoint.write (filters.size());
+    for (const auto& group : filters)
+    {
+        group.highPass.saveState (checkpoint);
+        group.tilt.saveState (checkpoint);
+    }
+}
+
+bool SideChainFilter::restoreState (DspCheckpoint::Reader& reader)
+{
+    size_t numGroups = 0;
+    if (! reader.read (numGroups) || numGroups != filters.size())
+        return false;
+
+    for (auto& group : filters)
+        if (! (group.highPass.restoreState (reader) && group.tilt.restoreState (reader)))
+            return false;
+
+    return true;
+}
+
+void SideChainFilter::setHighPassFrequency (const float frequencyInHertz)
+{
+    highPassFrequency = frequencyInHertz;
+    coefficientsNeedUpdate = true;
+}
+
+void SideChainFilter::setTilt (const float tiltInDecibels)
+{
+    tilt = tiltInDecibels;
+    coefficientsNeedUpdate = true;
+}
+
+void SideChainFilter::updateCoefficients()
+{
+    if (! coefficientsNeedUpdate.exchange (false) || sampleRate <= 0.0)
+        return;
+
+    const auto highPass = makeHighPass (sampleRate, highPassFrequency.load(), butterworthQ);
+
+    // a shelf of the full tilt, lowered by half of it: the pivot stays where it is
+    const float tiltInDecibels = tilt.load();
+    auto shelf = makeHighShelf (sampleRate, tiltPivotFrequency, butterworthQ, tiltInDecibels);
+    const float offset = std::pow (10.0f, -tiltInDecibels / 40.0f);
+    shelf.b0 *= offset;
+    shelf.b1 *= offset;
+    shelf.b2 *= offset;
+
+    for (auto& group : filters)
+    {
+        group.highPass.setCoefficients (highPass);
+        group.tilt.setCoefficients (shelf);
+    }
+
+    useTilt = tiltInDecibels != 0.0f;
+}
+
+template <typename Output>
+void SideChainFilter::process (const float* const* channels, const int firstChannel, const int numChannels, const int numSamples, const int stride, Output&& output)
+{
+    constexpr int lanes = MultiChannelBiquad::lanes;
+    const int endChannel = firstChannel + numChannels;
+    const int endGroup = std::min (static_cast<int> (filters.size()), (endChannel + lanes - 1) / lanes);
+
+    alignas (16) float frames[framesPerChunk][lanes] = {};
+
+    for (int g = firstChannel / lanes; g < endGroup; ++g)
+    {
+        const int groupFirstChannel = g * lanes;
+        const int groupChannels = std::min (lanes, endChannel - groupFirstChannel);
+        auto& group = filters[static_cast<size_t> (g)];
+
+        for (int start = 0; start < numSamples; start += framesPerChunk)
+        {
+            const int numFrames = std::min (framesPerChunk, numSamples - start);
+
+            // gather the group's channels into frames of one sample per lane
+            for (int l = 0; l < groupChannels; ++l)
+            {
+                const float* src = channels[groupFirstChannel + l] + start * stride;
+                for (int n = 0; n < numFrames; ++n)
+                    frames[n][l] = src[n * stride];
+            }
+
+            if (useTilt)
+                group.highPass.processFramesCascaded (group.tilt, frames, numFrames);
+            else
+                group.highPass.processFrames (frames, numFrames);
+
+            output (groupFirstChannel, groupChannels, start, numFrames, frames);
+        }
+    }
+}
+
+void SideChainFilter::processMaxAbs (const float* const* channels, const int numChannels, float* key, const int numSamples, const int stride)
+{
+    updateCoefficients();
+    std::fill (key, key + numSamples, 0.0f);
+
+    process (channels, 0, numChannels, numSamples, stride, [key] (int, int groupChannels, int start, int numFrames, const float (*frames)[MultiChannelBiquad::lanes])
+    {
+        for (int l = 0; l < groupChannels; ++l)
+            for (int n = 0; n < numFrames; ++n)
+                key[start + n] = std::max (key[start + n], std::abs (frames[n][l]));
+    });
+}
+
+void SideChainFilter::processAbs (const float* const* channels, float* const* keys, const int numChannels, const int numSamples, const int stride)
+{
+    updateCoefficients();
+    processAbsOfChannels (channels, keys, 0, numChannels, numSamples, stride);
+}
+
+void SideChainFilter::processAbsOfChannels (const float* const* channels, float* const* keys, const int firstChannel, const int numChannels, const int numSamples, const int stride)
+{
+    process (channels, firstChannel, numChannels, numSamples, stride, [keys] (int groupFirstChannel, int groupChannels, int start, int numFrames, const float (*frames)[MultiChannelBiquad::lanes])
+    {
+        for (int l = 0; l < groupChannels; ++l)
+            for (int n = 0; n < numFrames; ++n)
+                keys[groupFirstChannel + l][start + n] = std::abs (frames[n][l]);
+    });
+}
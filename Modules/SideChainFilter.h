@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    SideChainFilter.h
+
+    Detector EQ: high-pass and tilt on the side-chain key signal.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "MultiChannelBiquad.h"
+#include <vector>
+#include <atomic>
+
+/**
+ Filters the detector's copy of the signal, so e.g. sub-bass doesn't drive the gain reduction; the audio itself isn't touched. A second-order Butterworth high-pass is followed by a tilt: a high shelf around the pivot frequency, with half of its gain taken off the whole spectrum, so the lows go down by as much as the highs go up.
+
+ Both stages are MultiChannelBiquads, so four channels are filtered at once in one SIMD register, and they run in the same pass. The filtered key is written as absolute values, either as the maximum over all channels (for linked channels) or per channel.
+
+ The setters can be called from any thread; the new coefficients are computed on the audio thread with the next block.
+ */
+class SideChainFilter
+{
+public:
+    static constexpr float tiltPivotFrequency = 1000.0f;
+
+    SideChainFilter() {}
+
+    /** Prepares the filters for the given (processing) sample rate and channel count. Allocates. */
+    void prepare (const double sampleRate, const int numChannels);
+
+    /** Clears the filter states. */
+    void reset();
+
+    /** Saves the filter states into the checkpoint, and restores them. The coefficients follow from the settings. */
+    void saveState (DspCheckpoint& checkpoint) const;
+    bool restoreState (DspCheckpoint::Reader& reader);
+
+    void setEnabled (const bool shouldBeEnabled) { enabled = shouldBeEnabled; }
+    bool isEnabled() const { return enabled.load (std::memory_order_relaxed); }
+
+    void setHighPassFrequency (const float frequencyInHertz);
+    void setTilt (const float tiltInDecibels);
+
+    // ======================================================================
+    /** Filters numChannels channels and writes the maximum of the absolute filtered values of all channels into key. Channels are read with the given stride. */
+    void processMaxAbs (const float* const* channels, const int numChannels, float* key, const int numSamples, const int stride = 1);
+
+    /** Filters numChannels channels and writes the absolute filtered values of each channel into keys[channel]. */
+    void processAbs (const float* const* channels, float* const* keys, const int numChannels, const int numSamples, const int stride = 1);
+
+    /** Like processAbs(), but only for the channels [firstChannel, firstChannel + numChannels), where firstChannel is a multiple of MultiChannelBiquad::lanes, and without applying new settings: several threads can filter different groups of channels at once, after one call to updateCoefficients() for the block. */
+    void processAbsOfChannels (const float* const* channels, float* const* keys, const int firstChannel, const int numChannels, const int numSamples, const int stride = 1);
+
+    /** Applies what the setters changed. The other process functions do this themselves. */
+    void updateCoefficients();
+
+    // ======================================================================
+    /** Coefficients of a second-order high-pass (RBJ cookbook). */
+    static MultiChannelBiquad::Coefficients makeHighPass (const double sampleRate, const double frequency, const double Q);
+
+    /** Coefficients of a second-order high shelf with the given gain (RBJ cookbook). */
+    static MultiChannelBiquad::Coefficients makeHighShelf (const double sampleRate, const double frequency, const double Q, const double gainInDecibels);
+
+private:
+    static constexpr int framesPerChunk = 64;
+
+    template <typename Output>
+    void process (const float* const* channels, const int firstChannel, const int numChannels, const int numSamples, const int stride, Output&& output);
+
+    struct FilterGroup
+    {
+        MultiChannelBiquad highPass, tilt;
+    };
+    std::vector<FilterGroup> filters;
+
+    double sampleRate = 0.0;
+
+    std::atomic<bool> enabled { false };
+    std::atomic<float> highPassFrequency { 80.0f };
+    std::atomic<float> tilt { 0.0f };
+    std::atomic<bool> coefficientsNeedUpdate { true };
+
+    // the tilt stage is skipped while it's flat, audio thread only
+    bool useTilt = false;
+};
@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    TLimiterC.cpp
+
+  ==============================================================================
+*/
+
+#define TLIMITER_BUILDING_LIBRARY 1
+#include "TLimiterC.h"
+#include "LimiterCore.h"
+#include <new>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+struct TLimiter
+{
+    LimiterCore core;
+    bool prepared = false;
+    int clipperOrder = 0;
+    float ceiling = 1.0f;
+    int ditherBitDepth = 0;
+    int noiseShaping = 0;
+};
+
+TLimiter* tlimiter_create (void)
+{
+    return new (std::nothrow) TLimiter();
+}
+
+void tlimiter_destroy (TLimiter* limiter)
+{
+    delete limiter;
+}
+
+int tlimiter_prepare (TLimiter* limiter, double sampleRate, int numChannels)
+{
+    if (limiter == nullptr || sampleRate <= 0.0 || numChannels <= 0)
+        return -1;
+
+    // a failed prepare leaves the core half-sized, so it can't process until the next successful one
+    limiter->prepared = false;
+
+    try
+    {
+        limiter->core.prepare (sampleRate, numChannels);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return -1;
+    }
+
+    limiter->prepared = true;
+    return 0;
+}
+
+int tlimiter_set_parameter (TLimiter* limiter, TLimiterParameter parameter, float value)
+{
+    if (limiter == nullptr || std::isnan (value))
+        return -1;
+
+    // the choices are clamped before they're cast, so no enum ever holds a value it doesn't define
+    const auto clampChoice = [value] (const int maximum) { return static_cast<int> (std::max (0.0f, std::min (static_cast<float> (maximum), value))); };
+
+    if (parameter == TLIMITER_DITHER && value != 0.0f && value != 16.0f && value != 24.0f)
+        return -1;
+
+    if (parameter == TLIMITER_DECIMATION_FACTOR && value != 1.0f && value != 4.0f && value != 8.0f && value != 16.0f)
+        return -1;
+
+    if ((parameter == TLIMITER_ATTACK || parameter == TLIMITER_RELEASE) && ! (std::isfinite (value) && value >= 0.0f))
+        return -1;
+
+    auto& core = limiter->core;
+
+    switch (parameter)
+    {
+        case TLIMITER_THRESHOLD:         core.setThreshold (value); break;
+        case TLIMITER_KNEE:              core.setKnee (value); break;
+        case TLIMITER_RATIO:             core.setRatio (value); break;
+        case TLIMITER_ATTACK:            core.setAttackTime (value / 1000); break;
+        case TLIMITER_RELEASE:           core.setReleaseTime (value / 1000); break;
+        case TLIMITER_MAKE_UP:           core.setMakeUpGain (value); break;
+        case TLIMITER_LOOK_AHEAD:        core.setLookAhead (value > 0.5f); break;
+        case TLIMITER_FADE_SHAPE:        core.setFadeShape (static_cast<LookAheadGainReduction::FadeShape> (clampChoice (LookAheadGainReduction::numFadeShapes - 1))); break;
+        case TLIMITER_DECIMATION_FACTOR: core.setDecimationFactor (static_cast<int> (value)); break;
+        case TLIMITER_CHANNEL_LINK:      core.setChannelLink (value > 0.5f); break;
+        case TLIMITER_CLIPPER:           limiter->clipperOrder = clampChoice (2); break;
+        case TLIMITER_CEILING:           limiter->ceiling = value; break;
+        case TLIMITER_DITHER:            limiter->ditherBitDepth = static_cast<int> (value); break;
+        case TLIMITER_NOISE_SHAPING:     limiter->noiseShaping = clampChoice (3); break;
+        case TLIMITER_STATISTICS:        core.setCollectStatistics (value > 0.5f); break;
+        case TLIMITER_DETECTOR_EQ:       core.getSideChainFilter().setEnabled (value > 0.5f); break;
+        case TLIMITER_DETECTOR_HIGH_PASS: core.getSideChainFilter().setHighPassFrequency (value); break;
+        case TLIMITER_DETECTOR_TILT:     core.getSideChainFilter().setTilt (value); break;
+        default:                         return -1;
+    }
+
+    if (parameter == TLIMITER_CLIPPER || parameter == TLIMITER_CEILING)
+        core.setClipper (static_cast<AntiderivativeClipper::Order> (limiter->clipperOrder), limiter->ceiling);
+
+    if (parameter == TLIMITER_DITHER || parameter == TLIMITER_NOISE_SHAPING)
+        core.setDither (limiter->ditherBitDepth, static_cast<NoiseShapingDither::Shape> (limiter->noiseShaping));
+
+    return 0;
+}
+
+int tlimiter_get_latency (const TLimiter* limiter)
+{
+    return limiter != nullptr ? limiter->core.getLatencyInSamples() : 0;
+}
+
+void tlimiter_reset (TLimiter* limiter)
+{
+    if (limiter != nullptr)
+        limiter->core.reset();
+}
+
+void tlimiter_set_dither_seed (TLimiter* limiter, unsigned int seed)
+{
+    if (limiter != nullptr)
+        limiter->core.setDitherSeed (seed);
+}
+
+int tlimiter_process_planar (TLimiter* limiter, float* const* channels, int numSamples)
+{
+    if (limiter == nullptr || ! limiter->prepared || channels == nullptr || numSamples < 0)
+        return -1;
+
+    limiter->core.processPlanar (channels, numSamples);
+    return 0;
+}
+
+int tlimiter_process_interleaved (TLimiter* limiter, float* frames, int numFrames)
+{
+    if (limiter == nullptr || ! limiter->prepared || frames == nullptr || numFrames < 0)
+        return -1;
+
+    limiter->core.processInterleaved (frames, numFrames);
+    return 0;
+}
+
+int tlimiter_get_report (const TLimiter* limiter, char* buffer, int bufferSize)
+{
+    if (limiter == nullptr || bufferSize < 0 || (buffer == nullptr && bufferSize > 0))
+        return -1;
+
+    std::string report;
+    try
+    {
+        report = limiter->core.getStatistics().toJson();
+    }
+    catch (const std::bad_alloc&)
+    {
+        return -1;
+    }
+
+    const int length = static_cast<int> (report.size());
+    if (length < bufferSize)
+        std::memcpy (buffer, report.c_str(), static_cast<size_t> (length) + 1);
+
+    return length;
+}
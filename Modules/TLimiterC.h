@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    TLimiterC.h
+
+    Plain C interface to LimiterCore.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/**
+ CMake builds this interface as the tlimiter library, static by default, or shared with TLIMITER_BUILD_SHARED, which then exports only these functions. Define TLIMITER_SHARED_LIBRARY when using it as a shared library; the CMake target does that for its users. The plug-in doesn't compile it.
+ */
+#if defined (TLIMITER_SHARED_LIBRARY)
+ #if defined (_WIN32)
+  #if defined (TLIMITER_BUILDING_LIBRARY)
+   #define TLIMITER_API __declspec(dllexport)
+  #else
+   #define TLIMITER_API __declspec(dllimport)
+  #endif
+ #else
+  #define TLIMITER_API __attribute__((visibility ("default")))
+ #endif
+#else
+ #define TLIMITER_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct TLimiter TLimiter;
+
+typedef enum
+{
+    TLIMITER_THRESHOLD = 0,     /**< dB */
+    TLIMITER_KNEE,              /**< dB */
+    TLIMITER_RATIO,             /**< x : 1, INFINITY for a brickwall limiter */
+    TLIMITER_ATTACK,            /**< ms, finite and not negative; other values are rejected */
+    TLIMITER_RELEASE,           /**< ms, finite and not negative; other values are rejected */
+    TLIMITER_MAKE_UP,           /**< dB */
+    TLIMITER_LOOK_AHEAD,        /**< 0 = off, 1 = on */
+    TLIMITER_FADE_SHAPE,        /**< 0 = linear, 1 = raised cosine, 2 = exponential, 3 = S-curve; others are clamped to this range */
+    TLIMITER_DECIMATION_FACTOR, /**< 1 = every sample, or 4, 8, 16; other values are rejected */
+    TLIMITER_CHANNEL_LINK,      /**< 0 = every channel on its own, 1 = linked */
+    TLIMITER_CLIPPER,           /**< 0 = off, 1 = first order ADAA, 2 = second order ADAA; others are clamped to this range */
+    TLIMITER_CEILING,           /**< dB above threshold plus make-up */
+    TLIMITER_DITHER,            /**< output word length: 0 = off, 16 or 24; other values are rejected */
+    TLIMITER_NOISE_SHAPING,     /**< 0 = none, 1 = first order, 2 = Wannamaker 3-tap, 3 = Lipshitz 5-tap; others are clamped to this range */
+    TLIMITER_STATISTICS,        /**< 0 = off, 1 = collect the quality-control report */
+    TLIMITER_DETECTOR_EQ,       /**< 0 = off, 1 = filter the key signal with the high-pass and tilt below */
+    TLIMITER_DETECTOR_HIGH_PASS, /**< Hz */
+    TLIMITER_DETECTOR_TILT      /**< dB, positive values weight the highs more than the lows */
+} TLimiterParameter;
+
+/** Creates a limiter with the plug-in's default parameters. Returns NULL if out of memory. */
+TLIMITER_API TLimiter* tlimiter_create (void);
+
+TLIMITER_API void tlimiter_destroy (TLimiter* limiter);
+
+/** Allocates everything for processing. Returns 0 on success, -1 for invalid arguments or if out of memory. */
+TLIMITER_API int tlimiter_prepare (TLimiter* limiter, double sampleRate, int numChannels);
+
+/** Sets a parameter. Threshold, knee and ratio rebuild the characteristic table, which allocates. Returns 0 on success, -1 for an unknown parameter, a NaN or a value the parameter doesn't accept; the setting stays as it was then. */
+TLIMITER_API int tlimiter_set_parameter (TLimiter* limiter, TLimiterParameter parameter, float value);
+
+/** The latency of the current settings in samples. */
+TLIMITER_API int tlimiter_get_latency (const TLimiter* limiter);
+
+TLIMITER_API void tlimiter_reset (TLimiter* limiter);
+
+/** Seeds the dither, takes effect with the next reset or prepare. The same seed and input give bit-identical output. */
+TLIMITER_API void tlimiter_set_dither_seed (TLimiter* limiter, unsigned int seed);
+
+/** Processes numChannels planar buffers in place. Returns 0, or -1 without touching the buffers if the limiter isn't prepared or the arguments are invalid. */
+TLIMITER_API int tlimiter_process_planar (TLimiter* limiter, float* const* channels, int numSamples);
+
+/** Processes interleaved frames of numChannels samples in place. Returns 0, or -1 without touching the buffer if the limiter isn't prepared or the arguments are invalid. */
+TLIMITER_API int tlimiter_process_interleaved (TLimiter* limiter, float* frames, int numFrames);
+
+/** Writes the quality-control report of everything processed since the last reset or prepare as a null-terminated line of JSON into buffer, if it fits into bufferSize bytes. Returns the length of the report without the terminator, or -1 for invalid arguments. Collecting has to be enabled with TLIMITER_STATISTICS.
+ */
+TLIMITER_API int tlimiter_get_report (const TLimiter* limiter, char* buffer, int bufferSize);
+
+#ifdef __cplusplus
+}
+#endif
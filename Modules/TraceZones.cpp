@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    TraceZones.cpp
+
+  ==============================================================================
+*/
+
+#include "TraceZones.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstddef>
+
+TraceRecorder& TraceRecorder::getInstance()
+{
+    static TraceRecorder instance;
+    return instance;
+}
+
+TraceRecorder::TraceRecorder() : origin (now()), eventStorage (static_cast<size_t> (maxNumThreads) * eventsPerThread)
+{
+    for (size_t i = 0; i < rings.size(); ++i)
+        rings[i].events = eventStorage.data() + i * eventsPerThread;
+}
+
+int64_t TraceRecorder::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TraceRecorder::RingClaim::~RingClaim()
+{
+    // the events stay in the ring until the next thread which claims it overwrites them
+    if (ring != nullptr)
+        ring->claimed.store (false, std::memory_order_release);
+}
+
+TraceRecorder::ThreadRing* TraceRecorder::getRingForThisThread()
+{
+    thread_local RingClaim claim;
+
+    if (! claim.triedToClaim)
+    {
+        // first zone on this thread; if every ring is taken, the thread isn't recorded at all
+        claim.triedToClaim = true;
+
+        for (auto& ring : rings)
+        {
+            bool expected = false;
+            if (! ring.claimed.load (std::memory_order_relaxed) && ring.claimed.compare_exchange_strong (expected, true, std::memory_order_acquire))
+            {
+                ring.threadId = numThreadsSeen.fetch_add (1, std::memory_order_relaxed) + 1;
+                claim.ring = &ring;
+                break;
+            }
+        }
+    }
+
+    return claim.ring;
+}
+
+void TraceRecorder::record (const char* name, const int64_t beginInNanoseconds, const int64_t endInNanoseconds)
+{
+    auto* ring = getRingForThisThread();
+    if (ring == nullptr)
+        return;
+
+    const auto index = ring->numWritten.load (std::memory_order_relaxed);
+    ring->events[index % eventsPerThread] = { name, beginInNanoseconds, endInNanoseconds, ring->threadId };
+    ring->numWritten.store (index + 1, std::memory_order_release);
+}
+
+void TraceRecorder::writeChromeTrace (std::ostream& output)
+{
+    // copy first, then stream, so a slow output doesn't let the writers lap us
+    std::vector<Event> events;
+    events.reserve (eventStorage.size());
+
+    for (const auto& ring : rings)
+    {
+        const auto end = ring.numWritten.load (std::memory_order_acquire);
+        const auto begin = end > eventsPerThread ? end - eventsPerThread : 0;
+        const auto numCopied = events.size();
+
+        for (auto i = begin; i < end; ++i)
+            events.push_back (ring.events[i % eventsPerThread]);
+
+        // the writer might have lapped us while copying, drop everything which could have been overwritten
+        const auto endAfterCopy = ring.numWritten.load (std::memory_order_acquire);
+        const auto firstValid = endAfterCopy > eventsPerThread ? endAfterCopy - eventsPerThread : 0;
+
+        if (firstValid > begin)
+            events.erase (events.begin() + static_cast<std::ptrdiff_t> (numCopied),
+                          events.begin() + static_cast<std::ptrdiff_t> (numCopied + std::min (firstValid, end) - begin));
+    }
+
+    output << "{\"traceEvents\":[" << std::fixed << std::setprecision (3);
+    bool first = true;
+
+    for (const auto& event : events)
+    {
+        output << (first ? "" : ",")
+               << "\n{\"name\":\"" << event.name
+               << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId
+               << ",\"ts\":" << (event.beginInNanoseconds - origin) / 1000.0
+               << ",\"dur\":" << (event.endInNanoseconds - event.beginInNanoseconds) / 1000.0 << "}";
+        first = false;
+    }
+
+    output << "\n]}\n";
+}
+
+bool TraceRecorder::writeChromeTrace (const std::string& filePath)
+{
+    std::ofstream file (filePath);
+    if (! file)
+        return false;
+
+    writeChromeTrace (file);
+    return file.good();
+}
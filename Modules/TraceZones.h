@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    TraceZones.h
+
+    Compile-time switchable trace zones with Chrome / Perfetto trace export.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/**
+ Set TLIMITER_ENABLE_TRACING=1 in the preprocessor definitions to record trace zones. When it is 0 (the default), TLIMITER_TRACE_ZONE expands to nothing and tracing has no cost at all.
+ */
+#ifndef TLIMITER_ENABLE_TRACING
+ #define TLIMITER_ENABLE_TRACING 0
+#endif
+
+#if TLIMITER_ENABLE_TRACING
+ #define TLIMITER_TRACE_CONCAT_INNER(a, b) a ## b
+ #define TLIMITER_TRACE_CONCAT(a, b) TLIMITER_TRACE_CONCAT_INNER (a, b)
+
+ /** Records the time from here to the end of the enclosing scope. The name has to be a string literal. */
+ #define TLIMITER_TRACE_ZONE(name) TraceRecorder::ScopedZone TLIMITER_TRACE_CONCAT (traceZone, __LINE__) (name)
+
+ /** Allocates the recorder's rings, so the first zone on the audio thread doesn't. Call it while preparing. */
+ #define TLIMITER_TRACE_PREPARE() TraceRecorder::getInstance()
+#else
+ #define TLIMITER_TRACE_ZONE(name)
+ #define TLIMITER_TRACE_PREPARE()
+#endif
+
+#include <atomic>
+#include <array>
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstdint>
+
+/**
+ Collects the begin and end timestamps of trace zones. Every thread writes into a ring of events of its own, so recording is lock-free and wait-free. The rings come from a fixed pool, which is allocated with the recorder: the first zone on a thread claims a free ring with a compare-and-swap, and the thread hands it back when it ends. So recording never locks or allocates, and the memory is bounded no matter how many threads come and go. A thread which finds no free ring isn't recorded. When a ring is full, the oldest events are overwritten.
+
+ writeChromeTrace() can be called at any time from any thread and writes all events currently held in the rings as Chrome trace JSON, which can be opened in chrome://tracing or ui.perfetto.dev.
+ */
+class TraceRecorder
+{
+public:
+    struct Event
+    {
+        const char* name;
+        int64_t beginInNanoseconds;
+        int64_t endInNanoseconds;
+        int threadId; // a ring outlives its thread, so every event remembers who wrote it
+    };
+
+    static constexpr int eventsPerThread = 1 << 14;
+    static constexpr int maxNumThreads = 32;
+
+    /** RAII helper behind TLIMITER_TRACE_ZONE. */
+    class ScopedZone
+    {
+    public:
+        explicit ScopedZone (const char* zoneName) : recorder (getInstance()), name (zoneName), begin (now()) {}
+        ~ScopedZone() { recorder.record (name, begin, now()); }
+
+    private:
+        TraceRecorder& recorder;
+        const char* name;
+        int64_t begin;
+    };
+
+    static TraceRecorder& getInstance();
+
+    /** Monotonic timestamp in nanoseconds. */
+    static int64_t now();
+
+    /** Adds an event to the calling thread's ring. */
+    void record (const char* name, const int64_t beginInNanoseconds, const int64_t endInNanoseconds);
+
+    /** Writes the recorded events as Chrome trace JSON. The events are copied out of the rings first, so the recording threads are never held up by the output. */
+    void writeChromeTrace (std::ostream& output);
+
+    /** Writes the recorded events as Chrome trace JSON into the given file. Returns false if the file couldn't be written. */
+    bool writeChromeTrace (const std::string& filePath);
+
+private:
+    TraceRecorder();
+
+    struct ThreadRing
+    {
+        Event* events = nullptr; // eventsPerThread of them
+        std::atomic<bool> claimed { false };
+        std::atomic<uint64_t> numWritten { 0 };
+        int threadId = 0;
+    };
+
+    /** Returns the ring of the calling thread, or nullptr if the pool is exhausted. */
+    ThreadRing* getRingForThisThread();
+
+    /** Hands a thread's ring back to the pool when the thread ends. */
+    struct RingClaim
+    {
+        ~RingClaim();
+        ThreadRing* ring = nullptr;
+        bool triedToClaim = false;
+    };
+
+    const int64_t origin; // trace timestamps are relative to this
+
+    std::vector<Event> eventStorage;
+    std::array<ThreadRing, maxNumThreads> rings;
+    std::atomic<int> numThreadsSeen { 0 };
+};
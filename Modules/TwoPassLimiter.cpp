@@ -0,0 +1,308 @@
+/*
+  ==============================================================================
+
+    TwoPassLimiter.cpp
+
+  ==============================================================================
+*/
+
+#include "TwoPassLimiter.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    // the same as juce::Decibels::decibelsToGain
+    inline float decibelsToGain (const float decibels)
+    {
+        return decibels > -100.0f ? std::pow (10.0f, decibels * 0.05f) : 0.0f;
+    }
+}
+
+TwoPassLimiter::TwoPassLimiter()
+{
+    // the plug-in's default parameters
+    setThreshold (-30.0f);
+    setKnee (0.0f);
+    setRatio (std::numeric_limits<float>::infinity());
+    setAttackTime (0.03f);
+    setReleaseTime (0.15f);
+    gainReductionComputer.setMakeUpGain (0.0f);
+}
+
+bool TwoPassLimiter::beginAnalysis (const double newSampleRate, const int newNumChannels)
+{
+    sampleRate = newSampleRate;
+    numChannels = std::max (1, newNumChannels);
+
+    gainReductionComputer.prepare (sampleRate);
+    gainReductionComputer.reset();
+
+    chunk.assign (chunkSize, 0.0f);
+    position = 0;
+
+    cachedEntry.close();
+    intervals.clear();
+    numBuffered = 0;
+    numSamplesFromCache = 0;
+
+    if (cache != nullptr)
+    {
+        intervalBuffer.assign (static_cast<size_t> (numChannels) * EnvelopeCache::intervalSize, 0.0f);
+        intervalChannels.resize (static_cast<size_t> (numChannels));
+        for (int ch = 0; ch < numChannels; ++ch)
+            intervalChannels[static_cast<size_t> (ch)] = intervalBuffer.data() + static_cast<size_t> (ch) * EnvelopeCache::intervalSize;
+
+        settingsHash = getSettingsHash();
+        chainHash = settingsHash;
+    }
+
+    return envelope.create();
+}
+
+bool TwoPassLimiter::analyse (const float* const* channels, const int numSamples)
+{
+    if (cache == nullptr)
+        return computeEnvelope (channels, numSamples);
+
+    // the cache compares whole intervals, so collect one first
+    for (int start = 0; start < numSamples;)
+    {
+        const int n = std::min (numSamples - start, EnvelopeCache::intervalSize - numBuffered);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            std::copy (channels[ch] + start, channels[ch] + start + n, intervalBuffer.data() + static_cast<size_t> (ch) * EnvelopeCache::intervalSize + numBuffered);
+
+        numBuffered += n;
+        start += n;
+
+        if (numBuffered == EnvelopeCache::intervalSize && ! analyseInterval())
+            return false;
+    }
+
+    return true;
+}
+
+bool TwoPassLimiter::computeEnvelope (const float* const* channels, const int numSamples)
+{
+    float* key = chunk.data();
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        const int n = std::min (chunkSize, numSamples - start);
+
+        // side-chain: the maximum of the absolute values of all channels
+        for (int i = 0; i < n; ++i)
+            key[i] = std::abs (channels[0][start + i]);
+
+        for (int ch = 1; ch < numChannels; ++ch)
+            for (int i = 0; i < n; ++i)
+                key[i] = std::max (key[i], std::abs (channels[ch][start + i]));
+
+        gainReductionComputer.computeGainInDecibelsFromSidechainSignal (key, key, n);
+
+        if (! envelope.append (key, n))
+            return false;
+    }
+
+    return true;
+}
+
+bool TwoPassLimiter::analyseInterval()
+{
+    const int numSamples = numBuffered;
+    numBuffered = 0;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        chainHash = EnvelopeCache::hash (intervalChannels[static_cast<size_t> (ch)], static_cast<size_t> (numSamples) * sizeof (float), chainHash);
+
+    const size_t index = intervals.size();
+    if (index == 0)
+        cache->open (settingsHash, chainHash, cachedEntry);
+
+    EnvelopeCache::Interval interval { chainHash, {} };
+
+    // the same input so far, and an interval of the same length
+    const auto& cachedIntervals = cachedEntry.getIntervals();
+    bool fromCache = cachedEntry.isOpen() && index < cachedIntervals.size() && cachedIntervals[index].hash == chainHash
+                  && std::min<int64_t> (EnvelopeCache::intervalSize, cachedEntry.getNumSamples() - static_cast<int64_t> (index) * EnvelopeCache::intervalSize) == numSamples;
+
+    // the detector continues from the cached state, in case one of the next intervals differs
+    if (fromCache)
+    {
+        DspCheckpoint::Reader reader (cachedIntervals[index].detectorState);
+        fromCache = gainReductionComputer.restoreState (reader) && reader.isComplete();
+    }
+
+    if (fromCache)
+    {
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            const int n = std::min (chunkSize, numSamples - start);
+            if (! cachedEntry.readEnvelope (chunk.data(), n) || ! envelope.append (chunk.data(), n))
+                return false;
+        }
+
+        interval.detectorState = cachedIntervals[index].detectorState;
+        numSamplesFromCache += numSamples;
+    }
+    else
+    {
+        // the chain differs from here on
+        cachedEntry.close();
+
+        if (! computeEnvelope (intervalChannels.data(), numSamples))
+            return false;
+
+        gainReductionComputer.saveState (interval.detectorState);
+    }
+
+    intervals.push_back (std::move (interval));
+    return true;
+}
+
+bool TwoPassLimiter::endAnalysis()
+{
+    if (cache != nullptr && numBuffered > 0 && ! analyseInterval())
+        return false;
+
+    if (! envelope.map())
+        return false;
+
+    // an entry which already holds exactly this input stays as it is; failing to store only costs time next time
+    const int64_t numSamples = envelope.getNumSamples();
+    const bool alreadyStored = cachedEntry.isOpen() && cachedEntry.getNumSamples() == numSamples && numSamplesFromCache == numSamples;
+
+    // the entry might be the file store() replaces, which can't be removed or renamed while it's open on Windows
+    cachedEntry.close();
+
+    if (cache != nullptr && numSamples > 0 && ! alreadyStored)
+        cache->store (settingsHash, intervals, envelope);
+
+    smoothEnvelope();
+    position = 0;
+    return true;
+}
+
+uint64_t TwoPassLimiter::getSettingsHash() const
+{
+    // the fade-in and hold only shape the envelope afterwards, so they're not part of it
+    const float settings[] = { threshold, knee, ratio, attackTime, releaseTime };
+    const int32_t integers[] = { static_cast<int32_t> (detectorVersion), numChannels, decimationFactor };
+
+    uint64_t h = EnvelopeCache::hash (&sampleRate, sizeof (sampleRate), 0);
+    h = EnvelopeCache::hash (integers, sizeof (integers), h);
+    return EnvelopeCache::hash (settings, sizeof (settings), h);
+}
+
+void TwoPassLimiter::smoothEnvelope()
+{
+    float* gainReduction = envelope.getData();
+    const int64_t numSamples = envelope.getNumSamples();
+
+    if (gainReduction == nullptr)
+        return;
+
+    holdEnvelope (gainReduction, numSamples, static_cast<int> (std::round (holdTime * sampleRate)));
+
+    const int fadeInSamples = static_cast<int> (std::round (fadeInTime * sampleRate));
+
+    // the same fade table LookAheadGainReduction uses, as long as the fade-in time asks for
+    std::vector<float> fade (static_cast<size_t> (fadeInSamples + 1));
+    for (int k = 0; k <= fadeInSamples; ++k)
+        fade[static_cast<size_t> (k)] = LookAheadGainReduction::getFadeValue (fadeShape, fadeInSamples > 0 ? 1.0 - static_cast<double> (k) / fadeInSamples : 0.0);
+
+    // the fade-in state, exactly as in LookAheadGainReduction::process()
+    float nextGainReductionValue = 0.0f;
+    float peak = 0.0f;
+    int distance = fadeInSamples;
+
+    for (int64_t n = numSamples - 1; n >= 0; --n)
+    {
+        const float held = gainReduction[n];
+
+        // everything behind us is final; the ranges overlap, so the pages on their borders go as well
+        if (n % pageReleaseInterval == 0)
+            envelope.releasePages (n + 1, 2 * pageReleaseInterval);
+
+        if (held > nextGainReductionValue)
+        {
+            gainReduction[n] = nextGainReductionValue;
+            distance = std::min (distance + 1, fadeInSamples);
+        }
+        else
+        {
+            peak = held;
+            distance = std::min (1, fadeInSamples);
+        }
+
+        nextGainReductionValue = peak * fade[static_cast<size_t> (distance)];
+    }
+}
+
+void TwoPassLimiter::holdEnvelope (float* gainReduction, const int64_t numSamples, const int holdInSamples)
+{
+    if (holdInSamples <= 0)
+        return;
+
+    // A running minimum over the current and the last holdInSamples samples: a ring of the candidates, increasing in
+    // value from front to back. Every sample enters and leaves it once, so the pass is linear in the file length.
+    struct Candidate { int64_t index; float value; };
+    const int capacity = holdInSamples + 1;
+    std::vector<Candidate> candidates (static_cast<size_t> (capacity));
+    int front = 0, numCandidates = 0;
+
+    for (int64_t n = 0; n < numSamples; ++n)
+    {
+        // the one which left the window goes first, so the ring never holds more than the window
+        if (numCandidates > 0 && candidates[static_cast<size_t> (front)].index < n - holdInSamples)
+        {
+            front = (front + 1) % capacity;
+            --numCandidates;
+        }
+
+        const float value = gainReduction[n];
+
+        // the raw value is only read here, so the result can overwrite it
+        while (numCandidates > 0 && candidates[static_cast<size_t> ((front + numCandidates - 1) % capacity)].value >= value)
+            --numCandidates;
+
+        candidates[static_cast<size_t> ((front + numCandidates) % capacity)] = { n, value };
+        ++numCandidates;
+
+        // the candidates keep their own copies of the values, so the pages behind us can go until the fade comes back
+        if (n % pageReleaseInterval == 0 && n > 0)
+            envelope.releasePages (std::max<int64_t> (0, n - 2 * pageReleaseInterval), std::min<int64_t> (n, 2 * pageReleaseInterval));
+
+        gainReduction[n] = candidates[static_cast<size_t> (front)].value;
+    }
+}
+
+void TwoPassLimiter::process (float* const* channels, const int numSamples)
+{
+    const float* gainReduction = envelope.getData();
+    const int64_t numAnalysed = envelope.getNumSamples();
+    float* gain = chunk.data();
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        const int n = std::min (chunkSize, numSamples - start);
+
+        for (int i = 0; i < n; ++i)
+        {
+            const int64_t index = position + i;
+            const float reduction = gainReduction != nullptr && index < numAnalysed ? gainReduction[index] : 0.0f;
+            gain[i] = decibelsToGain (reduction + makeUpGain);
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < n; ++i)
+                channels[ch][start + i] *= gain[i];
+
+        position += n;
+
+        if (position / pageReleaseInterval != (position - n) / pageReleaseInterval)
+            envelope.releasePages (position - 2 * pageReleaseInterval, 2 * pageReleaseInterval);
+    }
+}
@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    TwoPassLimiter.h
+
+    Offline limiter with a non-causal envelope of unlimited look-ahead.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "GainReductionComputer.h"
+#include "LookAheadGainReduction.h"
+#include "EnvelopeFile.h"
+#include "EnvelopeCache.h"
+#include <algorithm>
+#include <vector>
+
+/**
+ An offline limiter which doesn't need to be causal. The first pass streams the whole file through the detector and appends the raw gain reduction of every sample to an EnvelopeFile. endAnalysis() then holds every reduction for the hold time in a forward pass, and walks the envelope backwards once to fade into every reduction over the fade-in time, with the same fades as LookAheadGainReduction, but without its 5 ms limit. The second pass streams the file again and only applies the finished envelope.
+
+ As the envelope already knows the future, the output isn't delayed at all. Memory use depends on the fade-in and hold times, not on the length of the file: the envelope stays in the mapped file.
+
+ Channels are always linked. Nothing allocates except beginAnalysis(), endAnalysis() and the setters for the fade-in and hold times.
+
+ With an EnvelopeCache, the first pass looks the raw envelope up instead of running the detector on an input it has seen before with the same detector settings. The fade-in and hold are applied afterwards, so they and the make-up gain can be changed without a miss.
+ */
+class TwoPassLimiter
+{
+public:
+    TwoPassLimiter();
+
+    // ======================================================================
+    void setThreshold (const float thresholdInDecibels) { threshold = thresholdInDecibels; gainReductionComputer.setThreshold (thresholdInDecibels); }
+    void setKnee (const float kneeInDecibels) { knee = kneeInDecibels; gainReductionComputer.setKnee (kneeInDecibels); }
+    void setRatio (const float newRatio) { ratio = newRatio; gainReductionComputer.setRatio (newRatio); }
+    void setAttackTime (const float attackTimeInSeconds) { attackTime = attackTimeInSeconds; gainReductionComputer.setAttackTime (attackTimeInSeconds); }
+    void setReleaseTime (const float releaseTimeInSeconds) { releaseTime = releaseTimeInSeconds; gainReductionComputer.setReleaseTime (releaseTimeInSeconds); }
+    void setDecimationFactor (const int factor) { decimationFactor = std::max (1, factor); gainReductionComputer.setDecimationFactor (decimationFactor); }
+
+    /** Only used by the second pass, so it can be changed without analysing again. */
+    void setMakeUpGain (const float makeUpGainInDecibels) { makeUpGain = makeUpGainInDecibels; }
+
+    /** How long before a reduction the fade into it starts. Takes effect with the next endAnalysis(). */
+    void setFadeInTime (const float fadeInTimeInSeconds) { fadeInTime = fadeInTimeInSeconds > 0.0f ? fadeInTimeInSeconds : 0.0f; }
+    void setFadeShape (const LookAheadGainReduction::FadeShape shape) { fadeShape = shape; }
+
+    /** How long every reduction is held after it, before the release sets in. Takes effect with the next endAnalysis(). */
+    void setHoldTime (const float holdTimeInSeconds) { holdTime = holdTimeInSeconds > 0.0f ? holdTimeInSeconds : 0.0f; }
+
+    /** Looks the raw envelope up in the given cache, and stores it there, from the next beginAnalysis() on. The cache isn't owned; pass nullptr to stop using it.
+     */
+    void setEnvelopeCache (EnvelopeCache* cacheToUse) { cache = cacheToUse; }
+
+    // ======================================================================
+    /** Starts the first pass over a new file. Returns false if the envelope file can't be created. */
+    bool beginAnalysis (const double sampleRate, const int numChannels);
+
+    /** Feeds the next samples of the first pass. Returns false if the envelope can't be written. */
+    bool analyse (const float* const* channels, const int numSamples);
+
+    /** Smooths the envelope and starts the second pass at the beginning of the file. Returns false if the envelope can't be mapped. */
+    bool endAnalysis();
+
+    /** Starts the second pass over again, e.g. with a different make-up gain. */
+    void rewind() { position = 0; }
+
+    /** Applies the envelope to the next samples of the second pass, in place. Samples beyond the analysed length only get the make-up gain. */
+    void process (float* const* channels, const int numSamples);
+
+    int64_t getNumAnalysedSamples() const { return envelope.getNumSamples(); }
+
+    /** How many samples of the last analysis were read from the cache instead of running through the detector. */
+    int64_t getNumSamplesFromCache() const { return numSamplesFromCache; }
+
+    /** The smoothed gain reduction in decibels, one value per sample; nullptr before endAnalysis(). */
+    const float* getEnvelope() const { return envelope.getData(); }
+
+    /** Part of every cache key. Bump it whenever a change to GainReductionComputer changes its output, so envelopes it computed before aren't served any more. */
+    static constexpr uint32_t detectorVersion = 1;
+
+private:
+    static constexpr int chunkSize = 1024;
+
+    /** The passes over the mapped envelope hand back the pages they're done with every this many samples. */
+    static constexpr int pageReleaseInterval = 1 << 18;
+
+    /** Runs the detector over the samples and appends the raw gain reduction to the envelope. */
+    bool computeEnvelope (const float* const* channels, const int numSamples);
+
+    /** With a cache: hashes the buffered interval, then copies its envelope from the cache entry if that has the same input so far, or computes it. */
+    bool analyseInterval();
+
+    /** Everything the raw envelope depends on. */
+    uint64_t getSettingsHash() const;
+
+    /** The hold, then the backward pass which fades into every reduction, in place. */
+    void smoothEnvelope();
+
+    /** The forward pass: every sample becomes the strongest reduction of itself and the holdInSamples samples before it. */
+    void holdEnvelope (float* gainReduction, const int64_t numSamples, const int holdInSamples);
+
+    GainReductionComputer gainReductionComputer;
+    EnvelopeFile envelope;
+
+    double sampleRate = 0.0;
+    int numChannels = 0;
+
+    // the detector settings, for the cache's key
+    float threshold = 0.0f, knee = 0.0f, ratio = 0.0f, attackTime = 0.0f, releaseTime = 0.0f;
+    int decimationFactor = 1;
+
+    float makeUpGain = 0.0f;
+    float fadeInTime = 0.005f;
+    float holdTime = 0.0f;
+    LookAheadGainReduction::FadeShape fadeShape = LookAheadGainReduction::FadeShape::linear;
+
+    std::vector<float> chunk;
+    int64_t position = 0;
+
+    // the cache, and the input buffered until an interval is complete
+    EnvelopeCache* cache = nullptr;
+    EnvelopeCache::Entry cachedEntry;
+    std::vector<EnvelopeCache::Interval> intervals;
+    std::vector<float> intervalBuffer;
+    std::vector<const float*> intervalChannels;
+    int numBuffered = 0;
+    uint64_t settingsHash = 0, chainHash = 0;
+    int64_t numSamplesFromCache = 0;
+};
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    WakeSemaphore.cpp
+
+  ==============================================================================
+*/
+
+#include "WakeSemaphore.h"
+#include <cerrno>
+#include <climits>
+
+#if defined (_WIN32)
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#endif
+
+#if defined (_WIN32)
+
+WakeSemaphore::WakeSemaphore() : handle (CreateSemaphoreW (nullptr, 0, LONG_MAX, nullptr)) {}
+WakeSemaphore::~WakeSemaphore() { CloseHandle (static_cast<HANDLE> (handle)); }
+
+void WakeSemaphore::post (const int count)
+{
+    if (count > 0)
+        ReleaseSemaphore (static_cast<HANDLE> (handle), count, nullptr);
+}
+
+void WakeSemaphore::wait()
+{
+    WaitForSingleObject (static_cast<HANDLE> (handle), INFINITE);
+}
+
+#elif defined (__APPLE__)
+
+WakeSemaphore::WakeSemaphore() : semaphore (dispatch_semaphore_create (0)) {}
+WakeSemaphore::~WakeSemaphore() { dispatch_release (semaphore); }
+
+void WakeSemaphore::post (const int count)
+{
+    for (int i = 0; i < count; ++i)
+        dispatch_semaphore_signal (semaphore);
+}
+
+void WakeSemaphore::wait()
+{
+    dispatch_semaphore_wait (semaphore, DISPATCH_TIME_FOREVER);
+}
+
+#else
+
+WakeSemaphore::WakeSemaphore() { sem_init (&semaphore, 0, 0); }
+WakeSemaphore::~WakeSemaphore() { sem_destroy (&semaphore); }
+
+void WakeSemaphore::post (const int count)
+{
+    for (int i = 0; i < count; ++i)
+        sem_post (&semaphore);
+}
+
+void WakeSemaphore::wait()
+{
+    // a signal handler may interrupt the wait, the token is still there then
+    while (sem_wait (&semaphore) != 0 && errno == EINTR)
+    {
+    }
+}
+
+#endif
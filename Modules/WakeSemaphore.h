@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    WakeSemaphore.h
+
+    A counting semaphore whose post never takes a lock, to wake worker threads from the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#if defined (_WIN32)
+ // HANDLE is a void*, so windows.h stays out of the header
+#elif defined (__APPLE__)
+ #include <dispatch/dispatch.h>
+#else
+ #include <semaphore.h>
+#endif
+
+/**
+ A counting semaphore on the OS primitive which wakes a sleeping thread without any user-space lock: a futex-based sem_t on Linux, a dispatch semaphore on macOS and a kernel semaphore on Windows. post() doesn't wait for anything, so the audio thread can use it to wake workers; std::condition_variable would need the sleepers' mutex for that.
+ */
+class WakeSemaphore
+{
+public:
+    WakeSemaphore();
+    ~WakeSemaphore();
+
+    /** Adds count tokens, waking up to count waiting threads. Never blocks. */
+    void post (const int count = 1);
+
+    /** Takes a token, and sleeps until there is one. */
+    void wait();
+
+private:
+   #if defined (_WIN32)
+    void* handle;
+   #elif defined (__APPLE__)
+    dispatch_semaphore_t semaphore;
+   #else
+    sem_t semaphore;
+   #endif
+
+    WakeSemaphore (const WakeSemaphore&) = delete;
+    WakeSemaphore& operator= (const WakeSemaphore&) = delete;
+};
@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    WorkerPool.cpp
+
+  ==============================================================================
+*/
+
+#include "WorkerPool.h"
+#include <chrono>
+
+#if defined (_WIN32)
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#else
+ #include <pthread.h>
+ #include <sched.h>
+#endif
+
+void WorkerPool::start (const int numThreads)
+{
+    stop();
+
+    shouldExit = false;
+    for (int i = 0; i < numThreads; ++i)
+    {
+        threads.emplace_back ([this] { workerLoop(); });
+        setRealtimePriority (threads.back());
+    }
+}
+
+void WorkerPool::stop()
+{
+    shouldExit = true;
+    wakeSleepers();
+
+    for (auto& thread : threads)
+        thread.join();
+
+    threads.clear();
+}
+
+void WorkerPool::setRealtimePriority (std::thread& thread)
+{
+    // best effort: without the privileges, the worker just keeps the default priority
+   #if defined (_WIN32)
+    SetThreadPriority (static_cast<HANDLE> (thread.native_handle()), THREAD_PRIORITY_TIME_CRITICAL);
+   #else
+    sched_param parameters {};
+    parameters.sched_priority = sched_get_priority_max (SCHED_FIFO) - 1;
+    pthread_setschedparam (thread.native_handle(), SCHED_FIFO, &parameters);
+   #endif
+}
+
+void WorkerPool::run (const int numTasks, TaskFunction function, void* context)
+{
+    if (numTasks <= 0)
+        return;
+
+    if (threads.empty() || numTasks == 1)
+    {
+        for (int i = 0; i < numTasks; ++i)
+            function (context, i);
+        return;
+    }
+
+    // the previous job is completely done, and the one before it (which used this slot) as well
+    const uint32_t generation = getGeneration() + 1;
+    auto& job = jobs[generation & 1];
+    job.function.store (function, std::memory_order_relaxed);
+    job.context.store (context, std::memory_order_relaxed);
+    job.numTasks.store (numTasks, std::memory_order_relaxed);
+    numTasksDone.store (0, std::memory_order_relaxed);
+
+    // publish the job, then wake the sleepers (both sequentially consistent, so a worker going to sleep right now can't miss it)
+    jobState.store (static_cast<uint64_t> (generation) << 32);
+    wakeSleepers();
+
+    processTasks();
+
+    // join: wait for the tasks still running on the workers
+    while (numTasksDone.load (std::memory_order_acquire) < numTasks)
+        std::this_thread::yield();
+}
+
+void WorkerPool::processTasks()
+{
+    uint64_t state = jobState.load (std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto& job = jobs[(state >> 32) & 1];
+        const int taskIndex = static_cast<int> (state & 0xffffffff);
+
+        if (taskIndex >= job.numTasks.load (std::memory_order_relaxed))
+            return;
+
+        // claim the task; fails if another thread claimed it first, or a new job was published in the meantime
+        if (jobState.compare_exchange_weak (state, state + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            job.function.load (std::memory_order_relaxed) (job.context.load (std::memory_order_relaxed), taskIndex);
+            numTasksDone.fetch_add (1, std::memory_order_release);
+            state = jobState.load (std::memory_order_acquire);
+        }
+    }
+}
+
+void WorkerPool::workerLoop()
+{
+    uint32_t lastGeneration = getGeneration();
+
+    while (! shouldExit.load())
+    {
+        processTasks();
+
+        // spin for a short while, the next callback's job usually isn't far away
+        const auto spinEnd = std::chrono::steady_clock::now() + std::chrono::microseconds (spinTimeInMicroseconds);
+        while (getGeneration() == lastGeneration && ! shouldExit.load() && std::chrono::steady_clock::now() < spinEnd)
+            std::this_thread::yield();
+
+        sleep (lastGeneration);
+        lastGeneration = getGeneration();
+    }
+}
+
+void WorkerPool::wakeSleepers()
+{
+    if (const int numToWake = numSleeping.exchange (0))
+        wakeSemaphore.post (numToWake);
+}
+
+void WorkerPool::sleep (const uint32_t lastGeneration)
+{
+    // count ourselves first, then check: either we see the new job, or its publisher sees us and posts a token
+    numSleeping.fetch_add (1);
+
+    if (getGeneration() == lastGeneration && ! shouldExit.load())
+    {
+        wakeSemaphore.wait();
+        return;
+    }
+
+    // we don't need to sleep; take ourselves off the count, unless a publisher counted us already and owes us a token
+    int count = numSleeping.load();
+    while (count > 0 && ! numSleeping.compare_exchange_weak (count, count - 1))
+    {
+    }
+
+    if (count == 0)
+        wakeSemaphore.wait();
+}
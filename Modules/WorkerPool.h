@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    WorkerPool.h
+
+    A small fork-join pool of pre-spawned real-time worker threads.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include "WakeSemaphore.h"
+
+/**
+ A fork-join pool for distributing independent tasks of one audio callback over several cores. The threads are spawned once in start() (not on the audio thread) and get the highest scheduling priority the OS grants us.
+
+ parallelFor() hands out the tasks through a shared atomic counter: every thread, including the calling audio thread, keeps claiming the next unprocessed task until none is left, so threads which finish early take over the work of slower ones. The call returns once all tasks are done. Workers spin briefly after each job before they go to sleep, so back-to-back jobs don't pay the wake-up latency; sleeping workers are woken through a WakeSemaphore, so parallelFor() never takes a lock.
+
+ Every job costs a hand-off, so callers should hand out few, large tasks: one per group of channels and host block, rather than one per sub-block.
+ */
+class WorkerPool
+{
+public:
+    WorkerPool() {}
+    ~WorkerPool() { stop(); }
+
+    /** Spawns the worker threads. Stops a running pool first. */
+    void start (const int numThreads);
+
+    /** Joins all worker threads. */
+    void stop();
+
+    int getNumThreads() const { return static_cast<int> (threads.size()); }
+
+    /** Calls function (taskIndex) for every taskIndex in [0, numTasks), distributed over the calling thread and the workers. Returns when all tasks are done. Doesn't allocate.
+     */
+    template <typename Function>
+    void parallelFor (const int numTasks, Function& function)
+    {
+        run (numTasks, [] (void* context, int taskIndex) { (*static_cast<Function*> (context)) (taskIndex); }, &function);
+    }
+
+    /** Gives the thread the highest scheduling priority the OS grants us, best effort. */
+    static void setRealtimePriority (std::thread& thread);
+
+private:
+    using TaskFunction = void (*) (void* context, int taskIndex);
+
+    struct Job
+    {
+        std::atomic<TaskFunction> function { nullptr };
+        std::atomic<void*> context { nullptr };
+        std::atomic<int> numTasks { 0 };
+    };
+
+    void run (const int numTasks, TaskFunction function, void* context);
+    void workerLoop();
+    void processTasks();
+    uint32_t getGeneration() const { return static_cast<uint32_t> (jobState.load() >> 32); }
+
+    static constexpr int spinTimeInMicroseconds = 100;
+
+    std::vector<std::thread> threads;
+    std::atomic<bool> shouldExit { false };
+
+    // Two job slots, used alternately. The job state packs the job's generation (upper 32 bits) and the index of the
+    // next unclaimed task (lower 32 bits), so a thread which is late for a job can never claim a task of the next one.
+    Job jobs[2];
+    std::atomic<uint64_t> jobState { 0 };
+    std::atomic<int> numTasksDone { 0 };
+
+    // Workers which are about to sleep count themselves in numSleeping; whoever publishes a job takes the count and posts
+    // as many tokens. A worker which finds work after counting itself takes itself off again, or takes its token.
+    WakeSemaphore wakeSemaphore;
+    std::atomic<int> numSleeping { 0 };
+
+    void wakeSleepers();
+    void sleep (const uint32_t lastGeneration);
+};
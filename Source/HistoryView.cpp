@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    HistoryView.cpp
+
+  ==============================================================================
+*/
+
+#include "HistoryView.h"
+
+HistoryView::HistoryView (TLimiterAudioProcessor& p) : audioProcessor (p)
+{
+}
+
+int64 HistoryView::getLiveEndColumn() const
+{
+    if (samplesPerColumn == 0)
+        return 0;
+
+    // both are pushed together, but the audio thread may be between the two
+    const int64 numSamples = jmin(audioProcessor.getInputLevelHistory().getNumSamples(samplesPerColumn),
+                                  audioProcessor.getGainReductionHistory().getNumSamples(samplesPerColumn));
+    return numSamples / samplesPerColumn;
+}
+
+int64 HistoryView::getEndColumn() const
+{
+    return followingLive ? getLiveEndColumn() : endColumn;
+}
+
+void HistoryView::refresh()
+{
+    const auto& history = audioProcessor.getInputLevelHistory();
+    if (history.getNumLevels() == 0)
+        return;
+
+    if (samplesPerColumn == 0)
+        samplesPerColumn = jmax(static_cast<int64> (history.getSamplesPerBin()),
+                                static_cast<int64> (defaultLengthInSeconds * audioProcessor.getSampleRate()) / jmax(1, getWidth()));
+
+    if (getEndColumn() != paintedEndColumn)
+        repaint();
+}
+
+void HistoryView::paint (Graphics& g)
+{
+    g.setColour(Colours::black.withAlpha(0.4f));
+    g.fillRect(getLocalBounds());
+
+    if (samplesPerColumn == 0)
+        return;
+
+    const auto& levels = audioProcessor.getInputLevelHistory();
+    const auto& gainReductions = audioProcessor.getGainReductionHistory();
+
+    const int width = getWidth();
+    const float height = static_cast<float> (getHeight());
+    paintedEndColumn = getEndColumn();
+
+    // 0 dB at the top, the bottom of the range at the bottom
+    auto toY = [height] (float decibels) { return height * jlimit(0.0f, 1.0f, decibels / rangeInDecibels); };
+    MinMaxPyramid::Range range;
+
+    g.setColour(Colours::lightgreen.withAlpha(0.8f));
+    for (int x = 0; x < width; ++x)
+    {
+        const int64 start = (paintedEndColumn - width + x) * samplesPerColumn;
+        if (levels.getRange(start, start + samplesPerColumn, range) && ! range.isEmpty())
+            g.drawVerticalLine(x, toY(range.maximum), jmax(toY(range.minimum), toY(range.maximum) + 1.0f));
+    }
+
+    // gain reduction hangs down from the top, as far as the strongest one in the column
+    g.setColour(Colours::orange.withAlpha(0.8f));
+    for (int x = 0; x < width; ++x)
+    {
+        const int64 start = (paintedEndColumn - width + x) * samplesPerColumn;
+        if (gainReductions.getRange(start, start + samplesPerColumn, range) && range.minimum < 0.0f)
+            g.drawVerticalLine(x, 0.0f, toY(range.minimum));
+    }
+
+    const double lengthInSeconds = static_cast<double> (width * samplesPerColumn) / audioProcessor.getSampleRate();
+    g.setFont(11.0f);
+    g.setColour(Colours::white.withAlpha(0.6f));
+    g.drawText((followingLive ? String() : String("Paused  ")) + String(lengthInSeconds, lengthInSeconds < 10.0 ? 1 : 0) + " s",
+               getLocalBounds().reduced(4, 2), Justification::topRight);
+}
+
+void HistoryView::setSamplesPerColumn (int64 newSamplesPerColumn, int anchorX)
+{
+    // from one bin per column to the whole history across the view
+    const auto& history = audioProcessor.getInputLevelHistory();
+    const int64 minSamplesPerColumn = history.getSamplesPerBin();
+    const int64 maxSamplesPerColumn = jmax(minSamplesPerColumn, static_cast<int64> (history.getLengthInSamples()) / jmax(1, getWidth()));
+    newSamplesPerColumn = jlimit(minSamplesPerColumn, maxSamplesPerColumn, newSamplesPerColumn);
+
+    const int anchor = jlimit(0, getWidth(), anchorX);
+    const int64 anchorSample = (getEndColumn() - getWidth() + anchor) * samplesPerColumn;
+
+    samplesPerColumn = newSamplesPerColumn;
+
+    // while following, the right edge stays live
+    if (! followingLive)
+        endColumn = jmin(getLiveEndColumn(), anchorSample / samplesPerColumn + getWidth() - anchor);
+
+    repaint();
+}
+
+void HistoryView::mouseWheelMove (const MouseEvent& event, const MouseWheelDetails& wheel)
+{
+    if (samplesPerColumn == 0 || wheel.deltaY == 0.0f)
+        return;
+
+    // up zooms in; always by at least a sample, so the smallest zooms don't get stuck
+    const auto scaled = static_cast<int64> (std::llround(samplesPerColumn * std::pow(2.0, -2.0 * wheel.deltaY)));
+    const int64 newSamplesPerColumn = wheel.deltaY > 0.0f ? jmin(scaled, samplesPerColumn - 1) : jmax(scaled, samplesPerColumn + 1);
+
+    setSamplesPerColumn(newSamplesPerColumn, event.x);
+}
+
+void HistoryView::mouseDown (const MouseEvent&)
+{
+    dragStartEndColumn = getEndColumn();
+}
+
+void HistoryView::mouseDrag (const MouseEvent& event)
+{
+    if (samplesPerColumn == 0)
+        return;
+
+    // dragging to the right pulls older history into view; back at the live end, it follows again
+    const int64 liveEndColumn = getLiveEndColumn();
+    endColumn = jmin(liveEndColumn, dragStartEndColumn - event.getDistanceFromDragStartX());
+    followingLive = endColumn == liveEndColumn;
+    repaint();
+}
+
+void HistoryView::mouseDoubleClick (const MouseEvent&)
+{
+    followingLive = true;
+    repaint();
+}
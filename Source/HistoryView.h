@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    HistoryView.h
+
+    A scrollable, zoomable plot of the input level and gain reduction history.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+using namespace juce;
+
+//==============================================================================
+/**
+ Draws the last minutes of input level and gain reduction from the processor's MinMaxPyramids, one vertical line from the minimum to the maximum per pixel column, so a repaint costs the same at every zoom.
+
+ The mouse wheel zooms around the pointer, dragging scrolls back in time and a double-click returns to following the live signal. The columns sit on whole multiples of the zoom on the timeline, so the picture doesn't shimmer while it scrolls.
+ */
+class HistoryView : public Component
+{
+public:
+    explicit HistoryView (TLimiterAudioProcessor& processor);
+
+    /** Repaints if the view moved on. Call it on every display refresh. */
+    void refresh();
+
+    void paint (Graphics& g) override;
+
+    void mouseWheelMove (const MouseEvent& event, const MouseWheelDetails& wheel) override;
+    void mouseDown (const MouseEvent& event) override;
+    void mouseDrag (const MouseEvent& event) override;
+    void mouseDoubleClick (const MouseEvent& event) override;
+
+    static constexpr float rangeInDecibels = -60.0f;
+    static constexpr double defaultLengthInSeconds = 10.0;
+
+private:
+    /** The column after the last one shown; while following, the newest one both histories have complete. */
+    int64 getEndColumn() const;
+    int64 getLiveEndColumn() const;
+
+    /** Zooms so the moment at anchorX stays where it is. */
+    void setSamplesPerColumn (int64 newSamplesPerColumn, int anchorX);
+
+    TLimiterAudioProcessor& audioProcessor;
+
+    int64 samplesPerColumn = 0; // 0 until the processor was prepared
+    bool followingLive = true;
+    int64 endColumn = 0; // while not following
+    int64 dragStartEndColumn = 0;
+    int64 paintedEndColumn = -1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HistoryView)
+};
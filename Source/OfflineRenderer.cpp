@@ -0,0 +1,722 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+#include <fstream>
+
+//==============================================================================
+void OfflineRenderer::BlockQueue::push(int blockIndex)
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+    jassert(size1 == 1); // there are never more blocks than entries
+
+    indices[static_cast<size_t> (start1)] = blockIndex;
+    fifo.finishedWrite(1);
+    blockAvailable.signal();
+}
+
+int OfflineRenderer::BlockQueue::pop(const std::atomic<bool>& cancelled)
+{
+    while (fifo.getNumReady() == 0)
+    {
+        if (cancelled.load())
+            return -1;
+
+        blockAvailable.wait(1);
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(1, start1, size1, start2, size2);
+    const int blockIndex = indices[static_cast<size_t> (start1)];
+    fifo.finishedRead(1);
+
+    return blockIndex;
+}
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer(AudioProcessor& processorToUse, int blockSizeToUse, int numBlocksToUse)
+    : processor(processorToUse),
+      blockSize(jmax(1, blockSizeToUse)),
+      numBlocks(jmax(3, numBlocksToUse)), // at least one block per stage
+      blocks(static_cast<size_t> (numBlocks)),
+      freeBlocks(numBlocks), decodedBlocks(numBlocks), processedBlocks(numBlocks)
+{
+}
+
+Result OfflineRenderer::render(const File& inputFile, const File& outputFile)
+{
+    return renderFile(inputFile, outputFile, [this](AudioFormatReader& reader, AudioFormatWriter& writer) { return render(reader, writer); });
+}
+
+Result OfflineRenderer::renderTwoPass(const File& inputFile, const File& outputFile, TwoPassLimiter& limiter)
+{
+    return renderFile(inputFile, outputFile, [&](AudioFormatReader& reader, AudioFormatWriter& writer) { return renderTwoPass(reader, writer, limiter); });
+}
+
+Result OfflineRenderer::renderFile(const File& inputFile, const File& outputFile, const std::function<Result(AudioFormatReader&, AudioFormatWriter&)>& renderWith)
+{
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(inputFile));
+    if (reader == nullptr)
+        return Result::fail("Can't read " + inputFile.getFullPathName());
+
+    outputFile.deleteFile();
+    std::unique_ptr<FileOutputStream> stream(outputFile.createOutputStream());
+    if (stream == nullptr)
+        return Result::fail("Can't write " + outputFile.getFullPathName());
+
+    WavAudioFormat wavFormat;
+    std::unique_ptr<AudioFormatWriter> writer(wavFormat.createWriterFor(stream.get(), reader->sampleRate, reader->numChannels,
+                                                                        static_cast<int> (reader->bitsPerSample), {}, 0));
+    if (writer == nullptr)
+        return Result::fail("Can't write WAV files with " + String(reader->numChannels) + " channels and " + String(reader->bitsPerSample) + " bit");
+
+    stream.release(); // the writer owns it now
+
+    const auto result = renderWith(*reader, *writer);
+    if (result.failed() || ! collectsRenderStatistics)
+        return result;
+
+    const auto reportFile = outputFile.withFileExtension("json");
+    std::ofstream report(reportFile.getFullPathName().toStdString());
+    renderStatistics.writeJson(report);
+    report << '\n';
+
+    return report.good() ? result : Result::fail("Can't write " + reportFile.getFullPathName());
+}
+
+Result OfflineRenderer::render(AudioFormatReader& reader, AudioFormatWriter& writer)
+{
+    const int numChannels = static_cast<int> (reader.numChannels);
+    const double sampleRate = reader.sampleRate;
+
+    processor.setNonRealtime(true);
+    processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+    if (processor.getTotalNumInputChannels() != numChannels)
+        return Result::fail("The processor doesn't support " + String(numChannels) + " channels");
+
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    // the latency is known after preparing
+    const int latencyInSamples = processor.getLatencySamples();
+
+    for (auto& block : blocks)
+    {
+        block.buffer.setSize(numChannels, blockSize);
+        block.numSamples = 0;
+        block.isLast = false;
+    }
+
+    freeBlocks.reset();
+    decodedBlocks.reset();
+    processedBlocks.reset();
+    for (int i = 0; i < numBlocks; ++i)
+        freeBlocks.push(i);
+
+    cancelled = false;
+    errorMessage.clear();
+    statistics = {};
+    statistics.numSamples = reader.lengthInSamples;
+
+    if (collectsRenderStatistics)
+        renderStatistics.prepare(sampleRate, numChannels, blockSize);
+
+    TLIMITER_TRACE_PREPARE();
+
+    // checkpoints on a grid of whole blocks, so a re-render cuts the input into the same blocks
+    auto* checkpointable = dynamic_cast<CheckpointableProcessor*> (&processor);
+    const bool saveCheckpoints = checkpointable != nullptr && checkpointIntervalInSeconds > 0.0 && checkpointable->canSaveCheckpoints();
+    const int64 checkpointSpacing = static_cast<int64> (jmax(1, roundToInt(checkpointIntervalInSeconds * sampleRate / blockSize))) * blockSize;
+
+    checkpoints.clear();
+    checkpointedSampleRate = sampleRate;
+    checkpointedNumChannels = numChannels;
+    checkpointedLength = reader.lengthInSamples;
+    checkpointedLatency = latencyInSamples;
+
+    const auto startTime = Time::getHighResolutionTicks();
+
+    std::thread decoder([&] { decode(reader, reader.lengthInSamples, latencyInSamples); });
+    std::thread encoder([&] { encode(writer, latencyInSamples, reader.lengthInSamples, collectsRenderStatistics ? &renderStatistics : nullptr); });
+
+    // the processing stage runs right here
+    MidiBuffer midiMessages;
+    int64 position = 0;
+    for (;;)
+    {
+        const int blockIndex = decodedBlocks.pop(cancelled);
+        if (blockIndex < 0)
+            break;
+
+        TLIMITER_TRACE_ZONE("render: process");
+        auto& block = blocks[static_cast<size_t> (blockIndex)];
+        const auto processStart = Time::getHighResolutionTicks();
+
+        if (saveCheckpoints && position % checkpointSpacing == 0)
+        {
+            checkpoints.push_back({ position, {} });
+            checkpointable->saveCheckpoint(checkpoints.back().state);
+        }
+
+        if (block.numSamples > 0)
+        {
+            // same channels, fewer samples: just a smaller view into the same memory
+            block.buffer.setSize(numChannels, block.numSamples, true, false, true);
+            processor.processBlock(block.buffer, midiMessages);
+            midiMessages.clear();
+        }
+
+        position += block.numSamples;
+        statistics.processSeconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - processStart);
+
+        const bool isLast = block.isLast;
+        processedBlocks.push(blockIndex);
+
+        if (isLast)
+            break;
+    }
+
+    decoder.join();
+    encoder.join();
+
+    processor.releaseResources();
+    writer.flush();
+
+    statistics.numSamplesProcessed = position;
+    statistics.totalSeconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTime);
+
+    if (collectsRenderStatistics)
+        renderStatistics.flush();
+
+    // after a failure as well, the trace might show why; the first error is the one reported
+   #if TLIMITER_ENABLE_TRACING
+    if (traceFile != File() && ! TraceRecorder::getInstance().writeChromeTrace(traceFile.getFullPathName().toStdString()))
+        cancel("Can't write " + traceFile.getFullPathName());
+   #endif
+
+    if (cancelled.load())
+    {
+        checkpoints.clear();
+        return Result::fail(errorMessage);
+    }
+
+    return Result::ok();
+}
+
+Result OfflineRenderer::renderTwoPass(AudioFormatReader& reader, AudioFormatWriter& writer, TwoPassLimiter& limiter)
+{
+    const int numChannels = static_cast<int> (reader.numChannels);
+    const int64 length = reader.lengthInSamples;
+
+    statistics = {};
+    statistics.numSamples = length;
+
+    if (collectsRenderStatistics)
+        renderStatistics.prepare(reader.sampleRate, numChannels, blockSize);
+
+    TLIMITER_TRACE_PREPARE();
+    const auto startTime = Time::getHighResolutionTicks();
+
+    if (envelopeCache != nullptr)
+        limiter.setEnvelopeCache(envelopeCache.get());
+
+    AudioBuffer<float> buffer(numChannels, blockSize);
+    Result result = limiter.beginAnalysis(reader.sampleRate, numChannels) ? Result::ok() : Result::fail("Can't create the envelope file");
+
+    // first pass: the detector writes the raw envelope
+    for (int64 position = 0; result.wasOk() && position < length; position += blockSize)
+    {
+        const int numSamples = static_cast<int> (jmin(static_cast<int64> (blockSize), length - position));
+        if (! readBlock(reader, buffer, position, numSamples))
+        {
+            result = Result::fail("Reading failed at sample " + String(position));
+            break;
+        }
+
+        TLIMITER_TRACE_ZONE("render: analyse");
+        const auto processStart = Time::getHighResolutionTicks();
+
+        if (! limiter.analyse(buffer.getArrayOfReadPointers(), numSamples))
+            result = Result::fail("Writing the envelope failed at sample " + String(position));
+
+        statistics.processSeconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - processStart);
+    }
+
+    // the hold, and the backward pass which fades into every reduction
+    if (result.wasOk())
+    {
+        TLIMITER_TRACE_ZONE("render: smooth");
+        const auto processStart = Time::getHighResolutionTicks();
+
+        if (! limiter.endAnalysis())
+            result = Result::fail("Can't map the envelope");
+
+        statistics.processSeconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - processStart);
+        statistics.numSamplesFromCache = limiter.getNumSamplesFromCache();
+    }
+
+    // the entry is stored by now; the limiter mustn't keep a cache which the renderer might delete
+    if (envelopeCache != nullptr)
+    {
+        limiter.setEnvelopeCache(nullptr);
+        envelopeCache->evict(envelopeCacheMaxBytes);
+    }
+
+    // second pass: the file again, with the envelope applied; nothing is delayed, so nothing is dropped
+    for (int64 position = 0; result.wasOk() && position < length; position += blockSize)
+    {
+        const int numSamples = static_cast<int> (jmin(static_cast<int64> (blockSize), length - position));
+        if (! readBlock(reader, buffer, position, numSamples))
+        {
+            result = Result::fail("Reading failed at sample " + String(position));
+            break;
+        }
+
+        {
+            TLIMITER_TRACE_ZONE("render: process");
+            const auto processStart = Time::getHighResolutionTicks();
+            limiter.process(buffer.getArrayOfWritePointers(), numSamples);
+            statistics.processSeconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - processStart);
+        }
+
+        TLIMITER_TRACE_ZONE("render: encode");
+        const auto encodeStart = Time::getHighResolutionTicks();
+
+        if (! writer.writeFromAudioSampleBuffer(buffer, 0, numSamples))
+        {
+            result = Result::fail("Writing failed at sample " + String(position));
+            break;
+        }
+
+        if (collectsRenderStatistics)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                renderStatistics.addOutput(buffer.getReadPointer(ch), numSamples, ch);
+
+            renderStatistics.endBlock(numSamples);
+        }
+
+        statistics.encodeSeconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - encodeStart);
+        statistics.numSamplesProcessed += numSamples;
+    }
+
+    writer.flush();
+    statistics.totalSeconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTime);
+
+    if (collectsRenderStatistics)
+        renderStatistics.flush();
+
+   #if TLIMITER_ENABLE_TRACING
+    if (traceFile != File() && ! TraceRecorder::getInstance().writeChromeTrace(traceFile.getFullPathName().toStdString()) && result.wasOk())
+        result = Result::fail("Can't write " + traceFile.getFullPathName());
+   #endif
+
+    return result;
+}
+
+void OfflineRenderer::setEnvelopeCacheDirectory(const File& directory, uint64 maxNumBytes)
+{
+    envelopeCacheMaxBytes = maxNumBytes;
+    envelopeCache.reset();
+
+    if (directory != File() && directory.createDirectory().wasOk())
+        envelopeCache = std::make_unique<EnvelopeCache>(directory.getFullPathName().toStdString());
+}
+
+bool OfflineRenderer::readBlock(AudioFormatReader& reader, AudioBuffer<float>& buffer, int64 position, int numSamples)
+{
+    const auto decodeStart = Time::getHighResolutionTicks();
+    TLIMITER_TRACE_ZONE("render: decode");
+
+    buffer.setSize(buffer.getNumChannels(), numSamples, false, false, true);
+    const bool ok = reader.read(&buffer, 0, numSamples, position, true, true);
+
+    statistics.decodeSeconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - decodeStart);
+    return ok;
+}
+
+Result OfflineRenderer::rerender(AudioFormatReader& input, AudioFormatReader& previousOutput, AudioFormatWriter& writer, int64 editStart, int64 editEnd)
+{
+    const int numChannels = static_cast<int> (input.numChannels);
+    const double sampleRate = input.sampleRate;
+    const int64 length = input.lengthInSamples;
+
+    if (checkpoints.empty() || sampleRate != checkpointedSampleRate || numChannels != checkpointedNumChannels
+        || length != checkpointedLength || previousOutput.lengthInSamples != length || previousOutput.numChannels != input.numChannels)
+        return render(input, writer);
+
+    processor.setNonRealtime(true);
+    processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    // the settings might have changed since the checkpoints were saved
+    auto* checkpointable = dynamic_cast<CheckpointableProcessor*> (&processor);
+    const int latencyInSamples = processor.getLatencySamples();
+
+    editStart = jlimit(static_cast<int64> (0), length, editStart);
+    editEnd = jlimit(editStart, length, editEnd);
+
+    // the last checkpoint at or before the edit; the first one is always at the start
+    size_t first = 0;
+    while (first + 1 < checkpoints.size() && checkpoints[first + 1].position <= editStart)
+        ++first;
+
+    if (checkpointable == nullptr || ! checkpointable->canSaveCheckpoints() || latencyInSamples != checkpointedLatency
+        || ! checkpointable->restoreCheckpoint(checkpoints[first].state))
+    {
+        processor.releaseResources();
+        return render(input, writer);
+    }
+
+    statistics = {};
+    statistics.numSamples = length;
+    const auto startTime = Time::getHighResolutionTicks();
+
+    AudioBuffer<float> buffer(numChannels, blockSize);
+    MidiBuffer midiMessages;
+    DspCheckpoint state;
+
+    const int64 numSamplesToProcess = length + latencyInSamples;
+    int64 position = checkpoints[first].position;
+
+    // processor output sample n is output file sample n - latencyInSamples; everything before the checkpoint stays
+    int64 numWritten = jmax(static_cast<int64> (0), position - latencyInSamples);
+    Result result = copySamples(previousOutput, writer, 0, numWritten, buffer) ? Result::ok() : Result::fail("Copying the previous render failed");
+
+    size_t next = first + 1;
+    while (result.wasOk() && position < numSamplesToProcess)
+    {
+        if (next < checkpoints.size() && checkpoints[next].position == position)
+        {
+            checkpointable->saveCheckpoint(state);
+            const bool converged = position >= editEnd && state == checkpoints[next].state;
+            std::swap(checkpoints[next].state, state);
+            ++next;
+
+            // same state and same input from here on, so the same output as before
+            if (converged)
+                break;
+        }
+
+        const int numSamples = static_cast<int> (jmin(static_cast<int64> (blockSize), numSamplesToProcess - position));
+        buffer.setSize(numChannels, numSamples, false, false, true);
+
+        const int numFromFile = static_cast<int> (jlimit(static_cast<int64> (0), static_cast<int64> (numSamples), length - position));
+        if (numFromFile > 0 && ! input.read(&buffer, 0, numFromFile, position, true, true))
+        {
+            result = Result::fail("Reading failed at sample " + String(position));
+            break;
+        }
+
+        if (numSamples > numFromFile)
+            buffer.clear(numFromFile, numSamples - numFromFile);
+
+        const auto processStart = Time::getHighResolutionTicks();
+        processor.processBlock(buffer, midiMessages);
+        midiMessages.clear();
+        statistics.processSeconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - processStart);
+
+        const int skip = static_cast<int> (jlimit(static_cast<int64> (0), static_cast<int64> (numSamples), latencyInSamples - position));
+        const int numToWrite = static_cast<int> (jmin(static_cast<int64> (numSamples - skip), length - numWritten));
+        if (numToWrite > 0 && ! writer.writeFromAudioSampleBuffer(buffer, skip, numToWrite))
+        {
+            result = Result::fail("Writing failed at sample " + String(numWritten));
+            break;
+        }
+
+        numWritten += jmax(0, numToWrite);
+        position += numSamples;
+        statistics.numSamplesProcessed += numSamples;
+    }
+
+    processor.releaseResources();
+
+    if (result.wasOk() && ! copySamples(previousOutput, writer, numWritten, length - numWritten, buffer))
+        result = Result::fail("Copying the previous render failed");
+
+    writer.flush();
+    statistics.totalSeconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTime);
+
+    // the checkpoints after a failure don't belong to any render
+    if (result.failed())
+        checkpoints.clear();
+
+    return result;
+}
+
+bool OfflineRenderer::copySamples(AudioFormatReader& reader, AudioFormatWriter& writer, int64 start, int64 numSamples, AudioBuffer<float>& buffer)
+{
+    const auto copyStart = Time::getHighResolutionTicks();
+
+    for (int64 offset = 0; offset < numSamples; offset += blockSize)
+    {
+        const int num = static_cast<int> (jmin(static_cast<int64> (blockSize), numSamples - offset));
+        buffer.setSize(buffer.getNumChannels(), num, false, false, true);
+
+        if (! reader.read(&buffer, 0, num, start + offset, true, true) || ! writer.writeFromAudioSampleBuffer(buffer, 0, num))
+            return false;
+    }
+
+    statistics.encodeSeconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - copyStart);
+    return true;
+}
+
+void OfflineRenderer::decode(AudioFormatReader& reader, int64 numSamplesToRead, int numTrailingSamples)
+{
+    const int64 totalNumSamples = numSamplesToRead + numTrailingSamples;
+    int64 position = 0;
+
+    for (;;)
+    {
+        const int blockIndex = freeBlocks.pop(cancelled);
+        if (blockIndex < 0)
+            return;
+
+        TLIMITER_TRACE_ZONE("render: decode");
+        auto& block = blocks[static_cast<size_t> (blockIndex)];
+        const auto decodeStart = Time::getHighResolutionTicks();
+
+        const int numSamples = static_cast<int> (jmin(static_cast<int64> (blockSize), totalNumSamples - position));
+        block.buffer.setSize(block.buffer.getNumChannels(), blockSize, false, false, true);
+
+        // the part which is still in the file, then silence to flush the processor's latency
+        const int numFromFile = static_cast<int> (jlimit(static_cast<int64> (0), static_cast<int64> (numSamples), numSamplesToRead - position));
+        if (numFromFile > 0 && ! reader.read(&block.buffer, 0, numFromFile, position, true, true))
+        {
+            cancel("Reading failed at sample " + String(position));
+            return;
+        }
+
+        if (numSamples > numFromFile)
+            block.buffer.clear(numFromFile, numSamples - numFromFile);
+
+        position += numSamples;
+        const bool isLast = position >= totalNumSamples;
+        block.numSamples = numSamples;
+        block.isLast = isLast;
+
+        statistics.decodeSeconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - decodeStart);
+
+        decodedBlocks.push(blockIndex);
+
+        if (isLast)
+            return;
+    }
+}
+
+void OfflineRenderer::encode(AudioFormatWriter& writer, int numSamplesToSkip, int64 numSamplesToWrite, RenderStatistics* outputStatistics)
+{
+    int64 numSkipped = 0, numWritten = 0;
+
+    for (;;)
+    {
+        const int blockIndex = processedBlocks.pop(cancelled);
+        if (blockIndex < 0)
+            return;
+
+        TLIMITER_TRACE_ZONE("render: encode");
+        auto& block = blocks[static_cast<size_t> (blockIndex)];
+        const auto encodeStart = Time::getHighResolutionTicks();
+
+        // the first samples are the processor's delay, not the file
+        const int skip = static_cast<int> (jmin(static_cast<int64> (block.numSamples), numSamplesToSkip - numSkipped));
+        numSkipped += skip;
+
+        const int numSamples = static_cast<int> (jmin(static_cast<int64> (block.numSamples - skip), numSamplesToWrite - numWritten));
+        if (numSamples > 0 && ! writer.writeFromAudioSampleBuffer(block.buffer, skip, numSamples))
+        {
+            cancel("Writing failed at sample " + String(numWritten));
+            return;
+        }
+        numWritten += jmax(0, numSamples);
+
+        // exactly what went into the file
+        if (outputStatistics != nullptr && numSamples > 0)
+        {
+            for (int ch = 0; ch < block.buffer.getNumChannels(); ++ch)
+                outputStatistics->addOutput(block.buffer.getReadPointer(ch, skip), numSamples, ch);
+
+            outputStatistics->endBlock(numSamples);
+        }
+
+        statistics.encodeSeconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - encodeStart);
+
+        const bool isLast = block.isLast;
+        freeBlocks.push(blockIndex);
+
+        if (isLast)
+            return;
+    }
+}
+
+Result OfflineRenderer::replay(const File& recordingFile, const File& outputFile)
+{
+    outputFile.deleteFile();
+    std::unique_ptr<FileOutputStream> stream(outputFile.createOutputStream());
+    if (stream == nullptr)
+        return Result::fail("Can't write " + outputFile.getFullPathName());
+
+    // the writer needs the recording's channel count and rate
+    FlightRecorder::Recording recording;
+    std::ifstream input(recordingFile.getFullPathName().toStdString(), std::ios::binary);
+    if (! recording.readFrom(input))
+        return Result::fail("Can't read the flight recording " + recordingFile.getFullPathName());
+
+    WavAudioFormat wavFormat;
+    std::unique_ptr<AudioFormatWriter> writer(wavFormat.createWriterFor(stream.get(), recording.sampleRate, static_cast<unsigned int> (recording.numChannels), 32, {}, 0));
+    if (writer == nullptr)
+        return Result::fail("Can't write WAV files with " + String(recording.numChannels) + " channels");
+
+    stream.release(); // the writer owns it now
+
+    return replay(recording, *writer);
+}
+
+Result OfflineRenderer::replay(const File& recordingFile, AudioFormatWriter& writer)
+{
+    FlightRecorder::Recording recording;
+    std::ifstream input(recordingFile.getFullPathName().toStdString(), std::ios::binary);
+    if (! recording.readFrom(input))
+        return Result::fail("Can't read the flight recording " + recordingFile.getFullPathName());
+
+    return replay(recording, writer);
+}
+
+Result OfflineRenderer::replay(const FlightRecorder::Recording& recording, AudioFormatWriter& writer)
+{
+    if (recording.blocks.empty())
+        return Result::fail("The flight recording is empty");
+
+    const int numChannels = recording.numChannels;
+    const int maxBlockSize = recording.getMaxBlockSize();
+
+    // find the recorded parameters; the ones this processor doesn't have (any more) are left out
+    std::vector<RangedAudioParameter*> targets;
+    for (const auto& id : recording.parameterIDs)
+    {
+        RangedAudioParameter* target = nullptr;
+        for (auto* parameter : processor.getParameters())
+            if (auto* withID = dynamic_cast<RangedAudioParameter*> (parameter))
+                if (withID->paramID == String(id))
+                    target = withID;
+
+        targets.push_back(target);
+    }
+
+    // the settings at the start of the recording decide how the processor is prepared
+    std::vector<float> currentValues(targets.size(), std::numeric_limits<float>::quiet_NaN());
+    setRecordedParameters(targets, recording.parameterValues.data(), currentValues);
+
+    processor.setNonRealtime(true);
+    processor.setPlayConfigDetails(numChannels, numChannels, recording.sampleRate, maxBlockSize);
+    if (processor.getTotalNumInputChannels() != numChannels)
+        return Result::fail("The processor doesn't support " + String(numChannels) + " channels");
+
+    processor.prepareToPlay(recording.sampleRate, maxBlockSize);
+
+    // continue from the state the processor was in live, instead of from a freshly prepared one
+    if (recording.initialState.getSize() > 0)
+    {
+        auto* checkpointable = dynamic_cast<CheckpointableProcessor*> (&processor);
+        if (checkpointable == nullptr || ! checkpointable->restoreCheckpoint(recording.initialState))
+        {
+            processor.releaseResources();
+            return Result::fail("The flight recording's DSP state doesn't fit the processor");
+        }
+    }
+
+    statistics = {};
+    const auto startTime = Time::getHighResolutionTicks();
+
+    AudioBuffer<float> buffer(numChannels, maxBlockSize);
+    MidiBuffer midiMessages;
+    int64 numWritten = 0;
+
+    // values the processor recorded besides its parameters, which live depended on the timing of other threads
+    auto* replayable = dynamic_cast<ReplayableProcessor*> (&processor);
+
+    for (const auto& block : recording.blocks)
+    {
+        setRecordedParameters(targets, recording.parameterValues.data() + block.parameterOffset, currentValues);
+
+        for (size_t i = 0; i < targets.size() && replayable != nullptr; ++i)
+            if (targets[i] == nullptr)
+                replayable->setRecordedValue(recording.parameterIDs[i], recording.parameterValues[block.parameterOffset + i]);
+
+        buffer.setSize(numChannels, block.numSamples, false, false, true);
+        const float* frames = recording.audio.data() + block.audioOffset;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* samples = buffer.getWritePointer(ch);
+            for (int i = 0; i < block.numSamples; ++i)
+                samples[i] = frames[i * numChannels + ch];
+        }
+
+        const auto processStart = Time::getHighResolutionTicks();
+        processor.processBlock(buffer, midiMessages);
+        midiMessages.clear();
+        statistics.processSeconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - processStart);
+
+        if (! writer.writeFromAudioSampleBuffer(buffer, 0, block.numSamples))
+        {
+            if (replayable != nullptr)
+                replayable->clearRecordedValues();
+
+            processor.releaseResources();
+            return Result::fail("Writing failed at sample " + String(numWritten));
+        }
+
+        numWritten += block.numSamples;
+    }
+
+    if (replayable != nullptr)
+        replayable->clearRecordedValues();
+
+    processor.releaseResources();
+    writer.flush();
+
+    statistics.numSamples = numWritten;
+    statistics.numSamplesProcessed = numWritten;
+    statistics.totalSeconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTime);
+
+    return Result::ok();
+}
+
+void OfflineRenderer::setRecordedParameters(const std::vector<RangedAudioParameter*>& targets, const float* values, std::vector<float>& currentValues)
+{
+    bool changed = false;
+
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        if (targets[i] == nullptr || values[i] == currentValues[i])
+            continue;
+
+        targets[i]->setValueNotifyingHost(targets[i]->convertTo0to1(values[i]));
+        currentValues[i] = values[i];
+        changed = true;
+    }
+
+    // live, the message thread handles these between two callbacks; here they happen before the next block
+    if (changed)
+        if (auto* asyncUpdater = dynamic_cast<AsyncUpdater*> (&processor))
+            asyncUpdater->handleUpdateNowIfNeeded();
+}
+
+void OfflineRenderer::cancel(const String& message)
+{
+    {
+        const ScopedLock lock(errorLock);
+        if (errorMessage.isEmpty())
+            errorMessage = message;
+    }
+
+    cancelled = true;
+}
@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+
+    Renders audio files through a processor, with decoding, processing and encoding running in parallel.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <thread>
+#include "../Modules/FlightRecorder.h"
+#include "../Modules/DspCheckpoint.h"
+#include "../Modules/RenderStatistics.h"
+#include "../Modules/TraceZones.h"
+#include "../Modules/TwoPassLimiter.h"
+#include <functional>
+
+using namespace juce;
+
+//==============================================================================
+/**
+ Renders a whole file through an AudioProcessor as a pipeline of three stages: a decoder thread reads blocks from the AudioFormatReader, the calling thread runs them through processBlock, and an encoder thread writes them to the AudioFormatWriter. The stages pass a fixed set of blocks around through bounded lock-free queues and recycle them, so nothing is allocated per block, and a file takes about as long as its slowest stage instead of the sum of all three.
+
+ The processor's latency is compensated: the renderer feeds it that many samples of silence after the end of the file and drops the same number from the beginning of its output, so the result lines up with the input and has the same length.
+
+ The processor runs in non-realtime mode, prepared after the switch. TLimiterAudioProcessor then neither hands its processing to the offload worker nor lets the adaptive quality reduce anything, so the output never depends on how fast the machine is.
+
+ renderTwoPass() renders a file without the processor, through a TwoPassLimiter, whose envelope knows the whole file in advance.
+
+ If the processor is a CheckpointableProcessor, a render can save checkpoints of its state at regular intervals. After a part of the input was edited, rerender() then starts at the last checkpoint before the edit, and stops as soon as the processor's state is the same again as in the previous render, which makes the cost of a re-render depend on the length of the edit instead of the length of the file.
+ */
+class OfflineRenderer
+{
+public:
+    /** How long each stage was busy during the last render, and how long the render took as a whole. */
+    struct Statistics
+    {
+        double decodeSeconds = 0.0;
+        double processSeconds = 0.0;
+        double encodeSeconds = 0.0;
+        double totalSeconds = 0.0;
+        int64 numSamples = 0;
+        int64 numSamplesProcessed = 0; // fed through the processor; less than numSamples after a re-render of a part
+        int64 numSamplesFromCache = 0; // of a two-pass render's first pass, read from the envelope cache instead of analysed
+    };
+
+    OfflineRenderer(AudioProcessor& processorToUse, int blockSizeToUse = 4096, int numBlocksToUse = 8);
+
+    /** Renders everything the reader holds through the processor into the writer. Prepares the processor for the reader's sample rate and channel count and releases it afterwards; the calling thread runs the processor.
+     */
+    Result render(AudioFormatReader& reader, AudioFormatWriter& writer);
+
+    /** Renders an audio file of any format the basic AudioFormatManager knows into a WAV file with the same sample rate, channels and bit depth. Overwrites the output file. With the render statistics collected, they're written next to it, as a JSON file of the same name.
+     */
+    Result render(const File& inputFile, const File& outputFile);
+
+    /** Renders everything the reader holds through a TwoPassLimiter instead of the processor, which isn't touched. The first pass streams the file through the limiter's detector into its envelope file, which endAnalysis() then smooths backwards; the second pass reads the file again and applies the envelope. Nothing is delayed, so nothing is dropped and the output lines up with the input. The limiter keeps its settings, e.g. from TLimiterAudioProcessor::configureTwoPassLimiter(). Render statistics and the trace file work as with render(); numSamplesProcessed counts the second pass.
+     */
+    Result renderTwoPass(AudioFormatReader& reader, AudioFormatWriter& writer, TwoPassLimiter& limiter);
+
+    /** Renders a file in two passes into a WAV file, as render() does with the processor. */
+    Result renderTwoPass(const File& inputFile, const File& outputFile, TwoPassLimiter& limiter);
+
+    /** Makes renderTwoPass() look the raw envelope up in an EnvelopeCache in this directory, which is created if needed, and store it there, so rendering a file again, e.g. with another make-up gain or after an edit, skips the detector for what it has seen before. The limiter only uses the cache during the render. After every two-pass render, the entries used least recently are evicted until the directory takes at most maxNumBytes. Pass File() to stop using a cache.
+     */
+    void setEnvelopeCacheDirectory(const File& directory, uint64 maxNumBytes = defaultEnvelopeCacheSize);
+
+    static constexpr uint64 defaultEnvelopeCacheSize = static_cast<uint64> (4) << 30;
+
+    /** Runs a dump of a FlightRecorder through the processor again, block by block, with the recorded block sizes and parameter values, and writes everything processBlock returns. A ReplayableProcessor also gets back the values it recorded besides its parameters, e.g. which blocks had a new characteristic table live, so what depended on the timing of the message thread happens at the same blocks again. Nothing is dropped for the latency, so the output lines up sample by sample with what the processor delivered live. The processor is prepared for the largest recorded block and released afterwards. If the dump holds the DSP state from before its first block, it's restored after preparing, so the output is bit for bit what the processor delivered live; otherwise the replay starts from a freshly prepared processor and takes a moment to converge.
+     */
+    Result replay(const File& recordingFile, AudioFormatWriter& writer);
+
+    /** Replays a dump into a 32-bit float WAV file, so the output is bit-exact. Overwrites the output file. */
+    Result replay(const File& recordingFile, const File& outputFile);
+
+    /** Makes render() save a checkpoint of the processor's state about every so many seconds, at block boundaries, if the processor supports checkpoints with its current settings. 0, the default, turns them off.
+     */
+    void setCheckpointInterval(double intervalInSeconds) { checkpointIntervalInSeconds = jmax(0.0, intervalInSeconds); }
+
+    int getNumCheckpoints() const { return static_cast<int> (checkpoints.size()); }
+
+    /** Makes render() collect the quality-control statistics of the output it writes, after the latency is dropped, so they describe exactly the rendered file. The detector's figures are null, the renderer only sees the output. Off by default, as it costs a true-peak interpolator per channel.
+     */
+    void setCollectsRenderStatistics(bool shouldCollect) { collectsRenderStatistics = shouldCollect; }
+
+    /** The statistics of the last render() which collected them. */
+    const RenderStatistics& getRenderStatistics() const { return renderStatistics; }
+
+    /** Makes render() write the trace zones recorded so far as Chrome trace JSON into this file once it's done. Only with TLIMITER_ENABLE_TRACING; pass File() to stop.
+     */
+    void setTraceFile(const File& file) { traceFile = file; }
+
+    /** Renders again after the input changed between the samples editStart and editEnd, and nowhere else. The previous output has to come from the last render() or rerender() of the same processor with the same settings and checkpoints, and the writer has to write somewhere else.
+
+     Processing starts at the last checkpoint before the edit. After the edit, the processor's state is compared with the previous render's at every checkpoint; once they are bit for bit the same, the rest of the output is too, and it's copied from previousOutput, as is everything before the first re-rendered sample. The checkpoints are updated along the way, so edits can follow each other. Without matching checkpoints, the whole input is rendered.
+     */
+    Result rerender(AudioFormatReader& input, AudioFormatReader& previousOutput, AudioFormatWriter& writer, int64 editStart, int64 editEnd);
+
+    const Statistics& getStatistics() const { return statistics; }
+
+private:
+    struct Block
+    {
+        AudioBuffer<float> buffer;
+        int numSamples = 0;
+        bool isLast = false;
+    };
+
+    /** Block indices handed from one stage to the next: one producer, one consumer, never more entries than blocks. */
+    class BlockQueue
+    {
+    public:
+        explicit BlockQueue(int capacity) : fifo(capacity + 1), indices(static_cast<size_t> (capacity + 1)) {}
+
+        void reset() { fifo.reset(); }
+        void push(int blockIndex);
+
+        /** Waits for the next block; returns -1 if the render was cancelled in the meantime. */
+        int pop(const std::atomic<bool>& cancelled);
+
+    private:
+        AbstractFifo fifo;
+        std::vector<int> indices;
+        WaitableEvent blockAvailable;
+    };
+
+    struct Checkpoint
+    {
+        int64 position; // in samples fed to the processor, always at a block boundary
+        DspCheckpoint state;
+    };
+
+    void decode(AudioFormatReader& reader, int64 numSamplesToRead, int numTrailingSamples);
+    void encode(AudioFormatWriter& writer, int numSamplesToSkip, int64 numSamplesToWrite, RenderStatistics* outputStatistics);
+
+    Result replay(const FlightRecorder::Recording& recording, AudioFormatWriter& writer);
+
+    /** Sets the processor's parameters to the recorded values of one block, only touching the ones which changed, and applies pending updates right away, as the message thread would have done between two blocks. */
+    void setRecordedParameters(const std::vector<RangedAudioParameter*>& targets, const float* values, std::vector<float>& currentValues);
+
+    /** Opens the input, creates a WAV writer with its format for the output, and renders with the given function; writes the render statistics next to the output if they're collected. */
+    Result renderFile(const File& inputFile, const File& outputFile, const std::function<Result(AudioFormatReader&, AudioFormatWriter&)>& renderWith);
+
+    /** Reads numSamples from position on into the buffer, resized to that many samples. */
+    bool readBlock(AudioFormatReader& reader, AudioBuffer<float>& buffer, int64 position, int numSamples);
+
+    /** Copies the samples from start to start + numSamples of a reader into the writer. */
+    bool copySamples(AudioFormatReader& reader, AudioFormatWriter& writer, int64 start, int64 numSamples, AudioBuffer<float>& buffer);
+
+    /** Stops all stages, e.g. after a failed read or write. */
+    void cancel(const String& message);
+
+    AudioProcessor& processor;
+    const int blockSize;
+    const int numBlocks;
+
+    std::vector<Block> blocks;
+    BlockQueue freeBlocks, decodedBlocks, processedBlocks;
+
+    std::atomic<bool> cancelled { false };
+    String errorMessage;
+    CriticalSection errorLock;
+
+    Statistics statistics;
+
+    bool collectsRenderStatistics = false;
+    RenderStatistics renderStatistics;
+    File traceFile;
+
+    std::unique_ptr<EnvelopeCache> envelopeCache;
+    uint64 envelopeCacheMaxBytes = defaultEnvelopeCacheSize;
+
+    double checkpointIntervalInSeconds = 0.0;
+    std::vector<Checkpoint> checkpoints;
+
+    // what the checkpoints were saved for
+    double checkpointedSampleRate = 0.0;
+    int checkpointedNumChannels = 0;
+    int64 checkpointedLength = 0;
+    int checkpointedLatency = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
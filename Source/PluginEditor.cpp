@@ -11,17 +11,18 @@
 
 //==============================================================================
 TLimiterAudioProcessorEditor::TLimiterAudioProcessorEditor (TLimiterAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p), historyView (p)
 {
-    setSize(740, 180);
+    setSize(740, 290);
 
     buildElements();
 
-    startTimerHz(60);
+    refreshScheduler->addClient(this);
 }
 
 TLimiterAudioProcessorEditor::~TLimiterAudioProcessorEditor()
 {
+    refreshScheduler->removeClient(this);
 }
 
 //==============================================================================
@@ -64,6 +65,30 @@ void TLimiterAudioProcessorEditor::buildElements()
     makeUp.setRange(-10.0f, 20.0f); addAndMakeVisible(&makeUp);
     makeUp.setTextValueSuffix(" dB");
 
+    dumpRecordingButton.onClick = [this]
+    {
+        const auto file = File::getSpecialLocation(File::userDesktopDirectory).getChildFile("T-Limiter-flight.tlfr");
+        if (audioProcessor.dumpFlightRecording(file))
+            AlertWindow::showMessageBoxAsync(AlertWindow::InfoIcon, "Flight recording", "The last seconds were written to " + file.getFullPathName() + ".");
+        else
+            AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "Flight recording",
+                                             "Nothing was written: the flight recorder is off, hasn't recorded anything yet, or " + file.getFullPathName() + " can't be written.");
+    };
+    addAndMakeVisible(dumpRecordingButton);
+
+    addAndMakeVisible(historyView);
+
+   #if TLIMITER_ENABLE_TRACING
+    dumpTraceButton.onClick = []
+    {
+        const auto file = File::getSpecialLocation(File::userDesktopDirectory).getChildFile("T-Limiter-trace.json");
+        if (TraceRecorder::getInstance().writeChromeTrace(file.getFullPathName().toStdString()))
+            AlertWindow::showMessageBoxAsync(AlertWindow::InfoIcon, "Trace", "The trace was written to " + file.getFullPathName() + ".");
+        else
+            AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "Trace", file.getFullPathName() + " can't be written.");
+    };
+    addAndMakeVisible(dumpTraceButton);
+   #endif
 }
 
 void TLimiterAudioProcessorEditor::paint (juce::Graphics& g)
@@ -75,12 +100,27 @@ void TLimiterAudioProcessorEditor::paint (juce::Graphics& g)
     g.setFont(15.0f);
 
 
-    g.drawText("Threshold", 20,     (getHeight() / 2) - 50, 100, 30, Justification::centred);
-    g.drawText("Knee",      140,    (getHeight() / 2) - 50, 100, 30, Justification::centred);
-    g.drawText("Attack", 260,    (getHeight() / 2) - 50, 100, 30, Justification::centred);
-    g.drawText("Release", 380,    (getHeight() / 2) - 50, 100, 30, Justification::centred);
-    g.drawText("Ratio", 500,    (getHeight() / 2) - 50, 100, 30, Justification::centred);
-    g.drawText("MakeUp", 620,    (getHeight() / 2) - 50, 100, 30, Justification::centred);
+    g.drawText("Threshold", 20,     knobRowCentre - 50, 100, 30, Justification::centred);
+    g.drawText("Knee",      140,    knobRowCentre - 50, 100, 30, Justification::centred);
+    g.drawText("Attack", 260,    knobRowCentre - 50, 100, 30, Justification::centred);
+    g.drawText("Release", 380,    knobRowCentre - 50, 100, 30, Justification::centred);
+    g.drawText("Ratio", 500,    knobRowCentre - 50, 100, 30, Justification::centred);
+    g.drawText("MakeUp", 620,    knobRowCentre - 50, 100, 30, Justification::centred);
+
+    drawMeter(g, inputMeterBounds, "IN", inputLevel, false);
+    drawMeter(g, gainReductionMeterBounds, "GR", gainReduction, true);
+
+    auto loudnessText = [] (float loudness) { return loudness > meterRangeInDecibels ? String(loudness, 1) : String("-"); };
+    auto loudnessArea = loudnessBounds;
+    g.setFont(11.0f);
+    g.setColour(Colours::white);
+    g.drawText("M " + loudnessText(momentaryLoudness) + "  S " + loudnessText(shortTermLoudness), loudnessArea.removeFromTop(17), Justification::centredRight);
+    g.drawText("I " + loudnessText(integratedLoudness) + " LUFS", loudnessArea, Justification::centredRight);
+
+    g.setColour(Colours::white.withAlpha(0.6f));
+    const String quality = qualityTier == 0 ? String("Full") : "Reduced (" + String(qualityTier) + ")";
+    g.drawText("Memory: " + String(static_cast<int64> ((memoryUsageInBytes + 1023) / 1024)) + " KB   Load: " + String(loadInPercent) + " %   Quality: " + quality,
+               statusBounds, Justification::centredLeft);
 
 
     //g.drawFittedText("Knee", labelRow.removeFromLeft(60), 12, Justification::centred, 1);
@@ -93,20 +133,97 @@ void TLimiterAudioProcessorEditor::paint (juce::Graphics& g)
 
 void TLimiterAudioProcessorEditor::resized()
 {
-    threshold.setBounds(20, getHeight() / 2 - 20, 100, 100);
-    knee.setBounds(140,     getHeight() / 2 - 20, 100, 100);
-    attack.setBounds(260,   getHeight() / 2 - 20, 100, 100);
-    release.setBounds(380,  getHeight() / 2 - 20, 100, 100);
-    ratio.setBounds(500,    getHeight() / 2 - 20, 100, 100);
-    makeUp.setBounds(620,   getHeight() / 2 - 20, 100, 100);
+    threshold.setBounds(20, knobRowCentre - 20, 100, 100);
+    knee.setBounds(140,     knobRowCentre - 20, 100, 100);
+    attack.setBounds(260,   knobRowCentre - 20, 100, 100);
+    release.setBounds(380,  knobRowCentre - 20, 100, 100);
+    ratio.setBounds(500,    knobRowCentre - 20, 100, 100);
+    makeUp.setBounds(620,   knobRowCentre - 20, 100, 100);
+
+    historyView.setBounds(historyBounds);
+
+    dumpRecordingButton.setBounds(getWidth() - 200, getHeight() - 24, 100, 20);
+
+   #if TLIMITER_ENABLE_TRACING
+    dumpTraceButton.setBounds(getWidth() - 90, getHeight() - 24, 80, 20);
+   #endif
+}
+
+void TLimiterAudioProcessorEditor::drawMeter(Graphics& g, Rectangle<int> bounds, const String& name, float valueInDecibels, bool fromRight)
+{
+    g.setFont(11.0f);
+    g.setColour(Colours::white);
+    g.drawText(name, bounds.removeFromLeft(30), Justification::centredLeft);
+
+    g.setColour(Colours::black.withAlpha(0.4f));
+    g.fillRect(bounds);
+
+    const float proportion = jlimit(0.0f, 1.0f, 1.0f - valueInDecibels / meterRangeInDecibels);
+    const int width = roundToInt(proportion * bounds.getWidth());
+
+    if (fromRight) // gain reduction grows from the right
+    {
+        g.setColour(Colours::orange);
+        g.fillRect(bounds.removeFromRight(bounds.getWidth() - width));
+    }
+    else
+    {
+        g.setColour(Colours::lightgreen);
+        g.fillRect(bounds.removeFromLeft(width));
+    }
 }
 
-void TLimiterAudioProcessorEditor::timerCallback()
+void TLimiterAudioProcessorEditor::refresh()
 {
     if (audioProcessor.characteristicChanged.get())
     {
         audioProcessor.characteristicChanged = false;
     }
+
+    // only invalidate the meters whose values moved by more than the displayable resolution
+    const float newInputLevel = jlimit(meterRangeInDecibels, 0.0f, audioProcessor.getMaxInputLevelInDecibels());
+    const float newGainReduction = jlimit(meterRangeInDecibels, 0.0f, audioProcessor.getMaxGainReductionInDecibels());
+
+    if (std::abs(newInputLevel - inputLevel) >= meterResolutionInDecibels)
+    {
+        inputLevel = newInputLevel;
+        repaint(inputMeterBounds);
+    }
+
+    if (std::abs(newGainReduction - gainReduction) >= meterResolutionInDecibels)
+    {
+        gainReduction = newGainReduction;
+        repaint(gainReductionMeterBounds);
+    }
+
+    const auto& loudnessMeter = audioProcessor.getLoudnessMeter();
+    const float newMomentary = jlimit(meterRangeInDecibels, 0.0f, loudnessMeter.getMomentaryLoudness());
+    const float newShortTerm = jlimit(meterRangeInDecibels, 0.0f, loudnessMeter.getShortTermLoudness());
+    const float newIntegrated = jlimit(meterRangeInDecibels, 0.0f, loudnessMeter.getIntegratedLoudness());
+
+    if (std::abs(newMomentary - momentaryLoudness) >= meterResolutionInDecibels
+        || std::abs(newShortTerm - shortTermLoudness) >= meterResolutionInDecibels
+        || std::abs(newIntegrated - integratedLoudness) >= meterResolutionInDecibels)
+    {
+        momentaryLoudness = newMomentary;
+        shortTermLoudness = newShortTerm;
+        integratedLoudness = newIntegrated;
+        repaint(loudnessBounds);
+    }
+
+    const size_t newMemoryUsage = audioProcessor.getMemoryUsageInBytes();
+    const int newLoad = roundToInt(100.0 * audioProcessor.getQualityGovernor().getLoad());
+    const int newQualityTier = audioProcessor.getQualityGovernor().getTier();
+
+    if (newMemoryUsage != memoryUsageInBytes || newLoad != loadInPercent || newQualityTier != qualityTier)
+    {
+        memoryUsageInBytes = newMemoryUsage;
+        loadInPercent = newLoad;
+        qualityTier = newQualityTier;
+        repaint(statusBounds);
+    }
+
+    historyView.refresh();
 }
 
 
@@ -10,6 +10,8 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "RefreshScheduler.h"
+#include "HistoryView.h"
 
 using namespace std;
 
@@ -19,7 +21,7 @@ typedef AudioProcessorValueTreeState::ButtonAttachment ButtonAttachment;
 //==============================================================================
 /**
 */
-class TLimiterAudioProcessorEditor  : public juce::AudioProcessorEditor, private Timer
+class TLimiterAudioProcessorEditor  : public juce::AudioProcessorEditor, private RefreshScheduler::Client
 
 {
 public:
@@ -30,14 +32,41 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
 
-    void timerCallback() override;
-
     void buildElements();
 
 private:
+    void refresh() override;
+    Component& getRefreshComponent() override { return *this; }
+
+    void drawMeter (Graphics& g, Rectangle<int> bounds, const String& name, float valueInDecibels, bool fromRight);
+
     // This reference is provided as a quick way for your editor to access the processor object that created it.
     TLimiterAudioProcessor& audioProcessor;
 
+    SharedResourcePointer<RefreshScheduler> refreshScheduler;
+
+    // meter values as they were painted the last time, in decibels
+    float inputLevel = meterRangeInDecibels;
+    float gainReduction = 0.0f;
+    float momentaryLoudness = meterRangeInDecibels, shortTermLoudness = meterRangeInDecibels, integratedLoudness = meterRangeInDecibels;
+    size_t memoryUsageInBytes = 0;
+    int loadInPercent = 0;
+    int qualityTier = 0;
+
+    static constexpr float meterRangeInDecibels = -60.0f;
+    static constexpr float meterResolutionInDecibels = 0.1f;
+
+    Rectangle<int> inputMeterBounds { 20, 10, 540, 12 };
+    Rectangle<int> gainReductionMeterBounds { 20, 28, 540, 12 };
+    Rectangle<int> loudnessBounds { 570, 8, 150, 34 };
+    Rectangle<int> historyBounds { 20, 190, 700, 70 };
+    Rectangle<int> statusBounds { 20, 266, 400, 16 };
+
+    // the vertical centre of the row of knobs
+    static constexpr int knobRowCentre = 105;
+
+    HistoryView historyView;
+
     Slider inputGain, threshold, knee, attack, release, ratio, makeUp;
 
     unique_ptr<SliderAttachment> inputGainVal, thresholdAttachment, kneeAttachment, attackAttachment, releaseAttachment, ratioAttachment, makeUpAttachment;
@@ -45,5 +74,11 @@ private:
     ToggleButton lookAhead;
     unique_ptr<ButtonAttachment> lookAheadAttachment;
 
+    TextButton dumpRecordingButton { "Dump Recording" };
+
+   #if TLIMITER_ENABLE_TRACING
+    TextButton dumpTraceButton { "Dump Trace" };
+   #endif
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TLimiterAudioProcessorEditor)
 };
@@ -8,6 +8,10 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include <fstream>
+
+// the JUCE-free core has to cut the buffers the same way to stay bit-identical
+static_assert(TLimiterAudioProcessor::subBlockSize == LimiterCore::subBlockSize, "sub-block sizes of plug-in and core differ");
 
 //==============================================================================
 TLimiterAudioProcessor::TLimiterAudioProcessor()
@@ -22,31 +26,101 @@ TLimiterAudioProcessor::TLimiterAudioProcessor()
                         ), parameters(*this, nullptr, "Parameters", createParameters())
 #endif
 {
+    // the parameters which are read with every block, so the audio thread doesn't search for them
+    lookAheadParameter = parameters.getRawParameterValue("lookAhead");
+    channelLinkParameter = parameters.getRawParameterValue("channelLink");
+    ceilingParameter = parameters.getRawParameterValue("ceiling");
+    adaptiveQualityParameter = parameters.getRawParameterValue("adaptiveQuality");
+    makeUpParameter = parameters.getRawParameterValue("makeUp");
+    loudnessMatchParameter = parameters.getRawParameterValue("loudnessMatch");
+    loudnessTargetParameter = parameters.getRawParameterValue("loudnessTarget");
+    controlRateParameter = parameters.getRawParameterValue("controlRate");
+    noiseShapingParameter = parameters.getRawParameterValue("noiseShaping");
+    sideChainFilterParameter = parameters.getRawParameterValue("sideChainFilter");
+
     parameters.addParameterListener("threshold", this);
     parameters.addParameterListener("knee", this);
     parameters.addParameterListener("attack", this);
     parameters.addParameterListener("release", this);
     parameters.addParameterListener("ratio", this);
     parameters.addParameterListener("makeUp", this);
+    parameters.addParameterListener("oversampling", this);
+    parameters.addParameterListener("oversamplingQuality", this);
+    parameters.addParameterListener("fadeShape", this);
+    parameters.addParameterListener("linkGroup", this);
+    parameters.addParameterListener("parallelChannels", this);
+    parameters.addParameterListener("controlRate", this);
+    parameters.addParameterListener("clipper", this);
+    parameters.addParameterListener("dither", this);
+    parameters.addParameterListener("noiseShaping", this);
+    parameters.addParameterListener("sideChainFilter", this);
+    parameters.addParameterListener("sideChainHighPass", this);
+    parameters.addParameterListener("sideChainTilt", this);
+    parameters.addParameterListener("offload", this);
+    parameters.addParameterListener("flightRecorder", this);
+
+    // the flight recorder takes a snapshot of every parameter with every block
+    for (auto* parameter : getParameters())
+        if (auto* withID = dynamic_cast<RangedAudioParameter*> (parameter))
+            if (recordedParameterIDs.size() < FlightRecorder::maxNumParameters)
+            {
+                recordedParameterIDs.push_back(withID->paramID.toStdString());
+                recordedParameterValues.push_back(parameters.getRawParameterValue(withID->paramID));
+            }
+
+    // and whether the block had a characteristic table, see setRecordedValue()
+    if (recordedParameterIDs.size() < FlightRecorder::maxNumParameters)
+    {
+        recordedParameterIDs.push_back("characteristicTable");
+        recordedParameterValues.push_back(&characteristicTableInUse);
+    }
+
+    for (int ch = 0; ch < maxNumChannels; ++ch)
+        strips.add(new ChannelStrip());
 
-    gainReductionComputer.setThreshold(parameters.getRawParameterValue("threshold")->load());
-    gainReductionComputer.setKnee(parameters.getRawParameterValue("knee")->load());
-    gainReductionComputer.setAttackTime(parameters.getRawParameterValue("attack")->load() / 1000);
-    gainReductionComputer.setReleaseTime(parameters.getRawParameterValue("release")->load() / 1000);
-    gainReductionComputer.setMakeUpGain(parameters.getRawParameterValue("makeUp")->load());
     const float ratio = parameters.getRawParameterValue("ratio")->load();
-    
-    if (ratio > 15.9f)
-        gainReductionComputer.setRatio(std::numeric_limits<float>::infinity());
-    else
-        gainReductionComputer.setRatio(ratio);
 
-    delay.setDelayTime(0.005f);
-    lookAheadFadeIn.setDelayTime(0.005f);
+    forEachGainReductionComputer([&](GainReductionComputer& computer)
+    {
+        computer.setThreshold(parameters.getRawParameterValue("threshold")->load());
+        computer.setKnee(parameters.getRawParameterValue("knee")->load());
+        computer.setAttackTime(parameters.getRawParameterValue("attack")->load() / 1000);
+        computer.setReleaseTime(parameters.getRawParameterValue("release")->load() / 1000);
+        computer.setMakeUpGain(makeUpParameter->load());
+        computer.setDecimationFactor(getDecimationFactorParameter(controlRateParameter->load()));
+
+        if (ratio > 15.9f)
+            computer.setRatio(std::numeric_limits<float>::infinity());
+        else
+            computer.setRatio(ratio);
+    });
+
+    const auto fadeShape = static_cast<LookAheadGainReduction::FadeShape> (roundToInt(parameters.getRawParameterValue("fadeShape")->load()));
+    lookAheadFadeIn.setDelayTime(lookAheadTimeInSeconds);
+    lookAheadFadeIn.setFadeShape(fadeShape);
+
+    for (auto* strip : strips)
+    {
+        strip->delay.setDelayTime(lookAheadTimeInSeconds);
+        strip->lookAheadFadeIn.setDelayTime(lookAheadTimeInSeconds);
+        strip->lookAheadFadeIn.setFadeShape(fadeShape);
+    }
+
+    outputClipper.setOrder(static_cast<AntiderivativeClipper::Order> (roundToInt(parameters.getRawParameterValue("clipper")->load())));
+    dither.setBitDepth(getDitherBitDepthParameter(parameters.getRawParameterValue("dither")->load()));
+    dither.setShape(static_cast<NoiseShapingDither::Shape> (roundToInt(noiseShapingParameter->load())));
+
+    sideChainFilter.setEnabled(sideChainFilterParameter->load() > 0.5f);
+    sideChainFilter.setHighPassFrequency(parameters.getRawParameterValue("sideChainHighPass")->load());
+    sideChainFilter.setTilt(parameters.getRawParameterValue("sideChainTilt")->load());
+
+    rebuildCharacteristicTable();
 }
 
 TLimiterAudioProcessor::~TLimiterAudioProcessor()
 {
+    offloadWorker.stop();
+    workerPool.stop();
 }
 
 //==============================================================================
@@ -115,7 +189,9 @@ void TLimiterAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    offloadWorker.stop();
     gainReductionComputer.reset();
+    workerPool.stop();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -125,12 +201,9 @@ bool TLimiterAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout up to maxNumChannels works, from mono up to higher order Ambisonics and object beds.
+    if (layouts.getMainOutputChannelSet().isDisabled()
+     || layouts.getMainOutputChannelSet().size() > maxNumChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -149,76 +222,872 @@ void TLimiterAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBloc
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
+    // The host's block size doesn't matter for the DSP: processBlock cuts every buffer into sub-blocks of subBlockSize
+    // samples, so all scratch memory is sized for those and stays small. Only the offload worker's FIFOs depend on it.
+
+    // the worker must not touch anything while it's prepared
+    offloadWorker.stop();
+
+    TLIMITER_TRACE_PREPARE();
+
+    oversamplingFactor = getOversamplingFactorParameter();
 
-    gainReductionComputer.prepare(sampleRate);
-    lookAheadFadeIn.prepare(sampleRate, samplesPerBlock);
-    delay.prepare({ sampleRate, static_cast<uint32> (samplesPerBlock), 2 });
+    const int numChannels = jlimit(1, maxNumChannels, getTotalNumInputChannels());
+    const int numChannelGroups = (numChannels + channelsPerTask - 1) / channelsPerTask;
 
-    sideChainBuffer.setSize(2, samplesPerBlock);
+    // the audio thread takes part in the work itself, so spawn one worker less than there are cores
+    const int numWorkers = parameters.getRawParameterValue("parallelChannels")->load() > 0.5f && numChannels >= minNumChannelsForWorkers
+                               ? jlimit(0, numChannelGroups - 1, SystemStats::getNumCpus() - 1)
+                               : 0;
 
-    if (parameters.getRawParameterValue("lookAhead")->load() > 0.5f)
-        setLatencySamples(static_cast<int> (0.005 * sampleRate));
+    oversamplers.clear();
+    if (oversamplingFactor > 1)
+    {
+        // IIR half-bands are minimum-latency, the FIR half-bands are linear-phase but add more latency
+        const auto filterType = parameters.getRawParameterValue("oversamplingQuality")->load() > 0.5f
+                                    ? Oversampling<float>::filterHalfBandFIREquiripple
+                                    : Oversampling<float>::filterHalfBandPolyphaseIIR;
+
+        // with workers, every channel group has its own filters, so each task can oversample its channels
+        const int groupSize = numWorkers > 0 ? channelsPerTask : numChannels;
+        for (int first = 0; first < numChannels; first += groupSize)
+        {
+            auto* oversampler = oversamplers.add(new Oversampling<float>(static_cast<size_t> (jmin(groupSize, numChannels - first)),
+                                                                         static_cast<size_t> (std::log2(oversamplingFactor)),
+                                                                         filterType, true, true));
+            oversampler->initProcessing(static_cast<size_t> (subBlockSize));
+        }
+    }
+
+    // detection, gain computation and the multiply all run at the oversampled rate
+    const double processingRate = sampleRate * oversamplingFactor;
+    const int processingBlockSize = subBlockSize * oversamplingFactor;
+
+    // Linked instances exchange their envelopes one host block late, so all the others have published that part of the
+    // timeline already, no matter in which order the host runs them. The audio waits for the link in each strip's link delay.
+    const int linkGroup = roundToInt(parameters.getRawParameterValue("linkGroup")->load()) - 1; // choice 0 is "Off"
+    gainLink.prepare(linkGroup, linkGroup >= 0 ? samplesPerBlock : 0, oversamplingFactor, processingBlockSize);
+    const int linkLatency = gainLink.getLatencyInSamples();
+
+    // The arena only ever grows: it is sized for at least 192 kHz, so hosts switching between the common rates,
+    // or simply preparing again, don't reallocate anything.
+    // Every piece taken from it is checked: if the arena can't be allocated, or getRequiredArenaBytes() missed a buffer,
+    // processBlock outputs silence instead of writing through a null pointer.
+    bool arenaAllocated = arena.reserve(getRequiredArenaBytes(jmax(sampleRate, maxPlannedSampleRate) * oversamplingFactor, processingBlockSize, numChannels, linkLatency));
+
+    gainReductionComputer.prepare(processingRate);
+    arenaAllocated = arenaAllocated && lookAheadFadeIn.prepare(processingRate, processingBlockSize, arena);
+
+    float* linkedChannels[] = { arena.allocate<float>(processingBlockSize), arena.allocate<float>(processingBlockSize) };
+    arenaAllocated = arenaAllocated && linkedChannels[0] != nullptr && linkedChannels[1] != nullptr;
+    if (arenaAllocated)
+        sideChainBuffer.setDataToReferTo(linkedChannels, 2, processingBlockSize);
+
+    sideChainFilter.prepare(processingRate, numChannels);
+
+    for (int ch = 0; ch < numChannels && arenaAllocated; ++ch)
+    {
+        auto* strip = strips[ch];
+        arenaAllocated = strip->delay.prepare({ processingRate, static_cast<uint32> (processingBlockSize), 1 }, arena);
+
+        // half a sample more, so Delay's truncation lands on exactly the link latency
+        strip->linkDelay.setDelayTime(linkLatency > 0 ? static_cast<float> ((linkLatency + 0.5) / processingRate) : 0.0f);
+        arenaAllocated = arenaAllocated && strip->linkDelay.prepare({ processingRate, static_cast<uint32> (processingBlockSize), 1 }, arena);
+        strip->gainReductionComputer.prepare(processingRate);
+        arenaAllocated = arenaAllocated && strip->lookAheadFadeIn.prepare(processingRate, processingBlockSize, arena);
+
+        float* stripChannels[] = { arena.allocate<float>(processingBlockSize) };
+        arenaAllocated = arenaAllocated && stripChannels[0] != nullptr;
+        if (arenaAllocated)
+            strip->sideChainBuffer.setDataToReferTo(stripChannels, 1, processingBlockSize);
+    }
+
+    // the sizes have to add up to exactly what was taken, at any rate
+    jassert(arenaAllocated);
+    jassert(! arenaAllocated || arena.getNumBytesUsed() == getRequiredArenaBytes(processingRate, processingBlockSize, numChannels, linkLatency));
+    dspPrepared = arenaAllocated;
+
+    if (numWorkers > 0)
+        workerPool.start(numWorkers);
     else
-        setLatencySamples(0);
+        workerPool.stop();
+
+    outputClipper.prepare(subBlockSize, jmax(1, getTotalNumInputChannels()));
+    outputClipper.reset();
+
+    // reseeds, so every render from the start is the same
+    dither.prepare(subBlockSize, jmax(1, getTotalNumInputChannels()));
+
+    loudnessMeter.prepare(sampleRate, jmax(1, getTotalNumInputChannels()), getLoudnessWeights(getChannelLayoutOfBus(true, 0)));
+    loudnessCorrection = 0.0f;
+
+    numProcessedSamples = 0;
+    timingStatistics.reset();
+
+    if (parameters.getRawParameterValue("flightRecorder")->load() > 0.5f && dspPrepared)
+    {
+        // a checkpoint of the freshly prepared DSP has the size all later ones have
+        saveCheckpoint(flightRecorderCheckpoint);
+        flightRecorder.prepare(sampleRate, jmax(1, getTotalNumInputChannels()), flightRecordingLengthInSeconds, flightRecordingMaxBytes,
+                               recordedParameterIDs, flightRecorderCheckpoint.getSize());
+    }
+    else
+    {
+        flightRecorder.release();
+        flightRecorderCheckpoint = DspCheckpoint();
+    }
+
+    memoryUsageInBytes = arena.getCapacity() + sizeof(*this) + static_cast<size_t> (strips.size()) * sizeof(ChannelStrip)
+                         + flightRecorder.getMemoryUsageInBytes() + flightRecorderCheckpoint.getSize();
+
+    // one bin per sub-block at the finest level; the histories survive preparing again at the same rate
+    const auto historyLength = static_cast<int64> (historyLengthInSeconds * sampleRate);
+    inputLevelHistory.prepare(subBlockSize, historyBinsPerLevel, historyLength);
+    gainReductionHistory.prepare(subBlockSize, historyBinsPerLevel, historyLength);
+
+    qualityGovernor.reset();
+    appliedQualityTier = 0;
+    applyQualityTier(0);
+
+    if (shouldRunOffloadWorker())
+        offloadWorker.start(jmax(1, getTotalNumInputChannels()), samplesPerBlock, processOffloaded, this);
+
+    updateLatency();
+}
+
+void TLimiterAudioProcessor::setNonRealtime(bool nonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime(nonRealtime);
+
+    // hosts usually switch before preparing, which starts the worker or not by itself
+    if (getSampleRate() > 0.0 && shouldRunOffloadWorker() != offloadWorker.isRunning())
+    {
+        workerModeChanged = true;
+        triggerAsyncUpdate();
+    }
+}
+
+bool TLimiterAudioProcessor::shouldRunOffloadWorker() const
+{
+    // an offline render has no deadline to keep
+    return dspPrepared && ! isNonRealtime() && parameters.getRawParameterValue("offload")->load() > 0.5f;
+}
+
+void TLimiterAudioProcessor::updateLatency()
+{
+    float latencyInSamples = oversamplers.isEmpty() ? 0.0f : oversamplers.getFirst()->getLatencyInSamples();
+
+    if (lookAheadParameter->load() > 0.5f)
+        latencyInSamples += static_cast<float> (lookAheadFadeIn.getDelayInSamples()) / oversamplingFactor;
+
+    latencyInSamples += outputClipper.getLatencyInSamples();
+
+    // linked instances deliver everything one host block later
+    latencyInSamples += static_cast<float> (gainLink.getLatencyInSamples()) / oversamplingFactor;
+
+    // the worker delivers every block one callback later
+    latencyInSamples += offloadWorker.getLatencyInSamples();
+
+    setLatencySamples(roundToInt(latencyInSamples));
+}
+
+size_t TLimiterAudioProcessor::getRequiredArenaBytes(double processingRate, int processingBlockSize, int numChannels, int linkLatency)
+{
+    const ProcessSpec channelSpec { processingRate, static_cast<uint32> (processingBlockSize), 1 };
+
+    const size_t linkedBytes = LookAheadGainReduction::getRequiredArenaBytes(processingRate, processingBlockSize, lookAheadTimeInSeconds)
+                               + 2 * MemoryArena::getRequiredBytes<float>(static_cast<size_t> (processingBlockSize));
+
+    const size_t stripBytes = Delay::getRequiredArenaBytes(channelSpec, lookAheadTimeInSeconds)
+                              + Delay::getRequiredArenaBytes(channelSpec, static_cast<float> ((linkLatency + 0.5) / processingRate))
+                              + LookAheadGainReduction::getRequiredArenaBytes(processingRate, processingBlockSize, lookAheadTimeInSeconds)
+                              + MemoryArena::getRequiredBytes<float>(static_cast<size_t> (processingBlockSize));
+
+    return linkedBytes + static_cast<size_t> (numChannels) * stripBytes;
+}
+
+std::vector<float> TLimiterAudioProcessor::getLoudnessWeights(const AudioChannelSet& layout)
+{
+    std::vector<float> weights;
+
+    for (int ch = 0; ch < layout.size(); ++ch)
+    {
+        switch (layout.getTypeOfChannel(ch))
+        {
+            case AudioChannelSet::leftSurround:
+            case AudioChannelSet::rightSurround:
+            case AudioChannelSet::leftSurroundSide:
+            case AudioChannelSet::rightSurroundSide:
+                weights.push_back(LoudnessMeter::surroundChannelWeight);
+                break;
+
+            case AudioChannelSet::LFE:
+            case AudioChannelSet::LFE2:
+                weights.push_back(0.0f);
+                break;
+
+            default:
+                weights.push_back(1.0f);
+                break;
+        }
+    }
+
+    return weights;
+}
+
+int TLimiterAudioProcessor::getOversamplingFactorParameter() const
+{
+    // choice index 0, 1, 2, 3 -> factor 1, 2, 4, 8
+    return 1 << jlimit(0, 3, roundToInt(parameters.getRawParameterValue("oversampling")->load()));
+}
+
+int TLimiterAudioProcessor::getDitherBitDepthParameter(float choice)
+{
+    // choice index 0, 1, 2 -> off, 16 bit, 24 bit
+    const int index = jlimit(0, 2, roundToInt(choice));
+    return index == 0 ? 0 : 8 + 8 * index;
+}
+
+int TLimiterAudioProcessor::getDecimationFactorParameter(float choice)
+{
+    // choice index 0, 1, 2, 3 -> every sample, every 4th, 8th, 16th sample
+    const int index = jlimit(0, 3, roundToInt(choice));
+    return index == 0 ? 1 : 2 << index;
+}
+
+void TLimiterAudioProcessor::handleAsyncUpdate()
+{
+    if (characteristicTableNeedsUpdate.exchange(false))
+        rebuildCharacteristicTable();
+
+    // A new oversampling or worker setting changes the processing rate and the latency, so everything needs to be prepared
+    // again. If the host prepared since it switched between real-time and offline, the worker is right already.
+    const bool workerNeedsUpdate = workerModeChanged.exchange(false) && shouldRunOffloadWorker() != offloadWorker.isRunning();
+
+    if ((processingNeedsUpdate.exchange(false) || workerNeedsUpdate) && getSampleRate() > 0.0)
+    {
+        suspendProcessing(true);
+        prepareToPlay(getSampleRate(), getBlockSize());
+        suspendProcessing(false);
+    }
+}
+
+void TLimiterAudioProcessor::rebuildCharacteristicTable()
+{
+    // The linked detector always carries the current threshold, knee and ratio. The version is taken before building,
+    // so a change while building makes the table outdated right away, and the change's own update builds the next one.
+    auto table = make_unique<CharacteristicTable>();
+    table->setVersion(characteristicVersion.load());
+    table->build(gainReductionComputer);
+    characteristicTables.publish(std::move(table));
 }
 
 void TLimiterAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     ScopedNoDenormals noDenormals;
+    TLIMITER_TRACE_ZONE("processBlock");
+
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
-    const bool useLookAhead = parameters.getRawParameterValue("lookAhead")->load() > 0.5f;
     const int numSamples = buffer.getNumSamples();
 
     // clear not needed output channels
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, numSamples);
 
-    /** STEP 1: compute sidechain-signal */
-    // copy the absolute values from the first input channel to the sideChainBuffer
-    FloatVectorOperations::abs(sideChainBuffer.getWritePointer(0), buffer.getReadPointer(0), numSamples);
+    // without its buffers the limiter can't run, and letting the input through unlimited could be far too loud
+    if (! dspPrepared)
+    {
+        buffer.clear();
+        return;
+    }
 
-    // copy all other channels to the second channel of the sideChainBuffer and write the maximum of both channels to the first one
-    for (int ch = 1; ch < totalNumInputChannels; ++ch)
+    // A table for an older threshold, knee or ratio isn't used, the detectors compute the characteristic directly until
+    // the new one arrives. When that happens depends on the message thread, so the decision is recorded with the block.
     {
-        FloatVectorOperations::abs(sideChainBuffer.getWritePointer(1), buffer.getReadPointer(ch), numSamples);
-        FloatVectorOperations::max(sideChainBuffer.getWritePointer(0), sideChainBuffer.getReadPointer(0), sideChainBuffer.getReadPointer(1), numSamples);
+        const int replayed = replayedCharacteristicTableInUse.load();
+        const auto* characteristicTable = characteristicTables.getCurrent();
+        const bool useTable = replayed >= 0 ? replayed > 0
+                                            : characteristicTable != nullptr && characteristicTable->getVersion() == characteristicVersion.load();
+        characteristicTableInUse.store(useTable ? 1.0f : 0.0f);
     }
 
-    /** STEP 2: calculate gain reduction, which one depends on lookAhead */
-    if (useLookAhead)
-        gainReductionComputer.computeGainInDecibelsFromSidechainSignal(sideChainBuffer.getReadPointer(0), sideChainBuffer.getWritePointer(1), numSamples);
+    // record exactly what a replay has to feed in again
+    {
+        TLIMITER_TRACE_ZONE("flight recorder");
+        float parameterSnapshot[FlightRecorder::maxNumParameters];
+        for (size_t i = 0; i < recordedParameterValues.size(); ++i)
+            parameterSnapshot[i] = recordedParameterValues[i]->load(std::memory_order_relaxed);
+
+        // now and then with the state before the block, which a replay starts from
+        if (totalNumInputChannels > 0)
+        {
+            const bool withCheckpoint = flightRecorder.needsCheckpoint() && canSaveCheckpoints();
+            if (withCheckpoint)
+                saveCheckpoint(flightRecorderCheckpoint);
+
+            flightRecorder.record(buffer.getArrayOfReadPointers(), numSamples, parameterSnapshot, withCheckpoint ? &flightRecorderCheckpoint : nullptr);
+        }
+    }
+
+    updateMakeUpGain(numSamples);
+
+    // when offloaded, the worker processes the previous blocks while we only swap buffers
+    if (offloadWorker.isRunning() && ! isNonRealtime())
+    {
+        TLIMITER_TRACE_ZONE("offload exchange");
+        offloadWorker.exchange(buffer.getArrayOfWritePointers(), totalNumInputChannels, numSamples);
+    }
+    else
+    {
+        // A host which switched to rendering offline is only ahead of preparing again: processing here, without the
+        // worker's block of latency, has to wait for the worker's last chunk first. Offline, waiting is fine.
+        offloadWorker.waitUntilIdle();
+
+        AudioBlock<float> block = AudioBlock<float>(buffer).getSubsetChannelBlock(0, static_cast<size_t> (totalNumInputChannels));
+        processChunk(block, gainLink.getGroup() >= 0 ? getTimelinePosition() : -1);
+    }
+
+    numProcessedSamples += numSamples;
+
+    // measure the loudness of what we deliver
+    TLIMITER_TRACE_ZONE("loudness");
+    loudnessMeter.process(buffer.getArrayOfReadPointers(), totalNumInputChannels, numSamples);
+}
+
+void TLimiterAudioProcessor::processOffloaded(void* context, float* const* channels, int numChannels, int numSamples)
+{
+    ScopedNoDenormals noDenormals;
+    TLIMITER_TRACE_ZONE("offloaded chunk");
+
+    auto& processor = *static_cast<TLimiterAudioProcessor*> (context);
+    AudioBlock<float> block(channels, static_cast<size_t> (numChannels), static_cast<size_t> (numSamples));
+
+    // the host's timeline can't be asked from here, and without one there is nothing to link
+    processor.processChunk(block, -1);
+}
+
+void TLimiterAudioProcessor::processChunk(AudioBlock<float>& block, int64 position)
+{
+    const int numSamples = static_cast<int> (block.getNumSamples());
+
+    timingStatistics.begin();
+
+    gainReductionComputer.setMakeUpGain(effectiveMakeUpGain.load(std::memory_order_relaxed));
+
+    // the clipper's ceiling sits on top of the level the limiter aims for
+    outputClipper.setCeiling(gainReductionComputer.getThreshold() + gainReductionComputer.getMakeUpGain() + ceilingParameter->load());
+
+    // the characteristic table stays valid until this block is completed
+    const auto* characteristicTable = characteristicTableInUse.load() > 0.5f ? characteristicTables.getCurrent() : nullptr;
+    forEachGainReductionComputer([&](GainReductionComputer& computer) { computer.setCharacteristicTable(characteristicTable); });
+
+    // Unlinked channels don't share anything, so the workers take whole channel groups through all sub-blocks at once.
+    // Linked channels share one envelope per sub-block, and what's left per channel then is cheaper than a hand-off.
+    if (workerPool.getNumThreads() > 0 && channelLinkParameter->load() < 0.5f)
+    {
+        for (int offset = 0; offset < numSamples; offset += maxSubBlocksPerTask * subBlockSize)
+        {
+            auto part = block.getSubBlock(static_cast<size_t> (offset), static_cast<size_t> (jmin(maxSubBlocksPerTask * subBlockSize, numSamples - offset)));
+            processChannelGroupsInParallel(part);
+        }
+    }
+    else
+    {
+        // cut the block into fixed-size sub-blocks, so the per-callback cost is proportional to its length
+        for (int offset = 0; offset < numSamples; offset += subBlockSize)
+        {
+            auto subBlock = block.getSubBlock(static_cast<size_t> (offset), static_cast<size_t> (jmin(subBlockSize, numSamples - offset)));
+            processSubBlock(subBlock, position < 0 ? position : position + offset);
+        }
+    }
+
+    characteristicTables.blockCompleted();
+    const double callbackSeconds = timingStatistics.end(numSamples);
+
+    // An offline render has no real-time budget to keep, and its output mustn't depend on how fast the machine is.
+    // The new tier takes effect with the next block.
+    if (adaptiveQualityParameter->load() > 0.5f && ! isNonRealtime())
+        qualityGovernor.update(callbackSeconds, numSamples, getSampleRate());
+    else if (qualityGovernor.getTier() != 0)
+        qualityGovernor.reset();
+
+    // the user's settings and the tier are only ever combined here, on the processing thread
+    const bool settingsChanged = qualitySettingsChanged.exchange(false);
+    if (settingsChanged || qualityGovernor.getTier() != appliedQualityTier)
+    {
+        appliedQualityTier = qualityGovernor.getTier();
+        applyQualityTier(appliedQualityTier);
+    }
+}
+
+void TLimiterAudioProcessor::applyQualityTier(int tier)
+{
+    // Only options which don't change the latency are reduced, so tier changes never shift the audio. Oversampling and
+    // look-ahead stay as the user set them. All of these can be changed while processing.
+    const int minDecimationFactor = tier >= 2 ? 16 : (tier == 1 ? 4 : 1);
+    const int decimationFactor = jmax(minDecimationFactor, getDecimationFactorParameter(controlRateParameter->load()));
+    forEachGainReductionComputer([&](GainReductionComputer& computer) { computer.setDecimationFactor(decimationFactor); });
+
+    int shape = roundToInt(noiseShapingParameter->load());
+    if (tier >= 2)
+        shape = jmin(shape, static_cast<int> (NoiseShapingDither::Shape::firstOrder));
+    dither.setShape(static_cast<NoiseShapingDither::Shape> (shape));
+
+    sideChainFilter.setEnabled(tier < 2 && sideChainFilterParameter->load() > 0.5f);
+}
+
+void TLimiterAudioProcessor::updateMakeUpGain(int numSamples)
+{
+    const float makeUp = makeUpParameter->load();
+    float correction = loudnessCorrection.load();
+
+    if (loudnessMatchParameter->load() > 0.5f)
+    {
+        // slowly drive the make-up gain so the short-term loudness of the output approaches the target
+        const float shortTerm = loudnessMeter.getShortTermLoudness();
+        if (shortTerm > -70.0f)
+        {
+            const float target = loudnessTargetParameter->load();
+            const float maxStep = maxLoudnessCorrectionSlewInDecibelsPerSecond * numSamples / static_cast<float> (getSampleRate());
+            correction += jlimit(-maxStep, maxStep, target - shortTerm);
+            correction = jlimit(-10.0f - makeUp, 20.0f - makeUp, correction); // stay within the make-up range
+        }
+    }
+    else
+        correction = 0.0f;
+
+    // only the value itself is handed over, processChunk applies it on whichever thread processes
+    loudnessCorrection = correction;
+    effectiveMakeUpGain.store(makeUp + correction, std::memory_order_relaxed);
+}
+
+void TLimiterAudioProcessor::processSubBlock(AudioBlock<float>& block, int64 position)
+{
+    // dither has to come last, it only fits into the gain stage if nothing follows it
+    const bool useDither = dither.isEnabled();
+    ditherInGainStage = useDither && oversamplers.isEmpty() && outputClipper.getOrder() == AntiderivativeClipper::Order::off;
+
+    if (! oversamplers.isEmpty())
+    {
+        auto oversampledBlock = upsample(block);
+        processLimiter(oversampledBlock, position);
+        downsample(block);
+    }
     else
+        processLimiter(block, position);
+
+    processOutputStages(block, 0, useDither);
+
+    // the detectors hold the meter values of the sub-block they just processed
+    inputLevelHistory.push(getMaxInputLevelInDecibels(), static_cast<int> (block.getNumSamples()));
+    gainReductionHistory.push(getMaxGainReductionInDecibels(), static_cast<int> (block.getNumSamples()));
+}
+
+void TLimiterAudioProcessor::processChannelGroupsInParallel(AudioBlock<float>& block)
+{
+    const int numChannels = static_cast<int> (block.getNumChannels());
+    const int numSamples = static_cast<int> (block.getNumSamples());
+    const int numSubBlocks = (numSamples + subBlockSize - 1) / subBlockSize;
+    const bool useLookAhead = lookAheadParameter->load() > 0.5f;
+
+    // everything the tasks share is settled before they start
+    const bool useDither = dither.isEnabled();
+    ditherInGainStage = useDither && oversamplers.isEmpty() && outputClipper.getOrder() == AntiderivativeClipper::Order::off;
+    sideChainFilter.updateCoefficients();
+
+    auto task = [&](int group)
+    {
+        ScopedNoDenormals noDenormals;
+        TLIMITER_TRACE_ZONE("channel group");
+
+        const int firstChannel = group * channelsPerTask;
+        auto groupBlock = block.getSubsetChannelBlock(static_cast<size_t> (firstChannel), static_cast<size_t> (jmin(channelsPerTask, numChannels - firstChannel)));
+
+        for (int subBlockIndex = 0; subBlockIndex < numSubBlocks; ++subBlockIndex)
+        {
+            const int offset = subBlockIndex * subBlockSize;
+            auto subBlock = groupBlock.getSubBlock(static_cast<size_t> (offset), static_cast<size_t> (jmin(subBlockSize, numSamples - offset)));
+
+            if (! oversamplers.isEmpty())
+            {
+                auto* oversampler = oversamplers[group];
+                auto oversampledBlock = oversampler->processSamplesUp(subBlock);
+                processUnlinked(oversampledBlock, firstChannel, useLookAhead);
+                oversampler->processSamplesDown(subBlock);
+            }
+            else
+                processUnlinked(subBlock, firstChannel, useLookAhead);
+
+            processOutputStages(subBlock, firstChannel, useDither);
+
+            // the history wants every sub-block's levels, which the detectors only hold until the next one
+            auto& meter = channelGroupMeters[group][subBlockIndex];
+            meter = { -std::numeric_limits<float>::infinity(), 0.0f };
+            for (size_t ch = 0; ch < subBlock.getNumChannels(); ++ch)
+            {
+                auto& computer = strips[firstChannel + static_cast<int> (ch)]->gainReductionComputer;
+                meter.inputLevel = jmax(meter.inputLevel, computer.getMaxInputLevelInDecibels());
+                meter.gainReduction = jmin(meter.gainReduction, computer.getMaxGainReductionInDecibels());
+            }
+        }
+    };
+
+    workerPool.parallelFor((numChannels + channelsPerTask - 1) / channelsPerTask, task);
+
+    for (int subBlockIndex = 0; subBlockIndex < numSubBlocks; ++subBlockIndex)
+    {
+        SubBlockMeter meter { -std::numeric_limits<float>::infinity(), 0.0f };
+        for (int group = 0; group * channelsPerTask < numChannels; ++group)
+        {
+            meter.inputLevel = jmax(meter.inputLevel, channelGroupMeters[group][subBlockIndex].inputLevel);
+            meter.gainReduction = jmin(meter.gainReduction, channelGroupMeters[group][subBlockIndex].gainReduction);
+        }
+
+        const int length = jmin(subBlockSize, numSamples - subBlockIndex * subBlockSize);
+        inputLevelHistory.push(meter.inputLevel, length);
+        gainReductionHistory.push(meter.gainReduction, length);
+    }
+}
+
+AudioBlock<float> TLimiterAudioProcessor::getOversamplerChannels(AudioBlock<float>& block, int oversamplerIndex) const
+{
+    if (oversamplers.size() == 1)
+        return block;
+
+    const int firstChannel = oversamplerIndex * channelsPerTask;
+    return block.getSubsetChannelBlock(static_cast<size_t> (firstChannel), static_cast<size_t> (jmin(channelsPerTask, static_cast<int> (block.getNumChannels()) - firstChannel)));
+}
+
+AudioBlock<float> TLimiterAudioProcessor::upsample(AudioBlock<float>& block)
+{
+    if (oversamplers.size() == 1)
+        return oversamplers.getFirst()->processSamplesUp(block);
+
+    // every channel group through its own filters, gathered into one block again for the linked detector
+    size_t numOversampledSamples = 0;
+    for (int i = 0; i < oversamplers.size(); ++i)
+    {
+        auto oversampledGroup = oversamplers[i]->processSamplesUp(getOversamplerChannels(block, i));
+
+        for (size_t ch = 0; ch < oversampledGroup.getNumChannels(); ++ch)
+            oversampledChannels[i * channelsPerTask + static_cast<int> (ch)] = oversampledGroup.getChannelPointer(ch);
+
+        numOversampledSamples = oversampledGroup.getNumSamples();
+    }
+
+    return AudioBlock<float>(oversampledChannels, block.getNumChannels(), numOversampledSamples);
+}
+
+void TLimiterAudioProcessor::downsample(AudioBlock<float>& block)
+{
+    for (int i = 0; i < oversamplers.size(); ++i)
+    {
+        auto channels = getOversamplerChannels(block, i);
+        oversamplers[i]->processSamplesDown(channels);
+    }
+}
+
+void TLimiterAudioProcessor::processOutputStages(AudioBlock<float>& block, int firstChannel, bool useDither)
+{
+    // clip what's left over at the base rate, the antialiasing replaces the oversampling
+    if (outputClipper.getOrder() != AntiderivativeClipper::Order::off)
+    {
+        TLIMITER_TRACE_ZONE("clipper");
+
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+            outputClipper.process(block.getChannelPointer(ch), static_cast<int> (block.getNumSamples()), firstChannel + static_cast<int> (ch));
+    }
+
+    if (useDither && ! ditherInGainStage)
+    {
+        TLIMITER_TRACE_ZONE("dither");
+
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+            dither.process(block.getChannelPointer(ch), static_cast<int> (block.getNumSamples()), firstChannel + static_cast<int> (ch));
+    }
+}
+
+int64 TLimiterAudioProcessor::getTimelinePosition()
+{
+    // linked instances have to agree on the position, and only the host's timeline is the same for all of them
+    if (auto* playHead = getPlayHead())
+    {
+        AudioPlayHead::CurrentPositionInfo info;
+        if (playHead->getCurrentPosition(info) && info.isPlaying && info.timeInSamples >= 0)
+            return info.timeInSamples;
+    }
+
+    return -1;
+}
+
+bool TLimiterAudioProcessor::dumpFlightRecording(const File& file) const
+{
+    std::ofstream stream(file.getFullPathName().toStdString(), std::ios::binary | std::ios::trunc);
+    return stream.is_open() && flightRecorder.writeTo(stream);
+}
+
+void TLimiterAudioProcessor::configureTwoPassLimiter(TwoPassLimiter& limiter)
+{
+    const float ratio = parameters.getRawParameterValue("ratio")->load();
+
+    limiter.setThreshold(parameters.getRawParameterValue("threshold")->load());
+    limiter.setKnee(parameters.getRawParameterValue("knee")->load());
+    limiter.setRatio(ratio > 15.9f ? std::numeric_limits<float>::infinity() : ratio);
+    limiter.setAttackTime(parameters.getRawParameterValue("attack")->load() / 1000);
+    limiter.setReleaseTime(parameters.getRawParameterValue("release")->load() / 1000);
+    limiter.setDecimationFactor(getDecimationFactorParameter(controlRateParameter->load()));
+    limiter.setMakeUpGain(makeUpParameter->load());
+
+    // the envelope knows the future anyway, so the fade only needs to be as long as the processor's
+    limiter.setFadeInTime(lookAheadTimeInSeconds);
+    limiter.setFadeShape(static_cast<LookAheadGainReduction::FadeShape> (roundToInt(parameters.getRawParameterValue("fadeShape")->load())));
+}
+
+//==============================================================================
+bool TLimiterAudioProcessor::canSaveCheckpoints() const
+{
+    return oversamplers.isEmpty()
+        && ! offloadWorker.isRunning()
+        && gainLink.getGroup() < 0
+        && (adaptiveQualityParameter->load() < 0.5f || isNonRealtime()) // offline, the governor holds full quality
+        && loudnessMatchParameter->load() < 0.5f;
+}
+
+void TLimiterAudioProcessor::saveCheckpoint(DspCheckpoint& checkpoint)
+{
+    checkpoint.clear();
+    checkpoint.write(numProcessedSamples);
+
+    gainReductionComputer.saveState(checkpoint);
+    lookAheadFadeIn.saveState(checkpoint);
+    sideChainFilter.saveState(checkpoint);
+
+    const int numChannels = jlimit(1, maxNumChannels, getTotalNumInputChannels());
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* strip = strips[ch];
+        strip->delay.saveState(checkpoint);
+        strip->gainReductionComputer.saveState(checkpoint);
+        strip->lookAheadFadeIn.saveState(checkpoint);
+    }
+
+    outputClipper.saveState(checkpoint);
+    dither.saveState(checkpoint);
+}
+
+bool TLimiterAudioProcessor::restoreCheckpoint(const DspCheckpoint& checkpoint)
+{
+    DspCheckpoint::Reader reader(checkpoint);
+
+    if (! (reader.read(numProcessedSamples)
+           && gainReductionComputer.restoreState(reader)
+           && lookAheadFadeIn.restoreState(reader)
+           && sideChainFilter.restoreState(reader)))
+        return false;
+
+    const int numChannels = jlimit(1, maxNumChannels, getTotalNumInputChannels());
+    for (int ch = 0; ch < numChannels; ++ch)
     {
-        gainReductionComputer.computeLinearGainFromSidechainSignal(sideChainBuffer.getReadPointer(0), sideChainBuffer.getWritePointer(1), numSamples);
+        auto* strip = strips[ch];
+        if (! (strip->delay.restoreState(reader)
+               && strip->gainReductionComputer.restoreState(reader)
+               && strip->lookAheadFadeIn.restoreState(reader)))
+            return false;
     }
-    // gain-reduction is now in the second channel of our sideChainBuffer
 
+    return outputClipper.restoreState(reader) && dither.restoreState(reader) && reader.isComplete();
+}
+
+void TLimiterAudioProcessor::setRecordedValue(const std::string& id, float value)
+{
+    // the replay builds every table before the block, so a block which had one live finds the same one
+    if (id == "characteristicTable")
+        replayedCharacteristicTableInUse = value > 0.5f ? 1 : 0;
+}
 
-    /** STEP 3: fade-in gain reduction if look-ahead is enabled */
-    if (useLookAhead)
+void TLimiterAudioProcessor::clearRecordedValues()
+{
+    replayedCharacteristicTableInUse = -1;
+}
+
+void TLimiterAudioProcessor::processLimiter(AudioBlock<float>& block, int64 position)
+{
+    const bool useLookAhead = lookAheadParameter->load() > 0.5f;
+    const int numChannels = static_cast<int> (block.getNumChannels());
+    const int numSamples = static_cast<int> (block.getNumSamples());
+
+    if (channelLinkParameter->load() < 0.5f)
     {
-        // delay audio signal
-        AudioBlock<float> ab(buffer);
-        ProcessContextReplacing<float> context(ab);
-        delay.process(context);
+        sideChainFilter.updateCoefficients();
+        processUnlinked(block, 0, useLookAhead);
+        return;
+    }
 
-        // fade in gain reduction
-        lookAheadFadeIn.pushSamples(sideChainBuffer.getReadPointer(1), numSamples);
-        lookAheadFadeIn.process();
-        lookAheadFadeIn.readSamples(sideChainBuffer.getWritePointer(1), numSamples);
+    /** STEP 1: compute sidechain-signal */
+    {
+        TLIMITER_TRACE_ZONE("sidechain");
 
-        // add make-up and convert to linear gain
-        const float makeUpGainInDecibels = gainReductionComputer.getMakeUpGain();
-        for (int i = 0; i < numSamples; ++i)
-            sideChainBuffer.setSample(1, i, Decibels::decibelsToGain(sideChainBuffer.getSample(1, i) + makeUpGainInDecibels));
+        if (sideChainFilter.isEnabled())
+        {
+            // the detector EQ filters all channels at once and writes the maximum of their absolute values
+            sideChainFilter.processMaxAbs(getChannelPointers(block), numChannels, sideChainBuffer.getWritePointer(0), numSamples);
+        }
+        else
+        {
+            // copy the absolute values from the first input channel to the sideChainBuffer
+            FloatVectorOperations::abs(sideChainBuffer.getWritePointer(0), block.getChannelPointer(0), numSamples);
+
+            // copy all other channels to the second channel of the sideChainBuffer and write the maximum of both channels to the first one
+            for (int ch = 1; ch < numChannels; ++ch)
+            {
+                FloatVectorOperations::abs(sideChainBuffer.getWritePointer(1), block.getChannelPointer(ch), numSamples);
+                FloatVectorOperations::max(sideChainBuffer.getWritePointer(0), sideChainBuffer.getReadPointer(0), sideChainBuffer.getReadPointer(1), numSamples);
+            }
+        }
     }
 
+    /** STEP 2: calculate gain reduction in decibels */
+    {
+        TLIMITER_TRACE_ZONE("gain computation");
+
+        gainReductionComputer.computeGainInDecibelsFromSidechainSignal(sideChainBuffer.getReadPointer(0), sideChainBuffer.getWritePointer(1), numSamples);
+        // gain-reduction is now in the second channel of our sideChainBuffer
+    }
 
-    /** STEP 4: apply gain-reduction to all channels */
-    for (int ch = 0; ch < totalNumInputChannels; ++ch)
-        FloatVectorOperations::multiply(buffer.getWritePointer(ch), sideChainBuffer.getReadPointer(1), numSamples);
+    /** STEP 2.5: link the gain reduction with the other instances of our link group */
+    {
+        TLIMITER_TRACE_ZONE("gain link");
+        gainLink.linkEnvelope(sideChainBuffer.getWritePointer(1), numSamples, position);
+    }
+
+
+    /** STEP 3: fade-in gain reduction if look-ahead is enabled, and convert to linear gain */
+    {
+        TLIMITER_TRACE_ZONE("fade-in");
+        LimiterCore::convertToLinearGain(sideChainBuffer.getWritePointer(1), numSamples, lookAheadFadeIn, gainReductionComputer.getMakeUpGain(), useLookAhead);
+    }
+
+
+    /** STEP 4: delay the audio signal if look-ahead is enabled, and apply gain-reduction to all channels */
+    {
+        TLIMITER_TRACE_ZONE("gain apply");
+
+        const float* gain = sideChainBuffer.getReadPointer(1);
+        const bool useLinkDelay = gainLink.getLatencyInSamples() > 0;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto channelBlock = block.getSingleChannelBlock(static_cast<size_t> (ch));
+
+            if (useLookAhead)
+                strips[ch]->delay.process(ProcessContextReplacing<float>(channelBlock));
+
+            if (useLinkDelay)
+                strips[ch]->linkDelay.process(ProcessContextReplacing<float>(channelBlock));
+
+            applyGain(channelBlock.getChannelPointer(0), gain, numSamples, ch);
+        }
+    }
+}
+
+void TLimiterAudioProcessor::processUnlinked(AudioBlock<float>& block, int firstChannel, bool useLookAhead)
+{
+    TLIMITER_TRACE_ZONE("unlinked channels");
+
+    const int numChannels = static_cast<int> (block.getNumChannels());
+    const int numSamples = static_cast<int> (block.getNumSamples());
+    const float makeUpGainInDecibels = gainReductionComputer.getMakeUpGain();
+    const bool useLinkDelay = gainLink.getLatencyInSamples() > 0;
+
+    // the detector EQ filters four channels at once, so all keys are computed up front; indexed by bus channel, as the filters are
+    const bool useSideChainFilter = sideChainFilter.isEnabled();
+    if (useSideChainFilter)
+    {
+        const float* channels[maxNumChannels];
+        float* keys[maxNumChannels];
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            channels[firstChannel + ch] = block.getChannelPointer(static_cast<size_t> (ch));
+            keys[firstChannel + ch] = strips[firstChannel + ch]->sideChainBuffer.getWritePointer(0);
+        }
+
+        sideChainFilter.processAbsOfChannels(channels, keys, firstChannel, numChannels, numSamples);
+    }
+
+    // the same four steps as the linked path, but each channel with its own envelope; link groups only apply to linked channels
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const int channel = firstChannel + ch;
+        auto& strip = *strips[channel];
+        auto channelBlock = block.getSingleChannelBlock(static_cast<size_t> (ch));
+        float* gain = strip.sideChainBuffer.getWritePointer(0);
+
+        if (! useSideChainFilter)
+            FloatVectorOperations::abs(gain, channelBlock.getChannelPointer(0), numSamples);
+
+        strip.gainReductionComputer.computeGainInDecibelsFromSidechainSignal(gain, gain, numSamples);
+        LimiterCore::convertToLinearGain(gain, numSamples, strip.lookAheadFadeIn, makeUpGainInDecibels, useLookAhead);
+
+        if (useLookAhead)
+            strip.delay.process(ProcessContextReplacing<float>(channelBlock));
+
+        applyGain(channelBlock.getChannelPointer(0), gain, numSamples, channel);
+
+        // nothing to link, but the latency stays the same
+        if (useLinkDelay)
+            strip.linkDelay.process(ProcessContextReplacing<float>(channelBlock));
+    }
+}
+
+const float* const* TLimiterAudioProcessor::getChannelPointers(AudioBlock<float>& block)
+{
+    const int numChannels = jmin(static_cast<int> (block.getNumChannels()), maxNumChannels);
+    for (int ch = 0; ch < numChannels; ++ch)
+        channelPointers[ch] = block.getChannelPointer(static_cast<size_t> (ch));
+
+    return channelPointers;
+}
+
+void TLimiterAudioProcessor::applyGain(float* samples, const float* gain, int numSamples, int channel)
+{
+    if (ditherInGainStage)
+        dither.processWithGain(samples, gain, numSamples, channel);
+    else
+        FloatVectorOperations::multiply(samples, gain, numSamples);
+}
+
+template <typename Function>
+void TLimiterAudioProcessor::forEachGainReductionComputer(Function&& function)
+{
+    function(gainReductionComputer);
+
+    for (auto* strip : strips)
+        function(strip->gainReductionComputer);
+}
+
+float TLimiterAudioProcessor::getMaxInputLevelInDecibels()
+{
+    if (channelLinkParameter->load() > 0.5f)
+        return gainReductionComputer.getMaxInputLevelInDecibels();
+
+    float level = -std::numeric_limits<float>::infinity();
+    for (int ch = 0; ch < jmin(maxNumChannels, getTotalNumInputChannels()); ++ch)
+        level = jmax(level, strips[ch]->gainReductionComputer.getMaxInputLevelInDecibels());
+
+    return level;
+}
+
+float TLimiterAudioProcessor::getMaxGainReductionInDecibels()
+{
+    if (channelLinkParameter->load() > 0.5f)
+        return gainReductionComputer.getMaxGainReductionInDecibels();
+
+    float gainReduction = 0.0f;
+    for (int ch = 0; ch < jmin(maxNumChannels, getTotalNumInputChannels()); ++ch)
+        gainReduction = jmin(gainReduction, strips[ch]->gainReductionComputer.getMaxGainReductionInDecibels());
+
+    return gainReduction;
 }
 
 AudioProcessorValueTreeState::ParameterLayout TLimiterAudioProcessor::createParameters()
@@ -233,6 +1102,28 @@ AudioProcessorValueTreeState::ParameterLayout TLimiterAudioProcessor::createPara
         AudioProcessorParameter::genericParameter, [](float value, int maximumStringLength) { if (value > 15.9f) return String("inf"); return String(value, 2); }));
     parameterVector.push_back(make_unique<AudioParameterFloat>("makeUp", "MakeUp Gain", NormalisableRange<float>(-10.0f, 20.0f, 0.1f), 0.0f, "dB"));
     parameterVector.push_back(make_unique<AudioParameterBool>("lookAhead", "Look-Ahead", false));
+    parameterVector.push_back(make_unique<AudioParameterChoice>("fadeShape", "Look-Ahead Fade", StringArray { "Linear", "Raised Cosine", "Exponential", "S-Curve" }, 0));
+    parameterVector.push_back(make_unique<AudioParameterChoice>("linkGroup", "Link Group", StringArray { "Off", "1", "2", "3", "4", "5", "6", "7", "8" }, 0));
+    parameterVector.push_back(make_unique<AudioParameterChoice>("oversampling", "Oversampling", StringArray { "Off", "2x", "4x", "8x" }, 0));
+    parameterVector.push_back(make_unique<AudioParameterChoice>("oversamplingQuality", "Oversampling Filter", StringArray { "Minimum Phase (IIR)", "Linear Phase (FIR)" }, 0));
+    parameterVector.push_back(make_unique<AudioParameterChoice>("controlRate", "Control Rate", StringArray { "Off", "1/4", "1/8", "1/16" }, 0));
+    parameterVector.push_back(make_unique<AudioParameterChoice>("clipper", "Clipper", StringArray { "Off", "ADAA 1st Order", "ADAA 2nd Order" }, 0));
+    parameterVector.push_back(make_unique<AudioParameterFloat>("ceiling", "Clipper Ceiling", NormalisableRange<float>(0.0f, 6.0f, 0.1f), 1.0f, "dB"));
+    parameterVector.push_back(make_unique<AudioParameterChoice>("dither", "Dither", StringArray { "Off", "16 bit", "24 bit" }, 0));
+    parameterVector.push_back(make_unique<AudioParameterChoice>("noiseShaping", "Noise Shaping", StringArray { "None", "First Order", "Wannamaker 3-Tap", "Lipshitz 5-Tap" }, 0));
+    parameterVector.push_back(make_unique<AudioParameterBool>("sideChainFilter", "Detector EQ", false));
+    parameterVector.push_back(make_unique<AudioParameterFloat>("sideChainHighPass", "Detector High-Pass", NormalisableRange<float>(20.0f, 500.0f, 1.0f, 0.4f), 80.0f, "Hz"));
+    parameterVector.push_back(make_unique<AudioParameterFloat>("sideChainTilt", "Detector Tilt", NormalisableRange<float>(-6.0f, 6.0f, 0.1f), 0.0f, "dB"));
+    parameterVector.push_back(make_unique<AudioParameterBool>("channelLink", "Channel Link", true));
+    parameterVector.push_back(make_unique<AudioParameterBool>("parallelChannels", "Parallel Channels", false));
+    // the tiers only reduce what doesn't change the latency, the text says so wherever the host shows the value
+    parameterVector.push_back(make_unique<AudioParameterBool>("adaptiveQuality", "Adaptive Quality", false, String(),
+                                                              [](bool value, int) { return value ? String("On (keeps oversampling and look-ahead)") : String("Off"); },
+                                                              [](const String& text) { return text.startsWithIgnoreCase("On"); }));
+    parameterVector.push_back(make_unique<AudioParameterBool>("offload", "Offload to Worker", false));
+    parameterVector.push_back(make_unique<AudioParameterBool>("flightRecorder", "Flight Recorder", true));
+    parameterVector.push_back(make_unique<AudioParameterBool>("loudnessMatch", "Loudness Match", false));
+    parameterVector.push_back(make_unique<AudioParameterFloat>("loudnessTarget", "Loudness Target", NormalisableRange<float>(-36.0f, -6.0f, 0.1f), -14.0f, "LUFS"));
 
     return { parameterVector.begin(), parameterVector.end() };
 }
@@ -273,34 +1164,70 @@ void TLimiterAudioProcessor::parameterChanged(const String& parameterID, float n
 {
     if (parameterID == "threshold")
     {
-        gainReductionComputer.setThreshold(newValue);
+        forEachGainReductionComputer([&](GainReductionComputer& computer) { computer.setThreshold(newValue); });
+        ++characteristicVersion;
         characteristicChanged = true;
+        characteristicTableNeedsUpdate = true;
+        triggerAsyncUpdate();
     }
     else if (parameterID == "knee")
     {
-        gainReductionComputer.setKnee(newValue);
+        forEachGainReductionComputer([&](GainReductionComputer& computer) { computer.setKnee(newValue); });
+        ++characteristicVersion;
         characteristicChanged = true;
+        characteristicTableNeedsUpdate = true;
+        triggerAsyncUpdate();
     }
     else if (parameterID == "attack")
-        gainReductionComputer.setAttackTime(newValue / 1000);
+        forEachGainReductionComputer([&](GainReductionComputer& computer) { computer.setAttackTime(newValue / 1000); });
     else if (parameterID == "release")
-        gainReductionComputer.setReleaseTime(newValue / 1000);
+        forEachGainReductionComputer([&](GainReductionComputer& computer) { computer.setReleaseTime(newValue / 1000); });
     else if (parameterID == "ratio")
     {
-        if (newValue > 15.9f)
-            gainReductionComputer.setRatio(std::numeric_limits<float>::infinity());
-        else
-            gainReductionComputer.setRatio(newValue);
+        const float ratio = newValue > 15.9f ? std::numeric_limits<float>::infinity() : newValue;
+        forEachGainReductionComputer([&](GainReductionComputer& computer) { computer.setRatio(ratio); });
+        ++characteristicVersion;
 
         characteristicChanged = true;
+        characteristicTableNeedsUpdate = true;
+        triggerAsyncUpdate();
     }
     else if (parameterID == "makeUp")
+        characteristicChanged = true; // the audio thread picks up the make-up gain with the next block
+    else if (parameterID == "controlRate" || parameterID == "noiseShaping" || parameterID == "sideChainFilter")
+        qualitySettingsChanged = true; // the governor might hold these below the user's setting
+    else if (parameterID == "linkGroup")
     {
-        gainReductionComputer.setMakeUpGain(newValue);
-        characteristicChanged = true;
+        // the link latency depends on the group, so it's joined while preparing
+        processingNeedsUpdate = true;
+        triggerAsyncUpdate();
+    }
+    else if (parameterID == "fadeShape")
+    {
+        const auto fadeShape = static_cast<LookAheadGainReduction::FadeShape> (roundToInt(newValue));
+        lookAheadFadeIn.setFadeShape(fadeShape);
+        for (auto* strip : strips)
+            strip->lookAheadFadeIn.setFadeShape(fadeShape);
+    }
+    else if (parameterID == "clipper")
+    {
+        // second order adds a sample of latency
+        outputClipper.setOrder(static_cast<AntiderivativeClipper::Order> (roundToInt(newValue)));
+        processingNeedsUpdate = true;
+        triggerAsyncUpdate();
+    }
+    else if (parameterID == "dither")
+        dither.setBitDepth(getDitherBitDepthParameter(newValue));
+    else if (parameterID == "sideChainHighPass")
+        sideChainFilter.setHighPassFrequency(newValue);
+    else if (parameterID == "sideChainTilt")
+        sideChainFilter.setTilt(newValue);
+    else if (parameterID == "oversampling" || parameterID == "oversamplingQuality" || parameterID == "parallelChannels"
+          || parameterID == "offload" || parameterID == "flightRecorder")
+    {
+        processingNeedsUpdate = true;
+        triggerAsyncUpdate();
     }
     else
         jassertfalse;
 }
-
-
@@ -11,6 +11,22 @@
 #include <JuceHeader.h>
 #include "../Modules/GainReductionComputer.h"
 #include "../Modules/LookAheadGainReduction.h"
+#include "../Modules/CallbackTimingStatistics.h"
+#include "../Modules/LoudnessMeter.h"
+#include "../Modules/TraceZones.h"
+#include "../Modules/GainLinkGroup.h"
+#include "../Modules/WorkerPool.h"
+#include "../Modules/LimiterCore.h"
+#include "../Modules/AntiderivativeClipper.h"
+#include "../Modules/NoiseShapingDither.h"
+#include "../Modules/MemoryArena.h"
+#include "../Modules/SideChainFilter.h"
+#include "../Modules/QualityGovernor.h"
+#include "../Modules/OffloadWorker.h"
+#include "../Modules/FlightRecorder.h"
+#include "../Modules/MinMaxPyramid.h"
+#include "../Modules/DspCheckpoint.h"
+#include "../Modules/TwoPassLimiter.h"
 #include "../ThirdParty/Delay.h"
 
 using namespace juce;
@@ -20,7 +36,8 @@ using namespace dsp;
 //==============================================================================
 /**
 */
-class TLimiterAudioProcessor  : public juce::AudioProcessor, public AudioProcessorValueTreeState::Listener
+class TLimiterAudioProcessor  : public juce::AudioProcessor, public AudioProcessorValueTreeState::Listener, public AsyncUpdater,
+                                public CheckpointableProcessor, public ReplayableProcessor
 {
 public:
     //==============================================================================
@@ -40,6 +57,9 @@ public:
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
+    /** An offline render doesn't use the offload worker: switching without preparing again has the worker started or stopped asynchronously, with the latency which goes with it. */
+    void setNonRealtime(bool nonRealtime) noexcept override;
+
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -70,19 +90,240 @@ public:
 
     GainReductionComputer& getCompressor() { return gainReductionComputer; };
 
+    /** Input level for the meter; the loudest channel when the channels aren't linked. */
+    float getMaxInputLevelInDecibels();
+
+    /** Gain reduction for the meter; the strongest one of all channels when they aren't linked. */
+    float getMaxGainReductionInDecibels();
+
     Atomic<bool> characteristicChanged = true;
 
+    /** The widest bus we accept, e.g. 7th order Ambisonics. */
+    static constexpr int maxNumChannels = 64;
+
+    /** The DSP modules always process host buffers in chunks of this many samples, no matter how big the host's blocks are. */
+    static constexpr int subBlockSize = 64;
+
+    const CallbackTimingStatistics& getTimingStatistics() const { return timingStatistics; }
+
+    /** The CPU load and the quality tier of the adaptive quality mode. */
+    const QualityGovernor& getQualityGovernor() const { return qualityGovernor; }
+
+    /** Loudness of the processed output. */
+    const LoudnessMeter& getLoudnessMeter() const { return loudnessMeter; }
+
+    /** The make-up gain currently added by the loudness-target mode, in decibels. */
+    float getLoudnessCorrection() const { return loudnessCorrection.load(); }
+
+    /** The memory this instance holds for its DSP: the arena, the processor and its channel strips, and the flight recorder. Updated in prepareToPlay. */
+    size_t getMemoryUsageInBytes() const { return memoryUsageInBytes.load(); }
+
+    /** Writes the last seconds of input, block sizes and parameter values to a file, which OfflineRenderer::replay can run through the processor again. With settings which allow checkpoints, the dump also holds the DSP state before its first block, so the replay is bit for bit what was heard. Call it from the message thread; the audio thread keeps running. Returns false if the flight recorder is off, nothing has been recorded yet or the file can't be written.
+     */
+    bool dumpFlightRecording(const File& file) const;
+
+    /** Gives an offline TwoPassLimiter the current threshold, knee, ratio, attack, release, control rate, make-up gain and fade shape, and the look-ahead time as its fade-in, e.g. for OfflineRenderer::renderTwoPass(). The loudness target and the output stages aren't part of it. */
+    void configureTwoPassLimiter(TwoPassLimiter& limiter);
+
+    /** The flight recorder keeps this long, unless that takes more than flightRecordingMaxBytes: wide buses at high rates get less. */
+    static constexpr double flightRecordingLengthInSeconds = 10.0;
+    static constexpr size_t flightRecordingMaxBytes = 32 << 20;
+
+    /** The input level and the gain reduction of every sub-block, as for the meters, over the last historyLengthInSeconds. Written by whichever thread processes, readable from any other. */
+    const MinMaxPyramid& getInputLevelHistory() const { return inputLevelHistory; }
+    const MinMaxPyramid& getGainReductionHistory() const { return gainReductionHistory; }
+
+    static constexpr double historyLengthInSeconds = 600.0;
+
+    /** Every level of the histories keeps this many bins, a few times as many as a display is wide, so scrolling back a few screens doesn't get coarser. */
+    static constexpr int historyBinsPerLevel = 4096;
+
+    //==============================================================================
+    /** Checkpoints hold the detectors, look-ahead and delay lines of all channels, the detector EQ, the clipper and the dither. They aren't available with oversampling, whose filter states are hidden in juce::dsp::Oversampling, nor with settings which make the output depend on more than the audio so far: the offload worker, gain link groups, adaptive quality outside of offline renders and loudness match.
+     */
+    bool canSaveCheckpoints() const override;
+    void saveCheckpoint(DspCheckpoint& checkpoint) override;
+    bool restoreCheckpoint(const DspCheckpoint& checkpoint) override;
+
+    //==============================================================================
+    /** Besides the parameters, the flight recorder keeps whether each block used the characteristic table, under the ID "characteristicTable". Live, that depends on when the message thread handed over the table for the latest threshold, knee and ratio; a replay sets it for each block instead of building a table.
+     */
+    void setRecordedValue(const std::string& id, float value) override;
+    void clearRecordedValues() override;
+
 private:
 
     AudioProcessorValueTreeState::ParameterLayout createParameters();
 
+    /** Processes the block in sub-blocks, with everything that has to happen once per block on the thread which runs the DSP: the characteristic table, the timing and the quality governor. */
+    void processChunk(AudioBlock<float>& block, int64 position);
+
+    /** The offload worker's process function. */
+    static void processOffloaded(void* context, float* const* channels, int numChannels, int numSamples);
+
+    /** Processes one sub-block of at most subBlockSize samples, including the oversampling. The position is the sub-block's position on the host's timeline, or -1 without one. */
+    void processSubBlock(AudioBlock<float>& block, int64 position);
+
+    /** Processes unlinked channels in one fan-out on the worker pool: each task takes a group of channelsPerTask channels through all sub-blocks of the block, which holds at most maxSubBlocksPerTask of them. */
+    void processChannelGroupsInParallel(AudioBlock<float>& block);
+
+    /** Oversamples all channels of the sub-block, with one or several oversamplers, and brings them back to the base rate. */
+    AudioBlock<float> upsample(AudioBlock<float>& block);
+    void downsample(AudioBlock<float>& block);
+
+    /** The channels of the block which the oversampler with the given index filters. */
+    AudioBlock<float> getOversamplerChannels(AudioBlock<float>& block, int oversamplerIndex) const;
+
+    /** Runs the clipper and the dither, unless it's part of the gain stage, on the channels of the block, which are the bus channels from firstChannel on. */
+    void processOutputStages(AudioBlock<float>& block, int firstChannel, bool useDither);
+
+    /** Runs the detector, the look-ahead and the gain stage on the given block, which might be oversampled. The position is the block's position on the host's timeline at the base rate, or -1 without one. */
+    void processLimiter(AudioBlock<float>& block, int64 position);
+
+    /** Multiplies a channel with the gain; when the gain stage is the last stage, the dither is applied in the same pass. */
+    void applyGain(float* samples, const float* gain, int numSamples, int channel);
+
+    /** Collects the channel pointers of the block for the modules which process all channels at once. */
+    const float* const* getChannelPointers(AudioBlock<float>& block);
+
+    /** Limits every channel on its own, with the detector and look-ahead of its strip. The block's channels are the bus channels from firstChannel on; channel groups of different threads can be processed at the same time, once the detector EQ's coefficients are up to date. */
+    void processUnlinked(AudioBlock<float>& block, int firstChannel, bool useLookAhead);
+
+    /** Calls function(computer) for the linked detector and the detectors of all channel strips. */
+    template <typename Function>
+    void forEachGainReductionComputer(Function&& function);
+
+    /** Returns the host's timeline position while it's playing, otherwise -1: only the host's timeline is shared by all instances. */
+    int64 getTimelinePosition();
+
+    /** Moves the loudness correction towards the loudness target and hands the effective make-up gain to the processing thread. */
+    void updateMakeUpGain(int numSamples);
+
+    /** Reports the latency of the current oversampling, look-ahead and offload settings to the host. */
+    void updateLatency();
+
+    /** Whether the offload worker should run: only when asked for, and never offline, where it would only add latency. */
+    bool shouldRunOffloadWorker() const;
+
+    /** Rebuilds the characteristic table, and re-prepares everything after the oversampling or worker settings changed. */
+    void handleAsyncUpdate() override;
+
+    /** Bakes the current threshold, knee and ratio into a new table and hands it to the audio thread. */
+    void rebuildCharacteristicTable();
+
+    /** Applies the control rate, noise shaping and detector EQ the user set, reduced as far as the given quality tier demands. Processing thread only. */
+    void applyQualityTier(int tier);
+
+    /** Returns the dither's word length (0 for off, 16 or 24) for the given dither choice. */
+    static int getDitherBitDepthParameter(float choice);
+
+    /** Returns the detector's decimation factor (1, 4, 8 or 16) for the given control rate choice. */
+    static int getDecimationFactorParameter(float choice);
+
+    /** Returns the number of arena bytes prepareToPlay takes at the given (oversampled) rate, block size, channel count and link latency. */
+    static size_t getRequiredArenaBytes(double processingRate, int processingBlockSize, int numChannels, int linkLatency);
+
+    /** Returns the BS.1770 weight of every channel of the layout: the surround channels at the sides count more, the LFE not at all. */
+    static std::vector<float> getLoudnessWeights(const AudioChannelSet& layout);
+
+    /** Returns the oversampling factor (1, 2, 4 or 8) selected by the parameter. */
+    int getOversamplingFactorParameter() const;
+
+    CallbackTimingStatistics timingStatistics;
+
+    // looked up once in the constructor, read with every block
+    std::atomic<float>* lookAheadParameter = nullptr;
+    std::atomic<float>* channelLinkParameter = nullptr;
+    std::atomic<float>* ceilingParameter = nullptr;
+    std::atomic<float>* adaptiveQualityParameter = nullptr;
+    std::atomic<float>* makeUpParameter = nullptr;
+    std::atomic<float>* loudnessMatchParameter = nullptr;
+    std::atomic<float>* loudnessTargetParameter = nullptr;
+    std::atomic<float>* controlRateParameter = nullptr;
+    std::atomic<float>* noiseShapingParameter = nullptr;
+    std::atomic<float>* sideChainFilterParameter = nullptr;
+
+    QualityGovernor qualityGovernor;
+    int appliedQualityTier = 0; // audio thread only
+    std::atomic<bool> qualitySettingsChanged { false }; // set when a setting the tiers reduce changes, applied on the processing thread
+    int64 numProcessedSamples = 0;
+
+    GainLinkMember gainLink;
+
+    LoudnessMeter loudnessMeter;
+    std::atomic<float> loudnessCorrection { 0.0f };
+    std::atomic<float> effectiveMakeUpGain { 0.0f }; // make-up plus loudness correction, set by the audio thread, applied on the processing thread
+    static constexpr float maxLoudnessCorrectionSlewInDecibelsPerSecond = 1.0f;
+
+    static constexpr float lookAheadTimeInSeconds = 0.005f;
+    static constexpr double maxPlannedSampleRate = 192000.0;
+
+    // holds the delay lines, look-ahead buffers and side-chain buffers of all channels
+    MemoryArena arena;
+    std::atomic<size_t> memoryUsageInBytes { 0 };
+    bool dspPrepared = false; // false until prepareToPlay got all of its buffers
+
+    int oversamplingFactor = 1;
+    OwnedArray<Oversampling<float>> oversamplers; // empty without oversampling; one for all channels, or one per channel group while the worker pool runs
+    float* oversampledChannels[maxNumChannels] = {};
+
     GainReductionComputer gainReductionComputer;
 
-    Delay delay;
+    CharacteristicTableHandOver characteristicTables;
+    std::atomic<bool> characteristicTableNeedsUpdate { false };
+    std::atomic<uint64_t> characteristicVersion { 0 }; // counts changes of threshold, knee and ratio; a table is only used if it was built for the latest
+    std::atomic<float> characteristicTableInUse { 0.0f }; // decided for each block before it's recorded, 1 if the block uses the table
+    std::atomic<int> replayedCharacteristicTableInUse { -1 }; // set by a replay for each block, -1 outside of one
+    std::atomic<bool> processingNeedsUpdate { false };
+    std::atomic<bool> workerModeChanged { false }; // switched between real-time and offline without preparing again
 
     LookAheadGainReduction lookAheadFadeIn;
     AudioBuffer<float> sideChainBuffer;
 
+    SideChainFilter sideChainFilter;
+    const float* channelPointers[maxNumChannels] = {};
+
+    AntiderivativeClipper outputClipper;
+
+    NoiseShapingDither dither;
+    bool ditherInGainStage = false; // set for each sub-block, or each fan-out to the workers
+
+    /** Everything a single channel needs of its own: its delay lines and, for unlinked limiting, its detector, look-ahead and scratch buffer. */
+    struct ChannelStrip
+    {
+        Delay delay;
+        Delay linkDelay; // waits for the other members of the link group, bypassed outside of one
+        GainReductionComputer gainReductionComputer;
+        LookAheadGainReduction lookAheadFadeIn;
+        AudioBuffer<float> sideChainBuffer;
+    };
+    OwnedArray<ChannelStrip> strips; // always maxNumChannels, so parameter changes never race with a reallocation
+
+    /** Narrower buses are processed inline, the hand-off would cost more than it saves. Tasks are as wide as the detector EQ's filter groups. */
+    static constexpr int minNumChannelsForWorkers = 8;
+    static constexpr int channelsPerTask = 4;
+    static constexpr int maxSubBlocksPerTask = 64;
+    static_assert(channelsPerTask % MultiChannelBiquad::lanes == 0, "a task has to cover whole detector EQ filter groups");
+    WorkerPool workerPool;
+
+    /** The meter values of every sub-block of a fan-out, per channel group: the detectors only hold the last one. */
+    struct SubBlockMeter
+    {
+        float inputLevel, gainReduction;
+    };
+    SubBlockMeter channelGroupMeters[maxNumChannels / channelsPerTask][maxSubBlocksPerTask];
+
+    /** Runs processChunk on its own thread, one host block behind, when processing is offloaded. */
+    OffloadWorker offloadWorker;
+
+    /** Records every block's input and parameters before it's processed. */
+    FlightRecorder flightRecorder;
+    DspCheckpoint flightRecorderCheckpoint; // sized in prepareToPlay, so saving it on the audio thread doesn't allocate
+    std::vector<std::string> recordedParameterIDs;
+    std::vector<std::atomic<float>*> recordedParameterValues;
+
+    MinMaxPyramid inputLevelHistory, gainReductionHistory;
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TLimiterAudioProcessor)
 };
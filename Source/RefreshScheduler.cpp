@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    RefreshScheduler.cpp
+
+  ==============================================================================
+*/
+
+#include "RefreshScheduler.h"
+
+RefreshScheduler::~RefreshScheduler()
+{
+    stopTimer();
+}
+
+void RefreshScheduler::addClient (Client* client)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    clients.addIfNotAlreadyThere (client);
+
+    if (! isTimerRunning())
+        startTimerHz (refreshRateInHz);
+}
+
+void RefreshScheduler::removeClient (Client* client)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    clients.removeFirstMatchingValue (client);
+
+    if (clients.isEmpty())
+        stopTimer();
+}
+
+void RefreshScheduler::timerCallback()
+{
+    const bool backgroundTick = (tickCount++ % backgroundRateDivider) == 0;
+
+    // iterate backwards, so clients may remove themselves from within refresh()
+    for (int i = clients.size(); --i >= 0;)
+    {
+        if (i >= clients.size())
+            continue;
+
+        auto* client = clients.getUnchecked (i);
+
+        // isShowing() is false for hidden components and for minimised windows
+        if (backgroundTick || client->getRefreshComponent().isShowing())
+            client->refresh();
+    }
+}
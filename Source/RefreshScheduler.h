@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    RefreshScheduler.h
+
+    A process-wide display refresh clock shared by all open editors.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+using namespace juce;
+
+//==============================================================================
+/**
+ A single message-thread timer which drives the display updates of every open editor in the process. Instead of each editor running its own 60 Hz timer, editors register as clients and are refreshed together in one tick, so JUCE can coalesce their repaints. Editors which are hidden or minimised are only refreshed at a low background rate.
+
+ Hold it with a SharedResourcePointer<RefreshScheduler>, so all instances share the same scheduler.
+ */
+class RefreshScheduler : private Timer
+{
+public:
+    /** Interface for components which want to be refreshed by the scheduler. */
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        /** Called on the message thread on every scheduler tick the client is due. Clients should only repaint the regions whose values actually changed.
+         */
+        virtual void refresh() = 0;
+
+        /** The component whose visibility decides if the client is refreshed at the full or the background rate.
+         */
+        virtual Component& getRefreshComponent() = 0;
+    };
+
+    RefreshScheduler() {}
+    ~RefreshScheduler() override;
+
+    void addClient (Client* client);
+    void removeClient (Client* client);
+
+    static constexpr int refreshRateInHz = 60;
+
+    /** Hidden or minimised clients are only refreshed every n-th tick. */
+    static constexpr int backgroundRateDivider = 15;
+
+private:
+    void timerCallback() override;
+
+    Array<Client*> clients;
+    uint32 tickCount = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RefreshScheduler)
+};
@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    AntiderivativeClipperTest.cpp
+
+    Clips low-frequency sines over the ceiling and checks that the output stays under the ceiling and on the static curve; then clips the channels of one clipper on several threads at once, as the processor's channel groups do, and compares them bit for bit with clipping them one after the other.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "AntiderivativeClipper.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr int blockSize = 64;
+    constexpr int numChannels = 8;
+    constexpr int channelsPerThread = 4;
+    constexpr int numBlocks = 20000;
+
+    /** Noise up to twice the ceiling, different on every channel. */
+    std::vector<std::vector<float>> makeSignal()
+    {
+        std::mt19937 random (3);
+        std::uniform_real_distribution<float> noise (-2.0f, 2.0f);
+
+        std::vector<std::vector<float>> channels (numChannels, std::vector<float> (static_cast<size_t> (numBlocks * blockSize)));
+        for (auto& channel : channels)
+            for (auto& sample : channel)
+                sample = noise (random);
+
+        return channels;
+    }
+
+    void prepare (AntiderivativeClipper& clipper, const AntiderivativeClipper::Order order)
+    {
+        clipper.setOrder (order);
+        clipper.setCeiling (-1.0f);
+        clipper.prepare (blockSize, numChannels);
+    }
+
+    /** At low frequencies neighbouring samples are close, and the difference quotients are ill-conditioned; the output must still follow the static curve, delayed by the clipper's half or whole sample, and never exceed the ceiling. */
+    void testLowFrequencies (const AntiderivativeClipper::Order order)
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int numSamples = 96000;
+
+        AntiderivativeClipper clipper;
+        prepare (clipper, order);
+        const float ceiling = std::pow (10.0f, 0.05f * -1.0f);
+        const double delay = order == AntiderivativeClipper::Order::first ? 0.5 : 1.0;
+
+        float maxOutput = 0.0f, maxError = 0.0f;
+
+        for (const double frequency : { 5.0, 10.0, 20.0, 50.0, 100.0 })
+        {
+            const double omega = 2.0 * 3.14159265358979323846 * frequency / sampleRate;
+            std::vector<float> samples (static_cast<size_t> (numSamples));
+            for (int i = 0; i < numSamples; ++i)
+                samples[static_cast<size_t> (i)] = static_cast<float> (1.3 * ceiling * std::sin (omega * i));
+
+            clipper.reset();
+            for (int position = 0; position < numSamples; position += blockSize)
+                clipper.process (samples.data() + position, blockSize, 0);
+
+            for (int i = 2; i < numSamples; ++i)
+            {
+                const auto expected = ceiling * AntiderivativeClipper::clip (static_cast<float> (1.3 * std::sin (omega * (i - delay))));
+                maxOutput = std::max (maxOutput, std::abs (samples[static_cast<size_t> (i)]));
+                maxError = std::max (maxError, std::abs (samples[static_cast<size_t> (i)] - expected));
+            }
+        }
+
+        std::printf ("%s order, 5 to 100 Hz at 1.3 times the ceiling: peak %.2f dB under the ceiling, max %g from the static curve\n",
+                     order == AntiderivativeClipper::Order::first ? "first" : "second", -20.0 * std::log10 (maxOutput / ceiling), maxError);
+        expect (maxOutput <= ceiling, "low frequencies don't exceed the ceiling");
+        expect (maxError < 2.0e-4f * ceiling, "low frequencies follow the static curve");
+    }
+
+    /** Every channel has its own scratch memory, so channel groups on different threads don't disturb each other. */
+    void testChannelsOnThreads (const AntiderivativeClipper::Order order)
+    {
+        const auto input = makeSignal();
+
+        auto sequential = input;
+        AntiderivativeClipper sequentialClipper;
+        prepare (sequentialClipper, order);
+
+        for (int b = 0; b < numBlocks; ++b)
+            for (int ch = 0; ch < numChannels; ++ch)
+                sequentialClipper.process (sequential[static_cast<size_t> (ch)].data() + b * blockSize, blockSize, ch);
+
+        // each thread takes its group of channels through all blocks, as a task of the processor does
+        auto parallel = input;
+        AntiderivativeClipper parallelClipper;
+        prepare (parallelClipper, order);
+
+        std::vector<std::thread> threads;
+        for (int first = 0; first < numChannels; first += channelsPerThread)
+        {
+            threads.emplace_back ([&, first]
+            {
+                for (int b = 0; b < numBlocks; ++b)
+                    for (int ch = first; ch < first + channelsPerThread; ++ch)
+                        parallelClipper.process (parallel[static_cast<size_t> (ch)].data() + b * blockSize, blockSize, ch);
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        expect (parallel == sequential, order == AntiderivativeClipper::Order::first ? "first order: channels clipped on different threads are the same as one after the other"
+                                                                                      : "second order: channels clipped on different threads are the same as one after the other");
+    }
+}
+
+int main()
+{
+    testLowFrequencies (AntiderivativeClipper::Order::first);
+    testLowFrequencies (AntiderivativeClipper::Order::second);
+    testChannelsOnThreads (AntiderivativeClipper::Order::first);
+    testChannelsOnThreads (AntiderivativeClipper::Order::second);
+
+    return getExitCode();
+}
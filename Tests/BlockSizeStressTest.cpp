@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    BlockSizeStressTest.cpp
+
+    Feeds the processor random host block sizes, larger than announced too, and measures the timing jitter.
+
+  ==============================================================================
+*/
+
+#include "ProcessorHarness.h"
+#include "TestUtilities.h"
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int announcedBlockSize = 512;
+    constexpr int numChannels = 2;
+
+    std::unique_ptr<TLimiterAudioProcessor> createProcessor()
+    {
+        auto processor = std::make_unique<TLimiterAudioProcessor>();
+
+        // with look-ahead and no attack, nothing gets past the threshold
+        ProcessorHarness::setParameter (*processor, "lookAhead", 1.0f);
+        ProcessorHarness::setParameter (*processor, "attack", 0.0f);
+        ProcessorHarness::setParameter (*processor, "threshold", -10.0f);
+
+        ProcessorHarness::prepare (*processor, numChannels, sampleRate, announcedBlockSize);
+        return processor;
+    }
+
+    void printTiming (const char* name, const ProcessorHarness::Timing& timing, const int numSamples)
+    {
+        std::printf ("%-24s %6d blocks  %7.1f ns/sample  fastest %7.1f us  slowest %7.1f us\n", name, timing.numBlocks,
+                     1.0e9 * timing.totalSeconds / numSamples, 1.0e6 * timing.minimumSeconds, 1.0e6 * timing.maximumSeconds);
+    }
+}
+
+int main()
+{
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    AudioBuffer<float> input (numChannels, static_cast<int> (30 * sampleRate));
+    ProcessorHarness::fillWithTestSignal (input, 3);
+
+    // the reference: the announced block size every time
+    AudioBuffer<float> expected (input);
+    auto reference = createProcessor();
+    printTiming ("fixed blocks", ProcessorHarness::process (*reference, expected, [] (int) { return announcedBlockSize; }), input.getNumSamples());
+
+    for (const int64 seed : { 1, 2, 3 })
+    {
+        // 1 to 8 times the announced size, with many odd and tiny blocks in between
+        Random random (seed);
+        auto blockSizeFor = [&random] (int)
+        {
+            switch (random.nextInt (4))
+            {
+                case 0:  return 1 + random.nextInt (16);
+                case 1:  return 1 + 2 * random.nextInt (announcedBlockSize / 2);
+                case 2:  return announcedBlockSize;
+                default: return announcedBlockSize + random.nextInt (7 * announcedBlockSize);
+            }
+        };
+
+        AudioBuffer<float> output (input);
+        auto processor = createProcessor();
+        const auto timing = ProcessorHarness::process (*processor, output, blockSizeFor);
+        printTiming ("random blocks", timing, input.getNumSamples());
+
+        expect (processor->getLatencySamples() == reference->getLatencySamples(), "the latency doesn't depend on the block sizes");
+
+        // the sub-blocks start at every host block, but none of the stages depends on where they start
+        float maxDifference = 0.0f;
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < input.getNumSamples(); ++i)
+                maxDifference = jmax (maxDifference, std::abs (output.getSample (ch, i) - expected.getSample (ch, i)));
+
+        std::printf ("max difference to the fixed blocks: %g\n", maxDifference);
+        expect (maxDifference < 1.0e-5f, "the output doesn't depend on the host's block sizes");
+
+        const float threshold = Decibels::decibelsToGain (-10.0f);
+        expect (output.getMagnitude (0, output.getNumSamples()) <= threshold * 1.001f, "the output stays below the threshold");
+    }
+
+    return getExitCode();
+}
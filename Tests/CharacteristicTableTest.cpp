@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    CharacteristicTableTest.cpp
+
+    Compares the detector with the characteristic table against the direct computation, and swaps tables while they're read.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "GainReductionComputer.h"
+#include "CharacteristicTable.h"
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+
+    struct Characteristic
+    {
+        float knee, ratio;
+    };
+
+    const Characteristic characteristics[] = {
+        { 0.0f, 4.0f },
+        { 6.0f, 4.0f },
+        { 0.0f, std::numeric_limits<float>::infinity() },
+        { 6.0f, std::numeric_limits<float>::infinity() }
+    };
+
+    void applyCharacteristic (GainReductionComputer& computer, const Characteristic& characteristic)
+    {
+        computer.setThreshold (-20.0f);
+        computer.setKnee (characteristic.knee);
+        computer.setRatio (characteristic.ratio);
+        computer.setAttackTime (0.001f);
+        computer.setReleaseTime (0.1f);
+        computer.prepare (sampleRate);
+    }
+
+    /** The envelope, which is what the gain stage gets: within 2e-5 dB of the direct computation for every signal, a few float steps of an envelope around -30 dB. */
+    void testEnvelopes()
+    {
+        for (const auto& characteristic : characteristics)
+        {
+            KernelVerifier verifier (sampleRate, 512, 11);
+            auto table = std::make_shared<CharacteristicTable>();
+
+            auto makeDirect = [&]
+            {
+                auto computer = std::make_shared<GainReductionComputer>();
+                applyCharacteristic (*computer, characteristic);
+                return KernelVerifier::Kernel ([computer] (const float* in, float* out, int n) { computer->computeGainInDecibelsFromSidechainSignal (in, out, n); });
+            };
+
+            auto makeTable = [&]
+            {
+                auto computer = std::make_shared<GainReductionComputer>();
+                applyCharacteristic (*computer, characteristic);
+                table->build (*computer);
+                computer->setCharacteristicTable (table.get());
+                return KernelVerifier::Kernel ([computer, table] (const float* in, float* out, int n) { computer->computeGainInDecibelsFromSidechainSignal (in, out, n); });
+            };
+
+            // the output is in dB already, so only the absolute error counts
+            for (const auto& report : verifier.compareAll (makeDirect, makeTable, { 2.0e-5f, 0.0f, std::numeric_limits<float>::infinity() }, 1 << 17))
+                expect (report, characteristic.knee > 0.0f ? "table envelope, 6 dB knee" : "table envelope, hard knee");
+        }
+    }
+
+    /** The static curve itself, sample by sample: the linear interpolation over 1/256 octave stays within 2e-5 dB, except in the one segment a hard knee's corner falls into, where it cuts the corner by at most a quarter of the segment width times the slope. Outside the table's range, it clamps. */
+    void testStaticCurve()
+    {
+        const float segmentWidthInDecibels = 20.0f * std::log10 (1.0f + 1.0f / (1 << CharacteristicTable::mantissaBits));
+
+        for (const auto& characteristic : characteristics)
+        {
+            GainReductionComputer computer;
+            applyCharacteristic (computer, characteristic);
+            CharacteristicTable table;
+            table.build (computer);
+
+            float maxError = 0.0f, maxCornerError = 0.0f;
+            for (float level = -140.0f; level < 47.0f; level += 0.0137f)
+            {
+                const float value = std::pow (10.0f, level / 20.0f);
+                const float error = std::abs (table.getGainReductionInDecibels (value) - computer.getGainReductionForLevel (20.0f * std::log10 (value)));
+
+                if (characteristic.knee == 0.0f && std::abs (level - computer.getThreshold()) < segmentWidthInDecibels)
+                    maxCornerError = std::max (maxCornerError, error);
+                else
+                    maxError = std::max (maxError, error);
+            }
+
+            const float slope = 1.0f - 1.0f / characteristic.ratio;
+            std::printf ("static curve, knee %.0f dB, ratio %g: max error %.3g dB, at the corner %.3g dB\n", characteristic.knee, characteristic.ratio, maxError, maxCornerError);
+            expect (maxError < 2.0e-5f, "the table follows the static curve");
+            expect (maxCornerError <= slope * segmentWidthInDecibels / 4.0f, "a hard knee's corner is cut by at most a quarter segment");
+
+            expect (table.getGainReductionInDecibels (0.0f) == 0.0f, "silence isn't reduced");
+            expect (table.getGainReductionInDecibels (1.0e6f) == table.getGainReductionInDecibels (256.0f), "values above +48 dBFS clamp to the last entry");
+            expect (table.getGainReductionInDecibels (std::numeric_limits<float>::quiet_NaN()) == table.getGainReductionInDecibels (256.0f), "NaNs clamp to the last entry, the strongest reduction");
+        }
+    }
+
+    /** The message thread publishes new tables while the audio thread reads them: retired tables are only deleted after the audio thread is done with them. */
+    void testHandOver()
+    {
+        CharacteristicTableHandOver handOver;
+        std::atomic<bool> done { false };
+        std::atomic<int> numPublished { 0 };
+
+        std::thread messageThread ([&]
+        {
+            for (int i = 0; numPublished < 2000; ++i)
+            {
+                GainReductionComputer computer;
+                computer.setThreshold (-static_cast<float> (i % 40));
+                computer.setRatio (std::numeric_limits<float>::infinity());
+
+                auto table = std::make_unique<CharacteristicTable>();
+                table->build (computer);
+                handOver.publish (std::move (table));
+                ++numPublished;
+            }
+            done = true;
+        });
+
+        // a brickwall at -40 ... 0 dB reduces a 0 dBFS sample by 0 ... 40 dB
+        bool allValid = true;
+        while (! done.load())
+        {
+            if (const auto* table = handOver.getCurrent())
+            {
+                const float gainReduction = table->getGainReductionInDecibels (1.0f);
+                allValid = allValid && gainReduction <= 0.0f && gainReduction >= -40.0f;
+            }
+            handOver.blockCompleted();
+        }
+
+        messageThread.join();
+        expect (allValid, "tables stay valid while new ones are published");
+    }
+}
+
+int main()
+{
+    testEnvelopes();
+    testStaticCurve();
+    testHandOver();
+
+    return getExitCode();
+}
@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    ControlRateTest.cpp
+
+    Checks that the decimated detector covers every peak, wherever it is in its group, and that its settings can change while it runs.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "GainReductionComputer.h"
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr float threshold = -20.0f;
+    constexpr int decimationFactors[] = { 4, 8, 16 };
+
+    /** A brickwall with instant attack: every sample's gain reduction has to bring it down to the threshold. */
+    void prepareBrickwall (GainReductionComputer& computer, const int decimationFactor)
+    {
+        computer.setThreshold (threshold);
+        computer.setKnee (0.0f);
+        computer.setRatio (std::numeric_limits<float>::infinity());
+        computer.setAttackTime (0.0f);
+        computer.setReleaseTime (0.1f);
+        computer.setDecimationFactor (decimationFactor);
+        computer.prepare (sampleRate);
+    }
+
+    /** The highest level in dB above the threshold which gets through, processed in blocks of the given size. */
+    float getMaxOvershoot (const std::vector<float>& signal, const int decimationFactor, const int blockSize)
+    {
+        GainReductionComputer computer;
+        prepareBrickwall (computer, decimationFactor);
+
+        std::vector<float> gain (signal.size());
+        for (size_t start = 0; start < signal.size(); start += static_cast<size_t> (blockSize))
+            computer.computeGainInDecibelsFromSidechainSignal (signal.data() + start, gain.data() + start, static_cast<int> (std::min (signal.size() - start, static_cast<size_t> (blockSize))));
+
+        float overshoot = -std::numeric_limits<float>::infinity();
+        for (size_t i = 0; i < signal.size(); ++i)
+            if (signal[i] != 0.0f)
+                overshoot = std::max (overshoot, 20.0f * std::log10 (std::abs (signal[i])) + gain[i] - threshold);
+
+        return overshoot;
+    }
+
+    /** Isolated peaks at every position within a group: the one at the group's first sample was let through by up to (factor - 1) / factor of its overshoot. */
+    void testPeakPositions()
+    {
+        for (const int factor : decimationFactors)
+        {
+            bool allCovered = true;
+            bool releaseMonotonic = true;
+
+            for (int position = 0; position < factor; ++position)
+            {
+                std::vector<float> signal (4096, 0.0f);
+                signal[static_cast<size_t> (10 * factor + position)] = 1.0f;
+
+                allCovered = allCovered && getMaxOvershoot (signal, factor, 512) <= 1.0e-4f;
+
+                // after the peak's group, the envelope only recovers
+                GainReductionComputer computer;
+                prepareBrickwall (computer, factor);
+                std::vector<float> gain (signal.size());
+                computer.computeGainInDecibelsFromSidechainSignal (signal.data(), gain.data(), static_cast<int> (signal.size()));
+
+                for (size_t i = static_cast<size_t> (11 * factor); i < gain.size(); ++i)
+                    releaseMonotonic = releaseMonotonic && gain[i] >= gain[i - 1];
+            }
+
+            std::printf ("decimation %2d: peaks at every position in the group covered: %s\n", factor, allCovered ? "yes" : "no");
+            expect (allCovered, "a peak anywhere in its group gets the full gain reduction");
+            expect (releaseMonotonic, "the release is interpolated without steps back");
+        }
+    }
+
+    /** Noise bursts and impulses in odd block sizes, which cut groups short at every block end. */
+    void testSignals()
+    {
+        KernelVerifier verifier (sampleRate, 512, 3);
+
+        for (const auto signalType : { KernelVerifier::Signal::bursts, KernelVerifier::Signal::impulses, KernelVerifier::Signal::whiteNoise })
+        {
+            std::vector<float> signal (1 << 16);
+            verifier.generateSignal (signalType, signal.data(), static_cast<int> (signal.size()));
+
+            for (const int factor : decimationFactors)
+                for (const int blockSize : { 61, 512 })
+                {
+                    const float overshoot = getMaxOvershoot (signal, factor, blockSize);
+                    std::printf ("decimation %2d, %-9s in blocks of %3d: max overshoot %+.2g dB\n", factor, KernelVerifier::getSignalName (signalType), blockSize, overshoot);
+                    expect (overshoot <= 1.0e-4f, "no peak gets through the decimated brickwall");
+                }
+        }
+    }
+
+    /** The message thread changes the ballistics while the audio thread runs: the coefficients follow on the audio thread, and the envelope stays valid. */
+    void testSettingsWhileProcessing()
+    {
+        GainReductionComputer computer;
+        prepareBrickwall (computer, 1);
+
+        std::atomic<bool> done { false };
+        std::thread messageThread ([&]
+        {
+            for (int i = 0; ! done.load(); ++i)
+            {
+                computer.setDecimationFactor (1 << (i % 5));
+                computer.setAttackTime (0.001f * (i % 3));
+                computer.setReleaseTime (0.05f + 0.05f * (i % 4));
+                std::this_thread::yield();
+            }
+        });
+
+        KernelVerifier verifier (sampleRate, 512, 5);
+        std::vector<float> signal (256), gain (256);
+        bool allValid = true;
+
+        for (int block = 0; block < 4000; ++block)
+        {
+            verifier.generateSignal (KernelVerifier::Signal::whiteNoise, signal.data(), static_cast<int> (signal.size()));
+            computer.computeGainInDecibelsFromSidechainSignal (signal.data(), gain.data(), static_cast<int> (signal.size()));
+
+            for (const float value : gain)
+                allValid = allValid && std::isfinite (value) && value <= 0.0f;
+        }
+
+        done = true;
+        messageThread.join();
+
+        expect (allValid, "changing the ballistics while processing keeps the envelope valid");
+    }
+}
+
+int main()
+{
+    testPeakPositions();
+    testSignals();
+    testSettingsWhileProcessing();
+
+    return getExitCode();
+}
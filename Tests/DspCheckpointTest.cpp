@@ -0,0 +1,223 @@
+/*
+  ==============================================================================
+
+    DspCheckpointTest.cpp
+
+    Saves the state of a chain of DSP modules in the middle of a signal and restores it into a fresh chain, which has to continue bit for bit; also checks that the states of an edited and an unedited signal become equal again after the edit, which partial re-renders rely on.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "DspCheckpoint.h"
+#include "GainReductionComputer.h"
+#include "LookAheadGainReduction.h"
+#include "SideChainFilter.h"
+#include "AntiderivativeClipper.h"
+#include "NoiseShapingDither.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 64;
+    constexpr int maxNumChannels = 2;
+    constexpr int64_t secondInBlocks = static_cast<int64_t> (sampleRate) / blockSize;
+
+    /** The processor's chain without the audio delay: detector EQ, detector, look-ahead fade, gain, second-order clipper and shaped 16-bit dither. */
+    struct Chain
+    {
+        SideChainFilter sideChainFilter;
+        GainReductionComputer gainReductionComputer;
+        LookAheadGainReduction lookAheadFadeIn;
+        AntiderivativeClipper clipper;
+        NoiseShapingDither dither;
+        int numChannels;
+
+        explicit Chain (const int numChannelsToUse) : numChannels (numChannelsToUse)
+        {
+            sideChainFilter.prepare (sampleRate, numChannels);
+            sideChainFilter.setEnabled (true);
+            sideChainFilter.setHighPassFrequency (100.0f);
+            sideChainFilter.setTilt (2.0f);
+
+            gainReductionComputer.setThreshold (-12.0f);
+            gainReductionComputer.setKnee (3.0f);
+            gainReductionComputer.setRatio (std::numeric_limits<float>::infinity());
+            gainReductionComputer.setAttackTime (0.001f);
+            gainReductionComputer.setReleaseTime (0.15f);
+            gainReductionComputer.prepare (sampleRate);
+
+            lookAheadFadeIn.setDelayTime (0.005f);
+            lookAheadFadeIn.prepare (sampleRate, blockSize);
+
+            clipper.setOrder (AntiderivativeClipper::Order::second);
+            clipper.setCeiling (-1.0f);
+            clipper.prepare (blockSize, numChannels);
+
+            dither.setBitDepth (16);
+            dither.setShape (NoiseShapingDither::Shape::wannamaker3);
+            dither.prepare (blockSize, numChannels);
+        }
+
+        void process (float* const* channels)
+        {
+            float key[blockSize], gain[blockSize];
+
+            const float* input[] = { channels[0], channels[numChannels - 1] };
+            sideChainFilter.processMaxAbs (input, numChannels, key, blockSize);
+            gainReductionComputer.computeGainInDecibelsFromSidechainSignal (key, gain, blockSize);
+
+            lookAheadFadeIn.pushSamples (gain, blockSize);
+            lookAheadFadeIn.process();
+            lookAheadFadeIn.readSamples (gain, blockSize);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                for (int i = 0; i < blockSize; ++i)
+                    channels[ch][i] *= std::pow (10.0f, gain[i] / 20.0f);
+
+                clipper.process (channels[ch], blockSize, ch);
+                dither.process (channels[ch], blockSize, ch);
+            }
+        }
+
+        void save (DspCheckpoint& checkpoint) const
+        {
+            checkpoint.clear();
+            sideChainFilter.saveState (checkpoint);
+            gainReductionComputer.saveState (checkpoint);
+            lookAheadFadeIn.saveState (checkpoint);
+            clipper.saveState (checkpoint);
+            dither.saveState (checkpoint);
+        }
+
+        bool restore (const DspCheckpoint& checkpoint)
+        {
+            DspCheckpoint::Reader reader (checkpoint);
+            return sideChainFilter.restoreState (reader) && gainReductionComputer.restoreState (reader) && lookAheadFadeIn.restoreState (reader)
+                && clipper.restoreState (reader) && dither.restoreState (reader) && reader.isComplete();
+        }
+    };
+
+    /** Noise with a slow swell, so the detector keeps attacking and releasing. */
+    std::vector<float> makeSignal (const int64_t numBlocks, const unsigned int seed)
+    {
+        std::mt19937 random (seed);
+        std::normal_distribution<float> noise (0.0f, 0.3f);
+
+        std::vector<float> signal (static_cast<size_t> (numBlocks * blockSize * maxNumChannels));
+        for (size_t i = 0; i < signal.size(); ++i)
+            signal[i] = noise (random) * (0.5f + 0.5f * std::sin (static_cast<float> (i / maxNumChannels) * 6.2831853f / (0.7f * static_cast<float> (sampleRate))));
+
+        return signal;
+    }
+
+    /** One block of the signal, channel after channel. */
+    float* const* getBlock (std::vector<float>& signal, const int64_t block, float* (&channels)[maxNumChannels])
+    {
+        for (int ch = 0; ch < maxNumChannels; ++ch)
+            channels[ch] = signal.data() + static_cast<size_t> ((block * maxNumChannels + ch) * blockSize);
+
+        return channels;
+    }
+
+    /** A chain restored from a checkpoint continues exactly like the one which saved it, and saving doesn't disturb the saving one. */
+    void testRestore()
+    {
+        constexpr int64_t numBlocks = 20 * secondInBlocks;
+        const auto input = makeSignal (numBlocks, 1);
+
+        auto expected = input;
+        Chain reference (2);
+        float* channels[maxNumChannels];
+        for (int64_t b = 0; b < numBlocks; ++b)
+            reference.process (getBlock (expected, b, channels));
+
+        auto output = input;
+        Chain saving (2), restored (2);
+        DspCheckpoint checkpoint;
+
+        for (int64_t b = 0; b < numBlocks / 2; ++b)
+            saving.process (getBlock (output, b, channels));
+
+        saving.save (checkpoint);
+        expect (restored.restore (checkpoint), "a checkpoint restores into a chain prepared the same way");
+
+        auto restoredOutput = output;
+        for (int64_t b = numBlocks / 2; b < numBlocks; ++b)
+        {
+            saving.process (getBlock (output, b, channels));
+            restored.process (getBlock (restoredOutput, b, channels));
+        }
+
+        expect (output == expected, "saving a checkpoint doesn't change the output");
+        expect (restoredOutput == expected, "a restored chain continues bit for bit");
+
+        Chain mono (1);
+        expect (! mono.restore (checkpoint), "a checkpoint doesn't restore into a chain prepared for fewer channels");
+    }
+
+    /** An edited signal and the original, side by side: the states differ after the edit, and become equal again a little later. From then on the outputs are the same. */
+    void testConvergence()
+    {
+        constexpr int64_t numBlocks = 20 * secondInBlocks;
+        constexpr int64_t editStart = 5 * secondInBlocks, editEnd = editStart + secondInBlocks / 2;
+
+        auto original = makeSignal (numBlocks, 2);
+        auto edited = original;
+        for (size_t i = static_cast<size_t> (editStart * blockSize * maxNumChannels); i < static_cast<size_t> (editEnd * blockSize * maxNumChannels); ++i)
+            edited[i] *= 2.5f;
+
+        Chain originalChain (2), editedChain (2);
+        DspCheckpoint originalState, editedState;
+        float* originalChannels[maxNumChannels];
+        float* editedChannels[maxNumChannels];
+
+        bool equalBefore = true, differentAfter = false;
+        int64_t convergedAt = -1;
+
+        for (int64_t b = 0; b < numBlocks; ++b)
+        {
+            // compared every second, as the renderer does, and right after the edit
+            if (b % secondInBlocks == 0 || b == editEnd)
+            {
+                originalChain.save (originalState);
+                editedChain.save (editedState);
+
+                if (b <= editStart)
+                    equalBefore = equalBefore && originalState == editedState;
+                else if (b == editEnd)
+                    differentAfter = originalState != editedState;
+                else if (convergedAt < 0 && originalState == editedState)
+                    convergedAt = b;
+            }
+
+            originalChain.process (getBlock (original, b, originalChannels));
+            editedChain.process (getBlock (edited, b, editedChannels));
+        }
+
+        std::printf ("0.5 s edit at 5 s: states equal again at %.0f s\n", convergedAt * blockSize / sampleRate);
+        expect (equalBefore, "the states are the same up to the edit");
+        expect (differentAfter, "the edit changes the states");
+        expect (convergedAt > 0 && convergedAt <= editEnd + 5 * secondInBlocks, "the states become equal again within a few seconds after the edit");
+
+        const size_t convergedSample = static_cast<size_t> ((convergedAt < 0 ? numBlocks : convergedAt) * blockSize * maxNumChannels);
+        expect (std::equal (original.begin() + static_cast<std::ptrdiff_t> (convergedSample), original.end(), edited.begin() + static_cast<std::ptrdiff_t> (convergedSample)),
+                "once the states are equal, so is the output");
+    }
+}
+
+int main()
+{
+    testRestore();
+    testConvergence();
+
+    return getExitCode();
+}
@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+    EnvelopeCacheTest.cpp
+
+    Analyses the same input with the two-pass limiter and an envelope cache again and again: an unchanged input is read from the cache, an input changed near its end only from the change on, and other detector settings miss it; every envelope has to be bit for bit the one analysed without a cache. Then fills a cache with entries of different inputs and checks that eviction removes the ones used least recently.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "TwoPassLimiter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+    constexpr int64_t numSamples = 40 * EnvelopeCache::intervalSize + 12345;
+
+    struct Analysis
+    {
+        std::vector<float> envelope;
+        int64_t numSamplesFromCache = 0;
+    };
+
+    /** Analyses the input in blocks of random sizes, which don't line up with the cache's intervals. They're whole groups of the decimation factor though, as a decimated detector's output depends on where its blocks end. */
+    Analysis analyse (const std::vector<float> (&input)[numChannels], EnvelopeCache* cache, const int decimationFactor = 1, const float releaseTime = 0.2f)
+    {
+        TwoPassLimiter limiter;
+        limiter.setThreshold (-12.0f);
+        limiter.setAttackTime (0.001f);
+        limiter.setReleaseTime (releaseTime);
+        limiter.setDecimationFactor (decimationFactor);
+        limiter.setHoldTime (0.01f);
+        limiter.setEnvelopeCache (cache);
+
+        Analysis analysis;
+        if (! expect (limiter.beginAnalysis (sampleRate, numChannels), "the analysis starts"))
+            return analysis;
+
+        std::mt19937 random (1);
+        for (int64_t position = 0; position < numSamples;)
+        {
+            const int n = static_cast<int> (std::min<int64_t> (numSamples - position, decimationFactor * (1 + static_cast<int64_t> (random() % 8192) / decimationFactor)));
+            const float* channels[] = { input[0].data() + position, input[1].data() + position };
+            expect (limiter.analyse (channels, n), "the input is analysed");
+            position += n;
+        }
+
+        if (expect (limiter.endAnalysis(), "the analysis ends"))
+            analysis.envelope.assign (limiter.getEnvelope(), limiter.getEnvelope() + numSamples);
+
+        analysis.numSamplesFromCache = limiter.getNumSamplesFromCache();
+        return analysis;
+    }
+
+    bool isSame (const Analysis& a, const Analysis& b)
+    {
+        return a.envelope.size() == b.envelope.size() && ! a.envelope.empty()
+            && std::memcmp (a.envelope.data(), b.envelope.data(), a.envelope.size() * sizeof (float)) == 0;
+    }
+
+    void makeInput (std::vector<float> (&input)[numChannels], const unsigned int seed)
+    {
+        std::mt19937 random (seed);
+        std::normal_distribution<float> noise (0.0f, 0.3f);
+        for (auto& channel : input)
+        {
+            channel.resize (static_cast<size_t> (numSamples));
+            for (auto& sample : channel)
+                sample = noise (random);
+        }
+    }
+
+    void testCache (const std::string& directory)
+    {
+        std::vector<float> input[numChannels];
+        makeInput (input, 5);
+
+        EnvelopeCache cache (directory);
+
+        const auto reference = analyse (input, nullptr);
+        const auto miss = analyse (input, &cache);
+        expect (miss.numSamplesFromCache == 0 && isSame (miss, reference), "the first analysis misses the cache and computes the same envelope");
+
+        const auto hit = analyse (input, &cache);
+        std::printf ("unchanged input: %lld of %lld samples from the cache\n", static_cast<long long> (hit.numSamplesFromCache), static_cast<long long> (numSamples));
+        expect (hit.numSamplesFromCache == numSamples, "an unchanged input is read entirely from the cache");
+        expect (isSame (hit, reference), "the envelope from the cache is the computed one");
+
+        // a change near the end: everything before its interval still comes from the cache
+        const int64_t changeStart = numSamples * 9 / 10;
+        for (int64_t i = changeStart; i < changeStart + 4800; ++i)
+            input[0][static_cast<size_t> (i)] *= 3.0f;
+
+        const auto changedReference = analyse (input, nullptr);
+        const auto partial = analyse (input, &cache);
+        const int64_t expectedFromCache = changeStart / EnvelopeCache::intervalSize * EnvelopeCache::intervalSize;
+        std::printf ("input changed at %lld: %lld samples from the cache\n", static_cast<long long> (changeStart), static_cast<long long> (partial.numSamplesFromCache));
+        expect (partial.numSamplesFromCache == expectedFromCache, "a changed input is read from the cache up to the interval of the change");
+        expect (isSame (partial, changedReference), "the partly cached envelope is the computed one");
+
+        const auto afterChange = analyse (input, &cache);
+        expect (afterChange.numSamplesFromCache == numSamples && isSame (afterChange, changedReference), "the changed input replaced the entry");
+
+        // the detector's settings are part of the key
+        const auto decimatedReference = analyse (input, nullptr, 4);
+        const auto decimated = analyse (input, &cache, 4);
+        expect (decimated.numSamplesFromCache == 0 && isSame (decimated, decimatedReference), "another decimation factor misses the cache");
+        expect (! isSame (decimated, changedReference), "the decimation factor changes the envelope");
+
+        const auto otherRelease = analyse (input, &cache, 1, 0.05f);
+        expect (otherRelease.numSamplesFromCache == 0, "another release time misses the cache");
+
+        const auto again = analyse (input, &cache);
+        expect (again.numSamplesFromCache == numSamples && isSame (again, changedReference), "the first settings still hit the cache");
+    }
+
+    /** Three inputs, stored an hour apart; the oldest is then hit again, so the second one is the least recently used and the first to go. */
+    void testEviction (const std::string& directory)
+    {
+        namespace fs = std::filesystem;
+
+        EnvelopeCache cache (directory);
+        std::vector<float> inputs[3][numChannels];
+        std::vector<fs::path> paths;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            makeInput (inputs[i], static_cast<unsigned int> (10 + i));
+            analyse (inputs[i], &cache);
+
+            // the entry which is new in the directory
+            for (const auto& item : fs::directory_iterator (directory))
+                if (std::find (paths.begin(), paths.end(), item.path()) == paths.end())
+                    paths.push_back (item.path());
+        }
+
+        if (! expect (paths.size() == 3, "every input has an entry"))
+            return;
+
+        const auto now = fs::file_time_type::clock::now();
+        for (size_t i = 0; i < paths.size(); ++i)
+            fs::last_write_time (paths[i], now - std::chrono::hours (3 - static_cast<int> (i)));
+
+        expect (analyse (inputs[0], &cache).numSamplesFromCache == numSamples, "the oldest entry is hit");
+
+        const auto entrySize = fs::file_size (paths[1]);
+        expect (cache.evict (UINT64_MAX) == 0 && fs::exists (paths[1]), "a cache within its size keeps everything");
+
+        const auto numBytesFreed = cache.evict (fs::file_size (paths[0]) + fs::file_size (paths[2]));
+        std::printf ("evicted %llu bytes\n", static_cast<unsigned long long> (numBytesFreed));
+        expect (numBytesFreed == entrySize && ! fs::exists (paths[1]), "the least recently used entry is evicted");
+        expect (fs::exists (paths[0]) && fs::exists (paths[2]), "the entries used since stay");
+
+        expect (cache.evict (0) > 0 && fs::is_empty (directory), "a size of 0 empties the cache");
+    }
+}
+
+int main()
+{
+    const auto directory = std::filesystem::temp_directory_path() / "EnvelopeCacheTest";
+    std::filesystem::remove_all (directory);
+    std::filesystem::create_directories (directory);
+
+    testCache (directory.string());
+
+    std::filesystem::remove_all (directory);
+    std::filesystem::create_directories (directory);
+    testEviction (directory.string());
+
+    std::filesystem::remove_all (directory);
+    return getExitCode();
+}
@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    FlightRecorderReplayTest.cpp
+
+    Runs the processor live with random block sizes and parameter changes, dumps its flight recording, replays the dump and checks that the replay is bit for bit what the processor delivered live.
+
+  ==============================================================================
+*/
+
+#include "ProcessorHarness.h"
+#include "OfflineRenderer.h"
+#include "TestUtilities.h"
+#include <fstream>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+    constexpr int announcedBlockSize = 512;
+
+    AudioBuffer<float> readFile (const File& file)
+    {
+        AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor (file));
+        if (reader == nullptr)
+            return {};
+
+        AudioBuffer<float> signal (static_cast<int> (reader->numChannels), static_cast<int> (reader->lengthInSamples));
+        reader->read (&signal, 0, signal.getNumSamples(), 0, true, true);
+        return signal;
+    }
+
+    /** Changes a parameter as the host does, without handling the update the processor asks the message thread for. */
+    void setParameterWithoutUpdate (TLimiterAudioProcessor& processor, const String& parameterID, const float value)
+    {
+        auto* parameter = processor.parameters.getParameter (parameterID);
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    /** 15 seconds, longer than the recording, in blocks of random sizes, with the threshold, knee, ratio, release and make-up gain moved every half second or so. The message thread gets to the new characteristic table a random number of blocks later. Returns what the processor delivered. */
+    AudioBuffer<float> runLive (TLimiterAudioProcessor& processor)
+    {
+        AudioBuffer<float> signal (numChannels, static_cast<int> (15 * sampleRate));
+        ProcessorHarness::fillWithTestSignal (signal, 11);
+
+        Random random (5);
+        MidiBuffer midi;
+        int updateBlock = -1;
+
+        for (int start = 0, block = 0; start < signal.getNumSamples(); ++block)
+        {
+            if (block % 50 == 49)
+            {
+                setParameterWithoutUpdate (processor, "threshold", -20.0f + random.nextFloat() * 15.0f);
+                setParameterWithoutUpdate (processor, "knee", random.nextFloat() * 6.0f);
+                setParameterWithoutUpdate (processor, "ratio", 4.0f + random.nextFloat() * 12.0f);
+                setParameterWithoutUpdate (processor, "release", 20.0f + random.nextFloat() * 300.0f);
+                setParameterWithoutUpdate (processor, "makeUp", random.nextFloat() * 6.0f);
+                updateBlock = block + random.nextInt (10);
+            }
+
+            if (block == updateBlock)
+                processor.handleUpdateNowIfNeeded();
+
+            const int numSamples = jmin (1 + random.nextInt (2 * announcedBlockSize), signal.getNumSamples() - start);
+            AudioBuffer<float> buffer (signal.getArrayOfWritePointers(), numChannels, start, numSamples);
+            processor.processBlock (buffer, midi);
+            start += numSamples;
+        }
+
+        return signal;
+    }
+
+    /** The processor's state at the start of the dump is restored, so the replay continues exactly where the processor was live. */
+    void testBitExactReplay (const File& directory)
+    {
+        TLimiterAudioProcessor live;
+        ProcessorHarness::setParameter (live, "lookAhead", 1.0f);
+        ProcessorHarness::setParameter (live, "attack", 0.0f);
+        ProcessorHarness::setParameter (live, "clipper", 2.0f);
+        ProcessorHarness::prepare (live, numChannels, sampleRate, announcedBlockSize);
+
+        const auto output = runLive (live);
+
+        const auto dumpFile = directory.getChildFile ("dump.tlfr");
+        expect (live.dumpFlightRecording (dumpFile), "the flight recording is dumped");
+
+        FlightRecorder::Recording recording;
+        std::ifstream stream (dumpFile.getFullPathName().toStdString(), std::ios::binary);
+        expect (recording.readFrom (stream) && recording.initialState.getSize() > 0, "the dump holds the state before its first block");
+
+        // a replay starts with the defaults, the dump sets everything else
+        TLimiterAudioProcessor replayed;
+        OfflineRenderer renderer (replayed);
+        const auto replayFile = directory.getChildFile ("replay.wav");
+        const auto result = renderer.replay (dumpFile, replayFile);
+        expect (result.wasOk(), "the dump is replayed");
+
+        // the dump is the end of what was processed live
+        const auto replay = readFile (replayFile);
+        const int offset = output.getNumSamples() - replay.getNumSamples();
+        std::printf ("replayed %.2f s of 15 s\n", replay.getNumSamples() / sampleRate);
+        expect (replay.getNumSamples() > sampleRate && offset >= 0, "the dump holds seconds of audio");
+
+        int numDifferent = 0;
+        for (int ch = 0; ch < numChannels && offset >= 0; ++ch)
+            for (int i = 0; i < replay.getNumSamples(); ++i)
+                if (replay.getSample (ch, i) != output.getSample (ch, offset + i))
+                    ++numDifferent;
+
+        std::printf ("samples differing from the live output: %d\n", numDifferent);
+        expect (numDifferent == 0, "the replay is bit for bit what the processor delivered live");
+    }
+
+    /** Switched off, the recorder takes no memory and there's nothing to dump. */
+    void testSwitchedOff (const File& directory)
+    {
+        TLimiterAudioProcessor recording, notRecording;
+        ProcessorHarness::setParameter (notRecording, "flightRecorder", 0.0f);
+        ProcessorHarness::prepare (recording, numChannels, sampleRate, announcedBlockSize);
+        ProcessorHarness::prepare (notRecording, numChannels, sampleRate, announcedBlockSize);
+
+        AudioBuffer<float> signal (numChannels, announcedBlockSize);
+        ProcessorHarness::fillWithTestSignal (signal, 1);
+        MidiBuffer midi;
+        recording.processBlock (signal, midi);
+        notRecording.processBlock (signal, midi);
+
+        std::printf ("memory with the flight recorder %.1f MB, without %.1f MB\n", recording.getMemoryUsageInBytes() / 1048576.0, notRecording.getMemoryUsageInBytes() / 1048576.0);
+        expect (recording.getMemoryUsageInBytes() > notRecording.getMemoryUsageInBytes() + TLimiterAudioProcessor::flightRecordingLengthInSeconds * sampleRate * numChannels * sizeof (float),
+                "the recorder's memory is counted");
+        expect (! notRecording.dumpFlightRecording (directory.getChildFile ("off.tlfr")), "a switched off recorder has nothing to dump");
+    }
+}
+
+int main()
+{
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const auto directory = File::createTempFile ("FlightRecorderReplayTest");
+    directory.createDirectory();
+
+    testBitExactReplay (directory);
+    testSwitchedOff (directory);
+
+    directory.deleteRecursively();
+    return getExitCode();
+}
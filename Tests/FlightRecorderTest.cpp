@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    FlightRecorderTest.cpp
+
+    Dumps the flight recorder over and over while another thread records blocks of random sizes, and checks that every dump is a consistent run of whole blocks which starts at its checkpoint; also checks the memory cap.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "FlightRecorder.h"
+#include <atomic>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 8000.0;
+    constexpr int numChannels = 2;
+    constexpr int maxBlockSize = 512;
+
+    /** The state before a block, as the processor would save it: here just the number of the block's first sample, plus some padding. */
+    void saveState (DspCheckpoint& checkpoint, const int64_t startSample)
+    {
+        checkpoint.clear();
+        checkpoint.write (startSample);
+
+        const float padding[16] = {};
+        checkpoint.write (padding, 16);
+    }
+
+    /** Whether a dump holds whole blocks of consecutive samples, each with its own parameter values, and starts at the sample its checkpoint names. */
+    bool isConsistent (const FlightRecorder::Recording& recording, const bool expectCheckpoint)
+    {
+        if (recording.blocks.empty() || recording.parameterIDs.size() != 1 || recording.numChannels != numChannels)
+            return false;
+
+        const float firstSample = recording.audio[0];
+
+        if (expectCheckpoint)
+        {
+            int64_t checkpointStart = -1;
+            DspCheckpoint::Reader reader (recording.initialState);
+            if (! reader.read (checkpointStart) || static_cast<float> (checkpointStart + 1) != firstSample)
+                return false;
+        }
+        else if (recording.initialState.getSize() != 0)
+            return false;
+
+        float expected = firstSample;
+        for (const auto& block : recording.blocks)
+        {
+            // every block's parameter is the number of its first sample
+            if (recording.parameterValues[block.parameterOffset] != expected)
+                return false;
+
+            for (int i = 0; i < block.numSamples; ++i, expected += 1.0f)
+                if (recording.audio[block.audioOffset + static_cast<size_t> (i * numChannels)] != expected
+                    || recording.audio[block.audioOffset + static_cast<size_t> (i * numChannels + 1)] != -expected)
+                    return false;
+        }
+
+        return true;
+    }
+
+    /** A writer records about half an hour of numbered samples at 8 kHz, with a checkpoint whenever one is due, while a reader dumps as fast as it can. */
+    void testConcurrentDumps()
+    {
+        FlightRecorder recorder;
+        recorder.prepare (sampleRate, numChannels, 2.0, 1 << 20, { "start" }, 1024);
+
+        std::atomic<bool> done { false };
+        int numDumps = 0, numInconsistent = 0, numWithoutCheckpoint = 0;
+
+        std::thread reader ([&]
+        {
+            while (! done.load())
+            {
+                std::stringstream stream;
+                if (! recorder.writeTo (stream))
+                    continue;
+
+                // a reader which was held up while the writer overwrote every checkpoint only gets the blocks after them, without a state
+                FlightRecorder::Recording recording;
+                const bool isRead = recording.readFrom (stream);
+                const bool hasCheckpoint = recording.initialState.getSize() > 0;
+
+                if (! isRead || ! isConsistent (recording, hasCheckpoint))
+                    ++numInconsistent;
+
+                if (! hasCheckpoint)
+                    ++numWithoutCheckpoint;
+
+                ++numDumps;
+            }
+        });
+
+        std::mt19937 random (1);
+        std::vector<float> left (maxBlockSize), right (maxBlockSize);
+        const float* channels[] = { left.data(), right.data() };
+        DspCheckpoint state;
+
+        // floats count exactly up to 2^24
+        for (int64_t position = 0; position < 15000000;)
+        {
+            const int numSamples = 1 + static_cast<int> (random() % maxBlockSize);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                left[static_cast<size_t> (i)] = static_cast<float> (position + i + 1);
+                right[static_cast<size_t> (i)] = -static_cast<float> (position + i + 1);
+            }
+
+            const bool withCheckpoint = recorder.needsCheckpoint();
+            if (withCheckpoint)
+                saveState (state, position);
+
+            const float parameter = static_cast<float> (position + 1);
+            recorder.record (channels, numSamples, &parameter, withCheckpoint ? &state : nullptr);
+            position += numSamples;
+        }
+
+        done = true;
+        reader.join();
+
+        std::printf ("%d dumps while recording: %d inconsistent, %d without a checkpoint\n", numDumps, numInconsistent, numWithoutCheckpoint);
+        expect (numDumps > 0, "the reader dumped while the writer recorded");
+        expect (numInconsistent == 0, "every dump is a consistent run of whole blocks which starts at its checkpoint, if it has one");
+        expect (numWithoutCheckpoint * 2 < numDumps, "most dumps start at a checkpoint");
+
+        // once the writer stopped, the dump spans from the oldest retained checkpoint to the end
+        std::stringstream stream;
+        FlightRecorder::Recording recording;
+        expect (recorder.writeTo (stream) && recording.readFrom (stream) && isConsistent (recording, true), "a dump after recording is consistent");
+
+        const double length = recording.audio.size() / static_cast<double> (numChannels) / sampleRate;
+        std::printf ("last dump: %.2f s of %.2f s recorded\n", length, recorder.getLengthInSeconds());
+        expect (length >= recorder.getLengthInSeconds() - FlightRecorder::checkpointIntervalInSeconds - 2 * maxBlockSize / sampleRate,
+                "the dump starts at most a checkpoint interval after the oldest block");
+    }
+
+    /** Without checkpoints, or with one that's too large, a dump starts at the oldest intact block and holds no state. */
+    void testWithoutCheckpoints()
+    {
+        for (const size_t checkpointSize : { static_cast<size_t> (0), static_cast<size_t> (8) })
+        {
+            FlightRecorder recorder;
+            recorder.prepare (sampleRate, numChannels, 1.0, 1 << 20, { "start" }, checkpointSize);
+
+            std::vector<float> left (64), right (64);
+            const float* channels[] = { left.data(), right.data() };
+            DspCheckpoint state;
+
+            for (int64_t position = 0; position < 20000; position += 64)
+            {
+                for (int i = 0; i < 64; ++i)
+                {
+                    left[static_cast<size_t> (i)] = static_cast<float> (position + i + 1);
+                    right[static_cast<size_t> (i)] = -static_cast<float> (position + i + 1);
+                }
+
+                saveState (state, position);
+                const float parameter = static_cast<float> (position + 1);
+                recorder.record (channels, 64, &parameter, recorder.needsCheckpoint() ? &state : nullptr);
+            }
+
+            std::stringstream stream;
+            FlightRecorder::Recording recording;
+            expect (recorder.writeTo (stream) && recording.readFrom (stream) && isConsistent (recording, false),
+                    checkpointSize == 0 ? "without checkpoints, a dump holds no state" : "a checkpoint larger than its slot isn't kept");
+        }
+    }
+
+    /** Wide buses at high rates get a shorter recording instead of more memory; narrow ones get the whole length. Released, nothing is left. */
+    void testMemoryCap()
+    {
+        constexpr size_t maxNumBytes = 32 << 20;
+        const std::vector<std::string> parameterIDs (30, "parameter");
+
+        FlightRecorder stereo;
+        stereo.prepare (48000.0, 2, 10.0, maxNumBytes, parameterIDs, 4096);
+        std::printf ("stereo at 48 kHz: %.2f s in %.1f MB\n", stereo.getLengthInSeconds(), stereo.getMemoryUsageInBytes() / 1048576.0);
+        expect (stereo.getLengthInSeconds() == 10.0, "a stereo recording at 48 kHz isn't shortened");
+
+        FlightRecorder wide;
+        wide.prepare (192000.0, 64, 10.0, maxNumBytes, parameterIDs, 65536);
+        std::printf ("64 channels at 192 kHz: %.2f s in %.1f MB\n", wide.getLengthInSeconds(), wide.getMemoryUsageInBytes() / 1048576.0);
+        expect (wide.getMemoryUsageInBytes() <= maxNumBytes, "a wide recording stays within the memory cap");
+        expect (wide.getLengthInSeconds() > 0.1 && wide.getLengthInSeconds() < 10.0, "a wide recording is shortened instead");
+
+        wide.release();
+        std::stringstream stream;
+        expect (wide.getMemoryUsageInBytes() == 0 && ! wide.needsCheckpoint() && ! wide.writeTo (stream), "a released recorder holds nothing");
+    }
+}
+
+int main()
+{
+    testConcurrentDumps();
+    testWithoutCheckpoints();
+    testMemoryCap();
+
+    return getExitCode();
+}
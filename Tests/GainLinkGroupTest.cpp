@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    GainLinkGroupTest.cpp
+
+    Links the envelopes of a few members, in every processing order and on several threads.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "GainLinkGroup.h"
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr int hostBlockSize = 64;
+    constexpr int numBlocks = 200;
+    constexpr int numSamples = hostBlockSize * numBlocks;
+
+    /** A member's raw envelope at the base rate: 0 dB, with a dip of its own somewhere. */
+    std::vector<float> makeEnvelope (const int dipStart, const float dip)
+    {
+        std::vector<float> envelope (numSamples, 0.0f);
+        std::fill (envelope.begin() + dipStart, envelope.begin() + dipStart + 37, dip);
+        return envelope;
+    }
+
+    /** Links one host block of a member's envelope, oversampled by repeating each sample. */
+    void linkBlock (GainLinkMember& member, const std::vector<float>& envelope, std::vector<float>& output, const int factor, const int block, const bool withTimeline)
+    {
+        float buffer[hostBlockSize * 8];
+        const int start = block * hostBlockSize;
+
+        for (int i = 0; i < hostBlockSize * factor; ++i)
+            buffer[i] = envelope[static_cast<size_t> (start + i / factor)];
+
+        member.linkEnvelope (buffer, hostBlockSize * factor, withTimeline ? start + 5000 : -1);
+
+        // every oversampled group has to come out the same
+        for (int i = 0; i < hostBlockSize; ++i)
+            output[static_cast<size_t> (start + i)] = *std::max_element (buffer + i * factor, buffer + (i + 1) * factor);
+    }
+
+    /** The expected output: the minimum of all envelopes, one host block late. */
+    std::vector<float> expectedOutput (const std::vector<const std::vector<float>*>& envelopes)
+    {
+        std::vector<float> expected (numSamples, 0.0f);
+        for (int i = hostBlockSize; i < numSamples; ++i)
+            for (const auto* envelope : envelopes)
+                expected[static_cast<size_t> (i)] = std::min (expected[static_cast<size_t> (i)], (*envelope)[static_cast<size_t> (i - hostBlockSize)]);
+        return expected;
+    }
+}
+
+int main()
+{
+    const auto envelopeA = makeEnvelope (1000, -10.0f);
+    const auto envelopeB = makeEnvelope (3000, -6.0f);
+    const auto envelopeC = makeEnvelope (6000, -3.0f);
+    const auto expectedLinked = expectedOutput ({ &envelopeA, &envelopeB, &envelopeC });
+
+    // A and B at the base rate, C oversampled, another member in a different group; the order changes every block
+    {
+        GainLinkMember a, b, c, stranger;
+        expect (a.prepare (0, hostBlockSize, 1, hostBlockSize) && b.prepare (0, hostBlockSize, 1, hostBlockSize)
+                && c.prepare (0, hostBlockSize, 4, 4 * hostBlockSize) && stranger.prepare (1, hostBlockSize, 1, hostBlockSize), "the members join");
+        expect (a.getLatencyInSamples() == hostBlockSize && c.getLatencyInSamples() == 4 * hostBlockSize, "the latency is one host block");
+
+        const auto envelopeStranger = makeEnvelope (2000, -20.0f);
+        std::vector<float> outputA (numSamples), outputB (numSamples), outputC (numSamples), outputStranger (numSamples);
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            if (block % 2 == 0)
+            {
+                linkBlock (a, envelopeA, outputA, 1, block, true);
+                linkBlock (stranger, envelopeStranger, outputStranger, 1, block, true);
+                linkBlock (b, envelopeB, outputB, 1, block, true);
+                linkBlock (c, envelopeC, outputC, 4, block, true);
+            }
+            else
+            {
+                linkBlock (c, envelopeC, outputC, 4, block, true);
+                linkBlock (b, envelopeB, outputB, 1, block, true);
+                linkBlock (stranger, envelopeStranger, outputStranger, 1, block, true);
+                linkBlock (a, envelopeA, outputA, 1, block, true);
+            }
+        }
+
+        expect (outputA == expectedLinked && outputB == expectedLinked && outputC == expectedLinked, "all members get the group minimum, in any order");
+        expect (outputStranger == expectedOutput ({ &envelopeStranger }), "other groups don't take part");
+    }
+
+    // without a shared timeline, nothing is linked, but the envelope is delayed all the same
+    {
+        GainLinkMember a, b;
+        a.prepare (2, hostBlockSize, 1, hostBlockSize);
+        b.prepare (2, hostBlockSize, 1, hostBlockSize);
+
+        std::vector<float> outputA (numSamples), outputB (numSamples);
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            linkBlock (a, envelopeA, outputA, 1, block, false);
+            linkBlock (b, envelopeB, outputB, 1, block, false);
+        }
+
+        expect (outputA == expectedOutput ({ &envelopeA }) && outputB == expectedOutput ({ &envelopeB }), "nothing is linked without a timeline");
+    }
+
+    // every member on its own thread, the host only makes sure a block is finished everywhere before the next one starts
+    {
+        GainLinkMember a, b, c;
+        a.prepare (3, hostBlockSize, 1, hostBlockSize);
+        b.prepare (3, hostBlockSize, 1, hostBlockSize);
+        c.prepare (3, hostBlockSize, 4, 4 * hostBlockSize);
+
+        std::vector<float> outputA (numSamples), outputB (numSamples), outputC (numSamples);
+        std::atomic<int> numFinished { 0 };
+
+        auto run = [&numFinished] (GainLinkMember& member, const std::vector<float>& envelope, std::vector<float>& output, const int factor)
+        {
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                while (numFinished.load() < 3 * block)
+                    std::this_thread::yield();
+
+                linkBlock (member, envelope, output, factor, block, true);
+                ++numFinished;
+            }
+        };
+
+        std::thread threadA (run, std::ref (a), std::cref (envelopeA), std::ref (outputA), 1);
+        std::thread threadB (run, std::ref (b), std::cref (envelopeB), std::ref (outputB), 1);
+        run (c, envelopeC, outputC, 4);
+        threadA.join();
+        threadB.join();
+
+        expect (outputA == expectedLinked && outputB == expectedLinked && outputC == expectedLinked, "members on different threads get the group minimum");
+    }
+
+    // a full group, and a latency the rings can't hold
+    {
+        std::vector<GainLinkMember> members (GainLinkGroups::maxNumMembers);
+        int numJoined = 0;
+        for (auto& member : members)
+            numJoined += member.prepare (4, hostBlockSize, 1, hostBlockSize) ? 1 : 0;
+
+        GainLinkMember oneTooMany;
+        expect (numJoined == GainLinkGroups::maxNumMembers && ! oneTooMany.prepare (4, hostBlockSize, 1, hostBlockSize) && oneTooMany.getLatencyInSamples() == 0, "a member without a slot doesn't link");
+    }
+
+    GainLinkMember tooLate;
+    expect (! tooLate.prepare (5, GainLinkGroups::ringSize, 1, hostBlockSize) && tooLate.getGroup() < 0, "a latency longer than the rings is refused");
+
+    return getExitCode();
+}
@@ -0,0 +1,211 @@
+/*
+  ==============================================================================
+
+    KernelVerifier.cpp
+
+  ==============================================================================
+*/
+
+#include "KernelVerifier.h"
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <iterator>
+
+KernelVerifier::KernelVerifier (const double newSampleRate, const int newMaximumBlockSize, const uint32_t newSeed)
+    : sampleRate (newSampleRate), maximumBlockSize (std::max (1, newMaximumBlockSize)), seed (newSeed)
+{
+}
+
+const char* KernelVerifier::getSignalName (const Signal signal)
+{
+    switch (signal)
+    {
+        case Signal::sineSweep:     return "sineSweep";
+        case Signal::whiteNoise:    return "whiteNoise";
+        case Signal::bursts:        return "bursts";
+        case Signal::impulses:      return "impulses";
+        case Signal::silence:       return "silence";
+    }
+
+    return "unknown";
+}
+
+void KernelVerifier::generateSignal (const Signal signal, float* dest, const int numSamples)
+{
+    std::mt19937 random (seed);
+    std::uniform_real_distribution<float> uniform (-1.0f, 1.0f);
+
+    switch (signal)
+    {
+        case Signal::sineSweep:
+        {
+            const double pi = 3.14159265358979323846;
+            const double f0 = 20.0, f1 = 20000.0;
+            const double duration = numSamples / sampleRate;
+            const double k = std::log (f1 / f0);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double t = i / sampleRate;
+                const double phase = 2.0 * pi * f0 * duration / k * (std::exp (t / duration * k) - 1.0);
+                dest[i] = static_cast<float> (std::sin (phase));
+            }
+            break;
+        }
+
+        case Signal::whiteNoise:
+            for (int i = 0; i < numSamples; ++i)
+                dest[i] = uniform (random);
+            break;
+
+        case Signal::bursts:
+        {
+            std::uniform_int_distribution<int> length (1, static_cast<int> (0.2 * sampleRate));
+            std::uniform_real_distribution<float> levelInDecibels (-60.0f, 6.0f);
+
+            // leave the last quarter silent, so release behaviour gets compared as well
+            const int end = numSamples - numSamples / 4;
+            int i = 0;
+            while (i < end)
+            {
+                const float gain = std::pow (10.0f, 0.05f * levelInDecibels (random));
+                const int burstEnd = std::min (end, i + length (random));
+                for (; i < burstEnd; ++i)
+                    dest[i] = gain * uniform (random);
+
+                const int gapEnd = std::min (end, i + length (random) / 4);
+                for (; i < gapEnd; ++i)
+                    dest[i] = 0.0f;
+            }
+            std::fill (dest + end, dest + numSamples, 0.0f);
+            break;
+        }
+
+        case Signal::impulses:
+        {
+            std::uniform_int_distribution<int> distance (1, static_cast<int> (0.05 * sampleRate));
+            std::fill (dest, dest + numSamples, 0.0f);
+            for (int i = distance (random); i < numSamples; i += distance (random))
+                dest[i] = 2.0f * uniform (random);
+            break;
+        }
+
+        case Signal::silence:
+            std::fill (dest, dest + numSamples, 0.0f);
+            break;
+    }
+}
+
+std::vector<int> KernelVerifier::makeBlockSizes (const int numSamples)
+{
+    static constexpr int primes[] = { 2, 3, 5, 7, 13, 31, 61, 127, 251, 509, 1021, 2039 };
+
+    std::mt19937 random (seed + 1);
+    std::uniform_int_distribution<int> choice (0, 5);
+    std::uniform_int_distribution<int> anySize (1, maximumBlockSize);
+
+    std::vector<int> blockSizes;
+    int remaining = numSamples;
+    while (remaining > 0)
+    {
+        int size;
+        switch (choice (random))
+        {
+            case 0: size = 1; break;
+            case 1: size = maximumBlockSize; break;
+            case 2: size = maximumBlockSize - 1; break;
+            case 3:
+            {
+                std::uniform_int_distribution<int> prime (0, static_cast<int> (std::size (primes)) - 1);
+                size = primes[prime (random)];
+                break;
+            }
+            default: size = anySize (random) | 1; break; // odd sizes
+        }
+
+        size = std::max (1, std::min ({ size, maximumBlockSize, remaining }));
+        blockSizes.push_back (size);
+        remaining -= size;
+    }
+
+    return blockSizes;
+}
+
+double KernelVerifier::run (Kernel& kernel, const std::vector<float>& input, std::vector<float>& output, const std::vector<int>& blockSizes)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    int offset = 0;
+    for (const int size : blockSizes)
+    {
+        kernel (input.data() + offset, output.data() + offset, size);
+        offset += size;
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano> (end - start).count();
+}
+
+KernelVerifier::Report KernelVerifier::compare (const Signal signal, Kernel reference, Kernel candidate, const ErrorBudget& budget, const int numSamples)
+{
+    Report report;
+    report.signalName = getSignalName (signal);
+    report.numSamples = numSamples;
+
+    std::vector<float> input (numSamples);
+    std::vector<float> referenceOutput (numSamples, 0.0f);
+    std::vector<float> candidateOutput (numSamples, 0.0f);
+
+    generateSignal (signal, input.data(), numSamples);
+    const auto blockSizes = makeBlockSizes (numSamples);
+    report.numBlocks = static_cast<int> (blockSizes.size());
+
+    report.referenceNanosecondsPerSample = run (reference, input, referenceOutput, blockSizes) / numSamples;
+    report.candidateNanosecondsPerSample = run (candidate, input, candidateOutput, blockSizes) / numSamples;
+
+    bool finite = true;
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float ref = referenceOutput[i];
+        const float cand = candidateOutput[i];
+
+        // both infinite with the same sign (e.g. -inf dB for digital silence) counts as a match
+        const float absError = (ref == cand) ? 0.0f : std::abs (cand - ref);
+        if (std::isnan (absError))
+        {
+            if (std::isnan (cand) != std::isnan (ref) || ! std::isnan (ref))
+                finite = false;
+            continue;
+        }
+
+        if (absError > report.maxAbsError)
+        {
+            report.maxAbsError = absError;
+            report.worstSampleIndex = i;
+        }
+
+        if (std::abs (ref) > budget.decibelErrorFloor)
+        {
+            const float decibelError = std::abs (20.0f * std::log10 (std::abs (cand) / std::abs (ref)));
+            if (decibelError > report.maxDecibelError || std::isnan (decibelError))
+                report.maxDecibelError = decibelError;
+        }
+    }
+
+    report.passed = finite
+                    && report.maxAbsError <= budget.maxAbsError
+                    && report.maxDecibelError <= budget.maxDecibelError;
+
+    return report;
+}
+
+std::vector<KernelVerifier::Report> KernelVerifier::compareAll (const std::function<Kernel()>& makeReference, const std::function<Kernel()>& makeCandidate, const ErrorBudget& budget, const int numSamples)
+{
+    std::vector<Report> reports;
+
+    for (const auto signal : { Signal::sineSweep, Signal::whiteNoise, Signal::bursts, Signal::impulses, Signal::silence })
+        reports.push_back (compare (signal, makeReference(), makeCandidate(), budget, numSamples));
+
+    return reports;
+}
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    KernelVerifier.h
+
+    Compares optimized DSP kernels against the frozen ReferenceKernels.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <cstdint>
+
+/**
+ Drives a reference kernel and a candidate kernel with identical generated signals and identical, randomized block-size sequences, and reports how far the candidate's output deviates from the reference and how long each of them took.
+
+ The block sizes include 1, the maximum block size and odd or prime sizes in between, so ring-buffer based kernels are forced through every blockSize1/blockSize2 wrap-around combination.
+
+ A kernel is any stateful streaming process, wrapped into a Kernel function object. It gets called block after block with the input and the output pointer of the current block:
+
+ @code
+ ReferenceKernels::GainReductionComputer reference;
+ GainReductionComputer candidate;
+ // ... set identical parameters and prepare both ...
+
+ KernelVerifier verifier (48000.0, 512);
+ auto report = verifier.compare (KernelVerifier::Signal::bursts,
+                                 [&] (const float* in, float* out, int n) { reference.computeGainInDecibelsFromSidechainSignal (in, out, n); },
+                                 [&] (const float* in, float* out, int n) { candidate.computeGainInDecibelsFromSidechainSignal (in, out, n); },
+                                 { 1.0e-4f, 0.01f });
+ jassert (report.passed);
+ @endcode
+ */
+class KernelVerifier
+{
+public:
+    using Kernel = std::function<void (const float* input, float* output, int numSamples)>;
+
+    enum class Signal
+    {
+        sineSweep,  // logarithmic sweep from 20 Hz to 20 kHz at 0 dBFS
+        whiteNoise, // uniform noise at 0 dBFS peak
+        bursts,     // noise bursts with random levels, lengths and gaps, followed by silence
+        impulses,   // sparse single-sample impulses with random levels
+        silence
+    };
+
+    /** The maximum deviation a candidate is allowed to have. The decibel error is only evaluated where the reference is above decibelErrorFloor. For kernels which already output decibel values (e.g. gain reduction) use maxAbsError.
+     */
+    struct ErrorBudget
+    {
+        float maxAbsError;
+        float maxDecibelError;
+        float decibelErrorFloor = 1.0e-5f; // -100 dB
+    };
+
+    struct Report
+    {
+        std::string signalName;
+        int numSamples = 0;
+        int numBlocks = 0;
+
+        float maxAbsError = 0.0f;
+        float maxDecibelError = 0.0f;
+        int worstSampleIndex = -1;
+
+        double referenceNanosecondsPerSample = 0.0;
+        double candidateNanosecondsPerSample = 0.0;
+
+        bool passed = false;
+    };
+
+    KernelVerifier (const double sampleRate, const int maximumBlockSize, const uint32_t seed = 1);
+
+    /** Feeds both kernels with the given signal, split into the same randomized blocks, and compares their outputs.
+     */
+    Report compare (const Signal signal, Kernel reference, Kernel candidate, const ErrorBudget& budget, const int numSamples = 1 << 18);
+
+    /** Runs compare() for every signal type, returns all reports. */
+    std::vector<Report> compareAll (const std::function<Kernel()>& makeReference, const std::function<Kernel()>& makeCandidate, const ErrorBudget& budget, const int numSamples = 1 << 18);
+
+    /** Fills dest with a deterministic test signal. */
+    void generateSignal (const Signal signal, float* dest, const int numSamples);
+
+    /** Returns a deterministic sequence of block sizes in the range [1, maximumBlockSize] which sums up to numSamples. */
+    std::vector<int> makeBlockSizes (const int numSamples);
+
+    static const char* getSignalName (const Signal signal);
+
+private:
+    static double run (Kernel& kernel, const std::vector<float>& input, std::vector<float>& output, const std::vector<int>& blockSizes);
+
+    double sampleRate;
+    int maximumBlockSize;
+    uint32_t seed;
+};
@@ -0,0 +1,162 @@
+/*
+  ==============================================================================
+
+    KernelVerifierTest.cpp
+
+    Checks the production kernels against the frozen reference kernels.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "ReferenceKernels.h"
+#include "GainReductionComputer.h"
+#include "LookAheadGainReduction.h"
+#include "LimiterCore.h"
+#include <memory>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+
+    struct DetectorSettings
+    {
+        float threshold, knee, ratio, attackTime, releaseTime;
+    };
+
+    /** For kernels whose output is in decibels already: the absolute error is the error in dB, a ratio of two of them means nothing. */
+    KernelVerifier::ErrorBudget decibelBudget (const float maxErrorInDecibels)
+    {
+        return { maxErrorInDecibels, 0.0f, std::numeric_limits<float>::infinity() };
+    }
+
+    template <typename Computer>
+    void applySettings (Computer& computer, const DetectorSettings& settings)
+    {
+        computer.setThreshold (settings.threshold);
+        computer.setKnee (settings.knee);
+        computer.setRatio (settings.ratio);
+        computer.setAttackTime (settings.attackTime);
+        computer.setReleaseTime (settings.releaseTime);
+        computer.prepare (sampleRate);
+    }
+
+    /** The detector at every sample, without a characteristic table. */
+    void testGainReductionComputer (const int maximumBlockSize, const uint32_t seed)
+    {
+        const DetectorSettings settings[] = {
+            { -20.0f, 0.0f, std::numeric_limits<float>::infinity(), 0.001f, 0.1f },
+            { -10.0f, 6.0f, 4.0f, 0.03f, 0.15f }
+        };
+
+        for (const auto& setting : settings)
+        {
+            KernelVerifier verifier (sampleRate, maximumBlockSize, seed);
+
+            auto makeReference = [&]
+            {
+                auto computer = std::make_shared<ReferenceKernels::GainReductionComputer>();
+                applySettings (*computer, setting);
+                return KernelVerifier::Kernel ([computer] (const float* in, float* out, int n) { computer->computeGainInDecibelsFromSidechainSignal (in, out, n); });
+            };
+
+            auto makeCandidate = [&]
+            {
+                auto computer = std::make_shared<GainReductionComputer>();
+                applySettings (*computer, setting);
+                return KernelVerifier::Kernel ([computer] (const float* in, float* out, int n) { computer->computeGainInDecibelsFromSidechainSignal (in, out, n); });
+            };
+
+            for (const auto& report : verifier.compareAll (makeReference, makeCandidate, decibelBudget (1.0e-4f), 1 << 17))
+                expect (report, "GainReductionComputer");
+        }
+    }
+
+    /** The look-ahead with the linear fade, which the reference implements. */
+    void testLookAheadGainReduction (const int maximumBlockSize, const uint32_t seed)
+    {
+        KernelVerifier verifier (sampleRate, maximumBlockSize, seed);
+
+        // the fade-in works on gain reduction in decibels, so the signals are turned into that first
+        auto makeKernel = [maximumBlockSize] (auto lookAhead)
+        {
+            auto scratch = std::make_shared<std::vector<float>> (static_cast<size_t> (maximumBlockSize));
+            lookAhead->setDelayTime (0.005f);
+            lookAhead->prepare (sampleRate, maximumBlockSize);
+
+            return KernelVerifier::Kernel ([lookAhead, scratch] (const float* in, float* out, int n)
+            {
+                for (int i = 0; i < n; ++i)
+                    (*scratch)[static_cast<size_t> (i)] = -20.0f * std::abs (in[i]);
+
+                lookAhead->pushSamples (scratch->data(), n);
+                lookAhead->process();
+                lookAhead->readSamples (out, n);
+            });
+        };
+
+        auto makeReference = [&] { return makeKernel (std::make_shared<ReferenceKernels::LookAheadGainReduction>()); };
+        auto makeCandidate = [&] { return makeKernel (std::make_shared<LookAheadGainReduction>()); };
+
+        // the production fade is computed incrementally, the reference one per sample
+        for (const auto& report : verifier.compareAll (makeReference, makeCandidate, decibelBudget (5.0e-4f), 1 << 17))
+            expect (report, "LookAheadGainReduction (linear)");
+    }
+
+    /** The delay line of LimiterCore, with the threshold so high that the gain stays at exactly 1. */
+    void testDelay (const int maximumBlockSize, const uint32_t seed)
+    {
+        KernelVerifier verifier (sampleRate, maximumBlockSize, seed);
+
+        auto makeReference = [&]
+        {
+            auto delay = std::make_shared<ReferenceKernels::Delay>();
+            delay->prepare (sampleRate, maximumBlockSize, 1);
+            delay->setDelayTime (0.005f);
+
+            return KernelVerifier::Kernel ([delay] (const float* in, float* out, int n)
+            {
+                std::copy (in, in + n, out);
+                delay->process (&out, 1, n);
+            });
+        };
+
+        auto makeCandidate = [&]
+        {
+            auto core = std::make_shared<LimiterCore>();
+            core->setThreshold (100.0f);
+            core->setLookAhead (true);
+            core->prepare (sampleRate, 1);
+
+            return KernelVerifier::Kernel ([core] (const float* in, float* out, int n)
+            {
+                std::copy (in, in + n, out);
+                core->processPlanar (&out, n);
+            });
+        };
+
+        for (const auto& report : verifier.compareAll (makeReference, makeCandidate, { 0.0f, 0.0f }, 1 << 17))
+            expect (report, "Delay (LimiterCore)");
+    }
+}
+
+int main()
+{
+    // 1 and the largest size are always among the block sizes, odd ones and primes force every ring wrap-around
+    for (const int maximumBlockSize : { 512, 61, 2048 })
+    {
+        for (const uint32_t seed : { 1u, 7u })
+        {
+            testGainReductionComputer (maximumBlockSize, seed);
+            testLookAheadGainReduction (maximumBlockSize, seed);
+            testDelay (maximumBlockSize, seed);
+        }
+    }
+
+    return getExitCode();
+}
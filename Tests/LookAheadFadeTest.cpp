@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    LookAheadFadeTest.cpp
+
+    Checks the fade-in of every shape in front of an isolated gain reduction peak.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "LookAheadGainReduction.h"
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int maximumBlockSize = 97;
+
+    /** Runs a single peak through the look-ahead in random blocks and returns the output. */
+    std::vector<float> runPeak (const LookAheadGainReduction::FadeShape shape, const int peakPosition, const float peak, const int numSamples, const uint32_t seed)
+    {
+        LookAheadGainReduction lookAhead;
+        lookAhead.setDelayTime (0.005f);
+        lookAhead.setFadeShape (shape);
+        lookAhead.prepare (sampleRate, maximumBlockSize);
+
+        std::vector<float> input (static_cast<size_t> (numSamples), 0.0f);
+        input[static_cast<size_t> (peakPosition)] = peak;
+        std::vector<float> output (input.size());
+
+        std::mt19937 random (seed);
+        std::uniform_int_distribution<int> blockSizes (1, maximumBlockSize);
+
+        for (int start = 0; start < numSamples;)
+        {
+            const int n = std::min (blockSizes (random), numSamples - start);
+            lookAhead.pushSamples (input.data() + start, n);
+            lookAhead.process();
+            lookAhead.readSamples (output.data() + start, n);
+            start += n;
+        }
+
+        return output;
+    }
+}
+
+int main()
+{
+    const char* names[] = { "linear", "raised cosine", "exponential", "S-curve" };
+    constexpr float peak = -12.0f;
+    constexpr int peakPosition = 5000;
+
+    for (int s = 0; s < LookAheadGainReduction::numFadeShapes; ++s)
+    {
+        const auto shape = static_cast<LookAheadGainReduction::FadeShape> (s);
+
+        LookAheadGainReduction probe;
+        probe.setDelayTime (0.005f);
+        probe.prepare (sampleRate, maximumBlockSize);
+        const int delay = probe.getDelayInSamples();
+
+        for (const uint32_t seed : { 1u, 2u, 3u })
+        {
+            const auto output = runPeak (shape, peakPosition, peak, 10000, seed);
+
+            // the peak comes out delayed, the fade of the shape in front of it, silence everywhere else
+            float maxError = 0.0f;
+            for (int j = 0; j < static_cast<int> (output.size()); ++j)
+            {
+                const int k = peakPosition + delay - j;
+                const float expected = k >= 0 && k <= delay ? peak * LookAheadGainReduction::getFadeValue (shape, 1.0 - static_cast<double> (k) / delay) : 0.0f;
+                maxError = std::max (maxError, std::abs (output[static_cast<size_t> (j)] - expected));
+            }
+
+            std::printf ("%-14s seed %u  max error %g dB\n", names[s], seed, maxError);
+            expect (maxError < 1.0e-5f, names[s]);
+        }
+
+        // every shape starts at 0 dB, reaches the peak and never turns back on the way
+        bool monotonic = true;
+        for (int k = 1; k <= delay; ++k)
+            monotonic = monotonic && LookAheadGainReduction::getFadeValue (shape, static_cast<double> (k) / delay) >= LookAheadGainReduction::getFadeValue (shape, static_cast<double> (k - 1) / delay);
+
+        expect (LookAheadGainReduction::getFadeValue (shape, 0.0) == 0.0f && std::abs (LookAheadGainReduction::getFadeValue (shape, 1.0) - 1.0f) < 1.0e-6f, "the fade runs from 0 to 1");
+        expect (monotonic, "the fade is monotonic");
+    }
+
+    return getExitCode();
+}
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    LoudnessMeterTest.cpp
+
+    Checks the loudness of sines against BS.1770, including the channel weights.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "LoudnessMeter.h"
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr double pi = 3.14159265358979323846;
+
+    /** The integrated loudness of 10 s of a 1 kHz sine at the given peak level on one channel of a 5.1 bus (L R C LFE Ls Rs). */
+    float measureSine (const int channel, const float peakInDecibels, const std::vector<float>& weights)
+    {
+        constexpr int numChannels = 6;
+        constexpr int numSamples = static_cast<int> (10 * sampleRate);
+
+        std::vector<std::vector<float>> buffers (numChannels, std::vector<float> (numSamples, 0.0f));
+        const float amplitude = std::pow (10.0f, peakInDecibels / 20.0f);
+        for (int i = 0; i < numSamples; ++i)
+            buffers[static_cast<size_t> (channel)][static_cast<size_t> (i)] = amplitude * static_cast<float> (std::sin (2.0 * pi * 1000.0 * i / sampleRate));
+
+        const float* channels[numChannels];
+        for (int ch = 0; ch < numChannels; ++ch)
+            channels[ch] = buffers[static_cast<size_t> (ch)].data();
+
+        LoudnessMeter meter;
+        meter.prepare (sampleRate, numChannels, weights);
+
+        // in odd blocks, so the 100 ms steps never line up with them
+        for (int start = 0; start < numSamples; start += 997)
+        {
+            const float* block[numChannels];
+            for (int ch = 0; ch < numChannels; ++ch)
+                block[ch] = channels[ch] + start;
+
+            meter.process (block, numChannels, std::min (997, numSamples - start));
+        }
+
+        return meter.getIntegratedLoudness();
+    }
+}
+
+int main()
+{
+    const std::vector<float> weights { 1.0f, 1.0f, 1.0f, 0.0f, LoudnessMeter::surroundChannelWeight, LoudnessMeter::surroundChannelWeight };
+
+    // BS.1770: a 0 dBFS 1 kHz sine on one front channel reads -3.01 LUFS
+    const float front = measureSine (0, -20.0f, weights);
+    std::printf ("front: %.2f LUFS\n", front);
+    expect (std::abs (front - -23.01f) < 0.1f, "a -20 dBFS sine on a front channel reads -23 LUFS");
+
+    const float surround = measureSine (4, -20.0f, weights);
+    std::printf ("surround: %.2f LUFS\n", surround);
+    expect (std::abs (surround - front - 1.49f) < 0.05f, "the surround channels count 1.5 dB more");
+
+    const float lfe = measureSine (3, -20.0f, weights);
+    expect (std::isinf (lfe) && lfe < 0.0f, "the LFE isn't measured");
+
+    // without weights, every channel counts the same
+    expect (std::abs (measureSine (4, -20.0f, {}) - front) < 0.01f, "channels without a weight count 1.0");
+
+    return getExitCode();
+}
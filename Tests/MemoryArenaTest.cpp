@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    MemoryArenaTest.cpp
+
+    Checks that the arena reports every allocation it can't serve, and that the sizes its users announce are exactly what they take.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "MemoryArena.h"
+#include "LookAheadGainReduction.h"
+#include <cstdint>
+#include <limits>
+
+using namespace TestUtilities;
+
+namespace
+{
+    void testExhaustion()
+    {
+        MemoryArena arena;
+        expect (arena.allocate<float> (1) == nullptr, "an empty arena serves nothing");
+
+        expect (arena.reserve (MemoryArena::getRequiredBytes<float> (100) + MemoryArena::getRequiredBytes<double> (7)), "a small arena can be reserved");
+        auto* first = arena.allocate<float> (100);
+        auto* second = arena.allocate<double> (7);
+        expect (first != nullptr && second != nullptr, "allocations within the reserved size are served");
+        expect (reinterpret_cast<uintptr_t> (second) % MemoryArena::alignment == 0, "allocations are aligned");
+        expect (arena.allocate<char> (1) == nullptr, "an exhausted arena returns nullptr");
+
+        arena.clear();
+        expect (arena.allocate<float> (100) != nullptr, "clear takes all allocations back");
+
+        // far more than any machine has, so operator new fails
+        expect (! arena.reserve (std::numeric_limits<size_t>::max() / 2), "a reserve which can't be allocated reports it");
+        expect (arena.getCapacity() == 0 && arena.allocate<float> (1) == nullptr, "after a failed reserve, the arena is empty");
+    }
+
+    /** The look-ahead buffers at every common rate: getRequiredArenaBytes() is exactly what prepare() takes, and one float less makes it fail. */
+    void testLookAheadSizes()
+    {
+        for (const double sampleRate : { 44100.0, 48000.0, 96000.0, 192000.0, 384000.0 })
+        {
+            const size_t requiredBytes = LookAheadGainReduction::getRequiredArenaBytes (sampleRate, 64, 0.005f);
+
+            LookAheadGainReduction lookAhead;
+            lookAhead.setDelayTime (0.005f);
+
+            MemoryArena arena;
+            arena.reserve (requiredBytes);
+            expect (lookAhead.prepare (sampleRate, 64, arena), "the look-ahead fits into the bytes it announces");
+            expect (arena.getNumBytesUsed() == requiredBytes, "the look-ahead takes exactly the bytes it announces");
+
+            MemoryArena tooSmall;
+            tooSmall.reserve (requiredBytes - sizeof (float));
+            expect (! lookAhead.prepare (sampleRate, 64, tooSmall), "the look-ahead reports an arena which is too small");
+        }
+    }
+}
+
+int main()
+{
+    testExhaustion();
+    testLookAheadSizes();
+
+    return getExitCode();
+}
@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+
+    MinMaxPyramidTest.cpp
+
+    Compares the pyramid's ranges with the minimum and maximum over every sample, at all zooms; then reads it from another thread while it's pushed to and prepared again with other sizes, and checks that every range read is one that was pushed.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "MinMaxPyramid.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace TestUtilities;
+
+namespace
+{
+    /** A single bin has to give exactly the values pushed into it, any other range at least all of them; the finest level forgets first, and its ranges are then taken from a coarser one. */
+    void testBruteForce()
+    {
+        constexpr int samplesPerBin = 64, binsPerLevel = 1024;
+        constexpr int64_t length = 1 << 22;
+
+        MinMaxPyramid pyramid;
+        pyramid.prepare (samplesPerBin, binsPerLevel, length);
+        expect (pyramid.getLengthInSamples() >= length && pyramid.getLengthInSamples() < 2 * length, "the coarsest level covers the length");
+
+        // blocks of random sizes, so values start and end anywhere within the bins
+        std::mt19937 random (1);
+        std::normal_distribution<float> level (-20.0f, 6.0f);
+        std::vector<float> values;
+
+        for (int64_t position = 0; position < length + length / 2;)
+        {
+            const int numSamples = 1 + static_cast<int> (random() % 300);
+            const float value = level (random);
+            pyramid.push (value, numSamples);
+            values.insert (values.end(), static_cast<size_t> (numSamples), value);
+            position += numSamples;
+        }
+
+        const auto numSamples = static_cast<int64_t> (values.size());
+        int numRanges = 0, numWrong = 0, numBins = 0, numNotExact = 0, numMissing = 0;
+
+        for (int trial = 0; trial < 10000; ++trial)
+        {
+            // every fourth range is a single recent bin, the others have any width and any position
+            const bool singleBin = trial % 4 == 0;
+            const auto width = std::max<int64_t> (1, static_cast<int64_t> (std::exp (std::uniform_real_distribution<double> (0.0, std::log (2.0e6)) (random))));
+            const int64_t start = singleBin ? (numSamples / samplesPerBin - 2 - static_cast<int64_t> (random() % (binsPerLevel - 2))) * samplesPerBin
+                                            : static_cast<int64_t> (random() % static_cast<uint64_t> (numSamples - width));
+            const int64_t end = singleBin ? start + samplesPerBin : start + width;
+
+            if (end > pyramid.getNumSamples (end - start))
+                continue;
+
+            MinMaxPyramid::Range range;
+            if (! pyramid.getRange (start, end, range))
+            {
+                // only what even the coarsest level forgot may be missing
+                if (start >= numSamples - pyramid.getLengthInSamples() / 2)
+                    ++numMissing;
+
+                continue;
+            }
+
+            const auto minmax = std::minmax_element (values.begin() + start, values.begin() + end);
+            ++numRanges;
+
+            if (range.minimum > *minmax.first || range.maximum < *minmax.second)
+                ++numWrong;
+
+            // the finest level still holds these
+            if (singleBin)
+            {
+                ++numBins;
+                if (range.minimum != *minmax.first || range.maximum != *minmax.second)
+                    ++numNotExact;
+            }
+        }
+
+        std::printf ("%d ranges compared: %d missing a value, %d of %d single bins not exact, %d missing while still held\n", numRanges, numWrong, numNotExact, numBins, numMissing);
+        expect (numRanges > 5000, "most ranges are found");
+        expect (numWrong == 0, "every range holds the minimum and maximum of its samples");
+        expect (numBins > 0 && numNotExact == 0, "a single bin on the finest level is exact");
+        expect (numMissing == 0, "ranges which a level still holds are found");
+
+        MinMaxPyramid::Range range;
+        expect (! pyramid.getRange (numSamples, numSamples + samplesPerBin, range), "ranges which haven't been pushed yet aren't found");
+
+        pyramid.prepare (samplesPerBin, binsPerLevel, length);
+        expect (pyramid.getNumSamples (samplesPerBin) == numSamples / samplesPerBin * samplesPerBin, "preparing again with the same sizes keeps the history");
+    }
+
+    /** The value pushed for every 64 samples is their index, so a reader knows what every range has to hold, whatever the pyramid was prepared with. */
+    void testConcurrentReads()
+    {
+        constexpr int unit = 64;
+
+        MinMaxPyramid pyramid;
+        pyramid.prepare (unit, 256, 1 << 20);
+
+        std::atomic<bool> done { false };
+        int64_t numReads = 0, numWrong = 0;
+
+        std::thread reader ([&]
+        {
+            std::mt19937 random (2);
+            while (! done.load())
+            {
+                const int64_t samplesPerRange = unit << (random() % 8);
+                const int64_t end = pyramid.getNumSamples (samplesPerRange);
+                const int64_t start = end - samplesPerRange * (1 + static_cast<int64_t> (random() % 1000));
+
+                MinMaxPyramid::Range range;
+                if (start < 0 || ! pyramid.getRange (start, start + samplesPerRange, range))
+                    continue;
+
+                ++numReads;
+                if (range.minimum > static_cast<float> (start / unit) || range.maximum < static_cast<float> ((start + samplesPerRange) / unit - 1))
+                    ++numWrong;
+            }
+        });
+
+        // the host prepares again with other sizes now and then, e.g. for another sample rate, while the editor keeps reading
+        const int samplesPerBin[] = { unit, 2 * unit, unit };
+        const int binsPerLevel[] = { 256, 512, 128 };
+
+        for (int round = 0; round < 30; ++round)
+        {
+            pyramid.prepare (samplesPerBin[round % 3], binsPerLevel[round % 3], (1 << 20) + round % 3);
+
+            for (int64_t k = 0; k < 100000; ++k)
+                pyramid.push (static_cast<float> (k), unit);
+        }
+
+        done = true;
+        reader.join();
+
+        std::printf ("%lld reads while pushing and preparing, %lld wrong\n", static_cast<long long> (numReads), static_cast<long long> (numWrong));
+        expect (numReads > 0, "the reader read while the pyramid was pushed to");
+        expect (numWrong == 0, "every range read holds the values pushed there");
+    }
+}
+
+int main()
+{
+    testBruteForce();
+    testConcurrentReads();
+
+    return getExitCode();
+}
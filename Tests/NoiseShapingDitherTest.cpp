@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    NoiseShapingDitherTest.cpp
+
+    Checks that the noise-shaped requantization error stays bounded through and after a passage which clips.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "NoiseShapingDither.h"
+#include <cmath>
+#include <vector>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr int bitDepth = 16;
+    constexpr float lsb = 1.0f / (1 << (bitDepth - 1));
+
+    /**
+     The error fed back is the rounding plus the TPDF dither, at most 1.5 LSB, so every output sample which isn't clipped differs from its input by at most 1.5 LSB * (1 + sum |h|). The clipped amount mustn't be fed back: it would add up over a loud passage and come out as noise of up to full scale once the signal gets quieter.
+     */
+    void testClippedPassage (const NoiseShapingDither::Shape shape, const float sumOfCoefficients, const char* name)
+    {
+        NoiseShapingDither dither;
+        dither.prepare (480, 1);
+        dither.setBitDepth (bitDepth);
+        dither.setShape (shape);
+        dither.reset();
+
+        // half a second 1.6 dB over full scale, then half a second at -12 dBFS
+        std::vector<float> input (48000), output;
+        for (size_t n = 0; n < input.size(); ++n)
+            input[n] = (n < input.size() / 2 ? 1.2f : 0.25f) * std::sin (0.01f * static_cast<float> (n));
+
+        output = input;
+        for (size_t start = 0; start < output.size(); start += 480)
+            dither.process (output.data() + start, 480, 0);
+
+        const float bound = 1.5f * (1.0f + sumOfCoefficients) * lsb;
+        float maxError = 0.0f;
+
+        for (size_t n = 0; n < input.size(); ++n)
+            if (std::abs (input[n]) < 1.0f - bound)
+                maxError = std::max (maxError, std::abs (output[n] - input[n]));
+
+        std::printf ("%-12s max error of the unclipped samples %.1f LSB, bound %.1f LSB\n", name, maxError / lsb, bound / lsb);
+        expect (maxError <= bound, "the noise-shaped error stays bounded through and after clipping");
+    }
+}
+
+int main()
+{
+    testClippedPassage (NoiseShapingDither::Shape::none, 0.0f, "no shaping");
+    testClippedPassage (NoiseShapingDither::Shape::firstOrder, 1.0f, "first order");
+    testClippedPassage (NoiseShapingDither::Shape::wannamaker3, 1.623f + 0.982f + 0.109f, "wannamaker3");
+    testClippedPassage (NoiseShapingDither::Shape::lipshitz5, 2.033f + 2.165f + 1.959f + 1.590f + 0.6149f, "lipshitz5");
+
+    return getExitCode();
+}
@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    OfflineRendererTest.cpp
+
+    Renders a file through the processor and checks the output against processBlock, its statistics report, and that offloading and adaptive quality don't change a render.
+
+  ==============================================================================
+*/
+
+#include "ProcessorHarness.h"
+#include "OfflineRenderer.h"
+#include "TestUtilities.h"
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+    constexpr int blockSize = 1024;
+
+    /** With look-ahead and no attack, nothing gets past the threshold, and the look-ahead gives the renderer a latency to compensate. */
+    std::unique_ptr<TLimiterAudioProcessor> createProcessor (const bool offloadAndAdapt)
+    {
+        auto processor = std::make_unique<TLimiterAudioProcessor>();
+
+        ProcessorHarness::setParameter (*processor, "lookAhead", 1.0f);
+        ProcessorHarness::setParameter (*processor, "attack", 0.0f);
+        ProcessorHarness::setParameter (*processor, "threshold", -10.0f);
+        ProcessorHarness::setParameter (*processor, "offload", offloadAndAdapt ? 1.0f : 0.0f);
+        ProcessorHarness::setParameter (*processor, "adaptiveQuality", offloadAndAdapt ? 1.0f : 0.0f);
+
+        ProcessorHarness::prepare (*processor, numChannels, sampleRate, blockSize);
+        return processor;
+    }
+
+    bool writeFile (const File& file, const AudioBuffer<float>& signal)
+    {
+        file.deleteFile();
+        std::unique_ptr<FileOutputStream> stream (file.createOutputStream());
+        if (stream == nullptr)
+            return false;
+
+        // 32-bit float, so the comparisons below can be exact
+        WavAudioFormat wavFormat;
+        std::unique_ptr<AudioFormatWriter> writer (wavFormat.createWriterFor (stream.get(), sampleRate, numChannels, 32, {}, 0));
+        if (writer == nullptr)
+            return false;
+
+        stream.release();
+        return writer->writeFromAudioSampleBuffer (signal, 0, signal.getNumSamples());
+    }
+
+    AudioBuffer<float> readFile (const File& file)
+    {
+        AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor (file));
+        if (reader == nullptr)
+            return {};
+
+        AudioBuffer<float> signal (static_cast<int> (reader->numChannels), static_cast<int> (reader->lengthInSamples));
+        reader->read (&signal, 0, signal.getNumSamples(), 0, true, true);
+        return signal;
+    }
+
+    bool isIdentical (const AudioBuffer<float>& a, const AudioBuffer<float>& b, const int offsetInB = 0)
+    {
+        if (a.getNumChannels() != b.getNumChannels() || a.getNumSamples() + offsetInB > b.getNumSamples())
+            return false;
+
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                if (a.getSample (ch, i) != b.getSample (ch, i + offsetInB))
+                    return false;
+
+        return true;
+    }
+}
+
+int main()
+{
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const auto directory = File::createTempFile ("OfflineRendererTest");
+    directory.createDirectory();
+    const auto inputFile = directory.getChildFile ("input.wav");
+
+    AudioBuffer<float> input (numChannels, static_cast<int> (10 * sampleRate) + 123);
+    ProcessorHarness::fillWithTestSignal (input, 7);
+    expect (writeFile (inputFile, input), "the input file is written");
+
+    // the reference: processBlock in the renderer's blocks, then the latency dropped
+    auto reference = createProcessor (false);
+    const int latencyInSamples = reference->getLatencySamples();
+    AudioBuffer<float> expected (numChannels, input.getNumSamples() + latencyInSamples);
+    expected.clear();
+    for (int ch = 0; ch < numChannels; ++ch)
+        expected.copyFrom (ch, 0, input, ch, 0, input.getNumSamples());
+
+    reference->setNonRealtime (true);
+    reference->prepareToPlay (sampleRate, blockSize);
+    ProcessorHarness::process (*reference, expected, [] (int) { return blockSize; });
+
+    for (const bool offloadAndAdapt : { false, true })
+    {
+        auto processor = createProcessor (offloadAndAdapt);
+        OfflineRenderer renderer (*processor, blockSize);
+        renderer.setCollectsRenderStatistics (true);
+
+        const auto outputFile = directory.getChildFile (offloadAndAdapt ? "offloaded.wav" : "output.wav");
+        const auto result = renderer.render (inputFile, outputFile);
+        std::printf ("render, offload and adaptive quality %s: %s\n", offloadAndAdapt ? "on" : "off", result.wasOk() ? "ok" : result.getErrorMessage().toRawUTF8());
+        expect (result.wasOk(), "the file is rendered");
+
+        const auto output = readFile (outputFile);
+        expect (output.getNumSamples() == input.getNumSamples(), "the output is as long as the input");
+        expect (isIdentical (output, expected, latencyInSamples), offloadAndAdapt ? "offloading and adaptive quality don't change a render"
+                                                                                    : "the render is processBlock with the latency compensated");
+
+        // the report describes the file, not the processor's delay
+        const auto report = JSON::parse (outputFile.withFileExtension ("json"));
+        const auto& statistics = renderer.getRenderStatistics();
+        std::printf ("%s\n", statistics.toJson().c_str());
+
+        expect (report.isObject(), "the report is written next to the output");
+        expect (std::abs (static_cast<double> (report["duration"]) - input.getNumSamples() / sampleRate) < 1.0e-3, "the report covers the whole file");
+        expect (static_cast<float> (static_cast<double> (report["samplePeak"])) <= -9.99f
+                    && std::abs (Decibels::gainToDecibels (output.getMagnitude (0, output.getNumSamples())) - statistics.getSamplePeakInDecibels()) < 1.0e-3f,
+                "the report's sample peak is the file's");
+        expect (report["maxGainReduction"].isVoid(), "the renderer can't see the detector, so its figures are null");
+    }
+
+    directory.deleteRecursively();
+    return getExitCode();
+}
@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+
+    OffloadWorkerTest.cpp
+
+    Exchanges blocks of random sizes with a worker which keeps up, sleeps in between or stalls, and checks that every sample comes out exactly one block later or as silence.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "OffloadWorker.h"
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr int numChannels = 2;
+
+    struct Worker
+    {
+        /** Every n-th chunk stalls the worker for 30 ms, far longer than a block; 0 never does. */
+        int stallEvery = 0;
+        int numChunks = 0;
+        std::atomic<int64_t> numProcessed { 0 };
+
+        /** Doubles the samples. */
+        static void process (void* context, float* const* channels, int numChannelsToProcess, int numSamples)
+        {
+            auto& worker = *static_cast<Worker*> (context);
+
+            for (int ch = 0; ch < numChannelsToProcess; ++ch)
+                for (int i = 0; i < numSamples; ++i)
+                    channels[ch][i] *= 2.0f;
+
+            worker.numProcessed.store (worker.numProcessed.load (std::memory_order_relaxed) + numSamples, std::memory_order_relaxed);
+
+            if (worker.stallEvery > 0 && ++worker.numChunks % worker.stallEvery == 0)
+                std::this_thread::sleep_for (std::chrono::milliseconds (30));
+        }
+    };
+
+    struct Result
+    {
+        int numMisaligned = 0;
+        int numSilent = 0;
+        int numUnderruns = 0;
+    };
+
+    /** Numbers the samples, so every output sample says which input it came from. Pauses for the given time between the blocks, 0 runs them back to back. */
+    Result run (const int maxBlockSize, const int numBlocks, const int stallEvery, const std::chrono::microseconds pause)
+    {
+        Worker worker;
+        worker.stallEvery = stallEvery;
+
+        OffloadWorker offloadWorker;
+        offloadWorker.start (numChannels, maxBlockSize, Worker::process, &worker);
+
+        std::mt19937 random (1);
+        std::vector<float> left (static_cast<size_t> (maxBlockSize)), right (static_cast<size_t> (maxBlockSize));
+        float* channels[] = { left.data(), right.data() };
+
+        Result result;
+        int64_t position = 0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            const int numSamples = random() % 3 == 0 ? maxBlockSize : 1 + static_cast<int> (random() % static_cast<unsigned int> (maxBlockSize));
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                left[static_cast<size_t> (i)] = static_cast<float> (position + i + 1);
+                right[static_cast<size_t> (i)] = -static_cast<float> (position + i + 1);
+            }
+
+            offloadWorker.exchange (channels, numChannels, numSamples);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                // one block of the size passed to start() later, doubled
+                const int64_t input = position + i + 1 - maxBlockSize;
+                const float expected = input >= 1 ? 2.0f * static_cast<float> (input) : 0.0f;
+                const float l = left[static_cast<size_t> (i)], r = right[static_cast<size_t> (i)];
+
+                if (l == 0.0f && r == 0.0f && expected != 0.0f)
+                    ++result.numSilent;
+                else if (l != expected || r != -expected)
+                    ++result.numMisaligned;
+            }
+
+            position += numSamples;
+
+            if (pause.count() > 0)
+                std::this_thread::sleep_for (pause);
+        }
+
+        // everything handed over is processed by then, so stopping finds nothing left to do
+        offloadWorker.waitUntilIdle();
+        const int64_t numProcessedWhenIdle = worker.numProcessed.load (std::memory_order_relaxed);
+
+        result.numUnderruns = offloadWorker.getNumUnderruns();
+        offloadWorker.stop();
+
+        expect (worker.numProcessed.load (std::memory_order_relaxed) == numProcessedWhenIdle, "waitUntilIdle returns once the worker processed all accepted input");
+        return result;
+    }
+
+    /** A worker which keeps up: no sample is late, whether it spins between the blocks or has to be woken from its sleep. */
+    void testKeepingUp()
+    {
+        for (const int maxBlockSize : { 64, 512 })
+        {
+            // longer than the worker spins, so it sleeps before every block
+            const auto result = run (maxBlockSize, 1000, 0, std::chrono::microseconds (300));
+            std::printf ("block %3d, woken every block: misaligned %d, silent %d, underruns %d\n", maxBlockSize, result.numMisaligned, result.numSilent, result.numUnderruns);
+            expect (result.numMisaligned == 0, "a woken worker delivers every sample one block later");
+            expect (result.numSilent == 0 && result.numUnderruns == 0, "a woken worker keeps up");
+        }
+    }
+
+    /** A stalling worker and one which is fed far faster than real time: whatever is missing is silence, everything else stays aligned. */
+    void testFallingBehind()
+    {
+        const auto stalled = run (256, 2000, 50, std::chrono::microseconds (200));
+        std::printf ("block 256, stalling: misaligned %d, silent %d, underruns %d\n", stalled.numMisaligned, stalled.numSilent, stalled.numUnderruns);
+        expect (stalled.numMisaligned == 0, "a stalling worker's output stays aligned");
+        expect (stalled.numSilent > 0 && stalled.numUnderruns > 0, "a stalling worker's missing output is counted");
+
+        const auto flooded = run (128, 20000, 0, std::chrono::microseconds (0));
+        std::printf ("block 128, back to back: misaligned %d, silent %d, underruns %d\n", flooded.numMisaligned, flooded.numSilent, flooded.numUnderruns);
+        expect (flooded.numMisaligned == 0, "a flooded worker's output stays aligned");
+    }
+
+    /** Stopping wakes a sleeping worker, and a restarted one starts over. */
+    void testRestart()
+    {
+        Worker worker;
+        OffloadWorker offloadWorker;
+
+        for (int i = 0; i < 50; ++i)
+        {
+            offloadWorker.start (numChannels, 64, Worker::process, &worker);
+            expect (offloadWorker.getLatencyInSamples() == 64, "a running worker adds one block of latency");
+            std::this_thread::sleep_for (std::chrono::microseconds (i % 2 == 0 ? 0 : 500));
+            offloadWorker.stop();
+        }
+
+        expect (! offloadWorker.isRunning() && offloadWorker.getLatencyInSamples() == 0, "a stopped worker adds no latency");
+        offloadWorker.waitUntilIdle();
+    }
+}
+
+int main()
+{
+    testKeepingUp();
+    testFallingBehind();
+    testRestart();
+
+    return getExitCode();
+}
@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    ParallelChannelsTest.cpp
+
+    Processes a wide unlinked bus with the channel groups on the worker pool and without it, through the detector EQ, look-ahead, second-order clipper and shaped dither, and compares the outputs bit for bit.
+
+  ==============================================================================
+*/
+
+#include "ProcessorHarness.h"
+#include "TestUtilities.h"
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 16;
+    constexpr int blockSize = 512;
+
+    AudioBuffer<float> process (const AudioBuffer<float>& input, const bool parallel)
+    {
+        TLimiterAudioProcessor processor;
+        ProcessorHarness::setParameter (processor, "channelLink", 0.0f);
+        ProcessorHarness::setParameter (processor, "parallelChannels", parallel ? 1.0f : 0.0f);
+        ProcessorHarness::setParameter (processor, "lookAhead", 1.0f);
+        ProcessorHarness::setParameter (processor, "threshold", -12.0f);
+        ProcessorHarness::setParameter (processor, "sideChainFilter", 1.0f);
+        ProcessorHarness::setParameter (processor, "clipper", 2.0f);
+        ProcessorHarness::setParameter (processor, "dither", 1.0f);
+        ProcessorHarness::setParameter (processor, "noiseShaping", 2.0f);
+        ProcessorHarness::prepare (processor, numChannels, sampleRate, blockSize);
+
+        AudioBuffer<float> output (input);
+        ProcessorHarness::process (processor, output, [] (int) { return blockSize; });
+        return output;
+    }
+}
+
+int main()
+{
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    AudioBuffer<float> input (numChannels, static_cast<int> (10 * sampleRate));
+    ProcessorHarness::fillWithTestSignal (input, 7);
+
+    // with a single core there are no workers, and both runs take the same path
+    std::printf ("%d cores\n", SystemStats::getNumCpus());
+
+    const auto sequential = process (input, false);
+    const auto parallel = process (input, true);
+
+    int numDifferent = 0;
+    float maxDifference = 0.0f;
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        for (int i = 0; i < input.getNumSamples(); ++i)
+        {
+            const float difference = std::abs (parallel.getSample (ch, i) - sequential.getSample (ch, i));
+            numDifferent += difference != 0.0f ? 1 : 0;
+            maxDifference = jmax (maxDifference, difference);
+        }
+    }
+
+    std::printf ("samples differing: %d, max difference %g\n", numDifferent, maxDifference);
+    expect (numDifferent == 0, "the channel groups on the worker pool give bit for bit the output of processing them one after the other");
+
+    return getExitCode();
+}
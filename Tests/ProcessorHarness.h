@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    ProcessorHarness.h
+
+    Drives TLimiterAudioProcessor outside a host, for the console harnesses.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include <chrono>
+#include <cstdio>
+
+/**
+ What a host would do around the processor: setting parameters and applying the updates they trigger right away, choosing the bus width, and timing processBlock. Only for the harnesses which are built with TLIMITER_JUCE_DIR; their main() has to create a ScopedJuceInitialiser_GUI first, the processor posts its updates to the message thread.
+ */
+namespace ProcessorHarness
+{
+    /** Sets a parameter to a value in its own range, e.g. 2 for the third choice, and applies whatever it triggers as the message thread would. */
+    inline void setParameter (TLimiterAudioProcessor& processor, const String& parameterID, const float value)
+    {
+        auto* parameter = processor.parameters.getParameter (parameterID);
+        jassert (parameter != nullptr);
+
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+        processor.handleUpdateNowIfNeeded();
+    }
+
+    /** Gives the processor a discrete bus of the given width and prepares it. */
+    inline bool prepare (TLimiterAudioProcessor& processor, const int numChannels, const double sampleRate, const int maximumBlockSize)
+    {
+        AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add (AudioChannelSet::discreteChannels (numChannels));
+        layout.outputBuses.add (AudioChannelSet::discreteChannels (numChannels));
+
+        if (! processor.setBusesLayout (layout))
+            return false;
+
+        processor.setRateAndBufferSizeDetails (sampleRate, maximumBlockSize);
+        processor.prepareToPlay (sampleRate, maximumBlockSize);
+        processor.handleUpdateNowIfNeeded();
+        return true;
+    }
+
+    /** Noise bursts with random levels up to +6 dBFS, so the limiter works all the time. The same for every seed. */
+    inline void fillWithTestSignal (AudioBuffer<float>& buffer, const int64 seed)
+    {
+        Random random (seed);
+        float level = 0.0f;
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            if (i % 4800 == 0)
+                level = Decibels::decibelsToGain (random.nextFloat() * 36.0f - 30.0f);
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                buffer.setSample (ch, i, level * (2.0f * random.nextFloat() - 1.0f));
+        }
+    }
+
+    /** The time processBlock took per call over a whole signal. */
+    struct Timing
+    {
+        double totalSeconds = 0.0;
+        double minimumSeconds = std::numeric_limits<double>::max();
+        double maximumSeconds = 0.0;
+        int numBlocks = 0;
+    };
+
+    /** Runs the signal through processBlock in place, in blocks of the sizes blockSizeFor(blockIndex) returns, and times every call. */
+    template <typename BlockSizeFunction>
+    Timing process (TLimiterAudioProcessor& processor, AudioBuffer<float>& signal, BlockSizeFunction&& blockSizeFor)
+    {
+        Timing timing;
+        MidiBuffer midi;
+
+        for (int start = 0; start < signal.getNumSamples();)
+        {
+            const int numSamples = jmin (blockSizeFor (timing.numBlocks), signal.getNumSamples() - start);
+            AudioBuffer<float> block (signal.getArrayOfWritePointers(), signal.getNumChannels(), start, numSamples);
+
+            const auto begin = std::chrono::steady_clock::now();
+            processor.processBlock (block, midi);
+            const double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now() - begin).count();
+
+            timing.totalSeconds += seconds;
+            timing.minimumSeconds = jmin (timing.minimumSeconds, seconds);
+            timing.maximumSeconds = jmax (timing.maximumSeconds, seconds);
+            ++timing.numBlocks;
+            start += numSamples;
+        }
+
+        return timing;
+    }
+}
@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    QualityGovernorTest.cpp
+
+    Feeds the governor simulated callback loads and checks when it steps down and up again.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "QualityGovernor.h"
+#include <functional>
+#include <vector>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr double budget = blockSize / sampleRate;
+
+    struct Change
+    {
+        double time;
+        int tier;
+    };
+
+    /** Runs the governor for the given time; loadOfBlock returns the share of the budget a block takes, given its index, time and the current tier. */
+    std::vector<Change> simulate (const double seconds, const std::function<double (int, double, int)>& loadOfBlock)
+    {
+        QualityGovernor governor;
+        std::vector<Change> changes;
+        int tier = 0;
+
+        for (int block = 0; block * budget < seconds; ++block)
+        {
+            const double time = block * budget;
+            const int newTier = governor.update (loadOfBlock (block, time, tier) * budget, blockSize, sampleRate);
+
+            if (newTier != tier)
+            {
+                std::printf ("  %.2f s: tier %d -> %d, load %.2f\n", time, tier, newTier, governor.getLoad());
+                changes.push_back ({ time, newTier });
+                tier = newTier;
+            }
+        }
+
+        return changes;
+    }
+
+    /** 70 % of the budget at full quality from 2 s to 10 s, 40 % in tier 1, 25 % in tier 2, and 10 % before and after. Tier 1 is inside the hysteresis band, so the governor stays there, and steps up once the load has decayed below 20 %. */
+    void testSustainedLoad()
+    {
+        std::printf ("sustained load:\n");
+        const auto changes = simulate (20.0, [] (int, double time, int tier)
+        {
+            if (time < 2.0 || time >= 10.0)
+                return 0.1;
+
+            return tier == 0 ? 0.7 : (tier == 1 ? 0.4 : 0.25);
+        });
+
+        expect (changes.size() == 2, "the governor steps down once and up once");
+        if (changes.size() == 2)
+        {
+            expect (changes[0].tier == 1 && changes[0].time - 2.0 < 0.2, "a sustained load steps down within 0.2 s");
+            expect (changes[1].tier == 0 && changes[1].time > 10.0 && changes[1].time - 10.0 < 2.0, "the governor steps up within 2 s of the load dropping");
+        }
+    }
+
+    /** A load no tier can bring down walks through all tiers and stays at the last one. */
+    void testOverload()
+    {
+        std::printf ("overload:\n");
+        const auto changes = simulate (10.0, [] (int, double, int) { return 0.9; });
+
+        expect (changes.size() == 2 && changes.back().tier == QualityGovernor::numTiers - 1, "an overload ends up in the lowest tier, without oscillating");
+    }
+
+    /** Single callbacks overrunning the budget: rare ones don't change anything, frequent ones step down within a second. */
+    void testSpikes()
+    {
+        std::printf ("a 3x overrun every 100 blocks:\n");
+        const auto rare = simulate (10.0, [] (int block, double, int) { return block % 100 == 0 ? 3.0 : 0.1; });
+        expect (rare.empty(), "rare overruns don't step down");
+
+        std::printf ("a 3x overrun every 10 blocks:\n");
+        const auto frequent = simulate (10.0, [] (int block, double, int) { return block % 10 == 0 ? 3.0 : 0.1; });
+        expect (! frequent.empty() && frequent.front().time < 1.0, "frequent overruns step down within a second");
+    }
+}
+
+int main()
+{
+    testSustainedLoad();
+    testOverload();
+    testSpikes();
+
+    return getExitCode();
+}
@@ -0,0 +1,318 @@
+/*
+  ==============================================================================
+
+    ReferenceKernels.cpp
+
+  ==============================================================================
+*/
+
+#include "ReferenceKernels.h"
+#include <cmath>
+#include <algorithm>
+
+namespace ReferenceKernels
+{
+
+//==============================================================================
+void GainReductionComputer::prepare (const double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    alphaAttack = 1.0f - timeToGain (attackTime);
+    alphaRelease = 1.0f - timeToGain (releaseTime);
+}
+
+void GainReductionComputer::setAttackTime (const float attackTimeInSeconds)
+{
+    attackTime = attackTimeInSeconds;
+    alphaAttack = 1.0f - timeToGain (attackTime);
+}
+
+void GainReductionComputer::setReleaseTime (const float releaseTimeInSeconds)
+{
+    releaseTime = releaseTimeInSeconds;
+    alphaRelease = 1.0f - timeToGain (releaseTime);
+}
+
+void GainReductionComputer::setKnee (const float kneeInDecibels)
+{
+    knee = kneeInDecibels;
+    kneeHalf = knee / 2.0f;
+}
+
+float GainReductionComputer::timeToGain (const float timeInSeconds) const
+{
+    return std::exp (-1.0f / (static_cast<float> (sampleRate) * timeInSeconds));
+}
+
+float GainReductionComputer::applyCharacteristicToOverShoot (const float overShootInDecibels) const
+{
+    if (overShootInDecibels <= -kneeHalf)
+        return 0.0f;
+    else if (overShootInDecibels > -kneeHalf && overShootInDecibels <= kneeHalf)
+        return 0.5f * slope * (overShootInDecibels + kneeHalf) * (overShootInDecibels + kneeHalf) / knee;
+    else
+        return slope * overShootInDecibels;
+}
+
+void GainReductionComputer::computeGainInDecibelsFromSidechainSignal (const float* sideChainSignal, float* destination, const int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float levelInDecibels = 20.0f * std::log10 (std::abs (sideChainSignal[i]));
+        const float gainReduction = applyCharacteristicToOverShoot (levelInDecibels - threshold);
+
+        const float diff = gainReduction - state;
+        if (diff < 0.0f)
+            state += alphaAttack * diff;
+        else
+            state += alphaRelease * diff;
+
+        destination[i] = state;
+    }
+}
+
+void GainReductionComputer::computeLinearGainFromSidechainSignal (const float* sideChainSignal, float* destination, const int numSamples)
+{
+    computeGainInDecibelsFromSidechainSignal (sideChainSignal, destination, numSamples);
+    for (int i = 0; i < numSamples; ++i)
+        destination[i] = std::pow (10.0f, 0.05f * (destination[i] + makeUpGain));
+}
+
+//==============================================================================
+void LookAheadGainReduction::setDelayTime (float delayTimeInSeconds)
+{
+    delay = delayTimeInSeconds <= 0.0f ? 0.0f : delayTimeInSeconds;
+
+    if (sampleRate != 0.0)
+        prepare (sampleRate, blockSize);
+}
+
+void LookAheadGainReduction::prepare (const double newSampleRate, const int newBlockSize)
+{
+    sampleRate = newSampleRate;
+    blockSize = newBlockSize;
+
+    delayInSamples = static_cast<int> (delay * sampleRate);
+
+    buffer.assign (blockSize + delayInSamples, 0.0f);
+    writePosition = 0;
+}
+
+void LookAheadGainReduction::pushSamples (const float* src, const int numSamples)
+{
+    int startIndex, blockSize1, blockSize2;
+    getRingPositions (writePosition, numSamples, startIndex, blockSize1, blockSize2);
+
+    for (int i = 0; i < blockSize1; ++i)
+        buffer[startIndex + i] = src[i];
+
+    for (int i = 0; i < blockSize2; ++i)
+        buffer[i] = src[blockSize1 + i];
+
+    writePosition += numSamples;
+    writePosition = writePosition % buffer.size();
+
+    lastPushedSamples = numSamples;
+}
+
+void LookAheadGainReduction::process()
+{
+    const int L = static_cast<int> (buffer.size());
+    float nextGainReductionValue = 0.0f;
+    float step = 0.0f;
+
+    int index = writePosition - 1;
+    if (index < 0)
+        index += L;
+
+    // all recently pushed samples
+    int size1, size2;
+    getProcessPositions (index, lastPushedSamples, size1, size2);
+
+    for (int run = 0; run < 2; ++run)
+    {
+        if (run == 1)
+        {
+            if (size2 <= 0)
+                break;
+            index = L - 1;
+        }
+
+        for (int i = 0; i < (run == 0 ? size1 : size2); ++i)
+        {
+            const float smpl = buffer[index];
+
+            if (smpl > nextGainReductionValue)
+            {
+                buffer[index] = nextGainReductionValue;
+                nextGainReductionValue += step;
+            }
+            else
+            {
+                step = - smpl / delayInSamples;
+                nextGainReductionValue = smpl + step;
+            }
+            --index;
+        }
+    }
+
+    if (index < 0)
+        index = L - 1;
+
+    // fade into the already processed samples, until the ramp meets them
+    getProcessPositions (index, delayInSamples, size1, size2);
+
+    for (int run = 0; run < 2; ++run)
+    {
+        if (run == 1)
+        {
+            if (size2 <= 0)
+                break;
+            index = L - 1;
+        }
+
+        for (int i = 0; i < (run == 0 ? size1 : size2); ++i)
+        {
+            const float smpl = buffer[index];
+
+            if (smpl > nextGainReductionValue)
+            {
+                buffer[index] = nextGainReductionValue;
+                nextGainReductionValue += step;
+            }
+            else
+                return;
+            --index;
+        }
+    }
+}
+
+void LookAheadGainReduction::readSamples (float* dest, const int numSamples)
+{
+    int startIndex, blockSize1, blockSize2;
+    getRingPositions (writePosition - lastPushedSamples - delayInSamples, numSamples, startIndex, blockSize1, blockSize2);
+
+    for (int i = 0; i < blockSize1; ++i)
+        dest[i] = buffer[startIndex + i];
+
+    for (int i = 0; i < blockSize2; ++i)
+        dest[blockSize1 + i] = buffer[i];
+}
+
+void LookAheadGainReduction::getProcessPositions (int startIndex, int numSamples, int& blockSize1, int& blockSize2) const
+{
+    if (numSamples <= 0)
+    {
+        blockSize1 = 0;
+        blockSize2 = 0;
+    }
+    else
+    {
+        blockSize1 = std::min (startIndex + 1, numSamples);
+        numSamples -= blockSize1;
+        blockSize2 = numSamples <= 0 ? 0 : numSamples;
+    }
+}
+
+void LookAheadGainReduction::getRingPositions (int position, int numSamples, int& startIndex, int& blockSize1, int& blockSize2) const
+{
+    const int L = static_cast<int> (buffer.size());
+
+    if (position < 0)
+        position = position + L;
+    position = position % L;
+
+    if (numSamples <= 0)
+    {
+        startIndex = 0;
+        blockSize1 = 0;
+        blockSize2 = 0;
+    }
+    else
+    {
+        startIndex = position;
+        blockSize1 = std::min (L - position, numSamples);
+        numSamples -= blockSize1;
+        blockSize2 = numSamples <= 0 ? 0 : numSamples;
+    }
+}
+
+//==============================================================================
+void Delay::setDelayTime (float delayTimeInSeconds)
+{
+    bypassed = delayTimeInSeconds <= 0.0f;
+    delay = bypassed ? 0.0f : delayTimeInSeconds;
+
+    prepare (sampleRate, maximumBlockSize, numChannels);
+}
+
+void Delay::prepare (const double newSampleRate, const int newMaximumBlockSize, const int newNumChannels)
+{
+    sampleRate = newSampleRate;
+    maximumBlockSize = newMaximumBlockSize;
+    numChannels = newNumChannels;
+
+    delayInSamples = static_cast<int> (delay * sampleRate);
+    bufferLength = maximumBlockSize + delayInSamples;
+
+    buffer.assign (numChannels, std::vector<float> (bufferLength, 0.0f));
+    writePosition = 0;
+}
+
+void Delay::process (float* const* channels, const int nChannels, const int numSamples)
+{
+    if (bypassed || bufferLength == 0)
+        return;
+
+    const int nCh = std::min (numChannels, nChannels);
+    int startIndex, blockSize1, blockSize2;
+
+    // write in delay line
+    getReadWritePositions (false, numSamples, startIndex, blockSize1, blockSize2);
+
+    for (int ch = 0; ch < nCh; ++ch)
+    {
+        std::copy (channels[ch], channels[ch] + blockSize1, buffer[ch].begin() + startIndex);
+        std::copy (channels[ch] + blockSize1, channels[ch] + blockSize1 + blockSize2, buffer[ch].begin());
+    }
+
+    // read from delay line
+    getReadWritePositions (true, numSamples, startIndex, blockSize1, blockSize2);
+
+    for (int ch = 0; ch < nCh; ++ch)
+    {
+        std::copy (buffer[ch].begin() + startIndex, buffer[ch].begin() + startIndex + blockSize1, channels[ch]);
+        std::copy (buffer[ch].begin(), buffer[ch].begin() + blockSize2, channels[ch] + blockSize1);
+    }
+
+    writePosition += numSamples;
+    writePosition = writePosition % bufferLength;
+}
+
+void Delay::getReadWritePositions (bool read, int numSamples, int& startIndex, int& blockSize1, int& blockSize2) const
+{
+    const int L = bufferLength;
+    int pos = writePosition;
+    if (read)
+        pos = writePosition - delayInSamples;
+    if (pos < 0)
+        pos = pos + L;
+    pos = pos % L;
+
+    if (numSamples <= 0)
+    {
+        startIndex = 0;
+        blockSize1 = 0;
+        blockSize2 = 0;
+    }
+    else
+    {
+        startIndex = pos;
+        blockSize1 = std::min (L - pos, numSamples);
+        numSamples -= blockSize1;
+        blockSize2 = numSamples <= 0 ? 0 : numSamples;
+    }
+}
+
+} // namespace ReferenceKernels
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    ReferenceKernels.h
+
+    Frozen scalar copies of the limiter's DSP kernels, used as golden
+    references when verifying optimized or approximate rewrites.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+
+/**
+ The scalar implementations of GainReductionComputer, LookAheadGainReduction and Delay as they were before any optimization work started. Do NOT optimize or otherwise change the code in here: its only purpose is to define what the correct output of the production kernels is, see KernelVerifier.
+ */
+namespace ReferenceKernels
+{
+
+/** Reference for GainReductionComputer::computeGainInDecibelsFromSidechainSignal and computeLinearGainFromSidechainSignal. */
+class GainReductionComputer
+{
+public:
+    GainReductionComputer() {}
+
+    void setAttackTime (const float attackTimeInSeconds);
+    void setReleaseTime (const float releaseTimeInSeconds);
+    void setKnee (const float kneeInDecibels);
+    void setThreshold (const float thresholdInDecibels) { threshold = thresholdInDecibels; }
+    void setMakeUpGain (const float makeUpGainInDecibels) { makeUpGain = makeUpGainInDecibels; }
+    void setRatio (const float ratio) { slope = 1.0f / ratio - 1.0f; }
+
+    void prepare (const double sampleRate);
+    void reset() { state = 0.0f; }
+
+    void computeGainInDecibelsFromSidechainSignal (const float* sideChainSignal, float* destination, const int numSamples);
+    void computeLinearGainFromSidechainSignal (const float* sideChainSignal, float* destination, const int numSamples);
+
+private:
+    float timeToGain (const float timeInSeconds) const;
+    float applyCharacteristicToOverShoot (const float overShootInDecibels) const;
+
+    double sampleRate = 0.0;
+    float knee = 0.0f, kneeHalf = 0.0f;
+    float threshold = -10.0f;
+    float attackTime = 0.01f;
+    float releaseTime = 0.15f;
+    float slope = -0.5f;
+    float makeUpGain = 0.0f;
+    float state = 0.0f;
+    float alphaAttack = 0.0f;
+    float alphaRelease = 0.0f;
+};
+
+/** Reference for LookAheadGainReduction with its linear decibel fade-in. */
+class LookAheadGainReduction
+{
+public:
+    LookAheadGainReduction() {}
+
+    void setDelayTime (float delayTimeInSeconds);
+    int getDelayInSamples() const { return delayInSamples; }
+
+    void prepare (const double sampleRate, const int blockSize);
+    void pushSamples (const float* src, const int numSamples);
+    void process();
+    void readSamples (float* dest, const int numSamples);
+
+private:
+    void getProcessPositions (int startIndex, int numSamples, int& blockSize1, int& blockSize2) const;
+    void getRingPositions (int position, int numSamples, int& startIndex, int& blockSize1, int& blockSize2) const;
+
+    double sampleRate = 0.0;
+    int blockSize = 0;
+    float delay = 0.0f;
+    int delayInSamples = 0;
+    int writePosition = 0;
+    int lastPushedSamples = 0;
+    std::vector<float> buffer;
+};
+
+/** Reference for the multi-channel Delay from ThirdParty/Delay.h, without the JUCE dependencies. */
+class Delay
+{
+public:
+    Delay() {}
+
+    void setDelayTime (float delayTimeInSeconds);
+    int getDelayInSamples() const { return bypassed ? 0 : delayInSamples; }
+
+    void prepare (const double sampleRate, const int maximumBlockSize, const int numChannels);
+
+    /** Delays the given channels in place. */
+    void process (float* const* channels, const int numChannels, const int numSamples);
+
+private:
+    void getReadWritePositions (bool read, int numSamples, int& startIndex, int& blockSize1, int& blockSize2) const;
+
+    double sampleRate = 0.0;
+    int maximumBlockSize = 0;
+    int numChannels = 0;
+    float delay = 0.0f;
+    int delayInSamples = 0;
+    bool bypassed = true;
+    int writePosition = 0;
+    int bufferLength = 0;
+    std::vector<std::vector<float>> buffer;
+};
+
+} // namespace ReferenceKernels
@@ -0,0 +1,167 @@
+/*
+  ==============================================================================
+
+    RenderStatisticsTest.cpp
+
+    Checks the peaks and overs of the render statistics against signals with known values, and the JSON report.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "RenderStatistics.h"
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr double pi = 3.14159265358979323846;
+
+    /** Feeds the channels in blocks of the given size, with a gain reduction of gainReductionInDecibels, and flushes at the end. */
+    void feed (RenderStatistics& statistics, const std::vector<std::vector<float>>& channels, const int blockSize, const float gainReductionInDecibels = 0.0f)
+    {
+        const int numSamples = static_cast<int> (channels[0].size());
+        const std::vector<float> gainReduction (static_cast<size_t> (blockSize), gainReductionInDecibels);
+
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            const int numInBlock = std::min (blockSize, numSamples - start);
+
+            for (size_t ch = 0; ch < channels.size(); ++ch)
+            {
+                statistics.addKeySignal (channels[ch].data() + start, numInBlock);
+                statistics.addOutput (channels[ch].data() + start, numInBlock, static_cast<int> (ch));
+            }
+
+            statistics.addGainReduction (gainReduction.data(), numInBlock);
+            statistics.endBlock (numInBlock);
+        }
+
+        statistics.flush();
+    }
+
+    /**
+     A 0.5 FS sine at a quarter of the sample rate with a phase of 45 degrees: every sample lands at 0.5 * sin (45°), -9.03 dBFS, between the crests at -6.02 dBFS. The interpolator reads -6.09 dBTP, close to the true value and far from the sample peak.
+     */
+    void testSineTruePeak()
+    {
+        std::vector<std::vector<float>> channels (1, std::vector<float> (static_cast<size_t> (sampleRate)));
+        for (size_t n = 0; n < channels[0].size(); ++n)
+            channels[0][n] = static_cast<float> (0.5 * std::sin (0.5 * pi * static_cast<double> (n) + 0.25 * pi));
+
+        RenderStatistics statistics;
+        statistics.prepare (sampleRate, 1, 64);
+        feed (statistics, channels, 64);
+
+        std::printf ("sine at fs/4: sample peak %.2f dBFS, true peak %.2f dBTP\n", statistics.getSamplePeakInDecibels(), statistics.getTruePeakInDecibels());
+        expect (std::abs (statistics.getSamplePeakInDecibels() - -9.03f) < 0.01f, "the sample peak of the sine is -9.03 dBFS");
+        expect (std::abs (statistics.getTruePeakInDecibels() - -6.09f) < 0.01f, "the interpolator reads the sine as -6.09 dBTP");
+        expect (std::abs (statistics.getTruePeakInDecibels() - -6.02f) < 0.1f, "the true peak is within 0.1 dB of the sine's crest");
+        expect (statistics.getNumSampleOvers() == 0 && statistics.getNumTruePeakOvers() == 0, "a sine at -6 dBTP has no overs");
+    }
+
+    /** Samples at exactly full scale count as overs, for the sample peak and for the true peak alike. */
+    void testOvers()
+    {
+        std::vector<std::vector<float>> channels (2, std::vector<float> (4800, 0.25f));
+        for (size_t n = 100; n < channels[0].size(); n += 500)
+        {
+            channels[0][n] = 1.0f;
+            channels[1][n + 1] = -1.0f;
+        }
+        channels[1][3000] = 0.999f;
+
+        RenderStatistics statistics;
+        statistics.prepare (sampleRate, 2, 64);
+        feed (statistics, channels, 64);
+
+        std::printf ("overs: %lld sample, %lld true peak\n", static_cast<long long> (statistics.getNumSampleOvers()), static_cast<long long> (statistics.getNumTruePeakOvers()));
+        expect (statistics.getNumSampleOvers() == 20, "samples at full scale count as sample overs, below don't");
+        expect (statistics.getNumTruePeakOvers() >= statistics.getNumSampleOvers(), "every sample over is a true-peak over");
+        expect (statistics.getSamplePeakInDecibels() == 0.0f, "the sample peak is full scale");
+    }
+
+    /** The figures don't depend on the block size, nor on how the blocks fall into the batches. */
+    void testBlockSizes()
+    {
+        std::vector<std::vector<float>> channels (2, std::vector<float> (3 * static_cast<size_t> (sampleRate)));
+        for (size_t n = 0; n < channels[0].size(); ++n)
+        {
+            channels[0][n] = static_cast<float> (0.9 * std::sin (0.031 * static_cast<double> (n)) * std::sin (0.00007 * static_cast<double> (n)));
+            channels[1][n] = static_cast<float> (0.7 * std::sin (0.17 * static_cast<double> (n)));
+        }
+
+        RenderStatistics inBlocksOf64, inBlocksOf61;
+        inBlocksOf64.prepare (sampleRate, 2, 64);
+        inBlocksOf61.prepare (sampleRate, 2, 64);
+        feed (inBlocksOf64, channels, 64, -1.0f);
+        feed (inBlocksOf61, channels, 61, -1.0f);
+
+        expect (inBlocksOf64.toJson() == inBlocksOf61.toJson(), "the report is the same in blocks of 64 and 61");
+    }
+
+    /** The report of a known render, and of silence, whose loudness doesn't exist. */
+    void testJson()
+    {
+        RenderStatistics statistics;
+        statistics.prepare (sampleRate, 2, 64);
+        statistics.setThreshold (-12.0f);
+
+        const std::vector<std::vector<float>> silence (2, std::vector<float> (static_cast<size_t> (sampleRate), 0.0f));
+        feed (statistics, silence, 64);
+
+        const std::string silent = statistics.toJson();
+        std::printf ("%s\n", silent.c_str());
+        expect (silent.front() == '{' && silent.back() == '}' && silent.find ('\n') == std::string::npos, "the report is a single JSON object on one line");
+        expect (silent.find ("\"duration\":1.000,\"sampleRate\":48000.000,\"channels\":2,") != std::string::npos, "the report starts with duration, sample rate and channels");
+        expect (silent.find ("\"samplePeak\":null,\"truePeak\":null,") != std::string::npos, "the peaks of silence are null");
+        expect (silent.find ("\"integratedLoudness\":null,\"peakToLoudnessRatio\":null,") != std::string::npos, "the loudness of silence is null");
+        expect (silent.find ("inf") == std::string::npos && silent.find ("nan") == std::string::npos, "the report has no infinities or NaNs");
+
+        // one second of a sine 6 dB over the threshold, reduced by 6 dB
+        statistics.reset();
+        std::vector<std::vector<float>> loud (2, std::vector<float> (static_cast<size_t> (sampleRate)));
+        for (auto& channel : loud)
+            for (size_t n = 0; n < channel.size(); ++n)
+                channel[n] = static_cast<float> (0.5 * std::sin (2.0 * pi * 997.0 * static_cast<double> (n) / sampleRate));
+        feed (statistics, loud, 64, -6.0f);
+
+        const std::string report = statistics.toJson();
+        std::printf ("%s\n", report.c_str());
+        expect (report.find ("\"maxGainReduction\":-6.000,\"meanGainReduction\":-6.000,") != std::string::npos, "the gain reduction is reported");
+        expect (report.find ("\"longestLimitingRun\":{\"start\":0.000,\"length\":1.000}") != std::string::npos, "the limiting run covers the whole render");
+        expect (report.find ("\"counts\":[0,0,0,0,0,0,0,0,0,0,0,0,48000,0,") != std::string::npos, "every sample lands in the 6 dB bin of the histogram");
+        expect (report.find ("\"integratedLoudness\":null") == std::string::npos, "a sine has a loudness");
+
+        // the same sine as output only, as a renderer sees it which can't reach the detector
+        statistics.reset();
+        for (int start = 0; start < static_cast<int> (sampleRate); start += 64)
+        {
+            for (size_t ch = 0; ch < loud.size(); ++ch)
+                statistics.addOutput (loud[ch].data() + start, 64, static_cast<int> (ch));
+            statistics.endBlock (64);
+        }
+        statistics.flush();
+
+        const std::string outputOnly = statistics.toJson();
+        std::printf ("%s\n", outputOnly.c_str());
+        expect (outputOnly.find ("\"timeAboveThreshold\":null,\"maxGainReduction\":null,\"meanGainReduction\":null,\"longestLimitingRun\":null,\"gainReductionHistogram\":null}") != std::string::npos,
+                "without the detector's signals, its figures are null");
+        expect (outputOnly.substr (0, outputOnly.find ("\"timeAboveThreshold\"")) == report.substr (0, report.find ("\"timeAboveThreshold\"")),
+                "the figures of the output are the same without the detector's signals");
+    }
+}
+
+int main()
+{
+    testSineTruePeak();
+    testOvers();
+    testBlockSizes();
+    testJson();
+
+    return getExitCode();
+}
@@ -0,0 +1,170 @@
+/*
+  ==============================================================================
+
+    RerenderTest.cpp
+
+    Renders a file with checkpoints, edits parts of it one after the other and re-renders only around each edit; every re-render has to be bit for bit the full render of the edited file, and processes only a fraction of it.
+
+  ==============================================================================
+*/
+
+#include "ProcessorHarness.h"
+#include "OfflineRenderer.h"
+#include "TestUtilities.h"
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+    constexpr int blockSize = 1024;
+    constexpr double lengthInSeconds = 60.0;
+
+    /** Settings which allow checkpoints and keep every stateful module busy: detector EQ, look-ahead, the second-order clipper and shaped dither. */
+    void setUp (TLimiterAudioProcessor& processor)
+    {
+        ProcessorHarness::setParameter (processor, "lookAhead", 1.0f);
+        ProcessorHarness::setParameter (processor, "attack", 1.0f);
+        ProcessorHarness::setParameter (processor, "threshold", -12.0f);
+        ProcessorHarness::setParameter (processor, "sideChainFilter", 1.0f);
+        ProcessorHarness::setParameter (processor, "clipper", 2.0f);
+        ProcessorHarness::setParameter (processor, "dither", 1.0f);
+        ProcessorHarness::setParameter (processor, "noiseShaping", 2.0f);
+    }
+
+    bool writeFile (const File& file, const AudioBuffer<float>& signal)
+    {
+        file.deleteFile();
+        std::unique_ptr<FileOutputStream> stream (file.createOutputStream());
+        if (stream == nullptr)
+            return false;
+
+        WavAudioFormat wavFormat;
+        std::unique_ptr<AudioFormatWriter> writer (wavFormat.createWriterFor (stream.get(), sampleRate, numChannels, 32, {}, 0));
+        if (writer == nullptr)
+            return false;
+
+        stream.release();
+        return writer->writeFromAudioSampleBuffer (signal, 0, signal.getNumSamples());
+    }
+
+    std::unique_ptr<AudioFormatReader> createReader (const File& file)
+    {
+        AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+        return std::unique_ptr<AudioFormatReader> (formatManager.createReaderFor (file));
+    }
+
+    std::unique_ptr<AudioFormatWriter> createWriter (const File& file)
+    {
+        file.deleteFile();
+        std::unique_ptr<FileOutputStream> stream (file.createOutputStream());
+        if (stream == nullptr)
+            return {};
+
+        WavAudioFormat wavFormat;
+        std::unique_ptr<AudioFormatWriter> writer (wavFormat.createWriterFor (stream.get(), sampleRate, numChannels, 32, {}, 0));
+        if (writer != nullptr)
+            stream.release();
+
+        return writer;
+    }
+
+    AudioBuffer<float> readFile (const File& file)
+    {
+        auto reader = createReader (file);
+        if (reader == nullptr)
+            return {};
+
+        AudioBuffer<float> signal (static_cast<int> (reader->numChannels), static_cast<int> (reader->lengthInSamples));
+        reader->read (&signal, 0, signal.getNumSamples(), 0, true, true);
+        return signal;
+    }
+
+    /** A full render of the file with a fresh processor. */
+    AudioBuffer<float> renderFully (const File& inputFile, const File& outputFile, double& seconds)
+    {
+        TLimiterAudioProcessor processor;
+        setUp (processor);
+
+        OfflineRenderer renderer (processor, blockSize);
+        expect (renderer.render (inputFile, outputFile).wasOk(), "the edited file is rendered");
+        seconds = renderer.getStatistics().totalSeconds;
+        return readFile (outputFile);
+    }
+}
+
+int main()
+{
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const auto directory = File::createTempFile ("RerenderTest");
+    directory.createDirectory();
+
+    AudioBuffer<float> input (numChannels, static_cast<int> (lengthInSeconds * sampleRate));
+    ProcessorHarness::fillWithTestSignal (input, 13);
+
+    const auto inputFile = directory.getChildFile ("input.wav");
+    auto outputFile = directory.getChildFile ("output.wav");
+    expect (writeFile (inputFile, input), "the input file is written");
+
+    TLimiterAudioProcessor processor;
+    setUp (processor);
+    OfflineRenderer renderer (processor, blockSize);
+    renderer.setCheckpointInterval (1.0);
+
+    expect (renderer.render (inputFile, outputFile).wasOk(), "the file is rendered with checkpoints");
+    std::printf ("full render: %.3f s, %d checkpoints\n", renderer.getStatistics().totalSeconds, renderer.getNumCheckpoints());
+    expect (renderer.getNumCheckpoints() >= static_cast<int> (lengthInSeconds), "a checkpoint about every second");
+
+    // edits which follow each other, overlapping a previous one, at the very start and at the very end
+    const double editTimes[] = { 20.0, 40.3, 20.5, 0.0, lengthInSeconds - 0.5 };
+
+    for (int edit = 0; edit < 5; ++edit)
+    {
+        const auto editStart = static_cast<int64> (editTimes[edit] * sampleRate);
+        const auto editEnd = jmin (static_cast<int64> (input.getNumSamples()), editStart + static_cast<int64> (0.5 * sampleRate));
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int64 i = editStart; i < editEnd; ++i)
+                input.setSample (ch, static_cast<int> (i), (ch == 0 ? 2.5f : -1.0f) * input.getSample (ch, static_cast<int> (i)));
+
+        const auto editedFile = directory.getChildFile ("edited" + String (edit) + ".wav");
+        expect (writeFile (editedFile, input), "the edited file is written");
+
+        // the re-render reads the edited input and the previous output, and writes a new one
+        const auto rerenderedFile = directory.getChildFile ("rerendered" + String (edit) + ".wav");
+        {
+            auto editedReader = createReader (editedFile);
+            auto previousReader = createReader (outputFile);
+            auto writer = createWriter (rerenderedFile);
+            expect (editedReader != nullptr && previousReader != nullptr && writer != nullptr, "the files are opened");
+
+            if (editedReader != nullptr && previousReader != nullptr && writer != nullptr)
+                expect (renderer.rerender (*editedReader, *previousReader, *writer, editStart, editEnd).wasOk(), "the edit is re-rendered");
+        }
+
+        const auto& statistics = renderer.getStatistics();
+        double fullSeconds = 0.0;
+        const auto expected = renderFully (editedFile, directory.getChildFile ("full" + String (edit) + ".wav"), fullSeconds);
+        const auto rerendered = readFile (rerenderedFile);
+
+        int numDifferent = rerendered.getNumSamples() == expected.getNumSamples() ? 0 : -1;
+        for (int ch = 0; ch < numChannels && numDifferent >= 0; ++ch)
+            for (int i = 0; i < expected.getNumSamples(); ++i)
+                if (rerendered.getSample (ch, i) != expected.getSample (ch, i))
+                    ++numDifferent;
+
+        std::printf ("edit at %5.1f s: processed %.1f%% of the file in %.3f s, full render %.3f s, samples differing %d\n", editTimes[edit],
+                     100.0 * statistics.numSamplesProcessed / input.getNumSamples(), statistics.totalSeconds, fullSeconds, numDifferent);
+
+        expect (numDifferent == 0, "the re-render is bit for bit the full render of the edited file");
+        expect (statistics.numSamplesProcessed < input.getNumSamples() / 4, "a re-render processes only a fraction of the file");
+
+        outputFile = rerenderedFile;
+    }
+
+    directory.deleteRecursively();
+    return getExitCode();
+}
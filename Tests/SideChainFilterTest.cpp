@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+    SideChainFilterTest.cpp
+
+    Checks the detector EQ's response, that all of its process functions agree, and that the limiter stays bit-identical for planar and interleaved buffers with it.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "SideChainFilter.h"
+#include "LimiterCore.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr double pi = 3.14159265358979323846;
+
+    /** The level of the filtered key for a full-scale sine, in dB, once the filter has settled. */
+    float getResponseInDecibels (const float frequency, const float highPassFrequency, const float tilt)
+    {
+        SideChainFilter filter;
+        filter.setEnabled (true);
+        filter.setHighPassFrequency (highPassFrequency);
+        filter.setTilt (tilt);
+        filter.prepare (sampleRate, 1);
+
+        const int numSamples = static_cast<int> (sampleRate);
+        std::vector<float> sine (static_cast<size_t> (numSamples)), key (static_cast<size_t> (numSamples));
+        for (int n = 0; n < numSamples; ++n)
+            sine[static_cast<size_t> (n)] = static_cast<float> (std::sin (2.0 * pi * frequency * n / sampleRate));
+
+        const float* channels[] = { sine.data() };
+        filter.processMaxAbs (channels, 1, key.data(), numSamples);
+
+        return 20.0f * std::log10 (*std::max_element (key.begin() + numSamples / 2, key.end()));
+    }
+
+    void testResponse()
+    {
+        const float atCutoff = getResponseInDecibels (80.0f, 80.0f, 0.0f);
+        const float octaveBelow = getResponseInDecibels (40.0f, 80.0f, 0.0f);
+        const float passband = getResponseInDecibels (1000.0f, 80.0f, 0.0f);
+        std::printf ("high-pass 80 Hz: %.2f dB at 40 Hz, %.2f dB at 80 Hz, %.2f dB at 1 kHz\n", octaveBelow, atCutoff, passband);
+        expect (std::abs (atCutoff - -3.01f) < 0.1f, "the Butterworth high-pass is 3 dB down at its cutoff");
+        expect (std::abs (octaveBelow - -12.3f) < 0.2f, "it falls by 12 dB per octave below");
+        expect (std::abs (passband) < 0.05f, "it passes 1 kHz");
+
+        const float lows = getResponseInDecibels (100.0f, 20.0f, 6.0f);
+        const float pivot = getResponseInDecibels (1000.0f, 20.0f, 6.0f);
+        const float highs = getResponseInDecibels (15000.0f, 20.0f, 6.0f);
+        std::printf ("tilt +6 dB: %.2f dB at 100 Hz, %.2f dB at 1 kHz, %.2f dB at 15 kHz\n", lows, pivot, highs);
+        expect (std::abs (pivot) < 0.1f, "the tilt pivots around 1 kHz");
+        expect (std::abs (lows - -3.0f) < 0.3f && std::abs (highs - 3.0f) < 0.3f, "the tilt takes half of its gain off the lows and adds half to the highs");
+    }
+
+    /** processMaxAbs(), processAbs() and processAbsOfChannels() for groups of four channels give the same keys, for planar and strided input. */
+    void testProcessFunctionsAgree()
+    {
+        constexpr int numChannels = 6;
+        constexpr int numSamples = 4096;
+
+        std::mt19937 random (7);
+        std::normal_distribution<float> noise (0.0f, 0.3f);
+        std::vector<float> interleaved (static_cast<size_t> (numChannels * numSamples));
+        std::vector<std::vector<float>> planar (numChannels, std::vector<float> (numSamples));
+        for (int n = 0; n < numSamples; ++n)
+            for (int ch = 0; ch < numChannels; ++ch)
+                planar[static_cast<size_t> (ch)][static_cast<size_t> (n)] = interleaved[static_cast<size_t> (n * numChannels + ch)] = noise (random);
+
+        auto makeFilter = []
+        {
+            auto filter = std::make_unique<SideChainFilter>();
+            filter->setEnabled (true);
+            filter->setHighPassFrequency (120.0f);
+            filter->setTilt (3.0f);
+            filter->prepare (sampleRate, numChannels);
+            return filter;
+        };
+
+        const float* planarChannels[numChannels];
+        const float* interleavedChannels[numChannels];
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            planarChannels[ch] = planar[static_cast<size_t> (ch)].data();
+            interleavedChannels[ch] = interleaved.data() + ch;
+        }
+
+        std::vector<std::vector<float>> keys (3 * numChannels, std::vector<float> (numSamples));
+        float* perChannel[numChannels];
+        float* strided[numChannels];
+        float* grouped[numChannels];
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            perChannel[ch] = keys[static_cast<size_t> (ch)].data();
+            strided[ch] = keys[static_cast<size_t> (numChannels + ch)].data();
+            grouped[ch] = keys[static_cast<size_t> (2 * numChannels + ch)].data();
+        }
+
+        std::vector<float> maxKey (numSamples);
+        makeFilter()->processMaxAbs (planarChannels, numChannels, maxKey.data(), numSamples);
+        makeFilter()->processAbs (planarChannels, perChannel, numChannels, numSamples);
+        makeFilter()->processAbs (interleavedChannels, strided, numChannels, numSamples, numChannels);
+
+        auto groupFilter = makeFilter();
+        groupFilter->updateCoefficients();
+        for (int first = 0; first < numChannels; first += MultiChannelBiquad::lanes)
+            groupFilter->processAbsOfChannels (planarChannels, grouped, first, std::min (MultiChannelBiquad::lanes, numChannels - first), numSamples);
+
+        bool sameKeys = true, sameMaximum = true;
+        for (int n = 0; n < numSamples; ++n)
+        {
+            float maximum = 0.0f;
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const float value = perChannel[ch][n];
+                sameKeys = sameKeys && strided[ch][n] == value && grouped[ch][n] == value;
+                maximum = std::max (maximum, value);
+            }
+            sameMaximum = sameMaximum && maxKey[static_cast<size_t> (n)] == maximum;
+        }
+
+        expect (sameKeys, "per-channel keys are the same for planar, strided and grouped processing");
+        expect (sameMaximum, "the linked key is the maximum of the per-channel keys");
+    }
+
+    /** The whole limiter with the detector EQ on, in odd host block sizes: planar and interleaved output are bit-identical, linked and unlinked. */
+    void testPlanarInterleaved()
+    {
+        constexpr int numChannels = 3;
+        constexpr int numSamples = 100000;
+
+        for (const bool link : { true, false })
+        {
+            LimiterCore planarCore, interleavedCore;
+            for (auto* core : { &planarCore, &interleavedCore })
+            {
+                core->setThreshold (-20.0f);
+                core->setLookAhead (true);
+                core->setChannelLink (link);
+                core->getSideChainFilter().setEnabled (true);
+                core->getSideChainFilter().setHighPassFrequency (100.0f);
+                core->getSideChainFilter().setTilt (2.0f);
+                core->prepare (sampleRate, numChannels);
+            }
+
+            std::mt19937 random (1);
+            std::normal_distribution<float> noise (0.0f, 0.3f);
+            std::vector<std::vector<float>> planar (numChannels, std::vector<float> (numSamples));
+            std::vector<float> interleaved (static_cast<size_t> (numChannels * numSamples));
+            for (int n = 0; n < numSamples; ++n)
+                for (int ch = 0; ch < numChannels; ++ch)
+                    planar[static_cast<size_t> (ch)][static_cast<size_t> (n)] = interleaved[static_cast<size_t> (n * numChannels + ch)] = noise (random);
+
+            for (int start = 0; start < numSamples; start += 300)
+            {
+                const int numInBlock = std::min (300, numSamples - start);
+                float* channels[] = { planar[0].data() + start, planar[1].data() + start, planar[2].data() + start };
+                planarCore.processPlanar (channels, numInBlock);
+                interleavedCore.processInterleaved (interleaved.data() + start * numChannels, numInBlock);
+            }
+
+            int numDifferences = 0;
+            for (int n = 0; n < numSamples; ++n)
+                for (int ch = 0; ch < numChannels; ++ch)
+                    numDifferences += planar[static_cast<size_t> (ch)][static_cast<size_t> (n)] != interleaved[static_cast<size_t> (n * numChannels + ch)] ? 1 : 0;
+
+            std::printf ("%s: %d samples differ between planar and interleaved\n", link ? "linked" : "unlinked", numDifferences);
+            expect (numDifferences == 0, "planar and interleaved output are bit-identical with the detector EQ");
+        }
+    }
+}
+
+int main()
+{
+    testResponse();
+    testProcessFunctionsAgree();
+    testPlanarInterleaved();
+
+    return getExitCode();
+}
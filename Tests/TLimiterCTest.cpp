@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    TLimiterCTest.cpp
+
+    Checks that the C interface refuses what it can't process and clamps what it can.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "TLimiterC.h"
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr int numChannels = 2;
+    constexpr int numSamples = 4096;
+
+    /** Fills both channels with a 0 dBFS sine. */
+    void fillSine (std::vector<float>& left, std::vector<float>& right)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            left[static_cast<size_t> (i)] = right[static_cast<size_t> (i)] = std::sin (0.05f * static_cast<float> (i));
+    }
+
+    /** Before the first successful prepare, processing is refused and the buffers are left as they were. */
+    void testProcessBeforePrepare()
+    {
+        auto* limiter = tlimiter_create();
+        std::vector<float> left (numSamples), right (numSamples), frames (numChannels * numSamples, 0.5f);
+        fillSine (left, right);
+        float* channels[] = { left.data(), right.data() };
+
+        expect (tlimiter_process_planar (limiter, channels, numSamples) == -1, "planar processing before prepare is refused");
+        expect (tlimiter_process_interleaved (limiter, frames.data(), numSamples) == -1, "interleaved processing before prepare is refused");
+        expect (left[10] == std::sin (0.5f) && frames[10] == 0.5f, "refused processing leaves the buffers untouched");
+        expect (tlimiter_process_planar (nullptr, channels, numSamples) == -1, "a null limiter is refused");
+
+        expect (tlimiter_prepare (limiter, 48000.0, numChannels) == 0, "prepare succeeds");
+        expect (tlimiter_process_planar (limiter, nullptr, numSamples) == -1, "null channels are refused");
+        expect (tlimiter_process_planar (limiter, channels, -1) == -1, "a negative length is refused");
+        expect (tlimiter_process_planar (limiter, channels, numSamples) == 0, "planar processing after prepare succeeds");
+        expect (tlimiter_process_interleaved (limiter, frames.data(), numSamples) == 0, "interleaved processing after prepare succeeds");
+
+        tlimiter_destroy (limiter);
+    }
+
+    /** Word lengths other than 0, 16 and 24, unsupported decimation factors, negative or infinite times and NaNs are rejected; choices out of range are clamped into it and still process. */
+    void testParameterValues()
+    {
+        auto* limiter = tlimiter_create();
+        tlimiter_prepare (limiter, 48000.0, numChannels);
+
+        expect (tlimiter_set_parameter (limiter, TLIMITER_DITHER, 0.0f) == 0, "dither off is accepted");
+        expect (tlimiter_set_parameter (limiter, TLIMITER_DITHER, 16.0f) == 0, "16 bit dither is accepted");
+        expect (tlimiter_set_parameter (limiter, TLIMITER_DITHER, 24.0f) == 0, "24 bit dither is accepted");
+        expect (tlimiter_set_parameter (limiter, TLIMITER_DITHER, 20.0f) == -1, "20 bit dither is rejected");
+        expect (tlimiter_set_parameter (limiter, TLIMITER_DITHER, 32.0f) == -1, "32 bit dither is rejected");
+        expect (tlimiter_set_parameter (limiter, TLIMITER_THRESHOLD, std::numeric_limits<float>::quiet_NaN()) == -1, "a NaN is rejected");
+
+        constexpr float infinity = std::numeric_limits<float>::infinity();
+
+        for (const float factor : { 1.0f, 4.0f, 8.0f, 16.0f })
+            expect (tlimiter_set_parameter (limiter, TLIMITER_DECIMATION_FACTOR, factor) == 0, "a supported decimation factor is accepted");
+
+        for (const float factor : { 0.0f, 3.0f, 4.5f, 32.0f, -4.0f, 1.0e30f, infinity, std::numeric_limits<float>::quiet_NaN() })
+            expect (tlimiter_set_parameter (limiter, TLIMITER_DECIMATION_FACTOR, factor) == -1, "an unsupported decimation factor is rejected");
+
+        for (const auto parameter : { TLIMITER_ATTACK, TLIMITER_RELEASE })
+        {
+            expect (tlimiter_set_parameter (limiter, parameter, 0.0f) == 0 && tlimiter_set_parameter (limiter, parameter, 100.0f) == 0, "a time of 0 ms or more is accepted");
+
+            for (const float time : { -1.0f, -infinity, infinity })
+                expect (tlimiter_set_parameter (limiter, parameter, time) == -1, "a negative or infinite time is rejected");
+        }
+
+        std::vector<float> left (numSamples), right (numSamples);
+        float* channels[] = { left.data(), right.data() };
+
+        for (const float fadeShape : { -3.0f, 7.0f, 1.0e9f, -std::numeric_limits<float>::infinity() })
+        {
+            expect (tlimiter_set_parameter (limiter, TLIMITER_FADE_SHAPE, fadeShape) == 0, "a fade shape out of range is clamped");
+            expect (tlimiter_set_parameter (limiter, TLIMITER_CLIPPER, fadeShape) == 0, "a clipper order out of range is clamped");
+            expect (tlimiter_set_parameter (limiter, TLIMITER_NOISE_SHAPING, fadeShape) == 0, "a noise shaping choice out of range is clamped");
+
+            fillSine (left, right);
+            tlimiter_process_planar (limiter, channels, numSamples);
+
+            bool allFinite = true;
+            for (const float sample : left)
+                allFinite = allFinite && std::isfinite (sample);
+            expect (allFinite, "clamped choices process a finite output");
+        }
+
+        tlimiter_destroy (limiter);
+    }
+}
+
+int main()
+{
+    testProcessBeforePrepare();
+    testParameterValues();
+
+    return getExitCode();
+}
@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    TestUtilities.h
+
+    The few helpers the test executables share.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "KernelVerifier.h"
+#include <cstdio>
+
+/**
+ Every test is a plain executable: it checks with expect(), prints what failed, and returns getExitCode() from main, so CTest sees a failure as a non-zero exit code.
+ */
+namespace TestUtilities
+{
+    inline int& getNumFailures()
+    {
+        static int numFailures = 0;
+        return numFailures;
+    }
+
+    inline bool expect (const bool condition, const char* description)
+    {
+        if (! condition)
+        {
+            std::printf ("FAILED: %s\n", description);
+            ++getNumFailures();
+        }
+
+        return condition;
+    }
+
+    /** Prints a verifier report and fails if it didn't pass its budget. */
+    inline bool expect (const KernelVerifier::Report& report, const char* description)
+    {
+        std::printf ("%-40s %-11s %7d blocks  max abs %.3g  max dB %.3g  %.1f -> %.1f ns/sample\n",
+                     description, report.signalName.c_str(), report.numBlocks, report.maxAbsError, report.maxDecibelError,
+                     report.referenceNanosecondsPerSample, report.candidateNanosecondsPerSample);
+
+        return expect (report.passed, description);
+    }
+
+    inline int getExitCode()
+    {
+        if (getNumFailures() == 0)
+            std::printf ("All checks passed.\n");
+        else
+            std::printf ("%d checks failed.\n", getNumFailures());
+
+        return getNumFailures() == 0 ? 0 : 1;
+    }
+}
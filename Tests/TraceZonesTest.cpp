@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    TraceZonesTest.cpp
+
+    Records zones from many threads while the trace is written.
+
+  ==============================================================================
+*/
+
+#define TLIMITER_ENABLE_TRACING 1
+
+#include "TestUtilities.h"
+#include "TraceZones.h"
+#include <thread>
+#include <sstream>
+#include <string>
+
+using namespace TestUtilities;
+
+namespace
+{
+    int countEvents (const std::string& trace, const std::string& name)
+    {
+        int count = 0;
+        for (auto position = trace.find (name); position != std::string::npos; position = trace.find (name, position + 1))
+            ++count;
+        return count;
+    }
+
+    std::string writeTrace()
+    {
+        std::ostringstream stream;
+        TraceRecorder::getInstance().writeChromeTrace (stream);
+        return stream.str();
+    }
+}
+
+int main()
+{
+    TLIMITER_TRACE_PREPARE();
+
+    // threads which come and go hand their rings back, so many more of them than there are rings get recorded
+    for (int i = 0; i < 4 * TraceRecorder::maxNumThreads; ++i)
+        std::thread ([] { TLIMITER_TRACE_ZONE ("shortLivedThread"); }).join();
+
+    expect (countEvents (writeTrace(), "\"shortLivedThread\"") == 4 * TraceRecorder::maxNumThreads, "the rings of ended threads are reused and keep their events");
+
+    // more threads alive at once than there are rings: the ones without a ring just aren't recorded
+    {
+        std::atomic<bool> release { false };
+        std::vector<std::thread> threads;
+        for (int i = 0; i < TraceRecorder::maxNumThreads + 8; ++i)
+            threads.emplace_back ([&release]
+            {
+                TLIMITER_TRACE_ZONE ("crowdedThread");
+                while (! release.load())
+                    std::this_thread::yield();
+            });
+
+        release = true;
+        for (auto& thread : threads)
+            thread.join();
+
+        const int numRecorded = countEvents (writeTrace(), "\"crowdedThread\"");
+        expect (numRecorded >= TraceRecorder::maxNumThreads - 1 && numRecorded <= TraceRecorder::maxNumThreads + 8, "threads beyond the pool are dropped");
+    }
+
+    // a writer which laps its ring many times while traces are written
+    {
+        std::atomic<bool> stop { false };
+        std::thread writer ([&stop]
+        {
+            while (! stop.load())
+                TLIMITER_TRACE_ZONE ("busyThread");
+        });
+
+        bool allComplete = true;
+        for (int i = 0; i < 50; ++i)
+        {
+            const auto trace = writeTrace();
+            const int numEvents = countEvents (trace, "\"busyThread\"");
+            allComplete = allComplete && numEvents <= TraceRecorder::eventsPerThread && trace.rfind ("\n]}\n") == trace.size() - 4;
+        }
+
+        stop = true;
+        writer.join();
+        expect (allComplete, "a trace holds at most one ring of a busy thread and is complete JSON");
+    }
+
+    return getExitCode();
+}
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    TwoPassLimiterTest.cpp
+
+    Checks where the two-pass limiter's hold and fade-in put the reduction around an impulse, and that no peak of a long signal gets through.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "TwoPassLimiter.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr float threshold = -10.0f;
+
+    /** A brickwall with instant attack, which reduces every sample exactly to the threshold. */
+    void prepareBrickwall (TwoPassLimiter& limiter, const float fadeInTime, const float holdTime)
+    {
+        limiter.setThreshold (threshold);
+        limiter.setKnee (0.0f);
+        limiter.setRatio (std::numeric_limits<float>::infinity());
+        limiter.setAttackTime (0.0f);
+        limiter.setReleaseTime (0.1f);
+        limiter.setFadeInTime (fadeInTime);
+        limiter.setHoldTime (holdTime);
+    }
+
+    /** A single sample 10 dB over the threshold: the full reduction from the impulse on for the hold time, then the release; before it, the fade over the fade-in time. */
+    void testImpulse()
+    {
+        constexpr int impulsePosition = 20000;
+        constexpr int fadeInSamples = 480, holdSamples = 960;
+
+        TwoPassLimiter limiter;
+        prepareBrickwall (limiter, fadeInSamples / static_cast<float> (sampleRate), holdSamples / static_cast<float> (sampleRate));
+
+        std::vector<float> signal (48000, 0.0f);
+        signal[impulsePosition] = 1.0f;
+        const float* channels[] = { signal.data() };
+
+        expect (limiter.beginAnalysis (sampleRate, 1) && limiter.analyse (channels, static_cast<int> (signal.size())) && limiter.endAnalysis(), "the impulse is analysed");
+
+        const float* envelope = limiter.getEnvelope();
+        const float reduction = envelope[impulsePosition];
+        expect (std::abs (reduction - threshold) < 1.0e-4f, "the impulse is reduced to the threshold");
+
+        bool held = true;
+        for (int n = impulsePosition; n <= impulsePosition + holdSamples; ++n)
+            held = held && envelope[n] == reduction;
+
+        std::printf ("impulse at %d: reduction %.2f dB, held through %d, %.2f dB one sample later\n", impulsePosition, reduction, impulsePosition + holdSamples, envelope[impulsePosition + holdSamples + 1]);
+        expect (held, "the reduction is held for the hold time after the impulse");
+        expect (envelope[impulsePosition + holdSamples + 1] > reduction, "the release sets in after the hold time");
+
+        bool fading = true;
+        for (int n = impulsePosition - fadeInSamples + 1; n < impulsePosition; ++n)
+            fading = fading && envelope[n] < 0.0f && envelope[n] <= envelope[n - 1] && envelope[n] > reduction;
+
+        bool untouched = true;
+        for (int n = 0; n <= impulsePosition - fadeInSamples; ++n)
+            untouched = untouched && envelope[n] == 0.0f;
+
+        expect (fading, "the fade-in deepens towards the impulse");
+        expect (untouched, "nothing before the fade-in is reduced");
+    }
+
+    /** Noise with loud bursts, a minute of it in blocks: every sample stays at or below the threshold, with and without a hold. */
+    void testPeaks()
+    {
+        constexpr int blockSize = 4096;
+        constexpr int64_t numSamples = 60 * static_cast<int64_t> (sampleRate);
+        const float ceiling = std::pow (10.0f, threshold / 20.0f);
+
+        for (const float holdTime : { 0.0f, 0.02f })
+        {
+            TwoPassLimiter limiter;
+            prepareBrickwall (limiter, 0.05f, holdTime);
+
+            std::vector<float> left (blockSize), right (blockSize);
+            float* channels[] = { left.data(), right.data() };
+
+            // the same signal for both passes
+            auto generate = [&] (const int64_t start)
+            {
+                std::mt19937 random (static_cast<unsigned int> (start));
+                std::normal_distribution<float> noise (0.0f, 0.2f);
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    const float level = ((start + i) / 20000) % 3 == 0 ? 4.0f : 1.0f;
+                    left[static_cast<size_t> (i)] = noise (random) * level;
+                    right[static_cast<size_t> (i)] = noise (random) * level;
+                }
+            };
+
+            bool analysed = limiter.beginAnalysis (sampleRate, 2);
+            for (int64_t start = 0; start < numSamples; start += blockSize)
+            {
+                generate (start);
+                analysed = analysed && limiter.analyse (channels, blockSize);
+            }
+            analysed = analysed && limiter.endAnalysis();
+            expect (analysed, "a minute of noise is analysed");
+
+            float peak = 0.0f;
+            for (int64_t start = 0; start < numSamples; start += blockSize)
+            {
+                generate (start);
+                limiter.process (channels, blockSize);
+
+                for (int i = 0; i < blockSize; ++i)
+                    peak = std::max ({ peak, std::abs (left[static_cast<size_t> (i)]), std::abs (right[static_cast<size_t> (i)]) });
+            }
+
+            std::printf ("noise bursts, hold %.0f ms: peak %.2f dB, threshold %.2f dB\n", holdTime * 1000.0f, 20.0f * std::log10 (peak), threshold);
+            expect (peak <= ceiling * 1.0001f, "no peak gets through");
+        }
+    }
+}
+
+int main()
+{
+    testImpulse();
+    testPeaks();
+
+    return getExitCode();
+}
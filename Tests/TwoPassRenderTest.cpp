@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    TwoPassRenderTest.cpp
+
+    Renders a file in two passes with the processor's settings and checks it against the TwoPassLimiter run on the whole signal in memory, its length and its peak; then renders it again with an envelope cache, which the second render reads the whole envelope from.
+
+  ==============================================================================
+*/
+
+#include "ProcessorHarness.h"
+#include "OfflineRenderer.h"
+#include "TestUtilities.h"
+
+using namespace TestUtilities;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+    constexpr int blockSize = 1024;
+
+    bool writeFile (const File& file, const AudioBuffer<float>& signal)
+    {
+        file.deleteFile();
+        std::unique_ptr<FileOutputStream> stream (file.createOutputStream());
+        if (stream == nullptr)
+            return false;
+
+        // 32-bit float, so the comparison below can be exact
+        WavAudioFormat wavFormat;
+        std::unique_ptr<AudioFormatWriter> writer (wavFormat.createWriterFor (stream.get(), sampleRate, numChannels, 32, {}, 0));
+        if (writer == nullptr)
+            return false;
+
+        stream.release();
+        return writer->writeFromAudioSampleBuffer (signal, 0, signal.getNumSamples());
+    }
+
+    AudioBuffer<float> readFile (const File& file)
+    {
+        AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor (file));
+        if (reader == nullptr)
+            return {};
+
+        AudioBuffer<float> signal (static_cast<int> (reader->numChannels), static_cast<int> (reader->lengthInSamples));
+        reader->read (&signal, 0, signal.getNumSamples(), 0, true, true);
+        return signal;
+    }
+}
+
+int main()
+{
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const auto directory = File::createTempFile ("TwoPassRenderTest");
+    directory.createDirectory();
+    const auto inputFile = directory.getChildFile ("input.wav");
+    const auto outputFile = directory.getChildFile ("output.wav");
+
+    AudioBuffer<float> input (numChannels, static_cast<int> (10 * sampleRate) + 123);
+    ProcessorHarness::fillWithTestSignal (input, 3);
+    expect (writeFile (inputFile, input), "the input file is written");
+
+    // without attack, the envelope catches every peak, and its fades make up for the missing delay
+    TLimiterAudioProcessor processor;
+    ProcessorHarness::setParameter (processor, "attack", 0.0f);
+    ProcessorHarness::setParameter (processor, "threshold", -10.0f);
+
+    TwoPassLimiter limiter;
+    processor.configureTwoPassLimiter (limiter);
+
+    OfflineRenderer renderer (processor, blockSize);
+    renderer.setCollectsRenderStatistics (true);
+    const auto result = renderer.renderTwoPass (inputFile, outputFile, limiter);
+    std::printf ("two-pass render: %s, %.3f s processing\n", result.wasOk() ? "ok" : result.getErrorMessage().toRawUTF8(), renderer.getStatistics().processSeconds);
+    expect (result.wasOk(), "the file is rendered in two passes");
+
+    // the reference: both passes over the signal in memory, in other block sizes
+    TwoPassLimiter reference;
+    processor.configureTwoPassLimiter (reference);
+    AudioBuffer<float> expected (input);
+
+    reference.beginAnalysis (sampleRate, numChannels);
+    for (int start = 0; start < expected.getNumSamples(); start += 999)
+    {
+        const float* channels[] = { expected.getReadPointer (0, start), expected.getReadPointer (1, start) };
+        reference.analyse (channels, jmin (999, expected.getNumSamples() - start));
+    }
+    reference.endAnalysis();
+
+    for (int start = 0; start < expected.getNumSamples(); start += 333)
+    {
+        float* channels[] = { expected.getWritePointer (0, start), expected.getWritePointer (1, start) };
+        reference.process (channels, jmin (333, expected.getNumSamples() - start));
+    }
+
+    const auto output = readFile (outputFile);
+    expect (output.getNumSamples() == input.getNumSamples(), "the output is as long as the input, nothing is delayed");
+
+    int numDifferent = 0;
+    for (int ch = 0; ch < numChannels && output.getNumSamples() == input.getNumSamples(); ++ch)
+        for (int i = 0; i < output.getNumSamples(); ++i)
+            numDifferent += output.getSample (ch, i) != expected.getSample (ch, i) ? 1 : 0;
+
+    std::printf ("samples differing from the limiter in memory: %d, peak %.3f dB\n", numDifferent, renderer.getRenderStatistics().getSamplePeakInDecibels());
+    expect (numDifferent == 0, "the render is the two-pass limiter over the whole file");
+    expect (renderer.getRenderStatistics().getSamplePeakInDecibels() <= -9.99f, "nothing gets past the threshold");
+    expect (outputFile.withFileExtension ("json").existsAsFile(), "the report is written next to the output");
+
+    // with a cache: the first render, with another make-up gain, stores the envelope, the second one reads all of it
+    const auto cacheDirectory = directory.getChildFile ("cache");
+    renderer.setEnvelopeCacheDirectory (cacheDirectory);
+
+    for (const bool expectHit : { false, true })
+    {
+        TwoPassLimiter cachedLimiter;
+        processor.configureTwoPassLimiter (cachedLimiter);
+        if (! expectHit)
+            cachedLimiter.setMakeUpGain (3.0f); // not part of the key, the envelope is the same
+
+        const auto cachedFile = directory.getChildFile (expectHit ? "hit.wav" : "miss.wav");
+        expect (renderer.renderTwoPass (inputFile, cachedFile, cachedLimiter).wasOk(), "the file is rendered with the envelope cache");
+
+        const auto numFromCache = renderer.getStatistics().numSamplesFromCache;
+        std::printf ("%s: %lld samples from the cache, %.3f s processing\n", expectHit ? "again" : "first", static_cast<long long> (numFromCache), renderer.getStatistics().processSeconds);
+        expect (numFromCache == (expectHit ? input.getNumSamples() : 0), expectHit ? "rendering again reads the whole envelope from the cache" : "the first render computes the envelope");
+
+        if (expectHit)
+        {
+            const auto cached = readFile (cachedFile);
+            bool same = cached.getNumSamples() == expected.getNumSamples();
+            for (int ch = 0; ch < numChannels && same; ++ch)
+                for (int i = 0; i < cached.getNumSamples() && same; ++i)
+                    same = cached.getSample (ch, i) == expected.getSample (ch, i);
+
+            expect (same, "the envelope from the cache renders the same file");
+        }
+    }
+
+    expect (cacheDirectory.getNumberOfChildFiles (File::findFiles) == 1, "the cache holds one entry for the file");
+
+    directory.deleteRecursively();
+    return getExitCode();
+}
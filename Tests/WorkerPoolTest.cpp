@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    WorkerPoolTest.cpp
+
+    Runs jobs back to back and after pauses, so the workers are woken from their spin and from their sleep.
+
+  ==============================================================================
+*/
+
+#include "TestUtilities.h"
+#include "WorkerPool.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace TestUtilities;
+
+namespace
+{
+    /** Runs numJobs jobs of numTasks tasks, pausing for the given time between them, and checks that every task ran exactly once. */
+    bool runJobs (WorkerPool& pool, const int numJobs, const int numTasks, const std::chrono::microseconds pause)
+    {
+        std::vector<std::atomic<int>> counts (static_cast<size_t> (numTasks));
+        bool allRanOnce = true;
+
+        for (int job = 0; job < numJobs; ++job)
+        {
+            for (auto& count : counts)
+                count.store (0, std::memory_order_relaxed);
+
+            auto task = [&counts] (int taskIndex) { counts[static_cast<size_t> (taskIndex)].fetch_add (1, std::memory_order_relaxed); };
+            pool.parallelFor (numTasks, task);
+
+            for (auto& count : counts)
+                allRanOnce = allRanOnce && count.load (std::memory_order_relaxed) == 1;
+
+            if (pause.count() > 0)
+                std::this_thread::sleep_for (pause);
+        }
+
+        return allRanOnce;
+    }
+}
+
+int main()
+{
+    WorkerPool pool;
+    pool.start (3);
+    expect (pool.getNumThreads() == 3, "the pool spawns the workers it's asked for");
+
+    expect (runJobs (pool, 2000, 16, std::chrono::microseconds (0)), "back-to-back jobs run every task once");
+
+    // longer than the workers spin, so they go to sleep in between and have to be woken
+    expect (runJobs (pool, 200, 16, std::chrono::microseconds (300)), "jobs after a pause run every task once");
+    expect (runJobs (pool, 200, 3, std::chrono::microseconds (150)), "fewer tasks than threads run once each");
+
+    // sleeping workers are woken to exit, and a restarted pool starts without leftover wake-ups
+    for (int i = 0; i < 20; ++i)
+    {
+        pool.start (1 + i % 4);
+        std::this_thread::sleep_for (std::chrono::microseconds (i % 2 == 0 ? 0 : 500));
+        expect (runJobs (pool, 20, 8, std::chrono::microseconds (50 * (i % 5))), "a restarted pool runs every task once");
+    }
+
+    pool.stop();
+    expect (pool.getNumThreads() == 0, "stop joins all workers");
+    expect (runJobs (pool, 10, 4, std::chrono::microseconds (0)), "without workers, the caller runs all tasks");
+
+    return getExitCode();
+}
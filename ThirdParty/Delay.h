@@ -23,6 +23,9 @@
 
 #pragma once
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "../Modules/TraceZones.h"
+#include "../Modules/MemoryArena.h"
+#include "../Modules/DspCheckpoint.h"
 
 using namespace juce;
 using namespace dsp;
@@ -48,7 +51,9 @@ public:
             bypassed = false;
         }
 
-        prepare (spec);
+        // arena memory is sized for the delay time it was prepared with
+        if (! usesArena)
+            prepare (spec);
     }
 
     const int getDelayInSamples()
@@ -65,11 +70,45 @@ public:
         buffer.setSize (specs.numChannels, specs.maximumBlockSize + delayInSamples);
         buffer.clear();
         writePosition = 0;
+        usesArena = false;
+    }
+
+    /** Prepares the delay line like above, but takes its buffer from the given arena. Set the delay time before.
+        Returns false if the arena is exhausted; the delay line mustn't be used until it was prepared successfully.
+     */
+    bool prepare (const ProcessSpec& specs, MemoryArena& arena)
+    {
+        spec = specs;
+
+        delayInSamples = static_cast<int> (delay * specs.sampleRate);
+        const int numSamples = static_cast<int> (specs.maximumBlockSize) + delayInSamples;
+
+        float* channels[maxNumArenaChannels];
+        const int numChannels = jmin ((int) specs.numChannels, maxNumArenaChannels);
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            channels[ch] = arena.allocate<float> (static_cast<size_t> (numSamples));
+            if (channels[ch] == nullptr)
+                return false;
+        }
+
+        buffer.setDataToReferTo (channels, numChannels, numSamples);
+        writePosition = 0;
+        usesArena = true;
+        return true;
+    }
+
+    /** The number of arena bytes prepare() takes for the given settings. */
+    static size_t getRequiredArenaBytes (const ProcessSpec& specs, const float delayTimeInSeconds)
+    {
+        const int numSamples = static_cast<int> (specs.maximumBlockSize) + static_cast<int> (jmax (0.0f, delayTimeInSeconds) * specs.sampleRate);
+        return jmin ((size_t) specs.numChannels, (size_t) maxNumArenaChannels) * MemoryArena::getRequiredBytes<float> (static_cast<size_t> (numSamples));
     }
 
     void process (const ProcessContextReplacing<float>& context) override
     {
         ScopedNoDenormals noDenormals;
+        TLIMITER_TRACE_ZONE ("Delay::process");
 
         if (! bypassed)
         {
@@ -113,6 +152,33 @@ public:
 
     }
 
+    /** Saves the delay line's contents and position into the checkpoint. */
+    void saveState (DspCheckpoint& checkpoint) const
+    {
+        checkpoint.write (buffer.getNumChannels());
+        checkpoint.write (buffer.getNumSamples());
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            checkpoint.write (buffer.getReadPointer (ch), static_cast<size_t> (buffer.getNumSamples()));
+
+        checkpoint.write (writePosition);
+    }
+
+    /** Restores a checkpoint; fails if the delay line was prepared for a different size. */
+    bool restoreState (DspCheckpoint::Reader& reader)
+    {
+        int numChannels = 0, numSamples = 0;
+        if (! reader.read (numChannels) || ! reader.read (numSamples)
+            || numChannels != buffer.getNumChannels() || numSamples != buffer.getNumSamples())
+            return false;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            if (! reader.read (buffer.getWritePointer (ch), static_cast<size_t> (numSamples)))
+                return false;
+
+        return reader.read (writePosition);
+    }
+
     void getReadWritePositions (bool read, int numSamples, int& startIndex, int& blockSize1, int& blockSize2)
     {
         const int L = buffer.getNumSamples();
@@ -144,10 +210,13 @@ public:
 
 private:
     //==============================================================================
+    static constexpr int maxNumArenaChannels = 32;
+
     ProcessSpec spec = {-1, 0, 0};
     float delay;
     int delayInSamples = 0;
     bool bypassed = false;
     int writePosition = 0;
+    bool usesArena = false;
     AudioBuffer<float> buffer;
 };